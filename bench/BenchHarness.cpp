@@ -0,0 +1,251 @@
+#include "BenchHarness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sched.h>
+#include <unistd.h>
+
+namespace bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<Case>& registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+int g_pinnedCpu = -1;
+
+bool pinTo(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+double runOnce(const Case& c, State& st)
+{
+    const auto start = Clock::now();
+    c.body(st);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string cpuModel()
+{
+    std::ifstream in("/proc/cpuinfo");
+    std::string   line;
+    while (std::getline(in, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            const size_t pos = line.find(':');
+            return pos == std::string::npos ? line : line.substr(pos + 2);
+        }
+    }
+    return "unknown";
+}
+
+std::string jsonEscape(const std::string& s)
+{
+    std::string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(ch);
+    }
+    return out;
+}
+
+void writeJson(const Options& opts, const std::vector<Result>& results)
+{
+    std::ofstream out(opts.jsonPath);
+    if (!out) {
+        std::cerr << "[bench] Cannot write " << opts.jsonPath << "\n";
+        return;
+    }
+    char host[256] = {0};
+    ::gethostname(host, sizeof(host) - 1);
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"host\": \"" << jsonEscape(host) << "\",\n"
+        << "    \"cpu_model\": \"" << jsonEscape(cpuModel()) << "\",\n"
+        << "    \"num_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n"
+        << "    \"pinned_cpu\": " << g_pinnedCpu << ",\n"
+        << "    \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n"
+#ifdef NDEBUG
+        << "    \"assertions\": false,\n"
+#else
+        << "    \"assertions\": true,\n"
+#endif
+        << "    \"warmup_s\": " << opts.warmupS << ",\n"
+        << "    \"min_time_s\": " << opts.minTimeS << ",\n"
+        << "    \"repetitions\": " << opts.repetitions << "\n  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.nsMedian << ", \"ns_per_op_min\": " << r.nsMin
+            << ", \"ns_per_op_max\": " << r.nsMax;
+        if (r.mbPerSec > 0) {
+            out << ", \"mb_per_s\": " << r.mbPerSec;
+        }
+        for (const auto& kv : r.counters) {
+            out << ", \"" << jsonEscape(kv.first) << "\": " << kv.second;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    std::cout << "[bench] Results written to " << opts.jsonPath << "\n";
+}
+
+} // namespace
+
+void add(const std::string& name, Body body, double bytesPerOp)
+{
+    registry().push_back(Case{name, std::move(body), bytesPerOp});
+}
+
+bool parseArgs(int argc, char* argv[], Options& opts)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const char* what) -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << what << "\n";
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char* v = nullptr;
+        if (arg == "--list") {
+            opts.listOnly = true;
+        } else if (arg == "--filter" && (v = value("--filter"))) {
+            opts.filter = v;
+        } else if (arg == "--cpu" && (v = value("--cpu"))) {
+            opts.cpu = std::atoi(v);
+        } else if (arg == "--warmup" && (v = value("--warmup"))) {
+            opts.warmupS = std::atof(v);
+        } else if (arg == "--min-time" && (v = value("--min-time"))) {
+            opts.minTimeS = std::atof(v);
+        } else if (arg == "--reps" && (v = value("--reps"))) {
+            opts.repetitions = std::max(1, std::atoi(v));
+        } else if (arg == "--json" && (v = value("--json"))) {
+            opts.jsonPath = v;
+        } else {
+            std::printf("Usage: %s [--list] [--filter SUBSTR] [--cpu N|-1] [--warmup S] [--min-time S] [--reps N] "
+                        "[--json PATH]\n",
+                        argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t runAll(const Options& opts)
+{
+    std::vector<Case> cases;
+    for (const Case& c : registry()) {
+        if (opts.filter.empty() || c.name.find(opts.filter) != std::string::npos) {
+            cases.push_back(c);
+        }
+    }
+    if (opts.listOnly) {
+        for (const Case& c : cases) {
+            std::cout << c.name << "\n";
+        }
+        return cases.size();
+    }
+
+    if (opts.cpu >= 0) {
+        if (pinTo(opts.cpu)) {
+            g_pinnedCpu = opts.cpu;
+        } else {
+            std::cerr << "[bench] Cannot pin to CPU " << opts.cpu << ": " << std::strerror(errno) << "\n";
+        }
+    }
+
+    std::printf("%-48s %14s %12s %12s %12s %10s\n", "benchmark", "iterations", "ns/op", "min", "max", "MB/s");
+    std::vector<Result> results;
+    for (const Case& c : cases) {
+        // 1. 预热：迭代次数倍增直到累计时间超过 warmupS，同时得到单次耗时的粗略估计
+        State    st;
+        uint64_t iters = 1;
+        double   spent = 0, last = 0;
+        while (true) {
+            st.iterations = iters;
+            last  = runOnce(c, st);
+            spent += last;
+            if (spent >= opts.warmupS || last >= opts.minTimeS) {
+                break;
+            }
+            iters *= 2;
+        }
+
+        // 2. 按估计的单次耗时确定每次重复的迭代次数
+        const double perOp = last / static_cast<double>(iters);
+        const uint64_t n = std::max<uint64_t>(1, static_cast<uint64_t>(opts.minTimeS / std::max(perOp, 1e-9)));
+
+        std::vector<double> samples;
+        for (int rep = 0; rep < opts.repetitions; ++rep) {
+            st.iterations = n;
+            st.counters.clear();
+            samples.push_back(runOnce(c, st) * 1e9 / static_cast<double>(n));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result r;
+        r.name       = c.name;
+        r.iterations = n;
+        r.nsMedian   = samples[samples.size() / 2];
+        r.nsMin      = samples.front();
+        r.nsMax      = samples.back();
+        r.mbPerSec   = c.bytesPerOp > 0 ? c.bytesPerOp / r.nsMedian * 1e3 : 0;
+        r.counters   = st.counters;
+        results.push_back(r);
+
+        std::printf("%-48s %14llu %12.1f %12.1f %12.1f", r.name.c_str(), static_cast<unsigned long long>(n),
+                    r.nsMedian, r.nsMin, r.nsMax);
+        if (r.mbPerSec > 0) {
+            std::printf(" %10.1f", r.mbPerSec);
+        }
+        for (const auto& kv : r.counters) {
+            std::printf("  %s=%.1f", kv.first.c_str(), kv.second);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    if (!opts.jsonPath.empty()) {
+        writeJson(opts, results);
+    }
+    return results.size();
+}
+
+void pinHelperThread()
+{
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 2) {
+        // 单核时恢复为不绑定，让调度器在被测线程让出 CPU 时运行辅助线程
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(0, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+        return;
+    }
+    const int base = g_pinnedCpu >= 0 ? g_pinnedCpu : 0;
+    pinTo(static_cast<int>((base + 1) % cpus));
+}
+
+} // namespace bench
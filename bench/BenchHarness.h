@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 微基准框架（dji-bench 使用）：固定 CPU、预热、自动确定迭代次数、多次重复取中位数、JSON 输出。
+ *
+ *        - 每个用例是一个 Body：按 State::iterations 执行若干次被测操作；
+ *          先预热，再按最短运行时间确定迭代次数，之后重复 repetitions 次，报告 ns/op 的中位数 / 最小 / 最大值；
+ *        - Body 可在 State::counters 中写入附加指标（如延时百分位），取最后一次重复的值；
+ *        - 多线程用例的辅助线程用 pinHelperThread() 放到另一个 CPU，避免与被测线程争用同一个核。
+ */
+namespace bench {
+
+struct State {
+    uint64_t                      iterations = 0;
+    std::map<std::string, double> counters;
+};
+
+using Body = std::function<void(State&)>;
+
+struct Case {
+    std::string name;
+    Body        body;
+    double      bytesPerOp = 0;   ///< 非 0 时额外报告吞吐（MB/s）
+};
+
+struct Options {
+    std::string filter;           ///< 用例名包含该子串才运行，空表示全部
+    int         cpu         = 0;  ///< 被测线程绑定的 CPU，-1 表示不绑定
+    double      warmupS     = 0.1;
+    double      minTimeS    = 0.2;   ///< 单次重复的最短运行时间
+    int         repetitions = 5;
+    std::string jsonPath;         ///< 非空时写出 JSON 结果
+    bool        listOnly    = false;
+};
+
+struct Result {
+    std::string                   name;
+    uint64_t                      iterations = 0;
+    double                        nsMedian = 0;
+    double                        nsMin    = 0;
+    double                        nsMax    = 0;
+    double                        mbPerSec = 0;
+    std::map<std::string, double> counters;
+};
+
+/**
+ * @brief 注册用例（在 main 之前或 main 中调用均可）
+ */
+void add(const std::string& name, Body body, double bytesPerOp = 0);
+
+/**
+ * @brief 解析命令行参数，失败或 --help 时返回 false
+ */
+bool parseArgs(int argc, char* argv[], Options& opts);
+
+/**
+ * @brief 运行所有匹配的用例并打印结果表，返回运行的用例数
+ */
+size_t runAll(const Options& opts);
+
+/**
+ * @brief 把当前线程绑定到被测 CPU 之外的一个 CPU（只有一个 CPU 时不绑定）
+ */
+void pinHelperThread();
+
+/**
+ * @brief 阻止编译器把被测表达式的结果优化掉
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
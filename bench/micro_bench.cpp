@@ -0,0 +1,531 @@
+// 热路径微基准：cmake --build build --target bench（结果同时写入 build/bench.json）
+//
+// 单独运行：
+//   ./build/dji-bench --list
+//   ./build/dji-bench --filter assembler --cpu 2 --reps 9 --json assembler.json
+//
+// 覆盖：命令解析 / 控制帧构造 / 大端转换、FrameAssembler::parseBuffer（块大小 × 噪声比例）、
+// ReplyFrameDecoder 逐帧解码、TelemetryData / UavState 反序列化、TelemetryUI::update 锁竞争、队列跨线程传递、
+// 控制帧负载 AES-GCM 加解密。
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchHarness.h"
+#include "CLI2Frame.h"
+#include "FrameAssembler.h"
+#include "ReplyFrameDecoder.h"
+#include "TelemetryUI.h"
+#include "TelemetryDataBuf-new.pb.h"
+#include "common_types.h"
+#include "common_utils.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/Metrics.h"
+#include "utils/PayloadCipher.h"
+
+/**
+ * @brief 访问被测类私有成员的入口（各类中声明为 friend）
+ */
+struct BenchAccess {
+    static void feed(FrameAssembler& fa, const uint8_t* data, size_t size)
+    {
+        fa.m_buffer.insert(fa.m_buffer.end(), data, data + size);
+        fa.m_lastRecvNs = Metrics::nowNs();
+        fa.parseBuffer();
+    }
+
+    static void decodeByte(ReplyFrameDecoder& dec, uint8_t byte) { dec.processByte(byte); }
+
+    static std::mutex& dataMutex(TelemetryUI& ui) { return ui.m_dataMutex; }
+    static const TelemetryData& data(TelemetryUI& ui) { return ui.m_data; }
+};
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// 样本数据
+// ---------------------------------------------------------------------------
+TelemetryData sampleTelemetry(uint64_t seq)
+{
+    TelemetryData t;
+    t.set_lng(113.9423 + seq * 1e-7);
+    t.set_lat(22.5251 + seq * 1e-7);
+    t.set_altitude(152.3f);
+    t.set_ultrasonic(98.7f);
+    t.set_pitch(-2.5f);
+    t.set_roll(1.25f);
+    t.set_yaw(87.0f);
+    t.set_airspeed(12.1f);
+    t.set_velocity(11.8f);
+    t.set_timestamp(1700000000000ULL + seq);
+    t.set_ptpitch(-45.0f);
+    t.set_ptyaw(10.0f);
+    t.set_zoomfactor(2.0f);
+    t.set_boxsn("SIMBOX000000001");
+    t.set_batterypower("82_80");
+    t.set_satellitecount(24);
+    t.set_rtklng(113.94231);
+    t.set_rtklat(22.52512);
+    t.set_rtkhfsl(140.2f);
+    t.set_rtkpositioninfo(50);
+    t.set_airflytimes(321);
+    t.set_airflydistance(2450.5f);
+    t.set_uavsn("1581F5FHD23B00DQ0001");
+    t.set_uavmodel("M30T");
+    t.set_homerange(812.0f);
+    t.set_flightmode(14);
+    t.set_xvelocity(3.2f);
+    t.set_yvelocity(-1.1f);
+    t.set_zvelocity(0.2f);
+    t.set_boxname("bench");
+    return t;
+}
+
+UavState sampleUavState()
+{
+    UavState s;
+    s.set_boxsn("SIMBOX000000001");
+    s.set_timestamp(1700000000000ULL);
+    auto* fc = s.mutable_flightcontrollerstate();
+    fc->set_satellitecount(24);
+    fc->set_gpssignallevel(5);
+    fc->set_flightmode(14);
+    fc->set_flightstatus(2);
+    fc->set_homeheight(120);
+    fc->set_rcmode("N");
+    fc->set_rcconnected(1);
+    auto* bat = s.mutable_batterystate();
+    bat->set_batterynum(2);
+    bat->set_batterypower("82_80");
+    bat->set_batteryvoltage("47_47");
+    for (auto* info : {bat->mutable_firstbatteryinfo(), bat->mutable_secondbatteryinfo()}) {
+        info->set_batterycapacitypercent(81);
+        info->set_currentvoltage(47200);
+        info->set_currentelectric(-12000);
+        info->set_fullcapacity(5880);
+        info->set_remainedcapacity(4760);
+        info->set_batterytemperature(32.5f);
+        info->set_cellcount(12);
+    }
+    auto* ptz = s.mutable_ptzstate();
+    ptz->set_pitch(-45.0f);
+    ptz->set_yaw(10.0f);
+    ptz->set_gimbalmode(2);
+    return s;
+}
+
+// 0x6A 0x77 | 长度（命令 + 负载，大端） | 命令 | 负载
+void appendReplyFrame(std::vector<uint8_t>& out, uint8_t cmdId, const std::string& payload)
+{
+    const uint16_t len = static_cast<uint16_t>(payload.size() + 1);
+    out.push_back(0x6A);
+    out.push_back(0x77);
+    out.push_back(static_cast<uint8_t>(len >> 8));
+    out.push_back(static_cast<uint8_t>(len & 0xFF));
+    out.push_back(cmdId);
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+/**
+ * @brief 约 1MB 的 0xA9 / 0xA8 混合数据流，帧间按字节比例 noise 插入不含 0x6A 的随机字节，
+ *        末尾用噪声补齐到 chunk 的整数倍，使循环回绕时不会把半帧拼到下一轮开头
+ */
+std::vector<uint8_t> makeStream(size_t chunk, double noise)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto noiseByte = [&] {
+        uint8_t b;
+        do {
+            b = static_cast<uint8_t>(byteDist(rng));
+        } while (b == 0x6A);
+        return b;
+    };
+
+    const std::string a8 = sampleUavState().SerializeAsString();
+    std::vector<uint8_t> out;
+    out.reserve(1 << 20);
+    for (uint64_t seq = 0; out.size() < (1u << 20); ++seq) {
+        const size_t before = out.size();
+        if (seq % 5 == 4) {
+            appendReplyFrame(out, 0xA8, a8);
+        } else {
+            appendReplyFrame(out, 0xA9, sampleTelemetry(seq).SerializeAsString());
+        }
+        // 噪声字节数的期望 = 帧长 × noise / (1 - noise)，即噪声占总字节数的 noise
+        const double want = (out.size() - before) * noise / (1.0 - noise);
+        size_t n = static_cast<size_t>(want);
+        n += unit(rng) < (want - n) ? 1 : 0;
+        for (size_t i = 0; i < n; ++i) {
+            out.push_back(noiseByte());
+        }
+    }
+    while (out.size() % chunk) {
+        out.push_back(noiseByte());
+    }
+    return out;
+}
+
+void drainCompleteQueue()
+{
+    std::queue<StampedFrame> drained;
+    std::lock_guard<std::mutex> lk(g_completeQueueMutex);
+    g_completeDataFrameQueue.swap(drained);
+}
+
+void setLatencyCounters(bench::State& st, const LatencyHistogram& hist, const char* prefix)
+{
+    const std::string p = prefix;
+    st.counters[p + "p50_ns"] = static_cast<double>(hist.percentile(50));
+    st.counters[p + "p99_ns"] = static_cast<double>(hist.percentile(99));
+    st.counters[p + "max_ns"] = static_cast<double>(hist.max());
+}
+
+// ---------------------------------------------------------------------------
+// CLI2Frame / common_utils
+// ---------------------------------------------------------------------------
+void registerCodecCases()
+{
+    const char* commands[][2] = {
+        {"parseCommand/takeoff", "takeoff 30"},
+        {"parseCommand/goto", "goto 113.9423 22.5251 120 10 0"},
+        {"parseCommand/gimbal_speed", "gimbal move speed 5 0 -10 500"},
+    };
+    for (const auto& cmd : commands) {
+        const std::string line = cmd[1];
+        bench::add(cmd[0], [line](bench::State& st) {
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                DataFrame f = parseCommand(line);
+                bench::doNotOptimize(f.data());
+            }
+        });
+    }
+
+    for (size_t paramLen : {0, 16, 1024}) {
+        const std::vector<uint8_t> param(paramLen, 0x5A);
+        bench::add("createControlFrame/param_" + std::to_string(paramLen), [param](bench::State& st) {
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                DataFrame f = createControlFrame(0x44, param);
+                bench::doNotOptimize(f.data());
+            }
+        }, static_cast<double>(paramLen));
+    }
+    {
+        // 航线分包路径：分包头 + 缓存中的数据片段
+        const std::vector<uint8_t> head(8, 0x01);
+        const std::vector<uint8_t> body(1024, 0x5A);
+        bench::add("createControlFrame/two_segment_1024", [head, body](bench::State& st) {
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                DataFrame f = createControlFrame(0x44, head.data(), head.size(), body.data(), body.size());
+                bench::doNotOptimize(f.data());
+            }
+        }, static_cast<double>(head.size() + body.size()));
+    }
+
+    bench::add("toBigEndian/float", [](bench::State& st) {
+        float v = 1.5f;
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            auto b = floatToBigEndian(v);
+            bench::doNotOptimize(b.data());
+            v += 0.25f;
+        }
+    });
+    bench::add("toBigEndian/double", [](bench::State& st) {
+        double v = 113.9423;
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            auto b = doubleToBigEndian(v);
+            bench::doNotOptimize(b.data());
+            v += 1e-7;
+        }
+    });
+    bench::add("toBigEndian/uint16", [](bench::State& st) {
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            auto b = uint16ToBigEndian(static_cast<uint16_t>(i));
+            bench::doNotOptimize(b.data());
+        }
+    });
+    bench::add("toBigEndian/uint32", [](bench::State& st) {
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            auto b = uint32ToBigEndian(static_cast<uint32_t>(i));
+            bench::doNotOptimize(b.data());
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// 接收路径：FrameAssembler / ReplyFrameDecoder / protobuf
+// ---------------------------------------------------------------------------
+void registerRecvCases()
+{
+    // 每次操作送入一块数据（模拟一次 recv），解析出的完整帧随即清空，
+    // 队列出队和帧析构的开销计入结果（与真实流水线中解码线程取走帧相当）
+    for (size_t chunk : {64, 1024, 16384}) {
+        for (double noise : {0.0, 0.01, 0.10}) {
+            char name[64];
+            std::snprintf(name, sizeof(name), "assembler/chunk_%zu/noise_%g%%", chunk, noise * 100);
+            auto stream = std::make_shared<std::vector<uint8_t>>();
+            bench::add(name, [stream, chunk, noise](bench::State& st) {
+                if (stream->empty()) {
+                    *stream = makeStream(chunk, noise);
+                }
+                FrameAssembler fa(false);
+                size_t offset = 0;
+                for (uint64_t i = 0; i < st.iterations; ++i) {
+                    BenchAccess::feed(fa, stream->data() + offset, chunk);
+                    drainCompleteQueue();
+                    offset += chunk;
+                    if (offset == stream->size()) {
+                        offset = 0;
+                    }
+                }
+            }, static_cast<double>(chunk));
+        }
+    }
+
+    {
+        std::vector<uint8_t> frame;
+        appendReplyFrame(frame, 0xA9, sampleTelemetry(0).SerializeAsString());
+        bench::add("decoder/a9_frame", [frame](bench::State& st) {
+            ReplyFrameDecoder dec;
+            uint64_t frames = 0;
+            dec.setDecodeCallback([&frames](uint8_t, const uint8_t*, uint16_t) { ++frames; });
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                for (uint8_t b : frame) {
+                    BenchAccess::decodeByte(dec, b);
+                }
+            }
+            bench::doNotOptimize(frames);
+        }, static_cast<double>(frame.size()));
+    }
+
+    {
+        const std::string bytes = sampleTelemetry(0).SerializeAsString();
+        bench::add("protobuf/TelemetryData_parse", [bytes](bench::State& st) {
+            TelemetryData t;
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                t.ParseFromString(bytes);
+                bench::doNotOptimize(t.lng());
+            }
+        }, static_cast<double>(bytes.size()));
+    }
+    {
+        const std::string bytes = sampleUavState().SerializeAsString();
+        bench::add("protobuf/UavState_parse", [bytes](bench::State& st) {
+            UavState s;
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                s.ParseFromString(bytes);
+                bench::doNotOptimize(s.timestamp());
+            }
+        }, static_cast<double>(bytes.size()));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TelemetryUI::update：无竞争 / 渲染线程持锁读数据时
+// ---------------------------------------------------------------------------
+void registerUiCases()
+{
+    bench::add("ui_update/uncontended", [](bench::State& st) {
+        TelemetryUI ui;
+        const TelemetryData t = sampleTelemetry(0);
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            ui.update(t);
+        }
+    });
+
+    // 辅助线程模拟 render()：持 m_dataMutex 读取全部字段后释放，立即再取锁，
+    // 即渲染线程满负荷时的最坏情况；逐次记录 update() 的耗时分布
+    bench::add("ui_update/contended_render", [](bench::State& st) {
+        TelemetryUI ui;
+        const TelemetryData t = sampleTelemetry(0);
+        std::atomic<bool> stop{false};
+        std::thread render([&] {
+            bench::pinHelperThread();
+            TelemetryData copy;
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lk(BenchAccess::dataMutex(ui));
+                copy = BenchAccess::data(ui);
+                bench::doNotOptimize(copy.lng());
+            }
+        });
+        LatencyHistogram hist;
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            const uint64_t start = Metrics::nowNs();
+            ui.update(t);
+            hist.record(Metrics::nowNs() - start);
+        }
+        stop = true;
+        render.join();
+        setLatencyCounters(st, hist, "");
+    });
+}
+
+// ---------------------------------------------------------------------------
+// 队列跨线程传递
+// ---------------------------------------------------------------------------
+void registerQueueCases()
+{
+    // 原始数据队列 -> 完整帧队列 -> 回到本线程：两次条件变量唤醒的往返时延
+    bench::add("queue/raw_complete_roundtrip", [](bench::State& st) {
+        std::atomic<bool> stop{false};
+        std::thread relay([&] {
+            bench::pinHelperThread();
+            while (true) {
+                StampedFrame f;
+                {
+                    std::unique_lock<std::mutex> lock(g_recvRawQueueMutex);
+                    g_recvRawQueueCond.wait(lock, [&] { return !g_recvRawDataFrameQueue.empty() || stop.load(); });
+                    if (g_recvRawDataFrameQueue.empty()) {
+                        return;
+                    }
+                    f = std::move(g_recvRawDataFrameQueue.front());
+                    g_recvRawDataFrameQueue.pop();
+                }
+                {
+                    std::lock_guard<std::mutex> lk(g_completeQueueMutex);
+                    g_completeDataFrameQueue.push(std::move(f));
+                }
+                g_completeQueueCond.notify_one();
+            }
+        });
+
+        LatencyHistogram hist;
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            StampedFrame f;
+            f.data.assign(64, 0x5A);
+            f.recvNs = Metrics::nowNs();
+            {
+                std::lock_guard<std::mutex> lk(g_recvRawQueueMutex);
+                g_recvRawDataFrameQueue.push(std::move(f));
+            }
+            g_recvRawQueueCond.notify_one();
+
+            std::unique_lock<std::mutex> lock(g_completeQueueMutex);
+            g_completeQueueCond.wait(lock, [] { return !g_completeDataFrameQueue.empty(); });
+            hist.record(Metrics::nowNs() - g_completeDataFrameQueue.front().recvNs);
+            g_completeDataFrameQueue.pop();
+        }
+        {
+            std::lock_guard<std::mutex> lk(g_recvRawQueueMutex);
+            stop = true;
+        }
+        g_recvRawQueueCond.notify_all();
+        relay.join();
+        setLatencyCounters(st, hist, "rtt_");
+    });
+
+    // 发送队列吞吐：本线程连续入队，辅助线程按 ComTask::sendThreadFunc 的方式每次最多取出 16 帧
+    bench::add("queue/send_stream", [](bench::State& st) {
+        std::atomic<bool> stop{false};
+        std::thread consumer([&] {
+            bench::pinHelperThread();
+            std::vector<DataFrame> batch;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(g_queueMutex);
+                    g_queueCond.wait(lock, [&] { return !g_dataFrameQueue.empty() || stop.load(); });
+                    if (g_dataFrameQueue.empty()) {
+                        return;
+                    }
+                    while (!g_dataFrameQueue.empty() && batch.size() < 16) {
+                        batch.push_back(std::move(g_dataFrameQueue.front()));
+                        g_dataFrameQueue.pop();
+                    }
+                }
+                bench::doNotOptimize(batch.data());
+                batch.clear();
+            }
+        });
+
+        const DataFrame frame = createControlFrame(0x11, floatToBigEndian(30.0f));
+        for (uint64_t i = 0; i < st.iterations; ++i) {
+            DataFrame f = frame;
+            {
+                std::lock_guard<std::mutex> lk(g_queueMutex);
+                g_dataFrameQueue.push(std::move(f));
+            }
+            g_queueCond.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lk(g_queueMutex);
+            stop = true;
+        }
+        g_queueCond.notify_all();
+        consumer.join();   // 计时包含取空队列
+    });
+}
+
+// ---------------------------------------------------------------------------
+// 控制帧负载加密（与 createControlFrame/param_* 明文用例对照）
+// ---------------------------------------------------------------------------
+void registerCipherCases()
+{
+    const std::vector<uint8_t> key(32, 0x42);
+
+    for (size_t paramLen : {0, 16, 1024}) {
+        const std::vector<uint8_t> param(paramLen, 0x5A);
+        bench::add("createControlFrame/aes256gcm_param_" + std::to_string(paramLen), [param, key](bench::State& st) {
+            g_payloadCipher.setKey(key);
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                DataFrame f = createControlFrame(0x44, param);
+                bench::doNotOptimize(f.data());
+            }
+            g_payloadCipher.setKey({});
+            st.counters["aesni"] = PayloadCipher::accelerated() ? 1 : 0;
+        }, static_cast<double>(paramLen));
+    }
+
+    // 纯加解密吞吐：就地加密、异地解密（保持输入不变），AAD 与控制帧一样为 20 字节
+    for (size_t len : {64, 1024, 16384}) {
+        auto cipher = std::make_shared<PayloadCipher>();
+        cipher->setKey(key);
+        const std::vector<uint8_t> aad(20, 0x11);
+
+        bench::add("cipher/seal_" + std::to_string(len), [cipher, aad, len](bench::State& st) {
+            std::vector<uint8_t> buf(len + PayloadCipher::kOverhead, 0x5A);
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                cipher->seal(aad.data(), aad.size(), buf.data() + PayloadCipher::kNonceSize, len, buf.data());
+                bench::doNotOptimize(buf.data());
+            }
+        }, static_cast<double>(len));
+
+        bench::add("cipher/open_" + std::to_string(len), [cipher, aad, len](bench::State& st) {
+            std::vector<uint8_t> sealed(len + PayloadCipher::kOverhead, 0x5A);
+            std::vector<uint8_t> plain(len);
+            cipher->seal(aad.data(), aad.size(), sealed.data() + PayloadCipher::kNonceSize, len, sealed.data());
+            uint64_t failures = 0;
+            for (uint64_t i = 0; i < st.iterations; ++i) {
+                failures += !cipher->open(aad.data(), aad.size(), sealed.data(), sealed.size(), plain.data());
+                bench::doNotOptimize(plain.data());
+            }
+            st.counters["failures"] = static_cast<double>(failures);
+        }, static_cast<double>(len));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bench::Options opts;
+    if (!bench::parseArgs(argc, argv, opts)) {
+        return 1;
+    }
+
+    registerCodecCases();
+    registerRecvCases();
+    registerUiCases();
+    registerQueueCases();
+    registerCipherCases();
+
+    return bench::runAll(opts) > 0 ? 0 : 1;
+}
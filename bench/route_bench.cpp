@@ -0,0 +1,163 @@
+// route_bench.cpp
+//
+// 航线 JSON 读写基准：对比 protobuf JSON 工具 + nlohmann 往返（旧实现）与
+// RouteDataModule 的流式读写（新实现）。
+//
+// 用法: route-bench [点数=100000] [临时目录=/tmp]
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <string>
+
+#include <google/protobuf/util/json_util.h>
+#include <nlohmann/json.hpp>
+
+#include "routeDataModule.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 重置并读取本进程的峰值 RSS（/proc/self/clear_refs 写 5 会重置 VmHWM）
+void resetPeakRss()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+long peakRssKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+long currentRssKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+// 生成 N 个航点的合成测绘航线（蛇形往返，每点带一个拍照动作）
+PlanLineData makeSyntheticPlan(int numPoints)
+{
+    PlanLineData plan;
+    plan.set_finishedaction(1);
+    plan.set_maxspeed(15);
+    plan.set_autospeed(8);
+    plan.set_homeheight(100);
+    plan.mutable_points()->Reserve(numPoints);
+
+    const int perLine = 100;
+    for (int i = 0; i < numPoints; ++i) {
+        const int line = i / perLine;
+        const int col  = (line % 2 == 0) ? (i % perLine) : (perLine - 1 - i % perLine);
+        PointData* p = plan.add_points();
+        p->set_lng(116.391 + col * 0.00005);
+        p->set_lat(39.9075 + line * 0.00004);
+        p->set_height(30.0f + static_cast<float>(i % 7));
+        p->set_speed(8);
+        p->set_flightpathmode(1);
+        p->set_interestindex(-1);
+        PointAction* a = p->add_actions();
+        a->set_type(2);
+        a->set_param(1);
+        a->set_waittime(2);
+    }
+    return plan;
+}
+
+bool legacyLoad(const std::string& path, PlanLineData& plan)
+{
+    std::ifstream ifs(path);
+    std::string jsonStr((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    google::protobuf::util::JsonParseOptions opts;
+    return google::protobuf::util::JsonStringToMessage(jsonStr, &plan, opts).ok();
+}
+
+bool legacyStore(const PlanLineData& plan, const std::string& path)
+{
+    google::protobuf::util::JsonPrintOptions opts;
+    opts.add_whitespace = true;
+    opts.always_print_primitive_fields = true;
+    opts.preserve_proto_field_names = true;
+    std::string s;
+    if (!google::protobuf::util::MessageToJsonString(plan, &s, opts).ok()) {
+        return false;
+    }
+    std::ofstream ofs(path);
+    ofs << nlohmann::json::parse(s).dump(4);
+    return ofs.good();
+}
+
+bool sameFile(const std::string& a, const std::string& b)
+{
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(fa)), std::istreambuf_iterator<char>()) ==
+           std::string((std::istreambuf_iterator<char>(fb)), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int numPoints     = argc > 1 ? std::stoi(argv[1]) : 100000;
+    const std::string dir   = argc > 2 ? argv[2] : "/tmp";
+    const std::string fNew  = dir + "/route_bench_stream.json";
+    const std::string fOld  = dir + "/route_bench_legacy.json";
+
+    RouteDataModule module;
+    const PlanLineData plan = makeSyntheticPlan(numPoints);
+    std::printf("points: %d, serialized: %zu bytes\n", numPoints, plan.ByteSizeLong());
+
+    // 每个阶段单独计时，并记录该阶段相对起点的峰值 RSS 增量
+    struct Phase { double ms; long peakKb; };
+    auto measure = [](auto&& fn) {
+        malloc_trim(0);    // 归还前一阶段释放的内存，避免复用掩盖本阶段的增长
+        const long base = currentRssKb();
+        resetPeakRss();
+        auto t0 = Clock::now();
+        fn();
+        return Phase{elapsedMs(t0), peakRssKb() - base};
+    };
+
+    const Phase streamWrite = measure([&] { module.planLineDataToJsonFile(plan, fNew); });
+    const Phase legacyWrite = measure([&] { legacyStore(plan, fOld); });
+
+    PlanLineData streamPlan, legacyPlan;
+    bool okStream = false, okLegacy = false;
+    const Phase streamRead = measure([&] { okStream = module.jsonFileToPlanLineData(fNew, streamPlan); });
+    const Phase legacyRead = measure([&] { okLegacy = legacyLoad(fOld, legacyPlan); });
+
+    std::printf("%-8s %12s %14s %12s %14s\n", "", "legacy(ms)", "legacy(KiB)", "stream(ms)", "stream(KiB)");
+    std::printf("%-8s %12.1f %14ld %12.1f %14ld\n", "write",
+                legacyWrite.ms, legacyWrite.peakKb, streamWrite.ms, streamWrite.peakKb);
+    std::printf("%-8s %12.1f %14ld %12.1f %14ld\n", "read",
+                legacyRead.ms, legacyRead.peakKb, streamRead.ms, streamRead.peakKb);
+    std::printf("output identical: %s, round-trip equal: %s\n",
+                sameFile(fNew, fOld) ? "yes" : "NO",
+                (okStream && okLegacy &&
+                 streamPlan.SerializeAsString() == legacyPlan.SerializeAsString()) ? "yes" : "NO");
+
+    std::remove(fNew.c_str());
+    std::remove(fOld.c_str());
+    return 0;
+}
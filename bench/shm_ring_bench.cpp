@@ -0,0 +1,160 @@
+// shm_ring_bench.cpp
+//
+// 共享内存帧流环跨进程基准：本进程作为写者连续发布帧，fork 出的读者进程各自用
+// ShmFrameReader::poll() 零拷贝读取，并校验负载内容（前 8 字节为序号）。
+// 写者不等待读者，读者跟不上时会出现 Overrun / 丢帧，结果中分别统计。
+// 限速为 0 时写者全速发布；单核机器上读写进程轮流占用 CPU，应配合限速测试。
+//
+// 用法: shm-ring-bench [读者数=2] [帧数=5000000] [负载字节=64] [环容量 KB=4096] [限速 帧/秒=0]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ShmFrameRing.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 父子进程之间通过匿名共享内存交换启动信号与结果
+struct ReaderResult {
+    uint64_t received;
+    uint64_t lost;
+    uint64_t overruns;
+    uint64_t corrupt;
+    double   seconds;
+};
+
+struct Shared {
+    std::atomic<int>  ready;
+    std::atomic<bool> done;
+    ReaderResult      results[64];
+};
+
+const char* kShmName = "/dji_cli_ring_bench";
+
+void runReader(Shared* shared, int index, uint64_t totalFrames)
+{
+    ShmFrameReader reader;
+    if (!reader.open(kShmName, true)) {
+        std::_Exit(1);
+    }
+    shared->ready.fetch_add(1);
+
+    ReaderResult r{};
+    uint64_t     lastSeq = 0;
+    Clock::time_point start;
+    bool started = false;
+    while (true) {
+        // 每次只取一帧，以便知道该帧的 commit 校验是否通过：通过校验却内容不符才算真正的错误
+        bool bad = false;
+        const size_t n = reader.poll([&](const ShmFrameRing::FrameView& f) {
+            if (!started) {
+                start   = Clock::now();
+                started = true;
+            }
+            uint64_t stamp = 0;
+            std::memcpy(&stamp, f.data, sizeof(stamp));
+            bad     = stamp != f.seq;
+            lastSeq = f.seq;
+        }, 1);
+        r.received += n;
+        r.corrupt  += (n == 1 && bad) ? 1 : 0;
+        if (n == 0 && shared->done.load(std::memory_order_acquire) && reader.lag() == 0) {
+            break;
+        }
+        if (lastSeq + 1 >= totalFrames && reader.lag() == 0) {
+            break;
+        }
+    }
+    r.seconds  = started ? std::chrono::duration<double>(Clock::now() - start).count() : 0;
+    r.lost     = reader.lostFrames();
+    r.overruns = reader.overruns();
+    shared->results[index] = r;
+    std::_Exit(0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int      readers  = argc > 1 ? std::atoi(argv[1]) : 2;
+    const uint64_t frames   = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    const uint32_t payload  = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 64;
+    const size_t   capacity = (argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 4096) * 1024;
+    const uint64_t rate     = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : 0;
+    if (readers < 0 || readers > 64 || payload < 8) {
+        std::fprintf(stderr, "readers must be 0..64 and payload >= 8\n");
+        return 1;
+    }
+
+    ShmFrameWriter writer;
+    if (!writer.create(kShmName, capacity)) {
+        return 1;
+    }
+
+    void* mem = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    Shared* shared = new (mem) Shared();
+
+    for (int i = 0; i < readers; ++i) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            runReader(shared, i, frames);
+        }
+        if (pid < 0) {
+            std::perror("fork");
+            return 1;
+        }
+    }
+    while (shared->ready.load() < readers) {
+        usleep(1000);
+    }
+
+    std::string buf(payload, '\x5a');
+    const auto start = Clock::now();
+    for (uint64_t seq = 0; seq < frames; ++seq) {
+        std::memcpy(&buf[0], &seq, sizeof(seq));
+        writer.publish(0xA9, reinterpret_cast<const uint8_t*>(buf.data()), payload, ShmFrameRing::monotonicNs());
+        // 限速按 1000 帧一批：批间睡眠让出 CPU
+        if (rate && (seq + 1) % 1000 == 0) {
+            const auto due = start + std::chrono::nanoseconds((seq + 1) * 1000000000ULL / rate);
+            if (due > Clock::now()) {
+                std::this_thread::sleep_until(due);
+            }
+        }
+    }
+    const double writeSec = std::chrono::duration<double>(Clock::now() - start).count();
+    shared->done.store(true, std::memory_order_release);
+
+    for (int i = 0; i < readers; ++i) {
+        int status = 0;
+        wait(&status);
+    }
+
+    std::printf("frames=%llu payload=%uB capacity=%zuKB readers=%d\n",
+                static_cast<unsigned long long>(frames), payload, capacity / 1024, readers);
+    std::printf("writer : %.3f s  %.2f Mframes/s  %.1f MB/s\n", writeSec, frames / writeSec / 1e6,
+                frames * static_cast<double>(payload) / writeSec / 1e6);
+    for (int i = 0; i < readers; ++i) {
+        const ReaderResult& r = shared->results[i];
+        // lost 只在下一帧到达时按序号差计入，结尾被跳过的帧由 missed 反映
+        std::printf("reader%-2d: received=%llu missed=%llu lost=%llu overruns=%llu corrupt=%llu  %.2f Mframes/s\n",
+                    i, static_cast<unsigned long long>(r.received),
+                    static_cast<unsigned long long>(frames - r.received), static_cast<unsigned long long>(r.lost),
+                    static_cast<unsigned long long>(r.overruns), static_cast<unsigned long long>(r.corrupt),
+                    r.seconds > 0 ? r.received / r.seconds / 1e6 : 0.0);
+    }
+    return 0;
+}
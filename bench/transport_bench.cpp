@@ -0,0 +1,217 @@
+// transport_bench.cpp
+//
+// 接收后端对比：fork 出 dji-sim 以高频率推送 0xA9 数据流，依次用 posix（阻塞 recv，CLinuxTCPCom）
+// 与 io_uring（multishot recv，CLinuxUringTCPCom）后端接收固定时长，统计帧率、接收线程每帧 CPU 时间
+// 与每帧系统调用数（posix 为 recv + pwrite 次数，io_uring 为 io_uring_enter + pwrite 次数）。
+// 指定录制文件时每个后端再跑一轮开启链路录制的，对比录制写文件的开销
+// （posix 为同步 pwrite，io_uring 为挂在接收 ring 上的写请求）。
+// 单核机器上模拟器与接收方轮流占用 CPU，帧率受模拟器发送速度限制，应以每帧 CPU 时间为主要指标。
+//
+// 用法: transport-bench [dji-sim 路径=./dji-sim] [秒数=5] [A9 频率=20000] [录制文件=（不录制）]
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CLinuxTCPCom.h"
+#include "CLinuxUringTCPCom.h"
+#include "LinkRecorder.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t threadCpuNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t monoNs()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// 按 6A 77 | 长度（大端）| 命令字 | 负载 切分字节流，只计数不解析
+class FrameCounter
+{
+public:
+    void feed(const uint8_t* data, size_t length)
+    {
+        m_buf.insert(m_buf.end(), data, data + length);
+        size_t pos = 0;
+        while (m_buf.size() - pos >= 4) {
+            if (m_buf[pos] != 0x6A || m_buf[pos + 1] != 0x77) {
+                ++pos;
+                continue;
+            }
+            const size_t total = 4 + ((static_cast<size_t>(m_buf[pos + 2]) << 8) | m_buf[pos + 3]);
+            if (m_buf.size() - pos < total) {
+                break;
+            }
+            ++m_frames;
+            pos += total;
+        }
+        m_buf.erase(m_buf.begin(), m_buf.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+
+    uint64_t frames() const { return m_frames; }
+
+private:
+    std::vector<uint8_t> m_buf;
+    uint64_t             m_frames = 0;
+};
+
+struct Result {
+    uint64_t frames   = 0;
+    uint64_t bytes    = 0;
+    uint64_t cpuNs    = 0;
+    uint64_t syscalls = 0;
+    double   seconds  = 0;
+};
+
+bool runOnce(bool useUring, uint16_t port, double seconds, const std::string& recordPath, Result& out)
+{
+    std::unique_ptr<CLinuxTCPCom> com;
+    if (useUring) {
+        com.reset(new CLinuxUringTCPCom());
+    } else {
+        com.reset(new CLinuxTCPCom());
+    }
+    int rc = -1;
+    for (int i = 0; i < 30 && rc < 0; ++i) {
+        rc = com->InitClient("127.0.0.1", port);
+        if (rc < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    if (rc < 0) {
+        std::fprintf(stderr, "cannot connect to simulator on port %u\n", port);
+        return false;
+    }
+
+    FrameCounter counter;
+    uint8_t      buf[16 * 1024];
+
+    // 预热 0.5 秒：等模拟器进入稳态、缓冲与页表就绪
+    const auto warmEnd = Clock::now() + std::chrono::milliseconds(500);
+    while (Clock::now() < warmEnd) {
+        if (com->RecvData(buf, sizeof(buf)) <= 0) {
+            std::fprintf(stderr, "connection closed during warm-up\n");
+            return false;
+        }
+    }
+
+    const bool recording = !recordPath.empty();
+    if (recording && !g_linkRecorder.start(recordPath)) {
+        return false;
+    }
+    auto* uring = dynamic_cast<CLinuxUringTCPCom*>(com.get());
+    const uint64_t enter0 = uring ? uring->EnterCalls() : 0;
+    uint64_t       recvs  = 0;
+    const auto     t0     = Clock::now();
+    const auto     tEnd   = t0 + std::chrono::duration<double>(seconds);
+    const uint64_t cpu0   = threadCpuNs();
+    while (Clock::now() < tEnd) {
+        const int n = com->RecvData(buf, sizeof(buf));
+        ++recvs;
+        if (n <= 0) {
+            std::fprintf(stderr, "connection closed during measurement\n");
+            break;
+        }
+        if (recording) {
+            g_linkRecorder.record(buf, static_cast<size_t>(n), monoNs());
+        }
+        counter.feed(buf, static_cast<size_t>(n));
+        out.bytes += static_cast<uint64_t>(n);
+    }
+    out.cpuNs    = threadCpuNs() - cpu0;
+    out.seconds  = std::chrono::duration<double>(Clock::now() - t0).count();
+    out.frames   = counter.frames();
+    out.syscalls = uring ? uring->EnterCalls() - enter0 : recvs;
+
+    // 先关连接（io_uring 后端在此等待在途的录制写完），再停录制
+    com->CloseFd();
+    if (recording) {
+        const LinkRecorder::Stats st = g_linkRecorder.stats();
+        out.syscalls += st.syncWrites;
+        g_linkRecorder.stop();
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::string simPath    = argc > 1 ? argv[1] : "./dji-sim";
+    const double      seconds    = argc > 2 ? std::atof(argv[2]) : 5.0;
+    const std::string a9Hz       = argc > 3 ? argv[3] : "20000";
+    const std::string recordPath = argc > 4 ? argv[4] : "";
+    if (seconds <= 0) {
+        std::fprintf(stderr, "seconds must be > 0\n");
+        return 1;
+    }
+
+    std::string why;
+    const bool  uringOk = CLinuxUringTCPCom::Supported(&why);
+    if (!uringOk) {
+        std::printf("io_uring unavailable (%s), only the posix backend will run\n", why.c_str());
+    }
+
+    const uint16_t    port     = static_cast<uint16_t>(20000 + getpid() % 10000);
+    const int         rounds   = (uringOk ? 2 : 1) * (recordPath.empty() ? 1 : 2);
+    const std::string portStr  = std::to_string(port);
+    const std::string duration = std::to_string(static_cast<int>(rounds * (seconds + 1.5) + 5));
+
+    const pid_t sim = fork();
+    if (sim < 0) {
+        std::perror("fork");
+        return 1;
+    }
+    if (sim == 0) {
+        const int devNull = ::open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+        }
+        execl(simPath.c_str(), simPath.c_str(), "--port", portStr.c_str(), "--a9-hz", a9Hz.c_str(), "--stats", "0",
+              "--duration", duration.c_str(), static_cast<char*>(nullptr));
+        std::fprintf(stderr, "cannot exec %s: %s\n", simPath.c_str(), std::strerror(errno));
+        _exit(127);
+    }
+
+    std::printf("simulator: %s port=%u a9=%sHz, %.1f s per run\n", simPath.c_str(), port, a9Hz.c_str(), seconds);
+    std::printf("%-14s %-7s %12s %10s %14s %15s\n", "backend", "record", "frames/s", "MB/s", "cpu ns/frame",
+                "syscalls/frame");
+    bool ok = true;
+    for (int backend = 0; backend < (uringOk ? 2 : 1) && ok; ++backend) {
+        for (int rec = 0; rec < (recordPath.empty() ? 1 : 2) && ok; ++rec) {
+            Result r;
+            ok = runOnce(backend == 1, port, seconds, rec ? recordPath : std::string(), r);
+            if (!ok || r.frames == 0) {
+                ok = false;
+                break;
+            }
+            std::printf("%-14s %-7s %12.0f %10.1f %14.0f %15.3f\n", backend ? "tcp+io_uring" : "tcp",
+                        rec ? "on" : "off", r.frames / r.seconds, r.bytes / r.seconds / 1e6,
+                        static_cast<double>(r.cpuNs) / r.frames, static_cast<double>(r.syscalls) / r.frames);
+        }
+    }
+
+    kill(sim, SIGTERM);
+    waitpid(sim, nullptr, 0);
+    return ok ? 0 : 1;
+}
@@ -4,12 +4,13 @@ std::queue<DataFrame> g_dataFrameQueue;
 std::mutex g_queueMutex;
 std::condition_variable g_queueCond;
 
-std::queue<DataFrame> g_recvRawDataFrameQueue;
+std::queue<StampedFrame> g_recvRawDataFrameQueue;
 std::mutex g_recvRawQueueMutex;
 std::condition_variable g_recvRawQueueCond;
 
-std::queue<DataFrame> g_completeDataFrameQueue;
+std::queue<StampedFrame> g_completeDataFrameQueue;
 std::mutex g_completeQueueMutex;
 std::condition_variable g_completeQueueCond;
 
-ServerConfig g_serverConfig;
\ No newline at end of file
+ServerConfig g_serverConfig;
+volatile std::sig_atomic_t g_terminateRequested = 0;
\ No newline at end of file
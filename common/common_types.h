@@ -1,21 +1,78 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <cstdint>
+#include <map>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <csignal>
+
+/**
+ * @brief 单个流水线线程的调度设置（配置文件 "threads" 字段，键为线程名：send / recv / assembler /
+ *        decoder / event-loop / ui），线程启动时由 ThreadSched::apply() 应用
+ */
+struct ThreadPolicy {
+    std::vector<int> cpus;              // 允许运行的 CPU，空表示不限制
+    int              fifoPriority = 0;  // SCHED_FIFO 优先级 1~99，0 表示保持 SCHED_OTHER
+    int              nice = 0;          // SCHED_OTHER 下的 nice 值（FIFO 申请失败时也使用该值）
+    bool             hasNice = false;   // 是否设置 nice
+};
 
 // 定义服务器配置结构体
 struct ServerConfig {
     std::string ip;
     int         port;
+    std::string transport = "tcp"; // 与云盒之间的传输：tcp / udp（控制帧确认重传，遥测不可靠、只保留最新）
+    std::string ioBackend = "auto"; // TCP 接收方式：auto（内核支持时用 io_uring）/ io_uring / posix（阻塞 recv）
+    double      udpLoss = 0.0;     // 以下为 UDP 本地链路模拟（测试用）：丢包率 0~1
+    int         udpDelayMs = 0;    // 单向附加时延
+    int         udpJitterMs = 0;   // 时延抖动（±）
+    std::string standbyServer;     // 备用链路地址（另一运营商 / 另一服务器），非空时开启双链路：紧急命令双发、遥测取较新的一条
+    int         standbyPort = 0;   // 备用链路端口，0 表示与 port 相同
+    int         linkStaleMs = 300; // 遥测来源链路静默超过该时长时切到另一条
+    std::string encryptionKey;     // 控制帧负载 AES-GCM 密钥（十六进制 32 / 64 字符），空串表示不加密
+    int         metricsPort = 9100; // 本地指标端点端口，0 表示不开启
+    std::string stateShm = "/dji_cli_state"; // 最新状态共享内存名，空串表示不发布
+    std::string frameShm = "/dji_cli_frames"; // 帧流共享内存名，空串表示不发布
+    int         relayPort = 0; // 遥测中继监听端口，0 表示不开启
+    std::string relayBind = "0.0.0.0"; // 遥测中继绑定地址
+    int         relayQueueKB = 1024; // 每个下游客户端的发送队列上限
+    std::string relayPolicy = "drop-oldest"; // 下游过慢时的策略：drop-oldest / disconnect
+    std::string querySocket; // 本机查询接口的 Unix 套接字路径（建议放在 $XDG_RUNTIME_DIR 下），空串表示不开启
+    bool        queryAllowCommands = false; // 是否允许经查询接口提交控制命令，默认只读
+    int         queryHistory = 6000; // 查询接口保留的遥测历史条数
+    // 各线程调度设置；默认只把 UI 线程降为 nice 5，渲染繁忙时不与网络 / 控制线程争抢 CPU
+    std::map<std::string, ThreadPolicy> threadPolicies = {{"ui", ThreadPolicy{{}, 0, 5, true}}};
     bool        is_valid = false; // 是否有效的配置
 };
 
 // 数据帧类型
 using DataFrame = std::vector<uint8_t>;
 
+/**
+ * @brief 接收方向带时间戳的数据帧（Metrics::nowNs()，0 表示未打点）
+ */
+struct StampedFrame {
+    DataFrame data;
+    uint64_t  recvNs      = 0;   ///< socket 读到数据的时刻
+    uint64_t  assembledNs = 0;   ///< 组装成完整帧的时刻
+    uint64_t  traceId     = 0;   ///< Tracer flow ID，追踪关闭时为 0
+};
+
+/**
+ * @brief 控制帧回复(0xD1)解析结果
+ */
+struct ControlReply {
+    uint8_t              encryptionFlag = 0;  ///< 加密标志
+    uint8_t              actionNumber   = 0;  ///< 动作编号
+    uint8_t              execResult     = 0;  ///< 执行结果
+    uint32_t             errorCode      = 0;  ///< 错误码
+    std::string          cloudBoxSN;          ///< 云盒 SN(15B)
+    std::vector<uint8_t> extra;               ///< SN 之后的扩展字段（如分包上传回显的序号），可能为空
+};
+
 /**
  * @brief 全局队列，用于存放待发送的数据帧
  */
@@ -26,18 +83,19 @@ extern std::condition_variable g_queueCond;
 /**
  * @brief 全局队列，用于存放接收到的原始数据帧
  */
-extern std::queue<DataFrame> g_recvRawDataFrameQueue;
+extern std::queue<StampedFrame> g_recvRawDataFrameQueue;
 extern std::mutex g_recvRawQueueMutex;
 extern std::condition_variable g_recvRawQueueCond;
 
 /**
  * @brief 全局队列，用于存放封装到的完整数据帧
  */
-extern std::queue<DataFrame> g_completeDataFrameQueue;
+extern std::queue<StampedFrame> g_completeDataFrameQueue;
 extern std::mutex g_completeQueueMutex;
 extern std::condition_variable g_completeQueueCond;
 
 extern ServerConfig g_serverConfig; // 全局服务器配置
+extern volatile std::sig_atomic_t g_terminateRequested; // 收到 SIGTERM / SIGINT 后置 1（main 中的信号处理函数设置）
 
 
 
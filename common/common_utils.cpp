@@ -21,6 +21,47 @@ ServerConfig getServerConfig(const std::string& filename) {
     try {
         server_cfg.ip   = j.at("server").get<std::string>();    // 获取服务器IP地址
         server_cfg.port = j.at("port").get<int>();              // 获取端口号
+        server_cfg.transport = j.value("transport", std::string("tcp"));            // 可选：tcp / udp
+        if (server_cfg.transport != "tcp" && server_cfg.transport != "udp") {
+            throw std::runtime_error("Unknown transport: " + server_cfg.transport);
+        }
+        server_cfg.ioBackend = j.value("ioBackend", std::string("auto"));           // 可选：auto / io_uring / posix
+        if (server_cfg.ioBackend != "auto" && server_cfg.ioBackend != "io_uring" && server_cfg.ioBackend != "posix") {
+            throw std::runtime_error("Unknown ioBackend: " + server_cfg.ioBackend);
+        }
+        server_cfg.udpLoss = j.value("udpLoss", 0.0);                               // 可选：UDP 链路模拟
+        server_cfg.udpDelayMs = j.value("udpDelayMs", 0);
+        server_cfg.udpJitterMs = j.value("udpJitterMs", 0);
+        server_cfg.standbyServer = j.value("standbyServer", std::string());         // 可选：双链路热备
+        server_cfg.standbyPort = j.value("standbyPort", 0);
+        server_cfg.linkStaleMs = j.value("linkStaleMs", 300);
+        server_cfg.encryptionKey = j.value("encryptionKey", std::string());         // 可选：控制帧负载加密
+        if (!server_cfg.encryptionKey.empty()
+            && ((server_cfg.encryptionKey.size() != 32 && server_cfg.encryptionKey.size() != 64)
+                || server_cfg.encryptionKey.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)) {
+            throw std::runtime_error("encryptionKey must be 32 or 64 hex characters");
+        }
+        server_cfg.metricsPort = j.value("metricsPort", 9100);  // 可选：本地指标端点端口
+        server_cfg.stateShm = j.value("stateShm", std::string("/dji_cli_state")); // 可选：状态共享内存名
+        server_cfg.frameShm = j.value("frameShm", std::string("/dji_cli_frames")); // 可选：帧流共享内存名
+        server_cfg.relayPort = j.value("relayPort", 0);                            // 可选：遥测中继
+        server_cfg.relayBind = j.value("relayBind", std::string("0.0.0.0"));
+        server_cfg.relayQueueKB = j.value("relayQueueKB", 1024);
+        server_cfg.relayPolicy = j.value("relayPolicy", std::string("drop-oldest"));
+        server_cfg.querySocket = j.value("querySocket", std::string()); // 可选：本机查询接口
+        server_cfg.queryAllowCommands = j.value("queryAllowCommands", false);
+        server_cfg.queryHistory = j.value("queryHistory", 6000);
+        // 可选：线程调度，如 "threads": {"recv": {"cpus": [2], "fifo": 40}, "ui": {"cpus": [0, 1], "nice": 10}}
+        if (j.contains("threads")) {
+            for (const auto& item : j.at("threads").items()) {
+                ThreadPolicy policy;
+                policy.cpus         = item.value().value("cpus", std::vector<int>());
+                policy.fifoPriority = item.value().value("fifo", 0);
+                policy.hasNice      = item.value().contains("nice");
+                policy.nice         = item.value().value("nice", 0);
+                server_cfg.threadPolicies[item.key()] = policy;
+            }
+        }
         server_cfg.is_valid = true; // 标记配置有效
     } catch (const json::exception& e) {
         throw std::runtime_error("Error reading JSON fields: " + std::string(e.what()));
@@ -11,13 +11,29 @@
 #include <unistd.h>
 #include <vector>
 #include <atomic>
+#include <csignal>
+#include <pthread.h>
 #include "common_types.h" // 引入公共类型定义
 #include "common_utils.h" // 引入公共工具函数
 #include "TasksManager.h"
 #include "CLI2Frame.h"   // 引入命令行到帧的转换器
+#include "utils/Tracer.h"
+#include "utils/AllocTrace.h"
 
 using namespace std;
 
+static pthread_t g_mainThread;
+
+// SIGTERM / SIGINT：记下请求并打断主线程中阻塞的系统调用（getline / 初始化时的 connect），
+// 主线程在 CLI 循环与连接重试中检查标志，按正常退出路径停止所有任务
+static void onTerminateSignal(int sig)
+{
+    g_terminateRequested = 1;
+    if (!pthread_equal(pthread_self(), g_mainThread)) {
+        pthread_kill(g_mainThread, sig);   // 落在其他线程（如双链路接收线程）时转给主线程
+    }
+}
+
 int main(int argc, char* argv[])
 {
 
@@ -31,27 +47,44 @@ int main(int argc, char* argv[])
  
     g_serverConfig = getServerConfig(cfgPath);
 
+    g_mainThread = pthread_self();
+    struct sigaction sa {};
+    sa.sa_handler = onTerminateSignal;   // 不设 SA_RESTART：read() 返回 EINTR，getline 失败退出循环
+    sigaction(SIGTERM, &sa, nullptr);
+    sigaction(SIGINT, &sa, nullptr);
+
     // 1. 创建一个任务管理器
     TasksManager tasksMgr;
 
-    // 2, 初始化（TCP连接、ComTask等）
+    // 2, 初始化（TCP连接、ComTask等），连不上时一直重试，直到收到终止信号
     if(!tasksMgr.initAllTasks()){
+        if (g_terminateRequested) {
+            return 0;
+        }
         cerr << "任务管理器初始化失败，请检查配置文件或网络连接。" << endl;
         return -1; // 初始化失败，退出程序
     }
 
-    // 3, 启动线程（收发数据）
+    // 3, 启动线程（收发数据）；创建期间屏蔽 SIGTERM / SIGINT，工作线程继承该掩码，信号总由主线程处理
+    sigset_t termSignals;
+    sigemptyset(&termSignals);
+    sigaddset(&termSignals, SIGTERM);
+    sigaddset(&termSignals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &termSignals, nullptr);
     tasksMgr.startAllTasks();
+    pthread_sigmask(SIG_UNBLOCK, &termSignals, nullptr);
     // 小睡一会儿，等待线程启动
     std::this_thread::sleep_for(std::chrono::seconds(1));
 
     // 4, 主线程CLI循环
+    Tracer::setThreadName("cli");
     printf("\n");
     printf("欢迎使用 pxh 地面站 CLI!\n");
     std::cout << "CLI 地面站示例. 输入命令, 如: takeoff 10\n";
     std::cout << "输入 exit 退出.\n";
 
-    while (true) {
+    // 命令执行期间（restart、stats sched 等）收到的信号在下一轮循环开始时处理
+    while (!g_terminateRequested) {
         std::cout << "pxh> ";
         std::string line;
         if (!std::getline(std::cin, line)) {
@@ -60,16 +93,44 @@ int main(int argc, char* argv[])
         if (line == "exit") {
             break;
         }
+        // 热重启数据流水线：restart [config.json]，带配置文件时切换到其中的 server / port / threads
+        if (line == "restart" || line.rfind("restart ", 0) == 0) {
+            if (line.size() > 8) {
+                try {
+                    const ServerConfig cfg = getServerConfig(line.substr(8));
+                    tasksMgr.restartPipeline(&cfg);
+                } catch (const std::exception& e) {
+                    cerr << "[main] " << e.what() << "\n";
+                }
+            } else {
+                tasksMgr.restartPipeline();
+            }
+            continue;
+        }
+        // 链路状态（双链路时为两条链路各自的收包、先到回复与遥测新鲜度）
+        if (line == "link") {
+            std::cout << tasksMgr.linkStatus();
+            continue;
+        }
         // 解析并构建数据帧
-        DataFrame frame = parseCommand(line);
-        if(!frame.empty())
         {
-            std::lock_guard<std::mutex> lk(g_queueMutex);
-            g_dataFrameQueue.push(frame);
+            Tracer::Scope traceScope("parseCommand");
+            DataFrame frame = parseCommand(line);
+            if(!frame.empty())
+            {
+                if (Tracer::enabled()) {
+                    traceScope.setFlow(Tracer::frameFlowId(frame), Tracer::Flow::Start);
+                }
+                std::lock_guard<std::mutex> lk(g_queueMutex);
+                g_dataFrameQueue.push(frame);
+            }
         }
         // 唤醒发送线程
         g_queueCond.notify_one();
     }
 
+    if (AllocTrace::enabled()) {
+        std::cerr << AllocTrace::toText();
+    }
     return 0;
 }
\ No newline at end of file
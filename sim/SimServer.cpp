@@ -0,0 +1,763 @@
+#include "SimServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "utils/AsyncLogger.h"
+
+namespace {
+
+constexpr auto   kTickInterval      = std::chrono::milliseconds(1);
+constexpr size_t kMaxFramesPerTick  = 10000;       // 单架飞机单条数据流每拍最多补发的帧数
+constexpr size_t kMaxInputBytes     = 64 * 1024;   // 客户端输入中找不到帧头时的缓冲上限
+constexpr uint8_t kCmdTelemetry     = 0xA9;
+constexpr uint8_t kCmdUavState      = 0xA8;
+constexpr uint8_t kCmdSignal        = 0xAA;
+constexpr uint8_t kCmdControl       = 0xD1;
+constexpr uint8_t kCmdHeartbeat     = 0x02;
+constexpr uint8_t kActionRouteChunk = 0x44;
+constexpr uint16_t kHeartbeatReplyStream = 0xFFFF;      // UDP 不可靠流号，数据流用 1 起的流号
+constexpr uint64_t kUdpIdleNs        = 10ULL * 1000000000ULL;   // 客户端每 3 秒一个心跳
+constexpr int      kUdpBatch         = 32;
+constexpr size_t   kUdpMaxDatagram   = 2048;
+
+uint64_t steadyNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+uint64_t epochMs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void setNonBlocking(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+uint64_t addrKey(const sockaddr_in& addr)
+{
+    return (static_cast<uint64_t>(ntohl(addr.sin_addr.s_addr)) << 16) | ntohs(addr.sin_port);
+}
+
+std::string addrName(const sockaddr_in& addr)
+{
+    char ip[INET_ADDRSTRLEN] = {0};
+    ::inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+std::string peerName(int fd)
+{
+    sockaddr_in addr{};
+    socklen_t   len = sizeof(addr);
+    if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        return "?";
+    }
+    return addrName(addr);
+}
+
+} // namespace
+
+uint64_t SimServer::vehicleClockMs() const
+{
+    const double elapsedMs = (steadyNs() - m_startNs) / 1e6;
+    return static_cast<uint64_t>(static_cast<double>(epochMs()) + m_opts.clockOffsetMs
+                                 + m_opts.clockDriftPpm * 1e-6 * elapsedMs);
+}
+
+std::string SimServer::encodeFrame(uint8_t cmdId, const std::string& payload)
+{
+    // 0x6A 0x77 | 长度（命令 1 字节 + 负载，大端）| 命令 | 负载
+    const size_t length = payload.size() + 1;
+    std::string frame;
+    frame.reserve(4 + length);
+    frame.push_back(static_cast<char>(0x6A));
+    frame.push_back(static_cast<char>(0x77));
+    frame.push_back(static_cast<char>((length >> 8) & 0xFF));
+    frame.push_back(static_cast<char>(length & 0xFF));
+    frame.push_back(static_cast<char>(cmdId));
+    frame += payload;
+    return frame;
+}
+
+bool SimServer::start(EventLoop& loop, const SimOptions& opts)
+{
+    m_opts = opts;
+    m_loop = &loop;
+    m_startNs = steadyNs();
+    m_rng.seed(opts.seed);
+
+    if (m_opts.vehicles.empty()) {
+        m_opts.vehicles.push_back(SimOptions::Vehicle{"SIMBOX000000001"});
+    }
+    for (size_t i = 0; i < m_opts.vehicles.size(); ++i) {
+        // 各架飞机的起飞点按 8 列网格错开约 300 米
+        const double lng = m_opts.homeLng + 0.003 * static_cast<double>(i % 8);
+        const double lat = m_opts.homeLat + 0.003 * static_cast<double>(i / 8);
+        m_vehicles.emplace_back(new SimVehicle(m_opts.vehicles[i].boxSn, static_cast<int>(i), lng, lat,
+                                               m_opts.seed + static_cast<uint32_t>(i)));
+    }
+    m_streams.assign(m_vehicles.size() * StreamCount, Stream{});
+
+    if (!m_opts.key.empty() && !m_cipher.setKeyHex(m_opts.key)) {
+        return false;
+    }
+
+    if (m_listener.TCPInitServer(m_opts.bind.c_str(), m_opts.port) < 0) {
+        std::cerr << "[SimServer] Failed to listen on " << m_opts.bind << ":" << m_opts.port << "\n";
+        return false;
+    }
+    setNonBlocking(m_listener.GetListenFd());
+
+    if (m_opts.udp) {
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = inet_addr(m_opts.bind.c_str());
+        addr.sin_port        = htons(m_opts.port);
+        m_udpFd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_udpFd < 0 || ::bind(m_udpFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "[SimServer] Failed to bind UDP " << m_opts.bind << ":" << m_opts.port << "\n";
+            return false;
+        }
+        int sndbuf = 4 << 20;
+        ::setsockopt(m_udpFd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    }
+
+    loop.runInLoop([this] {
+        m_loop->addFd(m_listener.GetListenFd(), EPOLLIN, [this](uint32_t) { onAccept(); });
+        if (m_udpFd >= 0) {
+            m_loop->addFd(m_udpFd, EPOLLIN, [this](uint32_t) { onUdpReadable(); });
+        }
+        m_lastTickNs = steadyNs();
+        m_tickTimer  = m_loop->runEvery(kTickInterval, [this] { onTick(); });
+        if (m_opts.statsIntervalS > 0) {
+            m_statsTimer = m_loop->runEvery(std::chrono::seconds(m_opts.statsIntervalS), [this] { printStats(); });
+        }
+        scheduleDisconnect();
+    });
+
+    std::cout << "[SimServer] " << m_vehicles.size() << " vehicle(s) on " << m_opts.bind << ":" << m_opts.port
+              << (m_udpFd >= 0 ? " (tcp+udp)" : "") << ", reply delay " << m_opts.replyDelayMs << "±" << m_opts.replyJitterMs << " ms, ack delay "
+              << m_opts.ackDelayMs << " ms";
+    if (m_opts.ackDropRate > 0 || m_opts.ackReorderMs > 0) {
+        std::cout << " (+0~" << m_opts.ackReorderMs << " ms, drop " << m_opts.ackDropRate << ")";
+    }
+    std::cout << "\n";
+    for (size_t i = 0; i < m_opts.vehicles.size(); ++i) {
+        const SimOptions::Vehicle& v = m_opts.vehicles[i];
+        std::cout << "[SimServer]   " << v.boxSn << "  A9 " << v.a9Hz << " Hz, A8 " << v.a8Hz << " Hz, AA "
+                  << v.aaHz << " Hz\n";
+    }
+    return true;
+}
+
+void SimServer::stop()
+{
+    m_loop->cancel(m_tickTimer);
+    m_loop->cancel(m_statsTimer);
+    m_loop->cancel(m_disconnectTimer);
+    m_loop->runInLoop([this] {
+        m_loop->removeFd(m_listener.GetListenFd());
+        m_listener.CloseFd();
+        while (!m_clients.empty()) {
+            closeClient(m_clients.begin()->first, "simulator stopped");
+        }
+        if (m_udpFd >= 0) {
+            m_loop->removeFd(m_udpFd);
+            ::close(m_udpFd);
+            m_udpFd = -1;
+        }
+    });
+}
+
+void SimServer::onTick()
+{
+    const uint64_t now = steadyNs();
+    const double   dt  = static_cast<double>(now - m_lastTickNs) / 1e9;
+    m_lastTickNs = now;
+    const uint64_t stampMs = vehicleClockMs();
+
+    for (size_t i = 0; i < m_vehicles.size(); ++i) {
+        SimVehicle& v = *m_vehicles[i];
+        v.step(dt);
+
+        const SimOptions::Vehicle& spec = m_opts.vehicles[i];
+        const double rates[StreamCount] = {spec.a9Hz, spec.a8Hz, spec.aaHz};
+        for (int s = 0; s < StreamCount; ++s) {
+            Stream& st = m_streams[i * StreamCount + s];
+            if (m_clients.empty()) {
+                st.due = 0;   // 没有客户端时不积压
+                continue;
+            }
+            st.due += rates[s] * dt;
+            const size_t n = std::min(static_cast<size_t>(st.due), kMaxFramesPerTick);
+            st.due -= std::floor(st.due);
+            if (n == 0) {
+                continue;
+            }
+
+            // 本拍内同一条数据流只序列化一次，所有客户端共用
+            std::string payload;
+            uint8_t     cmd;
+            if (s == StreamA9) {
+                TelemetryData msg;
+                v.fillTelemetry(msg, stampMs);
+                msg.SerializeToString(&payload);
+                cmd = kCmdTelemetry;
+            } else if (s == StreamA8) {
+                UavState msg;
+                v.fillUavState(msg, stampMs);
+                msg.SerializeToString(&payload);
+                cmd = kCmdUavState;
+            } else {
+                SignalList msg;
+                v.fillSignal(msg, stampMs);
+                msg.SerializeToString(&payload);
+                cmd = kCmdSignal;
+            }
+            const std::string frame    = encodeFrame(cmd, payload);
+            const uint16_t    udpStream = static_cast<uint16_t>(i * StreamCount + s + 1);
+            for (auto& kv : m_clients) {
+                for (size_t k = 0; k < n; ++k) {
+                    m_framesOut[s] += appendFrame(kv.second, frame, true, udpStream) ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    std::vector<int> broken;
+    std::vector<int> idle;
+    for (auto& kv : m_clients) {
+        Client& c = kv.second;
+        if (c.session) {
+            if (now - c.lastSeenNs > kUdpIdleNs) {
+                idle.push_back(kv.first);
+                continue;
+            }
+            const size_t before = c.datagrams.size();
+            c.session->collectRetransmits(now, c.datagrams);
+            m_udpRetransmits += c.datagrams.size() - before;
+        }
+        if (!c.wantWrite && !flush(kv.first, c, true)) {
+            broken.push_back(kv.first);
+        }
+    }
+    for (int fd : broken) {
+        closeClient(fd, "send failed");
+    }
+    for (int key : idle) {
+        closeClient(key, "timed out");
+    }
+}
+
+bool SimServer::appendFrame(Client& c, const std::string& frame, bool droppable, uint16_t udpStream)
+{
+    if (c.session) {
+        // 每拍都会发出，不会积压；数据流帧 / 心跳应答不可靠，其余应答可靠
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(frame.data());
+        c.datagrams.push_back(udpStream ? c.session->makeUnreliable(udpStream, data, frame.size())
+                                        : c.session->makeReliable(data, frame.size(), steadyNs()));
+        return true;
+    }
+    if (droppable && c.out.size() - c.outOffset > m_opts.maxQueueBytes) {
+        ++m_framesDropped;
+        return false;
+    }
+    if (m_opts.garbageRate > 0 && std::uniform_real_distribution<double>(0, 1)(m_rng) < m_opts.garbageRate) {
+        // 垃圾字节不含 0x6A，不会与后面的真帧头拼出假帧头
+        const int n = std::uniform_int_distribution<int>(1, 16)(m_rng);
+        for (int i = 0; i < n; ++i) {
+            uint8_t b = static_cast<uint8_t>(std::uniform_int_distribution<int>(0, 255)(m_rng));
+            c.out.push_back(static_cast<char>(b == 0x6A ? 0x00 : b));
+        }
+        m_garbageBytes += static_cast<uint64_t>(n);
+    }
+    c.out += frame;
+    return true;
+}
+
+bool SimServer::flush(int fd, Client& c, bool allowFragment)
+{
+    if (c.session) {
+        flushDatagrams(c);
+        return true;
+    }
+    bool blocked = false;
+    while (c.outOffset < c.out.size()) {
+        size_t     len      = c.out.size() - c.outOffset;
+        const bool fragment = allowFragment && m_opts.fragmentRate > 0 && len > 1 &&
+                              std::uniform_real_distribution<double>(0, 1)(m_rng) < m_opts.fragmentRate;
+        if (fragment) {
+            len = std::uniform_int_distribution<size_t>(1, std::min<size_t>(len - 1, 64))(m_rng);
+        }
+        const ssize_t n = ::send(fd, c.out.data() + c.outOffset, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                blocked = true;
+                break;
+            }
+            return false;
+        }
+        c.outOffset += static_cast<size_t>(n);
+        m_bytesOut  += static_cast<uint64_t>(n);
+        if (fragment) {
+            ++m_fragments;
+            break;   // 余下部分留到下一拍，客户端会在两次 recv 中分别收到
+        }
+    }
+    if (c.outOffset == c.out.size()) {
+        c.out.clear();
+        c.outOffset = 0;
+    } else if (c.outOffset > (1u << 20)) {
+        c.out.erase(0, c.outOffset);
+        c.outOffset = 0;
+    }
+
+    if (blocked != c.wantWrite) {
+        m_loop->modifyFd(fd, EPOLLIN | EPOLLRDHUP | (blocked ? uint32_t(EPOLLOUT) : 0u));
+        c.wantWrite = blocked;
+    }
+    return true;
+}
+
+void SimServer::flushDatagrams(Client& c)
+{
+    const size_t total = c.datagrams.size();
+    size_t       sent  = 0;
+    while (sent < total) {
+        mmsghdr      msgs[kUdpBatch];
+        iovec        iov[kUdpBatch];
+        const size_t n = std::min<size_t>(total - sent, kUdpBatch);
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base             = const_cast<char*>(c.datagrams[sent + i].data());
+            iov[i].iov_len              = c.datagrams[sent + i].size();
+            msgs[i].msg_hdr             = msghdr();
+            msgs[i].msg_hdr.msg_name    = &c.addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(c.addr);
+            msgs[i].msg_hdr.msg_iov     = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+        const int r = ::sendmmsg(m_udpFd, msgs, static_cast<unsigned>(n), MSG_DONTWAIT);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            break;   // 发送缓冲已满：不可靠数据报直接丢弃，可靠数据报等重传
+        }
+        for (int i = 0; i < r; ++i) {
+            m_bytesOut += msgs[i].msg_len;
+        }
+        sent += static_cast<size_t>(r);
+    }
+    m_framesDropped += total - sent;
+    c.datagrams.clear();
+}
+
+void SimServer::onUdpReadable()
+{
+    static uint8_t bufs[kUdpBatch][kUdpMaxDatagram];   // 只在事件循环线程中使用
+    while (true) {
+        mmsghdr     msgs[kUdpBatch];
+        iovec       iov[kUdpBatch];
+        sockaddr_in from[kUdpBatch];
+        for (int i = 0; i < kUdpBatch; ++i) {
+            iov[i].iov_base             = bufs[i];
+            iov[i].iov_len              = kUdpMaxDatagram;
+            msgs[i].msg_hdr             = msghdr();
+            msgs[i].msg_hdr.msg_name    = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov     = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+        const int n = ::recvmmsg(m_udpFd, msgs, kUdpBatch, MSG_DONTWAIT, nullptr);
+        if (n <= 0) {
+            return;
+        }
+
+        const uint64_t   now = steadyNs();
+        std::vector<int> touched;
+        for (int i = 0; i < n; ++i) {
+            const uint8_t* data   = bufs[i];
+            const size_t   length = msgs[i].msg_len;
+            if (length < ReliableUdpSession::kHeaderSize || data[0] != ReliableUdpSession::kMagic) {
+                continue;
+            }
+            const uint64_t key = addrKey(from[i]);
+            auto           pit = m_udpPeers.find(key);
+            if (pit == m_udpPeers.end()) {
+                // 任何来自新地址的数据报都登记为新客户端（客户端连接时先发一个空的可靠数据报）
+                Client c;
+                c.id   = m_nextClientId++;
+                c.peer = "udp:" + addrName(from[i]);
+                c.addr = from[i];
+                c.session.reset(new ReliableUdpSession(static_cast<uint32_t>(m_rng())));
+                LOG_INFO("SimServer", "Client {} registered", c.peer);
+                pit = m_udpPeers.emplace(key, m_nextUdpKey).first;
+                m_clients.emplace(m_nextUdpKey--, std::move(c));
+                ++m_accepted;
+            }
+            const int fd = pit->second;
+            Client&   c  = m_clients[fd];
+            c.lastSeenNs = now;
+
+            std::string ack;
+            const auto  in = c.session->onDatagram(data, length, now, ack);
+            if (!ack.empty()) {
+                c.datagrams.push_back(std::move(ack));
+            }
+            if ((in.kind == ReliableUdpSession::Kind::Reliable || in.kind == ReliableUdpSession::Kind::Unreliable) &&
+                in.length > 0) {
+                // 每个数据报是一个完整帧，仍走与 TCP 相同的解析，不要求按序到达
+                c.in.insert(c.in.end(), in.payload, in.payload + in.length);
+                parseControls(fd, c);
+            }
+            touched.push_back(fd);
+        }
+        for (int fd : touched) {
+            auto it = m_clients.find(fd);
+            if (it != m_clients.end() && !it->second.datagrams.empty()) {
+                flushDatagrams(it->second);
+            }
+        }
+        if (n < kUdpBatch) {
+            return;
+        }
+    }
+}
+
+void SimServer::onAccept()
+{
+    int fd;
+    while ((fd = m_listener.TCPAccept()) >= 0) {
+        m_listener.SetCommFd(-1);   // 连接由模拟器管理，不由监听对象关闭
+        setNonBlocking(fd);
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Client c;
+        c.id   = m_nextClientId++;
+        c.peer = peerName(fd);
+        m_clients.emplace(fd, std::move(c));
+        m_loop->addFd(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { onClientEvent(fd, events); });
+        ++m_accepted;
+    }
+}
+
+void SimServer::onClientEvent(int fd, uint32_t events)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    Client& c = it->second;
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeClient(fd, "socket error");
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        uint8_t buf[4096];
+        while (true) {
+            const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n == 0) {
+                closeClient(fd, "closed by peer");
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeClient(fd, "recv failed");
+                    return;
+                }
+                break;
+            }
+            c.in.insert(c.in.end(), buf, buf + n);
+        }
+
+        parseControls(fd, c);
+    }
+    if ((events & EPOLLOUT) && !flush(fd, c, false)) {
+        closeClient(fd, "send failed");
+    }
+}
+
+void SimServer::parseControls(int fd, Client& c)
+{
+    // 控制帧：0x74 0x79 | 长度（大端，不含帧头与长度本身）| SN 15B | 命令 | 加密 | 动作 | 参数
+    size_t pos = 0;
+    while (c.in.size() - pos >= 4) {
+        if (c.in[pos] != 0x74 || c.in[pos + 1] != 0x79) {
+            ++pos;
+            continue;
+        }
+        const size_t total = 4 + ((static_cast<size_t>(c.in[pos + 2]) << 8) | c.in[pos + 3]);
+        if (c.in.size() - pos < total) {
+            break;
+        }
+        handleControl(fd, c.in.data() + pos, total);
+        pos += total;
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + static_cast<std::ptrdiff_t>(pos));
+    if (c.in.size() > kMaxInputBytes) {
+        c.in.clear();
+    }
+}
+
+void SimServer::handleControl(int fd, const uint8_t* frame, size_t size)
+{
+    // 心跳: 0x74 0x79 | 0x00 0x09 | 0x02 | 本机时间戳 8B
+    if (size == 13 && frame[4] == kCmdHeartbeat) {
+        ++m_heartbeatsIn;
+        if (m_opts.heartbeatReply) {
+            std::string payload(reinterpret_cast<const char*>(frame + 5), 8);
+            const uint64_t boxMs = vehicleClockMs();
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                payload.push_back(static_cast<char>((boxMs >> shift) & 0xFF));
+            }
+            sendReply(fd, m_clients[fd].id, encodeFrame(kCmdHeartbeat, payload), kHeartbeatReplyStream);
+        }
+        return;
+    }
+    if (size < 22 || frame[19] != kCmdControl) {
+        ++m_otherFramesIn;
+        return;
+    }
+    ++m_controlsIn;
+
+    // 加密控制帧：动作编号之后为 nonce | 密文 | tag，帧头至动作编号为 AAD；解密后按明文帧处理
+    const bool encrypted = frame[20] == PayloadCipher::kFlagAesGcm;
+    if (!encrypted && m_cipher.enabled()) {
+        ++m_cipherFailures;   // 配置了密钥时不接受明文控制帧
+        return;
+    }
+    if (encrypted) {
+        if (size < 22 + PayloadCipher::kOverhead) {
+            ++m_cipherFailures;
+            return;
+        }
+        m_plainControl.assign(frame, frame + 22);
+        m_plainControl.resize(size - PayloadCipher::kOverhead);
+        if (!m_cipher.open(frame + 2, 20, frame + 22, size - 22, m_plainControl.data() + 22)) {
+            ++m_cipherFailures;
+            return;
+        }
+        frame = m_plainControl.data();
+        size  = m_plainControl.size();
+    }
+
+    const std::string  sn(reinterpret_cast<const char*>(frame + 4), 15);
+    const uint8_t      action = frame[21];
+    const uint8_t*     param  = frame + 22;
+    const size_t       plen   = size - 22;
+
+    // 按 SN 找飞机，找不到（如客户端用硬编码 SN）时交给第一架
+    SimVehicle* vehicle = m_vehicles.front().get();
+    for (auto& v : m_vehicles) {
+        if (v->boxSn() == sn) {
+            vehicle = v.get();
+            break;
+        }
+    }
+    uint8_t result = 1;
+    if (m_opts.rejectRate <= 0 || std::uniform_real_distribution<double>(0, 1)(m_rng) >= m_opts.rejectRate) {
+        result = action == kActionRouteChunk ? onRouteChunk(param, plen) : vehicle->applyControl(action, param, plen);
+    }
+    if (result != 0) {
+        ++m_rejected;
+    }
+
+    // 应答负载：加密标志 | 动作 | 执行结果 | 错误码 u32 | 云盒 SN 15B | 附加数据（0x44 为分包序号 + 传输 ID）
+    std::string payload;
+    payload.push_back(0x00);
+    payload.push_back(static_cast<char>(action));
+    payload.push_back(static_cast<char>(result));
+    const uint32_t errorCode = result == 0 ? 0 : 0x100u + result;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        payload.push_back(static_cast<char>((errorCode >> shift) & 0xFF));
+    }
+    payload += vehicle->boxSn().substr(0, 15);
+    payload.resize(7 + 15, ' ');
+    int delayMs = m_opts.replyDelayMs;
+    if (action == kActionRouteChunk) {
+        if (m_opts.ackDropRate > 0 && std::uniform_real_distribution<double>(0, 1)(m_rng) < m_opts.ackDropRate) {
+            ++m_acksDropped;
+            return;
+        }
+        if (plen >= 4) {
+            payload.push_back(static_cast<char>(param[2]));   // seq
+            payload.push_back(static_cast<char>(param[3]));
+            payload.push_back(static_cast<char>(param[0]));   // transfer id
+            payload.push_back(static_cast<char>(param[1]));
+        }
+        delayMs = m_opts.ackDelayMs;
+        if (m_opts.ackReorderMs > 0) {
+            delayMs += std::uniform_int_distribution<int>(0, m_opts.ackReorderMs)(m_rng);
+        }
+    } else if (m_opts.replyJitterMs > 0) {
+        delayMs += std::uniform_int_distribution<int>(-m_opts.replyJitterMs, m_opts.replyJitterMs)(m_rng);
+    }
+    if (encrypted) {
+        // 加密标志与动作编号保持明文（AAD），其余字段加密
+        std::string sealed(payload.size() + PayloadCipher::kOverhead, '\0');
+        sealed[0] = static_cast<char>(PayloadCipher::kFlagAesGcm);
+        sealed[1] = static_cast<char>(action);
+        auto* out = reinterpret_cast<uint8_t*>(&sealed[0]);
+        if (!m_cipher.seal(out, 2, reinterpret_cast<const uint8_t*>(payload.data()) + 2, payload.size() - 2,
+                           out + 2)) {
+            ++m_cipherFailures;
+            return;
+        }
+        payload.swap(sealed);
+    }
+
+    std::string    reply    = encodeFrame(kCmdControl, payload);
+    const uint64_t clientId = m_clients[fd].id;
+    if (delayMs <= 0) {
+        sendReply(fd, clientId, reply);
+    } else {
+        m_loop->runAfter(std::chrono::milliseconds(delayMs),
+                         [this, fd, clientId, reply = std::move(reply)] { sendReply(fd, clientId, reply); });
+    }
+}
+
+// 分包参数: [传输ID 2B][包序号 2B][总包数 2B][航线总长度 4B][数据]
+uint8_t SimServer::onRouteChunk(const uint8_t* param, size_t len)
+{
+    if (len < 10) {
+        return 2;
+    }
+    const uint16_t id     = static_cast<uint16_t>((param[0] << 8) | param[1]);
+    const uint16_t seq    = static_cast<uint16_t>((param[2] << 8) | param[3]);
+    const uint16_t total  = static_cast<uint16_t>((param[4] << 8) | param[5]);
+    const uint32_t length = (uint32_t(param[6]) << 24) | (uint32_t(param[7]) << 16) | (uint32_t(param[8]) << 8) | param[9];
+    if (total == 0 || seq >= total || len == 10) {
+        return 2;
+    }
+    RouteTransfer& r = m_route;
+    if (r.id != id || r.chunks.size() != total || r.length != length) {
+        r        = RouteTransfer();
+        r.id     = id;
+        r.length = length;
+        r.chunks.resize(total);
+    }
+    if (!r.chunks[seq].empty()) {
+        ++r.duplicates;   // 应答丢失后的重发
+        return 0;
+    }
+    r.chunks[seq].assign(reinterpret_cast<const char*>(param + 10), len - 10);
+    if (++r.received < total || r.done) {
+        return 0;
+    }
+    r.done = true;
+
+    std::string data;
+    data.reserve(length);
+    for (const std::string& chunk : r.chunks) {
+        data += chunk;
+    }
+    PlanLineData plan;
+    const bool   ok = data.size() == length && plan.ParseFromString(data);
+    std::printf("[SimServer] route transfer %u complete: %zu/%u bytes in %u chunks, %llu duplicate(s), %s\n", id,
+                data.size(), length, total, static_cast<unsigned long long>(r.duplicates),
+                ok ? ("PlanLineData with " + std::to_string(plan.points_size()) + " points").c_str() : "INVALID");
+    std::fflush(stdout);
+    return ok ? 0 : 3;
+}
+
+void SimServer::sendReply(int fd, uint64_t clientId, const std::string& frame, uint16_t udpStream)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end() || it->second.id != clientId) {
+        return;   // 客户端已断开（fd 可能被复用）
+    }
+    appendFrame(it->second, frame, false, udpStream);
+    ++m_repliesOut;
+    if (!it->second.wantWrite && !flush(fd, it->second, true)) {
+        closeClient(fd, "send failed");
+    }
+}
+
+void SimServer::scheduleDisconnect()
+{
+    if (m_opts.disconnectEveryS <= 0) {
+        return;
+    }
+    const double delayS = std::exponential_distribution<double>(1.0 / m_opts.disconnectEveryS)(m_rng);
+    m_disconnectTimer = m_loop->runAfter(std::chrono::microseconds(static_cast<int64_t>(delayS * 1e6)), [this] {
+        injectDisconnect();
+        scheduleDisconnect();
+    });
+}
+
+void SimServer::injectDisconnect()
+{
+    if (m_clients.empty()) {
+        return;
+    }
+    auto it = m_clients.begin();
+    std::advance(it, std::uniform_int_distribution<size_t>(0, m_clients.size() - 1)(m_rng));
+    const int fd = it->first;
+
+    // 先写出半帧再断开，客户端缓冲里留下不完整的帧（UDP 客户端只丢弃会话，下一个数据报重新登记）
+    if (!it->second.session) {
+        TelemetryData msg;
+        m_vehicles.front()->fillTelemetry(msg, vehicleClockMs());
+        const std::string frame = encodeFrame(kCmdTelemetry, msg.SerializeAsString());
+        it->second.out.append(frame, 0, frame.size() / 2);
+        flush(fd, it->second, false);
+    }
+    ++m_disconnects;
+    closeClient(fd, "injected disconnect");
+}
+
+void SimServer::closeClient(int fd, const char* reason)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    LOG_INFO("SimServer", "Client {} disconnected ({})", it->second.peer, reason);
+    if (it->second.session) {
+        m_udpPeers.erase(addrKey(it->second.addr));
+    } else {
+        m_loop->removeFd(fd);
+        ::close(fd);
+    }
+    m_clients.erase(it);
+}
+
+void SimServer::printStats()
+{
+    std::printf("[SimServer] clients=%zu accepted=%llu A9=%llu A8=%llu AA=%llu out=%.1fMB dropped=%llu "
+                "controls=%llu heartbeats=%llu replies=%llu rejected=%llu acks_dropped=%llu other=%llu garbage=%lluB fragments=%llu disconnects=%llu udp_retx=%llu cipher_fail=%llu\n",
+                m_clients.size(), static_cast<unsigned long long>(m_accepted),
+                static_cast<unsigned long long>(m_framesOut[StreamA9]),
+                static_cast<unsigned long long>(m_framesOut[StreamA8]),
+                static_cast<unsigned long long>(m_framesOut[StreamAA]), m_bytesOut / 1e6,
+                static_cast<unsigned long long>(m_framesDropped), static_cast<unsigned long long>(m_controlsIn),
+                static_cast<unsigned long long>(m_heartbeatsIn),
+                static_cast<unsigned long long>(m_repliesOut), static_cast<unsigned long long>(m_rejected),
+                static_cast<unsigned long long>(m_acksDropped),
+                static_cast<unsigned long long>(m_otherFramesIn), static_cast<unsigned long long>(m_garbageBytes),
+                static_cast<unsigned long long>(m_fragments), static_cast<unsigned long long>(m_disconnects),
+                static_cast<unsigned long long>(m_udpRetransmits),
+                static_cast<unsigned long long>(m_cipherFailures));
+    std::fflush(stdout);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+#include "SimVehicle.h"
+#include "utils/CLinuxTCPCom.h"
+#include "utils/PayloadCipher.h"
+#include "utils/ReliableUdp.h"
+#include "utils/EventLoop.h"
+
+/**
+ * @brief 模拟器配置（命令行参数见 sim/main.cpp）
+ */
+struct SimOptions {
+    struct Vehicle {
+        std::string boxSn;
+        double a9Hz = 10.0;    ///< 0xA9 遥测
+        double a8Hz = 2.0;     ///< 0xA8 飞机状态
+        double aaHz = 0.0;     ///< 0xAA 4G/5G 信号（SignalList，客户端尚未解析，默认不发）
+    };
+
+    std::string          bind = "0.0.0.0";
+    uint16_t             port = 8124;
+    bool                 udp  = false;   ///< 同时在同一端口提供 UDP 选择性可靠传输
+    std::vector<Vehicle> vehicles;
+    double               homeLng = 113.9423;
+    double               homeLat = 22.5251;
+
+    int    replyDelayMs  = 20;     ///< 控制帧到 0xD1 应答的延时
+    int    replyJitterMs = 0;      ///< 应答延时的均匀抖动（±）
+    int    ackDelayMs    = 5;      ///< 航线分包（0x44）应答延时
+    double ackDropRate   = 0.0;    ///< 不应答航线分包的比例（模拟应答丢失）
+    int    ackReorderMs  = 0;      ///< 航线分包应答额外附加 0~N ms 的随机延时，使应答乱序到达
+    double rejectRate    = 0.0;    ///< 以非 0 执行结果应答的比例
+    bool   heartbeatReply = true;  ///< 以 0x02 应答心跳（回显时间戳 + 云盒时间戳）
+    std::string key;               ///< 控制帧负载 AES-GCM 密钥（十六进制），加密的控制帧解密后处理，应答同样加密
+
+    double clockOffsetMs = 0.0;    ///< 机载时钟相对本机时钟的偏差（数据流时间戳与心跳应答均使用机载时钟）
+    double clockDriftPpm = 0.0;    ///< 机载时钟漂移
+
+    double fragmentRate  = 0.0;    ///< 每次写出时只写一段随机前缀、余下留到下一拍的概率
+    double garbageRate   = 0.0;    ///< 每帧之前插入 1~16 字节垃圾数据的概率
+    double disconnectEveryS = 0.0; ///< 平均每隔多少秒随机断开一个客户端（发出半帧后关闭），0 为不断开
+
+    size_t   maxQueueBytes  = 8 * 1024 * 1024;   ///< 每个客户端未写出数据上限，超出后丢弃数据流帧（应答不丢）
+    int      statsIntervalS = 5;
+    uint32_t seed           = 1;
+};
+
+/**
+ * @brief 云盒模拟器：监听 TCP 端口，向每个连接的客户端推送各架模拟飞机的 0xA9 / 0xA8 / 0xAA 数据流
+ *        （protobuf 编码，帧格式 0x6A 0x77 | 长度 | 命令 | 负载，与 ReplyFrameDecoder 解析的一致），
+ *        并按配置的延时对控制帧（0x74 0x79 ... 0xD1）回复 0xD1 应答，航线分包 0x44 的应答回显分包序号与传输 ID，
+ *        可按比例丢弃或随机延后（乱序）；
+ *        心跳立即以 0x02 应答（回显心跳时间戳 + 机载时钟毫秒时间戳），机载时钟可设置偏差与漂移。
+ *
+ *        - 全部在一个 EventLoop 中运行：1ms 节拍推进飞机模型，按各自频率累计应发帧数，
+ *          同一拍内同一架飞机的帧只序列化一次，所有客户端共用；高频率时一拍可发多帧，可用作压测源；
+ *        - 写出先进入每个客户端的发送缓冲，socket 写满时等待 EPOLLOUT；
+ *        - 故障注入：分段写出（帧被拆到多次 recv）、帧间垃圾字节、发出半帧后断开；
+ *        - UDP（--udp 1）：客户端按来源地址区分，首个数据报即登记；数据流帧走不可靠数据报（每架飞机每条流
+ *          一个流号），应答走可靠数据报（重传在 1ms 节拍中检查），心跳应答不可靠；每拍的数据报合并为一次
+ *          sendmmsg()；10 秒没有任何数据报的客户端视为断开。分段 / 垃圾字节注入只作用于 TCP。
+ */
+class SimServer
+{
+public:
+    bool start(EventLoop& loop, const SimOptions& opts);
+    void stop();
+
+    void printStats();
+
+private:
+    enum StreamIndex { StreamA9, StreamA8, StreamAA, StreamCount };
+
+    struct Client {
+        uint64_t             id = 0;
+        std::string          peer;
+        std::vector<uint8_t> in;             ///< 未解析完的控制帧
+        std::string          out;            ///< 待写出数据
+        size_t               outOffset = 0;  ///< out 中已写出的字节数
+        bool                 wantWrite = false;
+
+        // UDP 客户端（键为负数，不是 fd）
+        std::unique_ptr<ReliableUdpSession> session;
+        sockaddr_in                         addr{};
+        std::vector<std::string>            datagrams;   ///< 本拍待发的数据报
+        uint64_t                            lastSeenNs = 0;
+    };
+
+    struct Stream {
+        double due = 0;                      ///< 累计应发帧数（小数部分留到下一拍）
+    };
+
+    /**
+     * @brief 正在接收的分包航线（0x44），收齐后拼接并解析为 PlanLineData
+     */
+    struct RouteTransfer {
+        uint16_t                 id     = 0;
+        uint32_t                 length = 0;   ///< 航线总长度
+        std::vector<std::string> chunks;       ///< 按包序号存放，空串表示未收到
+        size_t                   received   = 0;
+        uint64_t                 duplicates = 0;
+        bool                     done       = false;
+    };
+
+    void onTick();
+    void onAccept();
+    void onClientEvent(int fd, uint32_t events);
+    void onUdpReadable();
+    void parseControls(int fd, Client& c);
+    void handleControl(int fd, const uint8_t* frame, size_t size);
+    uint8_t onRouteChunk(const uint8_t* param, size_t len);
+    void sendReply(int fd, uint64_t clientId, const std::string& frame, uint16_t udpStream = 0);
+    bool appendFrame(Client& c, const std::string& frame, bool droppable, uint16_t udpStream = 0);
+    bool flush(int fd, Client& c, bool allowFragment);
+    void flushDatagrams(Client& c);
+    void closeClient(int fd, const char* reason);
+    void scheduleDisconnect();
+    void injectDisconnect();
+
+    uint64_t vehicleClockMs() const;
+
+    static std::string encodeFrame(uint8_t cmdId, const std::string& payload);
+
+private:
+    EventLoop*   m_loop = nullptr;
+    SimOptions   m_opts;
+    CLinuxTCPCom m_listener;
+    std::mt19937 m_rng;
+    PayloadCipher        m_cipher;
+    std::vector<uint8_t> m_plainControl;   ///< 加密控制帧的解密缓冲，复用
+    RouteTransfer        m_route;
+
+    std::vector<std::unique_ptr<SimVehicle>> m_vehicles;
+    std::vector<Stream>                      m_streams;   ///< 每架飞机 StreamCount 个
+    std::unordered_map<int, Client>          m_clients;
+    uint64_t m_nextClientId = 1;
+
+    int                               m_udpFd = -1;
+    std::unordered_map<uint64_t, int> m_udpPeers;       ///< 地址（IP << 16 | 端口）-> m_clients 中的键
+    int                               m_nextUdpKey = -1;
+
+    EventLoop::TimerId m_tickTimer  = 0;
+    EventLoop::TimerId m_statsTimer = 0;
+    EventLoop::TimerId m_disconnectTimer = 0;
+    uint64_t           m_lastTickNs = 0;
+    uint64_t           m_startNs    = 0;
+
+    // 累计统计
+    uint64_t m_framesOut[StreamCount] = {0, 0, 0};
+    uint64_t m_bytesOut       = 0;
+    uint64_t m_framesDropped  = 0;
+    uint64_t m_controlsIn     = 0;
+    uint64_t m_otherFramesIn  = 0;
+    uint64_t m_heartbeatsIn   = 0;
+    uint64_t m_repliesOut     = 0;
+    uint64_t m_rejected       = 0;
+    uint64_t m_acksDropped    = 0;
+    uint64_t m_garbageBytes   = 0;
+    uint64_t m_fragments      = 0;
+    uint64_t m_disconnects    = 0;
+    uint64_t m_accepted       = 0;
+    uint64_t m_udpRetransmits = 0;
+    uint64_t m_cipherFailures = 0;   ///< 认证失败，或配置了密钥却收到明文控制帧
+};
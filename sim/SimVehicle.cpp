@@ -0,0 +1,404 @@
+#include "SimVehicle.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr double kPi            = 3.14159265358979323846;
+constexpr double kMetersPerDeg  = 111320.0;
+constexpr double kMaxHorizAccel = 4.0;    // m/s²
+constexpr double kMaxVertAccel  = 2.0;    // m/s²
+constexpr double kMaxYawRate    = 90.0;   // °/s
+constexpr double kGimbalSlew    = 60.0;   // °/s
+
+double clampd(double v, double lo, double hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+double wrap180(double deg)
+{
+    while (deg > 180.0) deg -= 360.0;
+    while (deg < -180.0) deg += 360.0;
+    return deg;
+}
+
+uint32_t readBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+float readFloatBE(const uint8_t* p)
+{
+    const uint32_t v = readBE32(p);
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+double readDoubleBE(const uint8_t* p)
+{
+    const uint64_t v = (static_cast<uint64_t>(readBE32(p)) << 32) | readBE32(p + 4);
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+} // namespace
+
+SimVehicle::SimVehicle(std::string boxSn, int index, double homeLng, double homeLat, uint32_t seed)
+    : m_boxSn(std::move(boxSn))
+    , m_uavSn("1581F5BKD2" + std::to_string(100000 + index).substr(1))
+    , m_index(index)
+    , m_homeLng(homeLng)
+    , m_homeLat(homeLat)
+    , m_rng(seed)
+{
+    // 各架飞机的盘旋参数错开，起始时已在空中，数据流一开始就有变化
+    m_orbitRadius = 60.0 + 20.0 * (index % 4);
+    m_orbitSpeed  = 6.0 + 2.0 * (index % 3);
+    m_cruiseAlt   = 40.0 + 10.0 * (index % 5);
+    const double angle = index * 1.3;
+    m_x   = m_orbitRadius * std::cos(angle);
+    m_y   = m_orbitRadius * std::sin(angle);
+    m_z   = m_cruiseAlt;
+    m_vx  = -std::sin(angle) * m_orbitSpeed;
+    m_vy  = std::cos(angle) * m_orbitSpeed;
+    m_yaw = std::atan2(m_vx, m_vy) * 180.0 / kPi;
+    m_targetAlt = m_cruiseAlt;
+    m_battery   = 95.0 - 7.0 * (index % 6);
+}
+
+void SimVehicle::step(double dt)
+{
+    if (dt <= 0) {
+        return;
+    }
+
+    // 云台：角速度控制优先，否则以固定角速度转向目标角度
+    if (m_gimbalSpeedLeft > 0) {
+        const double t = std::min(dt, m_gimbalSpeedLeft);
+        m_gimbalPitch += static_cast<float>(m_gimbalSpeedPitch * t);
+        m_gimbalYaw   += static_cast<float>(m_gimbalSpeedYaw * t);
+        m_gimbalSpeedLeft -= dt;
+        m_gimbalTargetPitch = m_gimbalPitch;
+        m_gimbalTargetYaw   = m_gimbalYaw;
+    } else {
+        const double maxStep = kGimbalSlew * dt;
+        m_gimbalPitch += static_cast<float>(clampd(m_gimbalTargetPitch - m_gimbalPitch, -maxStep, maxStep));
+        m_gimbalYaw   += static_cast<float>(clampd(wrap180(m_gimbalTargetYaw - m_gimbalYaw), -maxStep, maxStep));
+    }
+    m_gimbalPitch = static_cast<float>(clampd(m_gimbalPitch, -120.0, 30.0));
+    m_gimbalYaw   = static_cast<float>(wrap180(m_gimbalYaw));
+
+    if (m_phase == Phase::Landed) {
+        m_vx = m_vy = m_vz = m_ax = m_ay = 0;
+        m_z = 0;
+        return;
+    }
+
+    // 1. 按阶段求目标速度
+    double tvx = 0, tvy = 0, tvz = 0;
+    switch (m_phase) {
+    case Phase::TakingOff:
+        tvz = std::min(3.0, (m_targetAlt - m_z) + 0.3);
+        if (m_z >= m_targetAlt - 0.2) {
+            m_phase = Phase::Hover;
+        }
+        break;
+    case Phase::Hover:
+        tvz = clampd((m_targetAlt - m_z) * 0.8, -2.0, 2.0);
+        break;
+    case Phase::Orbit: {
+        const double r = std::max(std::hypot(m_x, m_y), 1.0);
+        const double radial = clampd((m_orbitRadius - r) * 0.3, -5.0, 5.0);
+        tvx = -m_y / r * m_orbitSpeed + m_x / r * radial;
+        tvy = m_x / r * m_orbitSpeed + m_y / r * radial;
+        tvz = clampd((m_cruiseAlt - m_z) * 0.5, -2.0, 2.0);
+        break;
+    }
+    case Phase::Goto:
+    case Phase::ReturnHome: {
+        const double dx = m_targetX - m_x;
+        const double dy = m_targetY - m_y;
+        const double d  = std::hypot(dx, dy);
+        const double spd = std::min(m_targetSpeed, d * 0.5);
+        if (d > 0.01) {
+            tvx = dx / d * spd;
+            tvy = dy / d * spd;
+        }
+        tvz = clampd((m_targetAlt - m_z) * 0.5, -3.0, 3.0);
+        if (d < 1.0 && std::fabs(m_targetAlt - m_z) < 0.5) {
+            if (m_phase == Phase::ReturnHome) {
+                m_phase = Phase::Landing;
+            } else {
+                m_phase     = Phase::Hover;
+                m_targetAlt = m_z;
+            }
+        }
+        break;
+    }
+    case Phase::Landing:
+        tvz = m_z > 5.0 ? -3.0 : -1.0;
+        break;
+    case Phase::Landed:
+        break;
+    }
+
+    // 2. 加速度限幅后积分
+    double dvx = tvx - m_vx;
+    double dvy = tvy - m_vy;
+    const double dv = std::hypot(dvx, dvy);
+    const double maxDv = kMaxHorizAccel * dt;
+    if (dv > maxDv) {
+        dvx *= maxDv / dv;
+        dvy *= maxDv / dv;
+    }
+    m_ax = dvx / dt;
+    m_ay = dvy / dt;
+    m_vx += dvx;
+    m_vy += dvy;
+    m_vz += clampd(tvz - m_vz, -kMaxVertAccel * dt, kMaxVertAccel * dt);
+
+    m_x += m_vx * dt;
+    m_y += m_vy * dt;
+    m_z += m_vz * dt;
+    if (m_z <= 0.0 && m_phase == Phase::Landing) {
+        m_phase = Phase::Landed;
+        m_z = 0;
+        m_vx = m_vy = m_vz = m_ax = m_ay = 0;
+    }
+    m_z = std::max(m_z, 0.0);
+
+    // 3. 机头转向速度方向（角速度限幅）
+    const double speed = groundSpeed();
+    if (speed > 1.0) {
+        const double heading = std::atan2(m_vx, m_vy) * 180.0 / kPi;
+        m_yaw = wrap180(m_yaw + clampd(wrap180(heading - m_yaw), -kMaxYawRate * dt, kMaxYawRate * dt));
+    }
+
+    // 4. 电量：悬停约 0.06%/s，随速度增加
+    m_flyTime  += dt;
+    m_distance += speed * dt;
+    m_battery   = std::max(0.0, m_battery - (0.06 + 0.0004 * speed * speed) * dt);
+}
+
+uint8_t SimVehicle::applyControl(uint8_t action, const uint8_t* param, size_t len)
+{
+    const bool airborne = m_phase != Phase::Landed;
+    switch (action) {
+    case 0x11: {   // 起飞 <height f32>
+        if (len < 4) return 2;
+        if (airborne) return 1;
+        const float alt = readFloatBE(param);
+        if (!(alt > 0.0f && alt <= 500.0f)) return 2;
+        m_targetAlt = alt;
+        m_phase     = Phase::TakingOff;
+        m_flyTime   = 0;
+        m_distance  = 0;
+        return 0;
+    }
+    case 0x14:     // 降落
+    case 0x29:     // 强制降落
+        if (!airborne) return 1;
+        m_phase = Phase::Landing;
+        return 0;
+    case 0x15:     // 取消降落
+        if (m_phase != Phase::Landing) return 1;
+        m_phase     = Phase::Hover;
+        m_targetAlt = m_z;
+        return 0;
+    case 0x12:     // 返航
+        if (!airborne) return 1;
+        m_phase       = Phase::ReturnHome;
+        m_targetX     = 0;
+        m_targetY     = 0;
+        m_targetAlt   = std::max(m_z, m_cruiseAlt);
+        m_targetSpeed = 10.0;
+        return 0;
+    case 0x13:     // 取消返航
+    case 0x3A:     // 停止打点飞行
+    case 0x32:     // 刹车
+        if (!airborne) return 1;
+        m_phase     = Phase::Hover;
+        m_targetAlt = m_z;
+        return 0;
+    case 0x39: {   // 打点飞行 <lon f64><lat f64><alt f32><speed f32><mode u8>
+        if (len < 25) return 2;
+        if (!airborne) return 1;
+        const double lng = readDoubleBE(param);
+        const double lat = readDoubleBE(param + 8);
+        m_targetX     = (lng - m_homeLng) * kMetersPerDeg * std::cos(m_homeLat * kPi / 180.0);
+        m_targetY     = (lat - m_homeLat) * kMetersPerDeg;
+        m_targetAlt   = readFloatBE(param + 16);
+        m_targetSpeed = clampd(readFloatBE(param + 20), 1.0, 15.0);
+        m_phase       = Phase::Goto;
+        return 0;
+    }
+    case 0x00:     // 云台回中
+        m_gimbalTargetPitch = m_gimbalTargetYaw = 0;
+        m_gimbalSpeedLeft   = 0;
+        return 0;
+    case 0x09:     // 云台绝对角度 <pitch><roll><yaw>
+        if (len < 12) return 2;
+        m_gimbalTargetPitch = readFloatBE(param);
+        m_gimbalRoll        = readFloatBE(param + 4);
+        m_gimbalTargetYaw   = readFloatBE(param + 8);
+        m_gimbalSpeedLeft   = 0;
+        return 0;
+    case 0xF4:     // 云台角速度 <pitch><roll><yaw><time_ms u16>
+        if (len < 14) return 2;
+        m_gimbalSpeedPitch = readFloatBE(param);
+        m_gimbalSpeedYaw   = readFloatBE(param + 8);
+        m_gimbalSpeedLeft  = ((param[12] << 8) | param[13]) / 1000.0;
+        return 0;
+    case 0x0D:     // 变焦
+        if (len < 1) return 2;
+        m_zoom = std::max<float>(1.0f, param[0]);
+        return 0;
+    default:
+        return 0;   // 其余动作只应答，不影响模型
+    }
+}
+
+void SimVehicle::lngLat(double& lng, double& lat) const
+{
+    lat = m_homeLat + m_y / kMetersPerDeg;
+    lng = m_homeLng + m_x / (kMetersPerDeg * std::cos(m_homeLat * kPi / 180.0));
+}
+
+double SimVehicle::groundSpeed() const
+{
+    return std::hypot(m_vx, m_vy);
+}
+
+uint32_t SimVehicle::flightMode() const
+{
+    switch (m_phase) {
+    case Phase::TakingOff:  return 11;
+    case Phase::Landing:    return 12;
+    case Phase::Orbit:      return 14;
+    case Phase::ReturnHome: return 15;
+    default:                return 6;
+    }
+}
+
+void SimVehicle::fillTelemetry(TelemetryData& msg, uint64_t timestampMs) const
+{
+    std::normal_distribution<double> noise(0.0, 0.2);
+    double lng, lat;
+    lngLat(lng, lat);
+
+    // 姿态由机体系加速度 / 速度推出：前飞低头，向右加速右倾
+    const double yawRad   = m_yaw * kPi / 180.0;
+    const double vForward = m_vx * std::sin(yawRad) + m_vy * std::cos(yawRad);
+    const double aForward = m_ax * std::sin(yawRad) + m_ay * std::cos(yawRad);
+    const double aRight   = m_ax * std::cos(yawRad) - m_ay * std::sin(yawRad);
+    const double pitch    = clampd(-(1.2 * vForward + 3.0 * aForward), -25.0, 25.0);
+    const double roll     = clampd(std::atan2(aRight, 9.8) * 180.0 / kPi, -25.0, 25.0);
+    const double speed    = groundSpeed();
+
+    msg.set_lng(lng);
+    msg.set_lat(lat);
+    msg.set_altitude(static_cast<float>(m_z));
+    msg.set_ultrasonic(m_z < 10.0 ? static_cast<float>(m_z) : 0.0f);
+    msg.set_pitch(static_cast<float>(pitch + noise(m_rng)));
+    msg.set_roll(static_cast<float>(roll + noise(m_rng)));
+    msg.set_yaw(static_cast<float>(m_yaw));
+    msg.set_velocity(static_cast<float>(speed));
+    msg.set_airspeed(static_cast<float>(std::max(0.0, speed + noise(m_rng))));
+    msg.set_xvelocity(static_cast<float>(m_vx));
+    msg.set_yvelocity(static_cast<float>(m_vy));
+    msg.set_zvelocity(static_cast<float>(m_vz));
+    msg.set_timestamp(timestampMs);
+    msg.set_ptpitch(m_gimbalPitch);
+    msg.set_ptroll(m_gimbalRoll);
+    msg.set_ptyaw(m_gimbalYaw);
+    msg.set_zoomfactor(m_zoom);
+    msg.set_boxsn(m_boxSn);
+    msg.set_boxname("SIM-" + std::to_string(m_index));
+    msg.set_batterypower(std::to_string(static_cast<int>(m_battery)));
+    msg.set_uavsn(m_uavSn);
+    msg.set_uavmodel("M30T");
+    msg.set_satellitecount(18 + static_cast<uint32_t>(m_index % 5));
+    msg.set_rtklng(lng);
+    msg.set_rtklat(lat);
+    msg.set_rtkpositioninfo(50);
+    msg.set_airflytimes(static_cast<uint32_t>(m_flyTime));
+    msg.set_airflydistance(static_cast<float>(m_distance));
+    msg.set_homerange(static_cast<float>(std::hypot(m_x, m_y)));
+    msg.set_flightmode(flightMode());
+    msg.set_predictflytime(static_cast<uint32_t>(m_battery * 16.0));
+    if (m_phase == Phase::Goto || m_phase == Phase::ReturnHome) {
+        msg.set_targetdistance(static_cast<float>(std::hypot(m_targetX - m_x, m_targetY - m_y)));
+    }
+}
+
+void SimVehicle::fillUavState(UavState& msg, uint64_t timestampMs) const
+{
+    const std::string power   = std::to_string(static_cast<int>(m_battery));
+    const double      voltage = 22.0 + 4.0 * m_battery / 100.0;   // 6S 电池
+    char volt[16];
+    std::snprintf(volt, sizeof(volt), "%.1f", voltage);
+
+    FlightControllerState* fc = msg.mutable_flightcontrollerstate();
+    fc->set_satellitecount(18 + static_cast<uint32_t>(m_index % 5));
+    fc->set_gpssignallevel(5);
+    fc->set_flightmode(flightMode());
+    fc->set_flightstatus(m_phase == Phase::Landed ? 0 : 2);
+    fc->mutable_homepoint()->set_lng(m_homeLng);
+    fc->mutable_homepoint()->set_lat(m_homeLat);
+    fc->set_homeheight(static_cast<int32_t>(m_cruiseAlt) + 20);
+    fc->set_devicestatus(4);
+    fc->set_rcmode("N");
+    fc->set_rcconnected(1);
+
+    BatteryState* bat = msg.mutable_batterystate();
+    bat->set_batterynum(2);
+    bat->set_batterypower(power + "_" + power);
+    bat->set_batteryvoltage(std::string(volt) + "_" + volt);
+    for (BatteryStateInfo* info : {bat->mutable_firstbatteryinfo(), bat->mutable_secondbatteryinfo()}) {
+        info->set_batterycapacitypercent(static_cast<uint32_t>(m_battery));
+        info->set_currentvoltage(static_cast<int32_t>(voltage * 1000));
+        info->set_currentelectric(m_phase == Phase::Landed ? 0 : -static_cast<int32_t>(12000 + 400 * groundSpeed()));
+        info->set_batterytemperature(static_cast<float>(28.0 + m_flyTime / 60.0));
+        info->set_cellcount(6);
+    }
+
+    PtzState* ptz = msg.mutable_ptzstate();
+    ptz->set_pitch(m_gimbalPitch);
+    ptz->set_roll(m_gimbalRoll);
+    ptz->set_yaw(m_gimbalYaw);
+    ptz->set_gimbalmode(1);
+
+    msg.mutable_camerastate()->set_zoomfactor(m_zoom);
+    msg.set_boxsn(m_boxSn);
+    msg.set_timestamp(timestampMs);
+}
+
+void SimVehicle::fillSignal(SignalList& msg, uint64_t timestampMs) const
+{
+    std::normal_distribution<double> noise(0.0, 1.5);
+    double lng, lat;
+    lngLat(lng, lat);
+    // 离起飞点越远、越高，信号越弱
+    const double range = std::hypot(m_x, m_y) + m_z;
+
+    SignalInfo* info = msg.add_signalinfo();
+    info->set_mode("NR5G-SA");
+    info->set_isp("CMCC");
+    info->set_rsrp(std::to_string(static_cast<int>(-75.0 - range / 40.0 + noise(m_rng))));
+    info->set_rsrq(std::to_string(static_cast<int>(-10.0 + noise(m_rng) / 2)));
+    info->set_sinr(std::to_string(static_cast<int>(22.0 - range / 60.0 + noise(m_rng))));
+    info->set_lng(lng);
+    info->set_lat(lat);
+    info->set_height(static_cast<float>(m_z));
+    info->set_timestamp(static_cast<uint32_t>(timestampMs / 1000));
+    info->set_box_sn(m_boxSn);
+    info->set_networkmode(5);
+    info->set_delaytime(static_cast<uint32_t>(std::max(5.0, 28.0 + range / 100.0 + noise(m_rng))));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "TelemetryDataBuf-new.pb.h"
+
+/**
+ * @brief 模拟飞机：在以 home 为原点的局部东-北-天坐标系中积分速度，生成随时间连续变化的遥测。
+ *
+ *        - 起飞后默认绕 home 盘旋（半径、速度按编号错开），收到 goto / rth / land 等控制帧后切换阶段；
+ *        - 水平 / 垂直加速度与偏航角速度有上限，姿态角由加速度和速度推出，数值连贯而非随机跳变；
+ *        - 云台响应 0x09（绝对角度）与 0xF4（角速度 + 持续时间）；
+ *        - 只在 SimServer 的事件循环线程中访问，不加锁。
+ */
+class SimVehicle
+{
+public:
+    enum class Phase { Landed, TakingOff, Hover, Orbit, Goto, ReturnHome, Landing };
+
+    SimVehicle(std::string boxSn, int index, double homeLng, double homeLat, uint32_t seed);
+
+    const std::string& boxSn() const { return m_boxSn; }
+    Phase              phase() const { return m_phase; }
+
+    /**
+     * @brief 推进 dt 秒
+     */
+    void step(double dt);
+
+    /**
+     * @brief 执行一条控制帧（动作编号 + 参数），返回执行结果：0=成功，非 0 为拒绝原因
+     */
+    uint8_t applyControl(uint8_t action, const uint8_t* param, size_t len);
+
+    void fillTelemetry(TelemetryData& msg, uint64_t timestampMs) const;
+    void fillUavState(UavState& msg, uint64_t timestampMs) const;
+    void fillSignal(SignalList& msg, uint64_t timestampMs) const;
+
+private:
+    void   lngLat(double& lng, double& lat) const;
+    double groundSpeed() const;
+    uint32_t flightMode() const;
+
+private:
+    std::string m_boxSn;
+    std::string m_uavSn;
+    int         m_index;
+    double      m_homeLng;
+    double      m_homeLat;
+    mutable std::mt19937 m_rng;    ///< 传感器噪声
+
+    Phase  m_phase = Phase::Orbit;
+    // 位置 / 速度（米、米每秒，东-北-天）
+    double m_x = 0, m_y = 0, m_z = 0;
+    double m_vx = 0, m_vy = 0, m_vz = 0;
+    double m_ax = 0, m_ay = 0;
+    double m_yaw = 0;              ///< 机头朝向（度，北为 0，顺时针）
+
+    double m_orbitRadius = 80;
+    double m_orbitSpeed  = 8;
+    double m_cruiseAlt   = 50;
+    double m_targetX = 0, m_targetY = 0, m_targetAlt = 0, m_targetSpeed = 8;
+
+    double m_battery  = 100;       ///< 剩余电量（%）
+    double m_flyTime  = 0;         ///< 本次飞行时间（秒）
+    double m_distance = 0;         ///< 本次飞行距离（米）
+
+    // 云台
+    float  m_gimbalPitch = 0, m_gimbalRoll = 0, m_gimbalYaw = 0;
+    float  m_gimbalTargetPitch = 0, m_gimbalTargetYaw = 0;
+    float  m_gimbalSpeedPitch = 0, m_gimbalSpeedYaw = 0;
+    double m_gimbalSpeedLeft = 0;  ///< 角速度控制剩余时间（秒）
+    float  m_zoom = 1.0f;
+};
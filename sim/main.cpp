@@ -0,0 +1,218 @@
+// dji-sim: 云盒模拟器 / 负载发生器
+//
+// 不接真实云盒时，把 config.json 的 server / port 指向本程序即可在本机运行客户端，
+// 也可把各数据流频率调高作为吞吐与时延测试的数据源。
+//
+// 用法见 usage()，例：
+//   dji-sim --port 8124 --vehicles 4
+//   dji-sim --vehicle SIMBOX000000001:50:5:1 --vehicle SIMBOX000000002:10 --reply-delay 40 --reply-jitter 20
+//   dji-sim --a9-hz 20000 --fragment 0.2 --garbage 0.01 --disconnect-every 30
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+#include <thread>
+
+#include "SimServer.h"
+#include "utils/AsyncLogger.h"
+
+namespace {
+
+void usage(const char* prog)
+{
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --bind IP               listen address (default 0.0.0.0)\n"
+        "  --port N                listen port (default 8124)\n"
+        "  --udp 0|1               also serve the selective-reliability UDP transport on the same port (default 0)\n"
+        "  --vehicles N            number of simulated vehicles using the default rates (default 1)\n"
+        "  --vehicle SN[:A9[:A8[:AA]]]\n"
+        "                          add a vehicle with its own box SN and stream rates in Hz (repeatable)\n"
+        "  --a9-hz F --a8-hz F --aa-hz F\n"
+        "                          default rates for 0xA9 telemetry / 0xA8 state / 0xAA signal (10 / 2 / 0)\n"
+        "  --home LNG,LAT          home point of the first vehicle\n"
+        "  --reply-delay MS        delay before a 0xD1 reply (default 20)\n"
+        "  --reply-jitter MS       uniform +/- jitter added to the reply delay (default 0)\n"
+        "  --ack-delay MS          delay before a route chunk (0x44) ack (default 5)\n"
+        "  --ack-drop P            fraction of route chunk acks that are never sent (default 0)\n"
+        "  --ack-reorder MS        extra uniform 0..MS delay per route chunk ack, so acks arrive out of order\n"
+        "  --reject-rate P         fraction of control frames answered with a failure result (default 0)\n"
+        "  --heartbeat-reply 0|1   answer heartbeats with 0x02 (echo + box timestamp) (default 1)\n"
+        "  --key HEX               AES-GCM key (32 or 64 hex chars) for encrypted control frames and their replies;\n"
+        "                          plaintext control frames are then dropped\n"
+        "  --clock-offset MS       box clock minus local clock, applied to all vehicle timestamps (default 0)\n"
+        "  --clock-drift PPM       box clock drift (default 0)\n"
+        "  --fragment P            probability that a write is cut short, splitting frames across reads\n"
+        "  --garbage P             probability of 1-16 garbage bytes before each frame\n"
+        "  --disconnect-every S    mean seconds between injected disconnects (half a frame, then close)\n"
+        "  --queue-kb N            per-client unsent data limit before stream frames are dropped (default 8192)\n"
+        "  --stats S               print counters every S seconds, 0 to disable (default 5)\n"
+        "  --duration S            exit after S seconds (default: run until SIGINT)\n"
+        "  --seed N                random seed (default 1)\n",
+        prog);
+}
+
+// 协议中的 SN 固定 15 字节
+std::string fixSn(std::string sn)
+{
+    sn.resize(15, '0');
+    return sn;
+}
+
+std::string defaultSn(int index)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "SIMBOX%09d", index + 1);
+    return fixSn(buf);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    SimOptions opts;
+    int    defaultVehicles = 0;
+    double a9Hz = 10.0, a8Hz = 2.0, aaHz = 0.0;
+    double durationS = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+        const char* val = argv[++i];
+        if (arg == "--bind") {
+            opts.bind = val;
+        } else if (arg == "--port") {
+            opts.port = static_cast<uint16_t>(std::atoi(val));
+        } else if (arg == "--udp") {
+            opts.udp = std::atoi(val) != 0;
+        } else if (arg == "--vehicles") {
+            defaultVehicles = std::atoi(val);
+        } else if (arg == "--vehicle") {
+            // SN[:A9[:A8[:AA]]]，未给出的频率稍后用默认值补齐
+            SimOptions::Vehicle v;
+            v.a9Hz = v.a8Hz = v.aaHz = -1;
+            std::string spec = val;
+            size_t pos = spec.find(':');
+            v.boxSn = fixSn(spec.substr(0, pos));
+            double* rates[] = {&v.a9Hz, &v.a8Hz, &v.aaHz};
+            for (double* r : rates) {
+                if (pos == std::string::npos) {
+                    break;
+                }
+                const size_t next = spec.find(':', pos + 1);
+                *r  = std::atof(spec.substr(pos + 1, next - pos - 1).c_str());
+                pos = next;
+            }
+            opts.vehicles.push_back(v);
+        } else if (arg == "--a9-hz") {
+            a9Hz = std::atof(val);
+        } else if (arg == "--a8-hz") {
+            a8Hz = std::atof(val);
+        } else if (arg == "--aa-hz") {
+            aaHz = std::atof(val);
+        } else if (arg == "--home") {
+            if (std::sscanf(val, "%lf,%lf", &opts.homeLng, &opts.homeLat) != 2) {
+                std::cerr << "--home expects LNG,LAT\n";
+                return 1;
+            }
+        } else if (arg == "--reply-delay") {
+            opts.replyDelayMs = std::atoi(val);
+        } else if (arg == "--reply-jitter") {
+            opts.replyJitterMs = std::atoi(val);
+        } else if (arg == "--ack-delay") {
+            opts.ackDelayMs = std::atoi(val);
+        } else if (arg == "--ack-drop") {
+            opts.ackDropRate = std::atof(val);
+        } else if (arg == "--ack-reorder") {
+            opts.ackReorderMs = std::atoi(val);
+        } else if (arg == "--reject-rate") {
+            opts.rejectRate = std::atof(val);
+        } else if (arg == "--heartbeat-reply") {
+            opts.heartbeatReply = std::atoi(val) != 0;
+        } else if (arg == "--key") {
+            opts.key = val;
+        } else if (arg == "--clock-offset") {
+            opts.clockOffsetMs = std::atof(val);
+        } else if (arg == "--clock-drift") {
+            opts.clockDriftPpm = std::atof(val);
+        } else if (arg == "--fragment") {
+            opts.fragmentRate = std::atof(val);
+        } else if (arg == "--garbage") {
+            opts.garbageRate = std::atof(val);
+        } else if (arg == "--disconnect-every") {
+            opts.disconnectEveryS = std::atof(val);
+        } else if (arg == "--queue-kb") {
+            opts.maxQueueBytes = std::strtoull(val, nullptr, 10) * 1024;
+        } else if (arg == "--stats") {
+            opts.statsIntervalS = std::atoi(val);
+        } else if (arg == "--duration") {
+            durationS = std::atof(val);
+        } else if (arg == "--seed") {
+            opts.seed = static_cast<uint32_t>(std::strtoul(val, nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    for (auto& v : opts.vehicles) {
+        v.a9Hz = v.a9Hz < 0 ? a9Hz : v.a9Hz;
+        v.a8Hz = v.a8Hz < 0 ? a8Hz : v.a8Hz;
+        v.aaHz = v.aaHz < 0 ? aaHz : v.aaHz;
+    }
+    if (opts.vehicles.empty() && defaultVehicles <= 0) {
+        defaultVehicles = 1;
+    }
+    for (int i = 0; i < defaultVehicles; ++i) {
+        opts.vehicles.push_back(SimOptions::Vehicle{defaultSn(static_cast<int>(opts.vehicles.size())), a9Hz, a8Hz, aaHz});
+    }
+
+    // 信号由专门的线程 sigwait 处理，事件循环线程不会被打断
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    AsyncLogger::instance().start();
+
+    SimServer server;
+    if (!server.start(g_eventLoop, opts)) {
+        AsyncLogger::instance().stop();
+        return 1;
+    }
+
+    auto shutdown = [&server] {
+        g_eventLoop.runInLoop([&server] {
+            server.printStats();
+            server.stop();
+            g_eventLoop.quit();
+        });
+    };
+    std::thread([signals, shutdown]() mutable {
+        int sig = 0;
+        sigwait(&signals, &sig);
+        shutdown();
+    }).detach();
+    if (durationS > 0) {
+        g_eventLoop.runAfter(std::chrono::microseconds(static_cast<int64_t>(durationS * 1e6)), shutdown);
+    }
+
+    g_eventLoop.loop();
+    AsyncLogger::instance().stop();
+    return 0;
+}
@@ -2,6 +2,53 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include "utils/CDualLinkCom.h"
+#include "utils/CLinuxTCPCom.h"
+#include "utils/CLinuxUDPCom.h"
+#include "utils/CLinuxUringTCPCom.h"
+#include "utils/LinkRecorder.h"
+#include "utils/PayloadCipher.h"
+
+namespace {
+
+std::unique_ptr<ITransport> makeLinkTransport(const ServerConfig& cfg, bool allowUring)
+{
+    if (cfg.transport == "udp") {
+        UdpLinkOptions emulator;
+        emulator.loss     = cfg.udpLoss;
+        emulator.delayMs  = cfg.udpDelayMs;
+        emulator.jitterMs = cfg.udpJitterMs;
+        return std::make_unique<CLinuxUDPCom>(emulator);
+    }
+    if (allowUring && cfg.ioBackend != "posix") {
+        std::string why;
+        if (CLinuxUringTCPCom::Supported(&why)) {
+            return std::make_unique<CLinuxUringTCPCom>();
+        }
+        if (cfg.ioBackend == "io_uring") {
+            std::cerr << "[TasksManager] io_uring unavailable (" << why << "), falling back to posix sockets.\n";
+        }
+    }
+    return std::make_unique<CLinuxTCPCom>();
+}
+
+std::unique_ptr<ITransport> makeTransport(const ServerConfig& cfg)
+{
+    if (cfg.standbyServer.empty()) {
+        return makeLinkTransport(cfg, true);
+    }
+    // 双链路：两条链路各有接收线程，录制写请求无法挂到它们的 ring 上，TCP 链路都用 posix 套接字
+    if (cfg.transport == "tcp" && cfg.ioBackend == "io_uring") {
+        std::cerr << "[TasksManager] io_uring is not used with a standby link, using posix sockets.\n";
+    }
+    DualLinkOptions opts;
+    opts.standbyIp   = cfg.standbyServer;
+    opts.standbyPort = static_cast<uint16_t>(cfg.standbyPort);
+    opts.staleMs     = cfg.linkStaleMs;
+    return std::make_unique<CDualLinkCom>(makeLinkTransport(cfg, false), makeLinkTransport(cfg, false), opts);
+}
+
+} // namespace
 
 TasksManager::TasksManager()
     : mIsRunning(false)
@@ -24,21 +71,35 @@ bool TasksManager::initAllTasks()
         std::cerr << "[TasksManager] Invalid server config!\n";
         return false; // 如果配置无效，直接返回
     }
+    if (!g_serverConfig.encryptionKey.empty()) {
+        if (!g_payloadCipher.setKeyHex(g_serverConfig.encryptionKey)) {
+            std::cerr << "[TasksManager] Invalid encryptionKey, refusing to run unencrypted.\n";
+            return false;
+        }
+        std::cout << "[TasksManager] Control payload encryption: " << g_payloadCipher.describe() << "\n";
+    }
 
-    // 1. 初始化TCP通信对象（client模式举例）
-    mTcpCom = std::make_unique<CLinuxTCPCom>();
+    // 1. 初始化传输层（client模式）
+    mTransport = makeTransport(g_serverConfig);
     while (true) {
-        if (mTcpCom->TCPInitClient(g_serverConfig.ip.c_str(), g_serverConfig.port) >= 0) {
-            std::cout << "[TasksManager] TCP client initialized successfully.\n";
+        if (mTransport->InitClient(g_serverConfig.ip.c_str(), g_serverConfig.port) >= 0) {
+            std::cout << "[TasksManager] " << mTransport->Name() << " client initialized successfully.\n";
             break;
         }
-        std::cerr << "[TasksManager] Failed to initialize TCP client, retrying...\n";
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+        std::cerr << "[TasksManager] Failed to initialize " << mTransport->Name() << " client, retrying...\n";
+        // 分段休眠，收到终止信号时不再重试
+        for (int i = 0; i < 30 && !g_terminateRequested; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (g_terminateRequested) {
+            std::cerr << "[TasksManager] Terminate requested, giving up connecting.\n";
+            return false;
+        }
     }
 
 
     // 2. 创建ComTask对象
-    mComTask = std::make_unique<ComTask>(*mTcpCom);
+    mComTask = std::make_unique<ComTask>(*mTransport);
 
     // 3. 创建帧组装器
     mFrameAssembler = std::make_unique<FrameAssembler>(false); // false表示正常模式
@@ -72,17 +133,39 @@ void TasksManager::startAllTasks()
     mIsRunning = true;
     std::cout << "[TasksManager] Starting all tasks..." << std::endl;
 
-    // 启动发送线程
-    mThreads.emplace_back(&TasksManager::sendTaskFunc, this);
+    // 异步日志后台线程（之前的日志同步输出）
+    AsyncLogger::instance().start();
+
+    // 启动收发、取帧、解析回复帧线程
+    startPipeline();
+
+    // 启动事件循环线程，并注册周期心跳
+    mEventLoopThread = std::thread(&TasksManager::runEventLoop, this);
+    mHeartbeatTimer = g_eventLoop.runEvery(std::chrono::seconds(3), [this] { sendHeartBeat(); });
 
-    // 启动接收线程
-    mThreads.emplace_back(&TasksManager::recvTaskFunc, this);
+    // 命令-回复关联与 RTT 统计（超时清理在事件循环中执行）
+    g_commandTracker.start();
 
-    // 启动取帧线程
-    mThreads.emplace_back(&TasksManager::assembleCompleteFrame, this);
+    // 流水线命令通道（脚本 / 批量命令使用）
+    g_commandChannel.start();
+
+    // 本地指标端点（stats metrics 命令也可直接查看）
+    Metrics::startEndpoint(g_eventLoop, static_cast<uint16_t>(g_serverConfig.metricsPort));
+
+    // 遥测中继：下游看板共用本程序的上行连接
+    if (g_serverConfig.relayPort > 0) {
+        TelemetryRelay::SlowPolicy policy = TelemetryRelay::SlowPolicy::DropOldest;
+        if (!TelemetryRelay::parsePolicy(g_serverConfig.relayPolicy, policy)) {
+            std::cerr << "[TasksManager] Unknown relayPolicy '" << g_serverConfig.relayPolicy
+                      << "', using drop-oldest.\n";
+        }
+        g_telemetryRelay.start(g_eventLoop, g_serverConfig.relayBind, static_cast<uint16_t>(g_serverConfig.relayPort),
+                               static_cast<size_t>(g_serverConfig.relayQueueKB) * 1024, policy);
+    }
 
-    // 启动解析回复帧线程
-    mThreads.emplace_back(&TasksManager::decodeReplyFrame, this);
+    // 本机查询接口（Unix 套接字）
+    g_queryServer.start(g_eventLoop, g_serverConfig.querySocket, static_cast<size_t>(g_serverConfig.queryHistory),
+                        g_serverConfig.queryAllowCommands);
 }
 
 void TasksManager::stopAllTasks()
@@ -95,28 +178,152 @@ void TasksManager::stopAllTasks()
 
     std::cout << "[TasksManager] Stopping all tasks...\n";
 
-    // 关闭socket，促使recv()返回，进而退出recv线程循环
-    if (mTcpCom) {
-        mTcpCom->CloseFd();
+    // 停止流水线线程（shutdown 读方向促使 recv() 返回，各条件变量等待被唤醒），再关闭 socket
+    stopPipeline();
+    if (mTransport) {
+        mTransport->CloseFd();   // io_uring 传输层在此等待已提交的录制写请求完成
+    }
+    g_linkRecorder.stop();
+
+    g_commandChannel.stop();
+    g_commandTracker.stop();
+    Metrics::stopEndpoint(g_eventLoop);
+    g_telemetryRelay.stop();
+    g_queryServer.stop();
+    g_eventLoop.cancel(mHeartbeatTimer);
+    mHeartbeatTimer = 0;
+    g_eventLoop.quit();             // 停止事件循环
+
+    if (mEventLoopThread.joinable()) {
+        mEventLoopThread.join();
     }
 
-    mComTask->m_isRunning = false;  // 停止通信任务
+    AsyncLogger::instance().stop();   // 输出剩余日志
+    std::cout << "[TasksManager] All tasks stopped.\n";
+}
 
-    mFrameAssembler->stop();        // 停止帧组装器
+void TasksManager::startPipeline()
+{
+    mPipelineStop = StopSource();
+    mPipelineStop.onStop([] { StopSource::notifyAll(g_queueMutex, g_queueCond); });
+    mPipelineStop.onStop([] { StopSource::notifyAll(g_recvRawQueueMutex, g_recvRawQueueCond); });
+    mPipelineStop.onStop([] { StopSource::notifyAll(g_completeQueueMutex, g_completeQueueCond); });
+    mPipelineStop.onStop([this] { mTransport->ShutdownRead(); });
+
+    const StopToken stop = mPipelineStop.token();
+    mThreads.emplace_back(&TasksManager::sendTaskFunc, this, stop);
+    mThreads.emplace_back(&TasksManager::recvTaskFunc, this, stop);
+    mThreads.emplace_back(&TasksManager::assembleCompleteFrame, this, stop);
+    mThreads.emplace_back(&TasksManager::decodeReplyFrame, this, stop);
+}
 
-    // 等待所有线程退出
+void TasksManager::stopPipeline()
+{
+    mPipelineStop.requestStop();
     for (auto &t : mThreads) {
         if (t.joinable()) {
             t.join();
         }
     }
     mThreads.clear();
+}
 
-    std::cout << "[TasksManager] All tasks stopped.\n";
+bool TasksManager::restartPipeline(const ServerConfig* linkConfig)
+{
+    if (!mIsRunning) {
+        std::cerr << "[TasksManager] Tasks are not running, nothing to restart.\n";
+        return false;
+    }
+    // 新密钥先校验：无效时保持原链路与原密钥，不做半截切换
+    std::vector<uint8_t> newKey;
+    if (linkConfig && !linkConfig->encryptionKey.empty()
+        && !PayloadCipher::parseHexKey(linkConfig->encryptionKey, newKey)) {
+        std::cerr << "[TasksManager] Invalid encryptionKey in new config, pipeline not restarted.\n";
+        return false;
+    }
+    const uint64_t startNs = Metrics::nowNs();
+
+    stopPipeline();
+    const uint64_t stoppedNs = Metrics::nowNs();
+
+    // 旧连接上未拼完的数据无法与新连接的字节流衔接
+    size_t dropped = mFrameAssembler->reset();
+    {
+        std::lock_guard<std::mutex> lk(g_recvRawQueueMutex);
+        while (!g_recvRawDataFrameQueue.empty()) {
+            dropped += g_recvRawDataFrameQueue.front().data.size();
+            g_recvRawDataFrameQueue.pop();
+        }
+    }
+    Metrics::add(Metrics::DiscardedBytes, dropped);
+
+    // 流水线线程都已退出；事件循环仍在运行，心跳定时器会经 mComTask 投递心跳帧。
+    // 先取消心跳定时器，替换在 mLinkMutex 下进行，覆盖取消生效前已在执行的那次回调
+    g_eventLoop.cancel(mHeartbeatTimer);
+    mHeartbeatTimer = 0;
+    {
+        std::lock_guard<std::mutex> lk(mLinkMutex);
+        if (linkConfig) {
+            g_serverConfig.ip             = linkConfig->ip;
+            g_serverConfig.port           = linkConfig->port;
+            g_serverConfig.transport      = linkConfig->transport;
+            g_serverConfig.ioBackend      = linkConfig->ioBackend;
+            g_serverConfig.udpLoss        = linkConfig->udpLoss;
+            g_serverConfig.udpDelayMs     = linkConfig->udpDelayMs;
+            g_serverConfig.udpJitterMs    = linkConfig->udpJitterMs;
+            g_serverConfig.standbyServer  = linkConfig->standbyServer;
+            g_serverConfig.standbyPort    = linkConfig->standbyPort;
+            g_serverConfig.linkStaleMs    = linkConfig->linkStaleMs;
+            g_serverConfig.encryptionKey  = linkConfig->encryptionKey;
+            g_serverConfig.threadPolicies = linkConfig->threadPolicies;
+            // 换密钥：之后构建的控制帧使用新密钥，旧密钥加密、尚未应答的命令的回复将无法解密
+            g_payloadCipher.setKey(newKey);
+        }
+        mTransport->CloseFd();
+        if (linkConfig) {
+            // 传输层重建（可切换 tcp / udp）：ComTask 持有其引用，一并重建，未发出的帧转交给新实例
+            mTransport   = makeTransport(g_serverConfig);
+            auto comTask = std::make_unique<ComTask>(*mTransport);
+            comTask->m_unsent.swap(mComTask->m_unsent);
+            mComTask = std::move(comTask);
+        }
+    }
+    mHeartbeatTimer = g_eventLoop.runEvery(std::chrono::seconds(3), [this] { sendHeartBeat(); });
+
+    if (mTransport->InitClient(g_serverConfig.ip.c_str(), g_serverConfig.port) < 0) {
+        std::cerr << "[TasksManager] Reconnect to " << g_serverConfig.ip << ":" << g_serverConfig.port
+                  << " failed, the receive thread keeps retrying.\n";
+    }
+
+    startPipeline();
+
+    size_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lk(g_queueMutex);
+        pending = g_dataFrameQueue.size();
+    }
+    std::cout << "[TasksManager] Pipeline restarted in " << (Metrics::nowNs() - startNs) / 1000 << " us (stop "
+              << (stoppedNs - startNs) / 1000 << " us), " << pending << " queued frames kept, " << dropped
+              << " partial bytes dropped.\n";
+    return true;
+}
+
+std::string TasksManager::linkStatus() const
+{
+    std::lock_guard<std::mutex> lk(mLinkMutex);
+    if (!mTransport) {
+        return "[TasksManager] No transport.\n";
+    }
+    if (const auto* dual = dynamic_cast<const CDualLinkCom*>(mTransport.get())) {
+        return dual->status();
+    }
+    return "[TasksManager] Single " + std::string(mTransport->Name()) + " link to " + g_serverConfig.ip + ":" +
+           std::to_string(g_serverConfig.port) + (mTransport->GetCommFd() >= 0 ? " (up)\n" : " (down)\n");
 }
 
 void TasksManager::pushDataFrame(const DataFrame& frame)
 {
+    std::lock_guard<std::mutex> lk(mLinkMutex);
     if (mComTask) {
         mComTask->pushDataFrame(frame);
     }
@@ -125,44 +332,64 @@ void TasksManager::pushDataFrame(const DataFrame& frame)
 /**
  * @brief 发送任务，替换原先的 ComTask::sendThreadFunc
  */
-void TasksManager::sendTaskFunc()
+void TasksManager::sendTaskFunc(StopToken stop)
 {
-    mComTask->sendThreadFunc();
+    Tracer::setThreadName("send");
+    ThreadSched::apply("send");
+    AllocTrace::setThreadStage(AllocTrace::Send);
+    mComTask->sendThreadFunc(stop);
 }
 
 /**
  * @brief 接收任务，替换原先的 ComTask::recvThreadFunc
  */
-void TasksManager::recvTaskFunc()
+void TasksManager::recvTaskFunc(StopToken stop)
+{
+    Tracer::setThreadName("recv");
+    ThreadSched::apply("recv");
+    AllocTrace::setThreadStage(AllocTrace::Recv);
+    mComTask->recvThreadFunc(stop);
+}
+
+/**
+ * @brief 事件循环任务，所有定时器回调都在该线程执行
+ */
+void TasksManager::runEventLoop()
 {
-    mComTask->recvThreadFunc();
+    Tracer::setThreadName("event-loop");
+    ThreadSched::apply("event-loop");
+    AllocTrace::setThreadStage(AllocTrace::EventLoop);
+    if (!g_eventLoop.loop()) {
+        std::cerr << "[TasksManager] Event loop failed to start.\n";
+    }
 }
 
 void TasksManager::sendHeartBeat()
 {
-    // 每隔3s发送一次心跳包
-    while (mIsRunning) {
-        std::this_thread::sleep_for(std::chrono::seconds(3));
-        std::cout << "[TasksManager] Sending heartbeat...\n";
-        DataFrame heartbeatFrame = createHeartbeatFrame();
-        if (mComTask) {
-            mComTask->pushDataFrame(heartbeatFrame);
-        }
+    std::lock_guard<std::mutex> lk(mLinkMutex);
+    if (mIsRunning && mComTask) {
+        mComTask->pushDataFrame(createHeartbeatFrame());
     }
 }
 
 /**
  * @brief 取帧任务，替换原先的 FrameAssembler::run
  */
-void TasksManager::assembleCompleteFrame()
+void TasksManager::assembleCompleteFrame(StopToken stop)
 {
-    mFrameAssembler->run();
+    Tracer::setThreadName("assembler");
+    ThreadSched::apply("assembler");
+    AllocTrace::setThreadStage(AllocTrace::Assemble);
+    mFrameAssembler->run(stop);
 }
 
 /**
  * @brief 解析回复帧任务，替换原先的 ReplyFrameDecoder::runDecodeThread
  */
-void TasksManager::decodeReplyFrame()
+void TasksManager::decodeReplyFrame(StopToken stop)
 {
-    mReplyDecoder->runDecodeThread();
+    Tracer::setThreadName("decoder");
+    ThreadSched::apply("decoder");
+    AllocTrace::setThreadStage(AllocTrace::Decode);
+    mReplyDecoder->runDecodeThread(stop);
 }
\ No newline at end of file
@@ -4,12 +4,24 @@
 #include "FrameAssembler.h"
 #include "ReplyFrameDecoder.h"
 #include "FrameDataHandler.h"
+#include "CommandTracker.h"
+#include "CommandChannel.h"
+#include "TelemetryRelay.h"
+#include "QueryServer.h"
 #include "com_task.h"
 #include "common_types.h"
 #include "common_utils.h"
-#include "utils/CLinuxTCPCom.h"
+#include "utils/ITransport.h"
+#include "utils/EventLoop.h"
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
+#include "utils/AsyncLogger.h"
+#include "utils/AllocTrace.h"
+#include "utils/ThreadSched.h"
+#include "utils/StopToken.h"
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -36,42 +48,73 @@ public:
    */
   void stopAllTasks();
 
+  /**
+   * @brief 热重启数据流水线（收发 / 组帧 / 解析线程与连接），事件循环及本地服务不受影响
+   * @param linkConfig 新的链路配置（server / port / transport / ioBackend / udp* / standby* / encryptionKey / threads），
+   *                   为空时按原配置重连
+   * @return 未运行或新配置中的 encryptionKey 无效时返回 false（不做任何改动）；重连失败时流水线照常启动，由接收线程继续重试
+   *
+   * 待发送的控制帧、已组装未解析的完整帧均保留；旧连接上未拼完的字节无法与新连接衔接，丢弃并计入
+   * DiscardedBytes。
+   */
+  bool restartPipeline(const ServerConfig *linkConfig = nullptr);
+
+  /**
+   * @brief 链路状态：单链路时为地址与连接状态，双链路时为各链路的收包、先到回复、重连与遥测新鲜度
+   */
+  std::string linkStatus() const;
+
   /**
    * @brief 往发送队列里塞入一帧数据
    */
   void pushDataFrame(const DataFrame &frame);
 
 private:
+  /**
+   * @brief 启动 / 停止收发、组帧、解析四个线程；停止时所有阻塞点经 StopToken 立即返回
+   */
+  void startPipeline();
+  void stopPipeline();
+
   /**
    * @brief 发送数据线程函数（原 ComTask::sendThreadFunc）
    */
-  void sendTaskFunc();
+  void sendTaskFunc(StopToken stop);
 
   /**
    * @brief 接收数据线程函数（原 ComTask::recvThreadFunc）
    */
-  void recvTaskFunc();
+  void recvTaskFunc(StopToken stop);
 
   /**
    * @brief 从原始数据块构建完整数据帧的函数
    */
-  void assembleCompleteFrame();
+  void assembleCompleteFrame(StopToken stop);
 
   /**
    * @brief 解析回复帧的线程函数（原 ReplyFrameDecoder::runDecodeThread）
    */
-  void decodeReplyFrame();
+  void decodeReplyFrame(StopToken stop);
+
+  /**
+   * @brief 事件循环线程函数（定时器、跨线程投递的任务）
+   */
+  void runEventLoop();
 
   /**
-   * @brief 发送心跳包
+   * @brief 发送心跳包，由事件循环每 3s 调用一次
    */
   void sendHeartBeat();
 
 private:
   std::atomic<bool>         mIsRunning;   ///< 表示当前任务是否处于运行状态
-  std::vector<std::thread>  mThreads;     ///< 线程容器
+  std::vector<std::thread>  mThreads;     ///< 流水线线程（收发 / 组帧 / 解析）
+  std::thread               mEventLoopThread; ///< 事件循环线程（重启流水线时不停止）
+  StopSource                mPipelineStop;    ///< 流水线线程的停止源，每次启动新建
+  EventLoop::TimerId        mHeartbeatTimer = 0; ///< 心跳定时器
 
-  std::unique_ptr<CLinuxTCPCom>       mTcpCom;          ///< TCP通信类封装
+  mutable std::mutex                  mLinkMutex;       ///< 保护 mTransport / mComTask 的替换以及 g_serverConfig 中的链路配置
+  std::unique_ptr<ITransport>         mTransport;       ///< 传输层（按配置为 TCP 或 UDP）
 
   std::unique_ptr<ComTask>            mComTask;         ///< 通信任务
   std::unique_ptr<FrameAssembler>     mFrameAssembler;  ///< 帧组装器
@@ -3,6 +3,13 @@
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include "modules/ClockSync.h"
+#include "modules/CommandTracker.h"
+#include "utils/GimbalJoystickController.h"
+#include "utils/LinkRecorder.h"
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
+#include "utils/AsyncLogger.h"
 
 
 // 使用全局队列：
@@ -10,17 +17,14 @@ extern std::queue<DataFrame> g_dataFrameQueue;
 extern std::mutex g_queueMutex;
 extern std::condition_variable g_queueCond;
 
-ComTask::ComTask(CLinuxTCPCom& tcpCom)
-    : m_tcpCom(tcpCom)
-    , m_isRunning(true)  // 初始设为true，当socket关闭或其他方式时可令其退出
+ComTask::ComTask(ITransport& transport)
+    : m_transport(transport)
 {
 }
 
 
 ComTask::~ComTask()
 {
-    // 退出时标记停止，若有需要也可以在这里强行 shutdown socket
-    m_isRunning = false;
 }
 
 void ComTask::pushDataFrame(const DataFrame& frame)
@@ -34,62 +38,86 @@ void ComTask::pushDataFrame(const DataFrame& frame)
     g_queueCond.notify_one();
 }
 
-void ComTask::sendThreadFunc()
+void ComTask::sendThreadFunc(const StopToken& stop)
 {
     std::cout << "[ComTask] sendThreadFunc started.\n";
-    while (m_isRunning)
+    std::vector<DataFrame> batch;
+    batch.reserve(kMaxSendBatch);
+    while (!stop.stopRequested())
     {
-        DataFrame frameToSend;
-        {
+        if (!m_unsent.empty()) {
+            // 上次停止时没能发出的帧排在队列之前
+            batch.swap(m_unsent);
+        } else {
             std::unique_lock<std::mutex> lk(g_queueMutex);
-            // 等待队列非空或者任务被停止
-            g_queueCond.wait(lk, [] {
-                return !g_dataFrameQueue.empty();
-            });
-
-            // 再次判断是否仍在运行
-            if (!m_isRunning) {
+            // 等待队列非空或者任务被停止；停止时队列中的帧原样保留，重启后继续发送
+            stop.wait(lk, g_queueCond, [] { return !g_dataFrameQueue.empty(); });
+            if (stop.stopRequested()) {
                 break;
             }
 
-            // 从队列中取出一帧
-            frameToSend = g_dataFrameQueue.front();
-            g_dataFrameQueue.pop();
+            // 一次取出积压的帧，合并为一次系统调用发出
+            Metrics::setGauge(Metrics::SendQueueDepth, g_dataFrameQueue.size());
+            while (!g_dataFrameQueue.empty() && batch.size() < kMaxSendBatch) {
+                batch.push_back(std::move(g_dataFrameQueue.front()));
+                g_dataFrameQueue.pop();
+            }
+        }
+
+        // 先登记发送时刻再写 socket：回复可能在 send() 返回前就被解析线程处理
+        for (const auto& frame : batch) {
+            g_commandTracker.onSending(frame);
+            g_clockSync.onSending(frame);
         }
 
-        // 调用 TCP 通信库发送数据
-        int sentBytes = m_tcpCom.TCPSendData(frameToSend.data(), frameToSend.size());
+        const uint64_t sendBeginNs = Tracer::enabled() ? Metrics::nowNs() : 0;
+        int sentBytes = batch.size() == 1 ? m_transport.SendData(batch[0].data(), batch[0].size())
+                                          : m_transport.SendBatch(batch);
+        if (sendBeginNs) {
+            const uint64_t sendEndNs = Metrics::nowNs();
+            for (const auto& frame : batch) {
+                Tracer::complete("SendData", sendBeginNs, sendEndNs, Tracer::frameFlowId(frame), Tracer::Flow::End);
+            }
+        }
         if (sentBytes > 0) {
-            // std::cout << "[ComTask] Sent " << sentBytes << " bytes.\n";
+            Metrics::add(Metrics::BytesOut, static_cast<uint64_t>(sentBytes));
+            Metrics::add(Metrics::FramesOut, batch.size());
+            for (const auto& frame : batch) {
+                GimbalJoystickController::onFrameSent(frame);
+            }
+        } else if (stop.stopRequested()) {
+            // 停止 / 重启过程中连接已被关闭：留到下次启动再发，控制帧不因重启丢失
+            m_unsent.swap(batch);
         } else {
-            std::cerr << "[ComTask] Send failed.\n";
+            LOG_ERROR_RL("ComTask", 5, "Send failed ({} frames via {}).", batch.size(), m_transport.Name());
         }
-
-        // 小休眠，避免空转
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        batch.clear();
+        // 队列为空时已在条件变量上阻塞，这里不再休眠，连续的命令可以背靠背发出
     }
     std::cout << "[ComTask] sendThreadFunc exiting...\n";
 }
 
-void ComTask::recvThreadFunc()
+void ComTask::recvThreadFunc(const StopToken& stop)
 {
     std::cout << "[ComTask] recvThreadFunc started.\n";
-    uint8_t buf[1024] = {0};
+    // 一次取走 io_uring 接收缓冲中的一整段（CLinuxUringTCPCom::kBufSize），减少拆分与入队次数
+    uint8_t buf[16 * 1024];
 
-    while (m_isRunning)
+    while (!stop.stopRequested())
     {
-        int received = m_tcpCom.TCPRecvData(buf, sizeof(buf));
+        int received = m_transport.RecvData(buf, sizeof(buf));
         if (received > 0) {
-            // // 简单打印
-            // std::cout << "[ComTask] Received " << received << " bytes.\n";
-            // for (int i = 0; i < received; i++)
-            // {
-            //     printf("%02X ", buf[i]);
-            // }
-            // printf("\n");
+            LOG_DEBUG("ComTask", "Received {} bytes.", received);
 
-            // 构造 DataFrame
-            DataFrame recvFrame(buf, buf + received); 
+            // 构造带接收时间戳的 DataFrame
+            StampedFrame recvFrame;
+            recvFrame.recvNs = Metrics::nowNs();
+            recvFrame.data.assign(buf, buf + received);
+            g_linkRecorder.record(buf, static_cast<size_t>(received), recvFrame.recvNs);
+            Metrics::add(Metrics::BytesIn, static_cast<uint64_t>(received));
+            Metrics::add(Metrics::RecvChunks);
+            const uint64_t traceId = Tracer::enabled() ? Tracer::newFlowId() : 0;
+            recvFrame.traceId = traceId;
             {
                 // 加锁并放入全局接收队列
                 std::unique_lock<std::mutex> lk(g_recvRawQueueMutex);
@@ -97,16 +125,23 @@ void ComTask::recvThreadFunc()
             }
             // 通知可能在等待数据的线程
             g_recvRawQueueCond.notify_one();
+            if (traceId) {
+                Tracer::complete("recv", recvFrame.recvNs, Metrics::nowNs(), traceId, Tracer::Flow::Start);
+            }
+        }
+        else if (stop.stopRequested()) {
+            // 停止时 ShutdownRead() 唤醒了 RecvData()
+            break;
         }
-        else if (received == 0) {
-            // 对端关闭连接
+        else if (received == 0 || m_transport.GetCommFd() < 0) {
+            // 对端关闭连接（或重启时未能连上）
             std::cerr << "[ComTask] Peer closed connection.\n";
-            // 进入重连逻辑
-            while(1){
-                std::this_thread::sleep_for(std::chrono::seconds(1));
+            // 进入重连逻辑，休眠可被停止打断
+            while (stop.sleepFor(std::chrono::seconds(1))) {
                 std::cout << "[ComTask] Waiting for reconnection...\n";
                 // 重新连接逻辑
-                if (m_tcpCom.TCPInitClient("127.0.0.1", 12345) == 0) {
+                m_transport.CloseFd();
+                if (m_transport.InitClient(g_serverConfig.ip.c_str(), g_serverConfig.port) == 0) {
                     std::cout << "[ComTask] Reconnected successfully.\n";
                     break; // 成功重新连接后跳出循环
                 } else {
@@ -116,11 +151,9 @@ void ComTask::recvThreadFunc()
         }
         else {
             // 可能是出错，也可能是非阻塞模式下的暂时无数据
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            stop.sleepFor(std::chrono::milliseconds(50));
         }
-
-        // 小休眠，避免空转
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // RecvData 阻塞等待数据，成功读到后不再休眠：每段数据后固定的 10ms 休眠既增加时延，又多一次系统调用
     }
     std::cout << "[ComTask] recvThreadFunc exiting...\n";
 }
\ No newline at end of file
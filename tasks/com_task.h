@@ -3,7 +3,9 @@
 #include <thread>
 #include <atomic>
 #include <condition_variable>
-#include "utils/CLinuxTCPCom.h"
+#include <vector>
+#include "utils/ITransport.h"
+#include "utils/StopToken.h"
 #include "common_types.h"
 
 /**
@@ -20,9 +22,9 @@ class ComTask
 
 public:
     /**
-     * @param tcpCom 外部传入的TCP通信对象引用，用于发送/接收数据
+     * @param transport 外部传入的传输层对象引用（TCP / UDP），用于发送/接收数据
      */
-    explicit ComTask(CLinuxTCPCom& tcpCom);
+    explicit ComTask(ITransport& transport);
 
     /**
      * @brief 析构函数
@@ -36,16 +38,20 @@ public:
 
 private:
     /**
-     * @brief 发送线程函数：不断从队列中获取数据帧并发送
+     * @brief 发送线程函数：不断从队列中获取数据帧并发送，直到 stop 被请求
+     * @note 队列中积压的帧（最多 kMaxSendBatch 帧）合并为一次 SendBatch()
      */
-    void sendThreadFunc();
+    void sendThreadFunc(const StopToken& stop);
 
     /**
-     * @brief 接收线程函数：不断接收服务器数据并简单打印
+     * @brief 接收线程函数：不断接收服务器数据并放入原始数据队列，直到 stop 被请求
+     * @note 停止时需 shutdown 套接字读方向以唤醒阻塞中的 recv()
      */
-    void recvThreadFunc();
+    void recvThreadFunc(const StopToken& stop);
 
 private:
-    CLinuxTCPCom&      m_tcpCom;     ///< 引用外部的TCP通信实例
-    std::atomic<bool>  m_isRunning;  ///< 控制任务是否继续运行
+    static constexpr size_t kMaxSendBatch = 16;
+
+    ITransport&             m_transport;   ///< 引用外部的传输层实例
+    std::vector<DataFrame>  m_unsent;      ///< 停止过程中发送失败的帧，下次启动时最先发出（仅发送线程访问）
 };
@@ -9,10 +9,29 @@
 #include <cstring>
 #include <cstdio>        // 如果你使用 printf/puts 等C风格IO，则需要
 #include <chrono>
+#include <fstream>
+#include <future>
+#include <thread>
 #include <unordered_map>
+#include <algorithm>
 #include <stdexcept>     // 若需要使用异常 (std::stoi, std::stod 等可能抛出)
 #include "common_utils.h"
 #include "GimbalJoystickController.h"
+#include "ClockSync.h"
+#include "CommandChannel.h"
+#include "CommandTracker.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "AsyncLogger.h"
+#include "AllocTrace.h"
+#include "ThreadSched.h"
+#include "LinkRecorder.h"
+#include "PayloadCipher.h"
+#include "ShmStateTable.h"
+#include "TelemetryRelay.h"
+#include "RouteGenerator.h"
+#include "RouteUploader.h"
+#include "RouteValidator.h"
 #include <google/protobuf/util/json_util.h>
 
 // ------------------ 打印字节帧数据 ------------------
@@ -33,10 +52,10 @@ DataFrame createHeartbeatFrame() {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00  // 时间戳 8字节
     };
 
-    // 获取当前时间戳（秒级）
+    // 获取当前时间戳（毫秒级，云盒应答心跳时用于估计时钟偏差，见 ClockSync）
     auto now = std::chrono::system_clock::now();
     auto duration = now.time_since_epoch();
-    uint64_t currentTimestamp = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
+    uint64_t currentTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 
     // 填充时间戳
     for (int i = 0; i < 8; i++) {
@@ -80,20 +99,46 @@ DataFrame createRegisterFrame(uint32_t companyId, const std::string& accessToken
 // 说明：以下是“控制帧”结构: [帧头2B][数据长度2B][SN号15B][指令编号1B][加密标志1B][动作编号1B][动作参数(NB)]
 //
 // 其中，SN号在此示例直接写死，也可以从配置中加载。指令编号默认为 0xD1(仅示例)。
+size_t maxControlParamLen()
+{
+    return MAX_CONTROL_PARAM_LEN - (g_payloadCipher.enabled() ? PayloadCipher::kOverhead : 0);
+}
+
 DataFrame createControlFrame(uint8_t actionId, const std::vector<uint8_t>& actionParam)
+{
+    return createControlFrame(actionId, actionParam.data(), actionParam.size());
+}
+
+DataFrame createControlFrame(uint8_t actionId,
+                             const uint8_t* head, size_t headLen,
+                             const uint8_t* body, size_t bodyLen)
 {
     // 1. 定义协议中的默认值或常量
     constexpr uint8_t FRAME_HEADER[2] = { 0x74, 0x79 };  // 帧头
     constexpr uint8_t DEFAULT_COMMAND_ID      = 0xD1;    // 指令编号
     constexpr uint8_t DEFAULT_ENCRYPTION_FLAG = 0x00;    // 加密标志(0x00=不加密)
+    constexpr size_t  AAD_END                 = 22;      // 长度 ~ 动作编号：不加密，参与认证
 
     // SN号(15B)，这里示例直接硬编码
     static const std::vector<uint8_t> SN_NUMBER = {
         'D', 'B', 'M', '2', '5', '0', '9', '7', '4', '0', '6', '5', '0', '0', '8'
     };
 
+    // 配置了密钥时动作参数就地加密：动作编号后先留出 nonce，参数之后追加 tag，一次分配到位
+    const bool   encrypt  = g_payloadCipher.enabled();
+    const size_t overhead = encrypt ? PayloadCipher::kOverhead : 0;
+
+    // 数据长度字段只有 2 字节，超长参数会被静默截断，这里直接拒绝
+    if (headLen + bodyLen + overhead > MAX_CONTROL_PARAM_LEN) {
+        std::cerr << "[CLI2Frame] Action 0x" << std::hex << static_cast<int>(actionId) << std::dec
+                  << " param too long (" << headLen + bodyLen << " > " << MAX_CONTROL_PARAM_LEN - overhead
+                  << " bytes), frame not built.\n";
+        return {};
+    }
+
     // 2. 开始组装数据帧
     DataFrame frame;
+    frame.reserve(4 + SN_NUMBER.size() + 3 + headLen + bodyLen + overhead);
 
     // (1) 插入帧头
     frame.insert(frame.end(), std::begin(FRAME_HEADER), std::end(FRAME_HEADER));
@@ -109,64 +154,142 @@ DataFrame createControlFrame(uint8_t actionId, const std::vector<uint8_t>& actio
     frame.push_back(DEFAULT_COMMAND_ID);
 
     // (5) 插入加密标志
-    frame.push_back(DEFAULT_ENCRYPTION_FLAG);
+    frame.push_back(encrypt ? PayloadCipher::kFlagAesGcm : DEFAULT_ENCRYPTION_FLAG);
 
     // (6) 插入动作编号
     frame.push_back(actionId);
+    if (encrypt) {
+        frame.resize(frame.size() + PayloadCipher::kNonceSize);
+    }
 
-    // (7) 插入动作参数（原 actionParam）
-    frame.insert(frame.end(), actionParam.begin(), actionParam.end());
+    // (7) 插入动作参数（两段依次拼接）
+    if (headLen > 0) {
+        frame.insert(frame.end(), head, head + headLen);
+    }
+    if (bodyLen > 0) {
+        frame.insert(frame.end(), body, body + bodyLen);
+    }
 
     // 3. 计算并回填“数据长度”（不包含帧头2字节 + 数据长度本身2字节）
     //    也就是从SN号开始到最后的所有字段大小
+    if (encrypt) {
+        frame.resize(frame.size() + PayloadCipher::kTagSize);
+    }
     uint16_t length = static_cast<uint16_t>(frame.size() - 4);
     frame[2] = static_cast<uint8_t>((length >> 8) & 0xFF);
     frame[3] = static_cast<uint8_t>((length & 0xFF));
 
+    // 4. 加密：长度、SN、命令、加密标志、动作编号作为 AAD
+    if (encrypt) {
+        uint8_t* sealed = frame.data() + AAD_END;
+        if (!g_payloadCipher.seal(frame.data() + 2, AAD_END - 2, sealed + PayloadCipher::kNonceSize,
+                                  headLen + bodyLen, sealed)) {
+            std::cerr << "[CLI2Frame] Encrypting action 0x" << std::hex << static_cast<int>(actionId) << std::dec
+                      << " failed, frame not built.\n";
+            return {};
+        }
+        Metrics::add(Metrics::FramesSealed);
+    }
+
     return frame;
 }
 
 
 
 
-// ------------------ 航线规划的示例(仅占位) ------------------
-static std::vector<uint8_t> mockRoutePlanData()
+// ------------------ 加载航线 ------------------
+static bool loadRoutePlanData(const std::string& path, PlanLineData& planData)
 {
-    // 在此拼装航线数据
     RouteDataModule routeModule;
-    PlanLineData planData;
 
     // 从 JSON 文件加载 PlanLineData
-    if (!routeModule.jsonFileToPlanLineData("../config/planData.json", planData)) {
+    if (!routeModule.jsonFileToPlanLineData(path, planData)) {
         std::cerr << "Error: Failed to load planData from JSON.\n";
-        return {};
+        return false;
     }
-    // // 打印 planData 的json格式
-    // // 使用 Protobuf 的 JsonPrintOptions 配置输出选项
-    // google::protobuf::util::JsonPrintOptions options;
-    // options.add_whitespace = true;              // 添加空格、换行等美化输出
-    // options.always_print_primitive_fields = true;
-    // options.preserve_proto_field_names = true;
-
-    // std::string jsonStr;
-    // auto status = google::protobuf::util::MessageToJsonString(planData, &jsonStr, options);
-    // if (!status.ok()) {
-    //     std::cerr << "Failed to convert PlanLineData to JSON string: " 
-    //               << status.ToString() << std::endl;
-    //     return {};
-    // }
-    // std::cout << jsonStr << std::endl;
-
-    // 将 PlanLineData 序列化为字节数组
-    std::string serialized_data;
-    if (!planData.SerializeToString(&serialized_data)) {
-        std::cerr << "Error: Failed to serialize PlanLineData.\n";
-        return {};
+
+    // 只给了建模参数、没有航点时，自动生成航点
+    if (planData.points_size() == 0) {
+        RouteGenerator generator;
+        if (!generator.generate(planData)) {
+            std::cerr << "Error: planData has no points and route generation failed: "
+                      << generator.error() << "\n";
+            return false;
+        }
+        std::cout << "[CLI2Frame] Generated " << planData.points_size() << " points from model.\n";
+    }
+    return true;
+}
+
+// ------------------ 批量命令：经 CommandChannel 流水线发送 ------------------
+// 每行一条 CLI 命令；"wait" 等待此前所有命令完成，"sleep <ms>" 暂停，# 开头为注释
+static void runCommandBatch(const std::vector<std::string>& lines)
+{
+    struct Item {
+        std::string line;
+        std::future<CommandChannel::Result> result;
+    };
+    std::vector<Item> items;
+    size_t waited = 0;
+    size_t failed = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    auto waitAll = [&] {
+        for (; waited < items.size(); ++waited) {
+            const CommandChannel::Result r = items[waited].result.get();
+            if (r.status != CommandChannel::Status::Ok) {
+                ++failed;
+            }
+            std::printf("[batch] #%zu %-32s %-9s attempts=%d rtt=%.1fms\n", waited + 1,
+                        items[waited].line.c_str(), CommandChannel::statusName(r.status), r.attempts, r.rttMs);
+        }
+    };
+
+    for (const std::string& raw : lines) {
+        std::istringstream iss(raw);
+        std::string first;
+        if (!(iss >> first) || first[0] == '#') {
+            continue;
+        }
+        if (first == "wait") {
+            waitAll();
+            continue;
+        }
+        if (first == "sleep") {
+            int ms = 0;
+            iss >> ms;
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            continue;
+        }
+        if (first == "batch" || first == "script") {
+            std::cerr << "[batch] Nested " << first << " ignored.\n";
+            continue;
+        }
+
+        DataFrame frame;
+        try {
+            frame = parseCommand(raw);
+        } catch (const std::exception& e) {
+            // 参数解析失败（std::stoi 等）不中断整个批次
+            std::cerr << "[batch] Invalid command \"" << raw << "\": " << e.what() << "\n";
+            continue;
+        }
+        if (frame.empty()) {
+            continue;   // 本地命令或解析失败（已打印原因）
+        }
+        if (frame.size() > 19 && frame[19] == 0xD1) {
+            items.push_back({raw, g_commandChannel.submit(std::move(frame))});
+        } else {
+            // 心跳 / 注册等非控制帧没有 0xD1 回复，直接发送
+            std::lock_guard<std::mutex> lk(g_queueMutex);
+            g_dataFrameQueue.push(std::move(frame));
+            g_queueCond.notify_one();
+        }
     }
-    // 转换为 uint8_t vector
-    std::vector<uint8_t> route_data(serialized_data.begin(), serialized_data.end());
+    waitAll();
 
-    return route_data;
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("[batch] %zu command(s), %zu failed, %.1f ms\n", items.size(), failed, ms);
 }
 
 // ------------------ 解析用户输入，生成 DataFrame ------------------
@@ -190,6 +313,136 @@ DataFrame parseCommand(const std::string& line)
         return createHeartbeatFrame();
     }
 
+    // 本地统计: stats rtt / stats metrics / stats clock / stats alloc / stats sched [ms] / stats reset（不生成帧）
+    if (tokens[0] == "stats") {
+        if (tokens.size() >= 2 && tokens[1] == "rtt") {
+            g_commandTracker.printStats();
+        } else if (tokens.size() >= 2 && tokens[1] == "metrics") {
+            std::cout << Metrics::toText(Metrics::snapshot());
+        } else if (tokens.size() >= 2 && tokens[1] == "clock") {
+            g_clockSync.printStats();
+        } else if (tokens.size() >= 2 && tokens[1] == "alloc") {
+            std::cout << AllocTrace::toText();
+        } else if (tokens.size() >= 2 && tokens[1] == "sched") {
+            // 探测期间阻塞 CLI，默认 1s
+            const int ms = tokens.size() >= 3 ? std::max(10, std::min(60000, std::stoi(tokens[2]))) : 1000;
+            ThreadSched::probe(ms);
+            std::cout << ThreadSched::report();
+        } else if (tokens.size() >= 2 && tokens[1] == "reset") {
+            g_commandTracker.reset();
+        } else {
+            std::cerr << "Usage: stats <rtt|metrics|clock|alloc|sched [ms]|reset>\n";
+        }
+        return {};
+    }
+
+    // 帧生命周期追踪: trace start | stop | dump <file> | trigger <ms> <file> | trigger off
+    if (tokens[0] == "trace") {
+        const std::string sub = tokens.size() >= 2 ? tokens[1] : "";
+        if (sub == "start") {
+            Tracer::start();
+            std::cout << "[trace] Recording (" << Tracer::ringCapacity() << " events per thread).\n";
+        } else if (sub == "stop") {
+            Tracer::stop();
+        } else if (sub == "dump" && tokens.size() >= 3) {
+            Tracer::dump(tokens[2]);
+        } else if (sub == "trigger" && tokens.size() >= 3 && tokens[2] == "off") {
+            Tracer::disarmTrigger();
+        } else if (sub == "trigger" && tokens.size() >= 4) {
+            Tracer::armTrigger(std::stod(tokens[2]), tokens[3]);
+            std::cout << "[trace] Will dump to " << tokens[3] << " when a frame takes > " << tokens[2] << " ms.\n";
+        } else {
+            std::cerr << "Usage: trace <start|stop|dump <file>|trigger <ms> <file>|trigger off>\n";
+        }
+        return {};
+    }
+
+    // 链路录制: record start <file> | stop | status
+    if (tokens[0] == "record") {
+        const std::string sub = tokens.size() >= 2 ? tokens[1] : "";
+        if (sub == "start" && tokens.size() >= 3) {
+            g_linkRecorder.start(tokens[2]);
+        } else if (sub == "stop") {
+            g_linkRecorder.stop();
+        } else if (sub == "status") {
+            std::cout << g_linkRecorder.status();
+        } else {
+            std::cerr << "Usage: record <start <file>|stop|status>\n";
+        }
+        return {};
+    }
+
+    // 日志: log level <debug|info|warn|error|off> / log stats
+    if (tokens[0] == "log") {
+        AsyncLogger& logger = AsyncLogger::instance();
+        LogLevel     level;
+        if (tokens.size() >= 3 && tokens[1] == "level" && AsyncLogger::parseLevel(tokens[2], level)) {
+            logger.setLevel(level);
+        } else if (tokens.size() >= 2 && tokens[1] == "stats") {
+            std::cout << "[log] level=" << AsyncLogger::levelName(logger.level())
+                      << " written=" << logger.written() << " dropped=" << logger.dropped() << "\n";
+        } else {
+            std::cerr << "Usage: log <level <debug|info|warn|error|off>|stats>\n";
+        }
+        return {};
+    }
+
+    // 共享内存状态表: state（以读者身份读取，与外部工具看到的内容一致）
+    if (tokens[0] == "state") {
+        ShmStateTable table;
+        if (!table.open(g_serverConfig.stateShm)) {
+            return {};
+        }
+        for (uint32_t i = 0; i < table.count(); ++i) {
+            VehicleState s;
+            if (!table.read(static_cast<int>(i), s)) {
+                std::cerr << "[state] #" << i << " busy, try again\n";
+                continue;
+            }
+            std::printf("[state] #%u box=%s uav=%s updates=%u mode=%u status=%u lat=%.7f lng=%.7f alt=%.1f "
+                        "yaw=%.1f v=%.1f sats=%u battery=%u/%u%%\n",
+                        i, s.boxSn, s.uavSn, s.updateCount, s.flightMode, s.flightStatus, s.lat, s.lng,
+                        s.altitude, s.yaw, s.velocity, s.satelliteCount, s.batteryPercent[0], s.batteryPercent[1]);
+        }
+        return {};
+    }
+
+    // 遥测中继: relay（各下游客户端的队列与丢弃统计）
+    if (tokens[0] == "relay") {
+        g_telemetryRelay.printStats();
+        return {};
+    }
+
+    // 批量命令: batch <cmd> ; <cmd> ; ...  /  script <file>
+    if (tokens[0] == "batch") {
+        std::vector<std::string> lines;
+        std::string rest = line.substr(line.find("batch") + 5);
+        std::istringstream ss(rest);
+        std::string part;
+        while (std::getline(ss, part, ';')) {
+            lines.push_back(part);
+        }
+        runCommandBatch(lines);
+        return {};
+    }
+    if (tokens[0] == "script") {
+        if (tokens.size() < 2) {
+            std::cerr << "Usage: script <file>\n";
+            return {};
+        }
+        std::ifstream in(tokens[1]);
+        if (!in) {
+            std::cerr << "Error: cannot open script " << tokens[1] << "\n";
+            return {};
+        }
+        std::vector<std::string> lines;
+        for (std::string l; std::getline(in, l);) {
+            lines.push_back(l);
+        }
+        runCommandBatch(lines);
+        return {};
+    }
+
     // 特殊命令: register
     if (tokens[0] == "register") {
         // 语法: register <companyId> <accessToken(字符串)>
@@ -318,14 +571,75 @@ DataFrame parseCommand(const std::string& line)
 
     // 航线飞行
     else if (tokens[0] == "route") {
-        // plan / start / pause / resume / stop
+        // plan [file] / check [file] / generate <model.json> [out.json] / start / pause / resume / stop
         if (tokens.size() < 2) {
-            std::cerr << "Usage: route <plan|start|pause|resume|stop>\n";
+            std::cerr << "Usage: route <plan [file]|check [file]|generate <model.json> [out.json]|start|pause|resume|stop>\n";
+            return {};
+        }
+        if (tokens[1] == "generate") {
+            // 根据 normalModel / surroundModel 生成航点并写回 JSON（默认覆盖输入文件）
+            if (tokens.size() < 3) {
+                std::cerr << "Usage: route generate <model.json> [out.json]\n";
+                return {};
+            }
+            const std::string outPath = (tokens.size() >= 4) ? tokens[3] : tokens[2];
+            RouteDataModule routeModule;
+            PlanLineData planData;
+            if (!routeModule.jsonFileToPlanLineData(tokens[2], planData)) {
+                return {};
+            }
+            RouteGenerator generator;
+            auto start = std::chrono::steady_clock::now();
+            if (!generator.generate(planData)) {
+                std::cerr << "Error: route generation failed: " << generator.error() << "\n";
+                return {};
+            }
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+            std::cout << "[CLI2Frame] Generated " << planData.points_size() << " points in "
+                      << us << " us.\n";
+            routeModule.planLineDataToJsonFile(planData, outPath);
+            return {};
+        }
+        if (tokens[1] == "check") {
+            // 只做本地校验与用时 / 电量估算，不上传
+            const std::string path = (tokens.size() >= 3) ? tokens[2] : "../config/planData.json";
+            PlanLineData planData;
+            if (loadRoutePlanData(path, planData)) {
+                RouteValidator::printReport(RouteValidator().validate(planData));
+            }
             return {};
         }
         if (tokens[1] == "plan") {
-            auto route_data = mockRoutePlanData(); 
-            return createControlFrame(0x10, route_data);
+            const std::string path = (tokens.size() >= 3) ? tokens[2] : "../config/planData.json";
+            PlanLineData planData;
+            if (!loadRoutePlanData(path, planData)) {
+                return {};
+            }
+
+            // 上传前校验，存在错误时拒绝上传
+            const RouteValidator::Report report = RouteValidator().validate(planData);
+            RouteValidator::printReport(report);
+            if (!report.ok()) {
+                std::cerr << "Error: route has " << report.errorCount << " error(s), upload refused.\n";
+                return {};
+            }
+
+            // 将 PlanLineData 序列化为字节数组
+            std::string route_data;
+            if (!planData.SerializeToString(&route_data)) {
+                std::cerr << "Error: Failed to serialize PlanLineData.\n";
+                return {};
+            }
+            if (route_data.size() <= maxControlParamLen()) {
+                return createControlFrame(ROUTE_PLAN_ACTION_ID,
+                                          reinterpret_cast<const uint8_t*>(route_data.data()),
+                                          route_data.size());
+            }
+            // 超过单帧上限：分包上传，阻塞直到全部应答或失败
+            RouteUploader uploader;
+            uploader.upload(std::move(route_data));
+            return {};
         } else if (tokens[1] == "start") {
             return createControlFrame(0x17, {});
         } else if (tokens[1] == "pause") {
@@ -482,6 +796,7 @@ DataFrame parseCommand(const std::string& line)
     else if (tokens[0] == "gimbal") {
         // gimbal move abs <pitch> <roll> <yaw>
         // gimbal move speed <pitch_speed> <roll_speed> <yaw_speed> <time_ms>
+        // gimbal move stream [rate_hz] [max_speed] [evdev_device]
         // gimbal follow <mode>
         // gimbal set <0|1|2|3>
         if (tokens.size() < 2) {
@@ -490,7 +805,7 @@ DataFrame parseCommand(const std::string& line)
         }
         if (tokens[1] == "move") {
             if (tokens.size() < 3) {
-                std::cerr << "Usage: gimbal move <joystick|abs|speed> ...\n";
+                std::cerr << "Usage: gimbal move <joystick|stream|abs|speed> ...\n";
                 return {};
             }
             if (tokens[2] == "joystick"){
@@ -501,6 +816,16 @@ DataFrame parseCommand(const std::string& line)
                 // run() 结束后, 就回到 CLI 普通模式
                 return {};
             }
+            if (tokens[2] == "stream") {
+                // 连续杆量模式：固定频率发送速度帧，输入来自键盘或 evdev 设备
+                GimbalJoystickController::StreamOptions opts;
+                if (tokens.size() > 3) opts.rateHz   = std::stoi(tokens[3]);
+                if (tokens.size() > 4) opts.maxSpeed = std::stof(tokens[4]);
+                if (tokens.size() > 5) opts.device   = tokens[5];
+                GimbalJoystickController controller;
+                controller.runStream(opts);
+                return {};
+            }
             if (tokens[2] == "abs") {
                 // gimbal move abs <pitch> <roll> <yaw>
                 if (tokens.size() < 6) {
@@ -30,13 +30,40 @@ DataFrame createHeartbeatFrame();
  */
 DataFrame createRegisterFrame(uint32_t companyId = DEFAULT_COMPANY_ID, const std::string& accessToken = DEFAULT_ACCESS_TOKEN);
 
+/**
+ * @brief 控制帧中“数据长度”字段为 uint16，扣除 SN(15B)+指令编号+加密标志+动作编号 后，
+ *        单帧动作参数的最大长度
+ */
+constexpr size_t MAX_CONTROL_PARAM_LEN = 0xFFFF - (15 + 1 + 1 + 1);
+
+/**
+ * @brief 当前可用的单帧动作参数上限：开启负载加密时再扣除 nonce 与 tag
+ */
+size_t maxControlParamLen();
+
 /**
  * @brief 生成“控制帧”
  * @param actionId   动作编号
  * @param actionParam 动作参数
+ * @return 构建好的数据帧；参数超过 maxControlParamLen() 时返回空帧（避免长度字段被截断）
+ * @note   g_payloadCipher 配置了密钥时，加密标志置 0x01，动作参数替换为 nonce | 密文 | tag
  */
 DataFrame createControlFrame(uint8_t actionId, const std::vector<uint8_t>& actionParam);
 
+/**
+ * @brief 生成“控制帧”，动作参数由两段连续内存依次拼接（如分包头 + 缓存中的数据片段），
+ *        直接写入帧内，不额外构造临时参数数组
+ * @param actionId 动作编号
+ * @param head     第一段参数
+ * @param headLen  第一段长度
+ * @param body     第二段参数（可为空）
+ * @param bodyLen  第二段长度
+ * @return 构建好的数据帧；参数总长超过 maxControlParamLen() 时返回空帧
+ */
+DataFrame createControlFrame(uint8_t actionId,
+                             const uint8_t* head, size_t headLen,
+                             const uint8_t* body = nullptr, size_t bodyLen = 0);
+
 /**
  * @brief 根据用户输入字符串，解析并生成对应的 DataFrame
  * @param line 用户输入的命令行字符串
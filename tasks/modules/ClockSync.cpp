@@ -0,0 +1,255 @@
+#include "ClockSync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include "CommandTracker.h"
+#include "Metrics.h"
+
+ClockSync g_clockSync;
+
+namespace {
+// 心跳帧: [0x74 0x79][0x00 0x09][0x02][时间戳 8B]
+constexpr size_t  HEARTBEAT_SIZE   = 13;
+constexpr uint8_t HEARTBEAT_CMD_ID = 0x02;
+
+constexpr size_t MAX_PENDING       = 8;        ///< 心跳 3s 一次，应答通常在下一次心跳前到达
+constexpr size_t MAX_EXCHANGES     = 64;       ///< 约 3 分钟
+constexpr size_t FILTER_WINDOW     = 8;        ///< 在最近 8 个样本中选时延最小的
+constexpr size_t DRIFT_GROUP       = 4;        ///< 拟合漂移时每 4 个连续样本取时延最小的一个
+constexpr double MIN_DRIFT_SPAN_MS = 60000.0;  ///< 样本跨度不足 1 分钟时不估计漂移
+constexpr double MAX_DRIFT_PPM     = 500.0;
+
+constexpr double BUCKET_MS   = 10000.0;
+constexpr size_t MAX_BUCKETS = 6;
+
+uint64_t readBE64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+} // namespace
+
+double ClockSync::wallMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t ClockSync::normalizeMs(uint64_t vehicleTs)
+{
+    return vehicleTs < 100000000000ULL ? vehicleTs * 1000 : vehicleTs;
+}
+
+void ClockSync::onSending(const DataFrame& frame)
+{
+    if (frame.size() != HEARTBEAT_SIZE || frame[0] != 0x74 || frame[1] != 0x79 || frame[4] != HEARTBEAT_CMD_ID) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_pending.push_back(PendingHeartbeat{readBE64(frame.data() + 5), wallMs()});
+    while (m_pending.size() > MAX_PENDING) {
+        m_pending.pop_front();
+    }
+}
+
+bool ClockSync::onHeartbeatReply(const uint8_t* data, uint16_t length)
+{
+    const double t4 = wallMs();
+    if (length < 8) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_pending.empty()) {
+        return false;
+    }
+
+    // 带回显时按回显的时间戳精确匹配，否则对应最近一次心跳
+    auto it = std::prev(m_pending.end());
+    uint64_t boxTs = readBE64(data);
+    if (length >= 16) {
+        const uint64_t echo = boxTs;
+        boxTs = readBE64(data + 8);
+        while (it->stamp != echo) {
+            if (it == m_pending.begin()) {
+                return false;
+            }
+            --it;
+        }
+    }
+    const double t1 = it->sentMs;
+    m_pending.erase(m_pending.begin(), std::next(it));
+    if (t4 < t1) {
+        return false;   // 本机时钟被回拨
+    }
+
+    m_exchanges.push_back(Exchange{(t1 + t4) / 2, static_cast<double>(normalizeMs(boxTs)) - (t1 + t4) / 2, t4 - t1});
+    while (m_exchanges.size() > MAX_EXCHANGES) {
+        m_exchanges.pop_front();
+    }
+    ++m_est.exchanges;
+    updateFromExchanges();
+    return true;
+}
+
+void ClockSync::updateFromExchanges()
+{
+    // 当前偏差：最近 FILTER_WINDOW 个样本中往返时延最小的一个
+    const size_t first = m_exchanges.size() > FILTER_WINDOW ? m_exchanges.size() - FILTER_WINDOW : 0;
+    const Exchange* best = &m_exchanges[first];
+    for (size_t i = first; i < m_exchanges.size(); ++i) {
+        if (m_exchanges[i].delayMs < best->delayMs) {
+            best = &m_exchanges[i];
+        }
+    }
+
+    // 漂移：每组连续样本只取时延最小的一个做最小二乘，排队严重的样本偏差误差大，不参与拟合
+    double drift = 0.0;
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, minX = 0, maxX = 0;
+    for (size_t g = 0; g + DRIFT_GROUP <= m_exchanges.size(); g += DRIFT_GROUP) {
+        const Exchange* e = &m_exchanges[g];
+        for (size_t i = g + 1; i < g + DRIFT_GROUP; ++i) {
+            if (m_exchanges[i].delayMs < e->delayMs) {
+                e = &m_exchanges[i];
+            }
+        }
+        const double x = e->localMs - best->localMs;
+        minX = n == 0 ? x : std::min(minX, x);
+        maxX = n == 0 ? x : std::max(maxX, x);
+        n += 1;
+        sx += x;
+        sy += e->offsetMs;
+        sxx += x * x;
+        sxy += x * e->offsetMs;
+    }
+    if (n >= 3 && maxX - minX >= MIN_DRIFT_SPAN_MS) {
+        const double denom = n * sxx - sx * sx;
+        if (denom > 0) {
+            drift = (n * sxy - sx * sy) / denom;
+            drift = std::max(-MAX_DRIFT_PPM * 1e-6, std::min(MAX_DRIFT_PPM * 1e-6, drift));
+        }
+    }
+
+    m_est.valid        = true;
+    m_est.fromExchange = true;
+    m_est.offsetMs     = best->offsetMs;
+    m_est.driftPpm     = drift * 1e6;
+    m_est.bestDelayMs  = best->delayMs;
+    m_refLocalMs       = best->localMs;
+}
+
+void ClockSync::updateFromOneWay()
+{
+    double minD = std::numeric_limits<double>::max();
+    for (const OneWayBucket& b : m_buckets) {
+        minD = std::min(minD, b.minD);
+    }
+    m_est.valid        = true;
+    m_est.fromExchange = false;
+    m_est.offsetMs     = m_minRttMs / 2 - minD;
+    m_est.driftPpm     = 0.0;
+    m_est.bestDelayMs  = m_minRttMs;
+    m_refLocalMs       = m_buckets.back().startMs;
+}
+
+double ClockSync::offsetAtLocked(double localMs) const
+{
+    return m_est.offsetMs + m_est.driftPpm * 1e-6 * (localMs - m_refLocalMs);
+}
+
+double ClockSync::onVehicleTimestamp(uint64_t vehicleTs)
+{
+    if (vehicleTs == 0) {
+        return std::nan("");
+    }
+    const double recvMs = wallMs();
+    const double tsMs   = static_cast<double>(normalizeMs(vehicleTs));
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (m_exchanges.empty()) {
+        const double d = recvMs - tsMs;
+        ++m_est.oneWay;
+        if (m_buckets.empty() || recvMs - m_buckets.back().startMs >= BUCKET_MS) {
+            m_buckets.push_back(OneWayBucket{recvMs, d});
+            while (m_buckets.size() > MAX_BUCKETS) {
+                m_buckets.pop_front();
+            }
+            // 每个新桶刷新一次假定的最小 RTT（需遍历各动作，不放在每帧路径上）
+            m_minRttMs = g_commandTracker.minRttUs() / 1000.0;
+        } else {
+            m_buckets.back().minD = std::min(m_buckets.back().minD, d);
+        }
+        updateFromOneWay();
+    }
+    if (!m_est.valid) {
+        return std::nan("");
+    }
+
+    const double latencyMs = recvMs - tsMs + offsetAtLocked(recvMs);
+    m_est.lastLatencyMs = latencyMs;
+    lk.unlock();
+
+    // 偏差估计误差大于实际时延时会算出负值，按 0 计入，保证样本数与帧数一致
+    const uint64_t nowNs = Metrics::nowNs();
+    const uint64_t latNs = latencyMs > 0 ? static_cast<uint64_t>(latencyMs * 1e6) : 0;
+    if (latNs < nowNs) {
+        Metrics::recordStage(Metrics::AirToGround, nowNs - latNs, nowNs);
+    }
+    return latencyMs;
+}
+
+double ClockSync::ageMs(uint64_t vehicleTs) const
+{
+    if (vehicleTs == 0) {
+        return std::nan("");
+    }
+    const double now = wallMs();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_est.valid) {
+        return std::nan("");
+    }
+    return now - static_cast<double>(normalizeMs(vehicleTs)) + offsetAtLocked(now);
+}
+
+ClockSync::Estimate ClockSync::estimate() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Estimate est = m_est;
+    est.offsetMs = offsetAtLocked(wallMs());   // 外推到当前时刻
+    return est;
+}
+
+void ClockSync::printStats() const
+{
+    const Estimate est = estimate();
+    if (!est.valid) {
+        std::printf("[ClockSync] No vehicle timestamps or heartbeat replies yet.\n");
+        return;
+    }
+    std::printf("[ClockSync] source=%s offset=%.1fms drift=%.1fppm %s=%.1fms exchanges=%llu one_way=%llu "
+                "last_latency=%.1fms\n",
+                est.fromExchange ? "heartbeat" : "one-way", est.offsetMs, est.driftPpm,
+                est.fromExchange ? "best_rtt" : "assumed_rtt", est.bestDelayMs,
+                static_cast<unsigned long long>(est.exchanges), static_cast<unsigned long long>(est.oneWay),
+                est.lastLatencyMs);
+    if (!est.fromExchange && est.bestDelayMs == 0) {
+        std::printf("[ClockSync] No RTT samples: latency is relative to the fastest frame (lower bound).\n");
+    }
+}
+
+void ClockSync::reset()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_pending.clear();
+    m_exchanges.clear();
+    m_buckets.clear();
+    m_est        = Estimate();
+    m_refLocalMs = 0.0;
+    m_minRttMs   = 0.0;
+}
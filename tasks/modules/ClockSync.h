@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "common_types.h"
+
+/**
+ * @brief 机载时钟偏差 / 漂移估计，以及遥测帧的空地时延与数据龄。
+ *
+ *        TelemetryData / UavState 的 timestamp 来自机载（云盒）时钟，与本机时钟存在偏差和漂移，
+ *        直接相减得到的“时延”没有意义。本类估计 offset = 机载时钟 - 本机时钟，两种来源：
+ *
+ *        - 心跳往返（优先）：心跳帧携带本机毫秒时间戳 t1，发送线程在写入 socket 前登记真实发送时刻；
+ *          云盒以 0x02 应答时（负载为回显的 t1 + 云盒时间戳 8B，大端毫秒；只有 8 字节时视为云盒时间戳，
+ *          对应最近一次心跳），在本机收到时刻 t4 得到一次 NTP 式样本：
+ *              offset = boxTs - (t1 + t4) / 2，delay = t4 - t1；
+ *          取最近若干样本中 delay 最小的一个作为当前偏差（排队延时越小，不对称误差越小），
+ *          样本跨度超过 1 分钟后，每 4 个连续样本取时延最小者做最小二乘拟合得到漂移（ppm），偏差随时间外推；
+ *        - 单向下包络（云盒不应答心跳时）：d = 收到时刻 - 机载时间戳 = 时延 - offset，
+ *          按 10s 分桶取 1 分钟内的最小值，假定最快的一帧时延为控制帧最小 RTT 的一半，
+ *          offset = minRtt / 2 - min(d)；没有 RTT 样本时按 0 计，此时时延为相对最快一帧的下界。
+ *
+ *        每个带机载时间戳的帧经 onVehicleTimestamp() 换算为空地时延，记入 Metrics::AirToGround；
+ *        UI 通过 ageMs() 显示当前画面数据的数据龄。可通过 CLI `stats clock` 查看估计状态。
+ *        所有接口线程安全。
+ */
+class ClockSync
+{
+public:
+    struct Estimate {
+        bool     valid        = false;
+        bool     fromExchange = false;   ///< true：心跳往返；false：单向下包络
+        double   offsetMs     = 0.0;     ///< 机载时钟 - 本机时钟（参考时刻的值）
+        double   driftPpm     = 0.0;     ///< 机载时钟相对本机时钟的漂移
+        double   bestDelayMs  = 0.0;     ///< 所用心跳样本的往返时延；单向模式为假定的最小 RTT
+        uint64_t exchanges    = 0;       ///< 累计有效心跳往返样本
+        uint64_t oneWay       = 0;       ///< 累计单向样本
+        double   lastLatencyMs = 0.0;    ///< 最近一帧的空地时延
+    };
+
+    /**
+     * @brief 帧即将写入 socket（由发送线程调用）；只登记心跳帧，其他帧直接忽略
+     */
+    void onSending(const DataFrame& frame);
+
+    /**
+     * @brief 收到云盒的 0x02 心跳应答（由解析线程调用）
+     * @return 负载格式无法识别或找不到对应心跳时返回 false
+     */
+    bool onHeartbeatReply(const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief 收到带机载时间戳的帧（由解析线程调用），返回估计的空地时延（毫秒）
+     * @return 时间戳为 0 或尚无估计时返回 NaN
+     */
+    double onVehicleTimestamp(uint64_t vehicleTs);
+
+    /**
+     * @brief 机载时间戳对应的数据到现在的时长（毫秒），尚无估计时返回 NaN
+     */
+    double ageMs(uint64_t vehicleTs) const;
+
+    Estimate estimate() const;
+
+    /**
+     * @brief 打印当前估计
+     */
+    void printStats() const;
+
+    void reset();
+
+    /**
+     * @brief 本机时钟（system_clock），毫秒，带小数部分
+     */
+    static double wallMs();
+
+    /**
+     * @brief 机载时间戳统一为毫秒：小于 1e11 的视为秒
+     */
+    static uint64_t normalizeMs(uint64_t vehicleTs);
+
+private:
+    struct PendingHeartbeat {
+        uint64_t stamp;     ///< 心跳帧中的本机时间戳
+        double   sentMs;    ///< 实际写入 socket 的时刻
+    };
+
+    struct Exchange {
+        double localMs;     ///< (t1 + t4) / 2
+        double offsetMs;
+        double delayMs;
+    };
+
+    struct OneWayBucket {
+        double startMs;
+        double minD;
+    };
+
+    double offsetAtLocked(double localMs) const;
+    void   updateFromExchanges();
+    void   updateFromOneWay();
+
+private:
+    mutable std::mutex           m_mutex;
+    std::deque<PendingHeartbeat> m_pending;
+    std::deque<Exchange>         m_exchanges;
+    std::deque<OneWayBucket>     m_buckets;
+    Estimate                     m_est;
+    double                       m_refLocalMs = 0.0;   ///< offsetMs 对应的本机时刻
+    double                       m_minRttMs   = 0.0;   ///< 单向模式假定的最小 RTT
+};
+
+extern ClockSync g_clockSync;
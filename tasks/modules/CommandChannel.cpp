@@ -0,0 +1,240 @@
+#include "CommandChannel.h"
+
+#include <iostream>
+#include "EventLoop.h"
+#include "FrameDataHandler.h"
+
+CommandChannel g_commandChannel;
+
+namespace {
+constexpr size_t  CTRL_CMD_OFFSET    = 19;
+constexpr size_t  CTRL_ACTION_OFFSET = 21;
+constexpr uint8_t CTRL_CMD_ID        = 0xD1;
+
+// 重复执行结果相同的动作（绝对量设置、开关、状态切换），超时后允许重发
+constexpr uint8_t kIdempotentActions[] = {
+    0x09,               // 云台绝对角度
+    0x0D, 0x0F, 0xFF,   // 变焦到指定倍数 / 停止变焦
+    0x10,               // 航线规划（整条覆盖）
+    0x12, 0x13,         // 返航 / 取消返航
+    0x14, 0x15,         // 降落 / 取消降落
+    0x18, 0x19, 0x20,   // 航线暂停 / 恢复 / 停止
+    0x1A, 0x1B,         // 激光测距开关 / 指点对焦
+    0x1C, 0x1D,         // 云台跟随模式 / 云台姿态
+    0x21, 0x22,         // 返航高度 / 相机模式
+    0x26, 0x27,         // 视频源 / 相机类型
+    0x30, 0x31, 0x32,   // 控制权 / 返航点 / 刹车
+    0x35, 0x36, 0x37,   // 避障开关
+    0x38,               // 定时拍照设置
+    0x39, 0x3A,         // 指点飞行 / 停止
+    0x43,               // 拍照推流开关
+};
+} // namespace
+
+CommandChannel::CommandChannel()
+{
+    for (uint8_t a : kIdempotentActions) {
+        m_retryable[a] = true;
+    }
+}
+
+void CommandChannel::start()
+{
+    if (m_listenerId < 0) {
+        m_listenerId = FrameDataHandler::addReplyListener([this](const ControlReply& r) { onReply(r); });
+    }
+}
+
+void CommandChannel::stop()
+{
+    // 监听者回调持有监听表的锁再进入 m_mutex，这里先注销再加锁，避免锁顺序相反
+    if (m_listenerId >= 0) {
+        FrameDataHandler::removeReplyListener(m_listenerId);
+        m_listenerId = -1;
+    }
+
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        for (auto& kv : m_inFlight) {
+            g_eventLoop.cancel(kv.second.timer);
+            finish(kv.second, Status::Cancelled, done);
+        }
+        m_inFlight.clear();
+        for (auto& cmd : m_waiting) {
+            finish(cmd, Status::Cancelled, done);
+        }
+        m_waiting.clear();
+        m_actionOwner.fill(0);
+    }
+    notify(done);
+}
+
+void CommandChannel::setOptions(const Options& opts)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_opts = opts;
+    if (m_opts.window == 0) {
+        m_opts.window = 1;
+    }
+}
+
+void CommandChannel::setRetryable(uint8_t action, bool retryable)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_retryable[action] = retryable;
+}
+
+void CommandChannel::submit(DataFrame frame, Callback cb)
+{
+    if (frame.size() <= CTRL_ACTION_OFFSET || frame[0] != 0x74 || frame[1] != 0x79 ||
+        frame[CTRL_CMD_OFFSET] != CTRL_CMD_ID) {
+        std::cerr << "[CommandChannel] Not a control frame, rejected.\n";
+        Result r;
+        r.status = Status::Invalid;
+        if (cb) {
+            cb(r);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Command cmd;
+    cmd.id     = m_nextId++;
+    cmd.action = frame[CTRL_ACTION_OFFSET];
+    cmd.frame  = std::move(frame);
+    cmd.cb     = std::move(cb);
+    m_waiting.push_back(std::move(cmd));
+    pump();
+}
+
+std::future<CommandChannel::Result> CommandChannel::submit(DataFrame frame)
+{
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::future<Result> fut = promise->get_future();
+    submit(std::move(frame), [promise](const Result& r) { promise->set_value(r); });
+    return fut;
+}
+
+size_t CommandChannel::inFlight() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_inFlight.size();
+}
+
+size_t CommandChannel::queued() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_waiting.size();
+}
+
+const char* CommandChannel::statusName(Status s)
+{
+    switch (s) {
+    case Status::Ok:        return "OK";
+    case Status::Rejected:  return "REJECTED";
+    case Status::Timeout:   return "TIMEOUT";
+    case Status::Cancelled: return "CANCELLED";
+    case Status::Invalid:   return "INVALID";
+    }
+    return "?";
+}
+
+// 调用方持有 m_mutex：按提交顺序把可发送的命令放入窗口，同动作编号已在途的跳过（保持其相对顺序）
+void CommandChannel::pump()
+{
+    for (auto it = m_waiting.begin(); it != m_waiting.end() && m_inFlight.size() < m_opts.window;) {
+        if (m_actionOwner[it->action] != 0) {
+            ++it;
+            continue;
+        }
+        Command cmd = std::move(*it);
+        it = m_waiting.erase(it);
+
+        m_actionOwner[cmd.action] = cmd.id;
+        auto res = m_inFlight.emplace(cmd.id, std::move(cmd));
+        send(res.first->second);
+    }
+}
+
+// 调用方持有 m_mutex
+void CommandChannel::send(Command& cmd)
+{
+    ++cmd.attempts;
+    cmd.sentAt = Clock::now();
+    {
+        std::lock_guard<std::mutex> qlk(g_queueMutex);
+        g_dataFrameQueue.push(cmd.frame);
+    }
+    g_queueCond.notify_one();
+
+    const uint64_t id = cmd.id;
+    cmd.timer = g_eventLoop.runAfter(m_opts.timeout, [this, id] { onTimeout(id); });
+}
+
+void CommandChannel::onReply(const ControlReply& reply)
+{
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const uint64_t id = m_actionOwner[reply.actionNumber];
+        auto it = (id != 0) ? m_inFlight.find(id) : m_inFlight.end();
+        if (it == m_inFlight.end()) {
+            return;      // 不是通过本通道发送的命令
+        }
+        g_eventLoop.cancel(it->second.timer);
+        finish(it->second, reply.execResult == 0 ? Status::Ok : Status::Rejected, done, &reply);
+        m_actionOwner[reply.actionNumber] = 0;
+        m_inFlight.erase(it);
+        pump();
+    }
+    notify(done);
+}
+
+// 在事件循环线程执行
+void CommandChannel::onTimeout(uint64_t id)
+{
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_inFlight.find(id);
+        if (it == m_inFlight.end()) {
+            return;
+        }
+        Command& cmd = it->second;
+        if (m_retryable[cmd.action] && cmd.attempts <= m_opts.maxRetries) {
+            std::cerr << "[CommandChannel] action 0x" << std::hex << static_cast<int>(cmd.action) << std::dec
+                      << " timed out, retry " << cmd.attempts << "/" << m_opts.maxRetries << "\n";
+            send(cmd);
+            return;
+        }
+        finish(cmd, Status::Timeout, done);
+        m_actionOwner[cmd.action] = 0;
+        m_inFlight.erase(it);
+        pump();
+    }
+    notify(done);
+}
+
+// 调用方持有 m_mutex；回调收集起来在释放锁后执行
+void CommandChannel::finish(Command& cmd, Status status, std::vector<Completion>& done, const ControlReply* reply)
+{
+    Result r;
+    r.status   = status;
+    r.action   = cmd.action;
+    r.attempts = cmd.attempts;
+    if (reply) {
+        r.reply = *reply;
+        r.rttMs = std::chrono::duration<double, std::milli>(Clock::now() - cmd.sentAt).count();
+    }
+    if (cmd.cb) {
+        done.emplace_back(std::move(cmd.cb), std::move(r));
+    }
+}
+
+void CommandChannel::notify(std::vector<Completion>& done)
+{
+    for (auto& c : done) {
+        c.first(c.second);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "common_types.h"
+
+/**
+ * @brief 流水线式控制命令通道：滑动窗口 + 0xD1 回复匹配 + 超时重试 + 完成通知。
+ *
+ *        - 最多同时在途 window 条命令，其余排队；不同动作编号的命令并行在途，
+ *          同一动作编号同一时刻只允许一条在途（0xD1 回复只带动作编号，据此保证匹配无歧义），
+ *          后到的同动作命令排队但不阻塞其他动作；
+ *        - 超时后按动作的幂等规则决定是否重发：绝对量设置（云台角度、变焦倍数、返航高度等）可重发；
+ *          拍照、起飞、相对变焦、格式化等重复执行会产生副作用的命令不重发，直接报告超时；
+ *        - 调用方可取得 std::future，或传入回调（回调在解析线程 / 事件循环线程中执行，应尽快返回）。
+ *
+ *        超时由 g_eventLoop 的定时器驱动，不额外创建线程。
+ */
+class CommandChannel
+{
+public:
+    enum class Status { Ok, Rejected, Timeout, Cancelled, Invalid };
+
+    struct Result {
+        Status       status   = Status::Invalid;
+        uint8_t      action   = 0;
+        int          attempts = 0;    ///< 实际发送次数
+        double       rttMs    = 0.0;  ///< 最后一次发送到收到回复的时延
+        ControlReply reply;           ///< status 为 Ok / Rejected 时有效
+    };
+
+    using Callback = std::function<void(const Result&)>;
+
+    struct Options {
+        size_t                    window     = 8;      ///< 最多同时在途的命令数
+        std::chrono::milliseconds timeout{2000};       ///< 单次发送的应答超时
+        int                       maxRetries = 2;      ///< 可重发动作的最大重发次数
+    };
+
+    CommandChannel();
+
+    /**
+     * @brief 注册 0xD1 回复监听者
+     */
+    void start();
+
+    /**
+     * @brief 注销监听者，未完成的命令以 Cancelled 结束
+     */
+    void stop();
+
+    void setOptions(const Options& opts);
+
+    /**
+     * @brief 覆盖某动作编号的幂等规则（true 表示超时后允许重发）
+     */
+    void setRetryable(uint8_t action, bool retryable);
+
+    /**
+     * @brief 提交一条控制帧（createControlFrame 生成），完成时调用 cb
+     */
+    void submit(DataFrame frame, Callback cb);
+
+    /**
+     * @brief 提交一条控制帧，返回完成 future
+     */
+    std::future<Result> submit(DataFrame frame);
+
+    /**
+     * @brief 当前在途 / 排队的命令数
+     */
+    size_t inFlight() const;
+    size_t queued() const;
+
+    static const char* statusName(Status s);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Command {
+        uint64_t          id       = 0;
+        DataFrame         frame;
+        uint8_t           action   = 0;
+        int               attempts = 0;
+        Clock::time_point sentAt;
+        uint64_t          timer    = 0;
+        Callback          cb;
+    };
+    using Completion = std::pair<Callback, Result>;
+
+    void onReply(const ControlReply& reply);
+    void onTimeout(uint64_t id);
+    void pump();
+    void send(Command& cmd);
+    void finish(Command& cmd, Status status, std::vector<Completion>& done, const ControlReply* reply = nullptr);
+    static void notify(std::vector<Completion>& done);
+
+private:
+    mutable std::mutex m_mutex;
+    Options            m_opts;
+    uint64_t           m_nextId     = 1;
+    int                m_listenerId = -1;
+
+    std::deque<Command>                   m_waiting;
+    std::unordered_map<uint64_t, Command> m_inFlight;
+    std::array<uint64_t, 256>             m_actionOwner{};   ///< 动作编号 -> 在途命令 ID，0 表示空闲
+    std::array<bool, 256>                 m_retryable{};
+};
+
+extern CommandChannel g_commandChannel;
@@ -0,0 +1,248 @@
+#include "CommandTracker.h"
+
+#include <cstdio>
+#include <iostream>
+#include "EventLoop.h"
+#include "FrameDataHandler.h"
+#include "GimbalJoystickController.h"
+#include "PayloadCipher.h"
+
+CommandTracker g_commandTracker;
+
+namespace {
+// 控制帧: [0x74 0x79][长度 2B][SN 15B][0xD1][加密 1B][动作 1B][参数...]
+constexpr size_t  CTRL_CMD_OFFSET    = 19;
+constexpr size_t  CTRL_ENC_OFFSET    = 20;
+constexpr size_t  CTRL_ACTION_OFFSET = 21;
+constexpr size_t  CTRL_PARAM_OFFSET  = 22;
+constexpr uint8_t CTRL_CMD_ID        = 0xD1;
+
+constexpr auto SWEEP_INTERVAL = std::chrono::milliseconds(100);
+
+// FNV-1a，用于识别同一条命令的原样重发
+uint64_t frameHash(const DataFrame& frame)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (uint8_t b : frame) {
+        h = (h ^ b) * 1099511628211ULL;
+    }
+    return h;
+}
+} // namespace
+
+CommandTracker::CommandTracker() = default;
+
+void CommandTracker::start()
+{
+    if (m_listenerId >= 0) {
+        return;
+    }
+    m_listenerId = FrameDataHandler::addReplyListener([this](const ControlReply& r) { onReply(r); });
+    m_sweepTimer = g_eventLoop.runEvery(SWEEP_INTERVAL, [this] { sweep(); });
+}
+
+void CommandTracker::stop()
+{
+    if (m_listenerId >= 0) {
+        FrameDataHandler::removeReplyListener(m_listenerId);
+        m_listenerId = -1;
+    }
+    g_eventLoop.cancel(m_sweepTimer);
+    m_sweepTimer = 0;
+}
+
+CommandTracker::Entry& CommandTracker::entry(uint8_t action)
+{
+    auto& e = m_entries[action];
+    if (!e) {
+        e = std::make_unique<Entry>();
+        e->stats.action = action;
+    }
+    return *e;
+}
+
+void CommandTracker::onSending(const DataFrame& frame)
+{
+    if (frame.size() <= CTRL_ACTION_OFFSET || frame[0] != 0x74 || frame[1] != 0x79 ||
+        frame[CTRL_CMD_OFFSET] != CTRL_CMD_ID) {
+        return;
+    }
+    const uint8_t action = frame[CTRL_ACTION_OFFSET];
+    const auto    now    = Clock::now();
+    const bool    stick  = GimbalJoystickController::isStreamFrame(frame);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Entry& e = entry(action);
+    if (stick) {
+        // 杆量帧每个节拍一帧，时延由 GimbalJoystickController 统计；登记为在途会挤占同动作的命令匹配并大量超时
+        ++e.streamFrames;
+        e.streamSentAt = now;
+        return;
+    }
+    ++e.stats.sent;
+
+    // 同一序号（或无序号时内容完全相同）的命令仍在途，视为重发：刷新超时，但不再计入 RTT
+    int32_t seq = -1;
+    if (e.seqOffset >= 0) {
+        const size_t pos = CTRL_PARAM_OFFSET + static_cast<size_t>(e.seqOffset);
+        if (frame[CTRL_ENC_OFFSET] == PayloadCipher::kFlagAesGcm) {
+            // 加密帧（重发时 nonce 不同，不能按内容识别）：只解出参数开头到序号为止
+            uint8_t head[16];
+            const size_t count = static_cast<size_t>(e.seqOffset) + 2;
+            if (count <= sizeof(head) &&
+                g_payloadCipher.peek(frame.data() + CTRL_PARAM_OFFSET, frame.size() - CTRL_PARAM_OFFSET, count, head)) {
+                seq = (static_cast<int32_t>(head[count - 2]) << 8) | head[count - 1];
+            }
+        } else if (frame.size() >= pos + 2) {
+            seq = (static_cast<int32_t>(frame[pos]) << 8) | frame[pos + 1];
+        }
+    }
+    const uint64_t hash = (seq < 0) ? frameHash(frame) : 0;
+    for (Pending& p : e.pending) {
+        if (seq >= 0 ? p.seq == seq : p.hash == hash) {
+            p.sentAt        = now;
+            p.retransmitted = true;
+            return;
+        }
+    }
+    e.pending.push_back({seq, hash, now, false});
+    e.stats.inFlight = e.pending.size();
+}
+
+void CommandTracker::onReply(const ControlReply& reply)
+{
+    const auto now = Clock::now();
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Entry& e = entry(reply.actionNumber);
+    if (e.pending.empty() && e.streamFrames > 0) {
+        --e.streamFrames;   // 杆量帧的回复
+        return;
+    }
+    ++e.stats.replied;
+    if (reply.execResult != 0) {
+        ++e.stats.rejected;
+    }
+
+    auto it = e.pending.begin();
+    if (e.seqOffset >= 0 && reply.extra.size() >= 2) {
+        const int32_t seq = (static_cast<int32_t>(reply.extra[0]) << 8) | reply.extra[1];
+        while (it != e.pending.end() && it->seq != seq) {
+            ++it;
+        }
+    }
+    if (it == e.pending.end()) {
+        ++e.stats.unmatched;     // 已超时清理，或对端主动上报
+        return;
+    }
+
+    if (!it->retransmitted) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - it->sentAt).count();
+        e.stats.rtt.record(static_cast<uint64_t>(us));
+    }
+    e.pending.erase(it);
+    e.stats.inFlight = e.pending.size();
+}
+
+void CommandTracker::setSequenceOffset(uint8_t action, size_t paramOffset)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    entry(action).seqOffset = static_cast<int>(paramOffset);
+}
+
+void CommandTracker::setTimeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_timeout = timeout;
+}
+
+// 在事件循环线程中执行，清理超时的在途命令
+void CommandTracker::sweep()
+{
+    const auto now = Clock::now();
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& e : m_entries) {
+        if (!e) {
+            continue;
+        }
+        if (e->streamFrames && now - e->streamSentAt >= m_timeout) {
+            e->streamFrames = 0;   // 杆量帧的回复丢失，不再等待
+        }
+        auto& q = e->pending;
+        for (auto it = q.begin(); it != q.end();) {
+            if (now - it->sentAt < m_timeout) {
+                ++it;
+                continue;
+            }
+            ++e->stats.timeouts;
+            std::fprintf(stderr, "[CommandTracker] action 0x%02X%s timed out after %lld ms\n",
+                         e->stats.action,
+                         it->seq >= 0 ? (" seq " + std::to_string(it->seq)).c_str() : "",
+                         static_cast<long long>(m_timeout.count()));
+            it = q.erase(it);
+        }
+        e->stats.inFlight = q.size();
+    }
+}
+
+std::vector<CommandTracker::ActionStats> CommandTracker::snapshot() const
+{
+    std::vector<ActionStats> out;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (const auto& e : m_entries) {
+        if (e && (e->stats.sent || e->stats.replied)) {
+            out.push_back(e->stats);
+        }
+    }
+    return out;
+}
+
+uint64_t CommandTracker::minRttUs() const
+{
+    uint64_t best = 0;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (const auto& e : m_entries) {
+        if (e && e->stats.rtt.count() && (best == 0 || e->stats.rtt.min() < best)) {
+            best = e->stats.rtt.min();
+        }
+    }
+    return best;
+}
+
+void CommandTracker::printStats() const
+{
+    const std::vector<ActionStats> all = snapshot();
+    if (all.empty()) {
+        std::cout << "[CommandTracker] No control commands sent yet.\n";
+        return;
+    }
+    std::printf("action     sent  replied  reject  timeout  inflight      p50      p90      p99    p99.9      max  (ms)\n");
+    for (const ActionStats& s : all) {
+        auto ms = [](uint64_t us) { return us / 1000.0; };
+        std::printf("  0x%02X %8llu %8llu %7llu %8llu %9zu %8.2f %8.2f %8.2f %8.2f %8.2f\n",
+                    s.action,
+                    static_cast<unsigned long long>(s.sent),
+                    static_cast<unsigned long long>(s.replied),
+                    static_cast<unsigned long long>(s.rejected),
+                    static_cast<unsigned long long>(s.timeouts),
+                    s.inFlight,
+                    ms(s.rtt.percentile(50)), ms(s.rtt.percentile(90)), ms(s.rtt.percentile(99)),
+                    ms(s.rtt.percentile(99.9)), ms(s.rtt.max()));
+    }
+}
+
+void CommandTracker::reset()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& e : m_entries) {
+        if (e) {
+            const int seqOffset = e->seqOffset;
+            const uint8_t action = e->stats.action;
+            e->stats = ActionStats();
+            e->stats.action = action;
+            e->stats.inFlight = e->pending.size();
+            e->seqOffset = seqOffset;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "common_types.h"
+#include "LatencyHistogram.h"
+
+/**
+ * @brief 控制帧(0xD1)在途表：关联每条命令与它的回复，统计每个动作编号的往返时延(RTT)。
+ *
+ *        - ComTask 发送线程在帧写入 socket 前调用 onSending()，按动作编号登记发送时刻；
+ *        - FrameDataHandler 解析到 0xD1 回复后经回复监听者调用 onReply()，
+ *          按动作编号匹配最早的在途命令；对登记了序号位置的动作（如分包上传）按回显序号精确匹配；
+ *        - 事件循环定时清理超过 timeout 未回复的命令，计入超时次数。
+ *
+ *        连续杆量模式的 0xF4 帧由 GimbalJoystickController 自行统计，这里不登记，其回复也不计入
+ *        （该动作没有在途命令时的回复视为杆量帧的回复）。
+ *        同一序号（无序号时为内容相同的帧）被重发后收到的回复无法判断对应哪一次发送，
+ *        不计入 RTT（Karn 算法）。
+ *        每个动作编号一个 LatencyHistogram，可通过 CLI `stats rtt` 查看 p50/p90/p99/p99.9。
+ */
+class CommandTracker
+{
+public:
+    struct ActionStats {
+        uint8_t  action     = 0;
+        uint64_t sent       = 0;   ///< 发送次数（含重发）
+        uint64_t replied    = 0;   ///< 收到回复次数
+        uint64_t rejected   = 0;   ///< 回复执行结果非 0 的次数
+        uint64_t timeouts   = 0;   ///< 超时未回复次数
+        uint64_t unmatched  = 0;   ///< 找不到在途命令的回复次数
+        size_t   inFlight   = 0;   ///< 当前在途
+        LatencyHistogram rtt;      ///< 往返时延(微秒)
+    };
+
+    CommandTracker();
+
+    /**
+     * @brief 注册回复监听者并在 g_eventLoop 上启动超时清理
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief 控制帧即将写入 socket（由发送线程调用）；非控制帧直接忽略
+     * @note  发送失败的命令不会收到回复，最终计入超时
+     */
+    void onSending(const DataFrame& frame);
+
+    /**
+     * @brief 收到 0xD1 回复（由解析线程调用）
+     */
+    void onReply(const ControlReply& reply);
+
+    /**
+     * @brief 登记某动作参数中 2 字节大端序号的位置，回复的扩展字段前 2 字节回显该序号
+     */
+    void setSequenceOffset(uint8_t action, size_t paramOffset);
+
+    /**
+     * @brief 命令超时时间，默认 5s
+     */
+    void setTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 有记录的各动作统计快照
+     */
+    std::vector<ActionStats> snapshot() const;
+
+    /**
+     * @brief 打印各动作 RTT 与超时统计
+     */
+    void printStats() const;
+
+    /**
+     * @brief 所有动作中最小的 RTT（微秒），没有样本时返回 0
+     */
+    uint64_t minRttUs() const;
+
+    void reset();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        int32_t           seq;          ///< -1 表示该动作没有序号
+        uint64_t          hash;         ///< 无序号时整帧的哈希，用于识别重发
+        Clock::time_point sentAt;
+        bool              retransmitted;
+    };
+
+    struct Entry {
+        ActionStats         stats;
+        std::deque<Pending> pending;
+        int                 seqOffset = -1;
+        uint64_t            streamFrames = 0;   ///< 已发出、尚未收到回复的杆量帧（不登记在途）
+        Clock::time_point   streamSentAt;       ///< 最近一帧杆量帧的发送时刻，超过超时时间后清零计数
+    };
+
+    Entry& entry(uint8_t action);
+    void   sweep();
+
+private:
+    mutable std::mutex m_mutex;
+    std::array<std::unique_ptr<Entry>, 256> m_entries;   ///< 按动作编号索引，首次使用时创建
+    std::chrono::milliseconds m_timeout{5000};
+
+    int      m_listenerId = -1;
+    uint64_t m_sweepTimer = 0;
+};
+
+extern CommandTracker g_commandTracker;
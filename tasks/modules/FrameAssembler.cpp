@@ -4,6 +4,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
 
 // // ----------------------------
 // // 声明全局队列与同步变量（你可能在别的地方有相同声明，也可放到统一的头文件）
@@ -22,58 +24,59 @@
 // -----------------------------------------------------------------
 FrameAssembler::FrameAssembler(bool discardMode)
     : m_discardMode(discardMode)
-    , m_stopFlag(false)
 {
 }
 
 FrameAssembler::~FrameAssembler()
 {
-    // 如果还有可能在 run() 中等待，需要确保不会阻塞析构。
-    // 一般情况下，建议在外部显式调用 stop() 再 join 线程。
-    // 这里留空即可。
+    // run() 所在线程由外部通过 StopToken 停止并 join，这里留空即可。
 }
 
 // -----------------------------------------------------------------
-// 停止函数：只设置标志并唤醒可能的等待
+// 重置：丢弃未拼完的数据
 // -----------------------------------------------------------------
-void FrameAssembler::stop()
+size_t FrameAssembler::reset()
 {
-    m_stopFlag.store(true);
-    // 唤醒等待 g_recvRawQueueCond 的线程，避免卡住
-    g_recvRawQueueCond.notify_all();
+    const size_t dropped = m_buffer.size();
+    m_buffer.clear();
+    m_lastRecvNs  = 0;
+    m_lastTraceId = 0;
+    return dropped;
 }
 
 // -----------------------------------------------------------------
 // 线程体：循环从 g_recvRawDataFrameQueue 中取数据帧，追加到缓冲并解析
 // -----------------------------------------------------------------
-void FrameAssembler::run()
+void FrameAssembler::run(const StopToken& stop)
 {
     std::cout << "[FrameAssembler] run() started.\n";
 
-    while (!m_stopFlag.load())
+    while (!stop.stopRequested())
     {
         // 等待 原始数据队列 有新数据或停止
         std::unique_lock<std::mutex> lock(g_recvRawQueueMutex);
-        g_recvRawQueueCond.wait(lock, [&]{
-            return !g_recvRawDataFrameQueue.empty() || m_stopFlag.load();
-        });
+        stop.wait(lock, g_recvRawQueueCond, [] { return !g_recvRawDataFrameQueue.empty(); });
 
         // 再次检查停止标志
-        if (m_stopFlag.load()) {
+        if (stop.stopRequested()) {
             break;
         }
 
         // 从队列中取出一个原始数据帧
-        DataFrame rawFrame = g_recvRawDataFrameQueue.front();
+        Metrics::setGauge(Metrics::RawQueueDepth, g_recvRawDataFrameQueue.size());
+        StampedFrame rawFrame = std::move(g_recvRawDataFrameQueue.front());
         g_recvRawDataFrameQueue.pop();
         lock.unlock();
 
-        // std::cout << "[FrameAssembler] Received raw frame of size: " << rawFrame.size() << "\n";
+        // std::cout << "[FrameAssembler] Received raw frame of size: " << rawFrame.data.size() << "\n";
 
         // 追加到本地缓冲
-        m_buffer.insert(m_buffer.end(), rawFrame.begin(), rawFrame.end());
+        m_buffer.insert(m_buffer.end(), rawFrame.data.begin(), rawFrame.data.end());
+        m_lastRecvNs  = rawFrame.recvNs;
+        m_lastTraceId = rawFrame.traceId;
 
         // 尝试解析缓冲区
+        Tracer::Scope traceScope("parseBuffer", m_lastTraceId, Tracer::Flow::Step);
         parseBuffer();
     }
 }
@@ -90,6 +93,7 @@ void FrameAssembler::parseBuffer()
         {
             // 舍弃模式下，如果连 3 字节都不到，就直接丢弃（示例逻辑，可自行调整）
             if (m_discardMode && m_buffer.size() < 3) {
+                Metrics::add(Metrics::DiscardedBytes, m_buffer.size());
                 m_buffer.clear();
             }
             break;
@@ -99,6 +103,7 @@ void FrameAssembler::parseBuffer()
         if (m_buffer[0] != 0x6A || m_buffer[1] != 0x77)
         {
             // 帧头不对，丢弃一个字节，继续查找
+            Metrics::add(Metrics::ResyncBytes);
             m_buffer.erase(m_buffer.begin());
             continue;
         }
@@ -116,6 +121,7 @@ void FrameAssembler::parseBuffer()
             {
                 // 若小于半帧直接丢弃（这里用 frameSize/2.0 示例）
                 if (m_buffer.size() < (frameSize / 2.0)) {
+                    Metrics::add(Metrics::DiscardedBytes, m_buffer.size());
                     m_buffer.clear();
                 }
             }
@@ -124,7 +130,13 @@ void FrameAssembler::parseBuffer()
         }
 
         // 5. 构造一个完整帧
-        DataFrame completeFrame(m_buffer.begin(), m_buffer.begin() + frameSize);
+        StampedFrame completeFrame;
+        completeFrame.data.assign(m_buffer.begin(), m_buffer.begin() + frameSize);
+        completeFrame.recvNs      = m_lastRecvNs;
+        completeFrame.assembledNs = Metrics::nowNs();
+        completeFrame.traceId     = m_lastTraceId;
+        Metrics::recordStage(Metrics::RecvToAssembled, completeFrame.recvNs, completeFrame.assembledNs);
+        Metrics::add(Metrics::FramesAssembled);
 
         // 6. 放入完整帧队列
         {
@@ -139,6 +151,7 @@ void FrameAssembler::parseBuffer()
         // 8. 舍弃模式：只要解析出一帧，就丢弃剩余并退出循环
         if (m_discardMode)
         {
+            Metrics::add(Metrics::DiscardedBytes, m_buffer.size());
             m_buffer.clear();
             break;
         }
@@ -3,6 +3,7 @@
 #include <vector>
 #include <atomic>
 #include "common_types.h"
+#include "utils/StopToken.h"
 
 // /**
 //  * @brief 全局使用的数据帧定义
@@ -23,14 +24,16 @@
  *
  *        使用方法：
  *            1. 在主线程中构造 FrameAssembler 对象。
- *            2. 在外部创建线程（std::thread）调用对象的 run() 函数。
- *            3. 在需要停止时调用 stop()，并等待该线程退出。
+ *            2. 在外部创建线程（std::thread）调用对象的 run(token) 函数。
+ *            3. 在需要停止时对 token 所属的 StopSource 请求停止（并唤醒 g_recvRawQueueCond），等待该线程退出。
  */
 class FrameAssembler
 {
     // 让 TasksManager 可以直接调用本类的私有成员（包括线程函数）
     friend class TasksManager;
-    
+    // 微基准（bench/micro_bench.cpp）直接驱动解析函数
+    friend struct BenchAccess;
+
 public:
     /**
      * @param discardMode 是否开启“舍弃模式”
@@ -43,15 +46,15 @@ public:
     ~FrameAssembler();
 
     /**
-     * @brief 在外部线程中执行此函数，循环从全局队列中取数据并解析成完整帧
-     *        直到 stop() 被调用或对象被析构（m_stopFlag = true）。
+     * @brief 在外部线程中执行此函数，循环从全局队列中取数据并解析成完整帧，直到 stop 被请求
      */
-    void run();
+    void run(const StopToken& stop);
 
     /**
-     * @brief 设置停止标志，退出 run() 的循环
+     * @brief 丢弃缓冲中未拼完的数据（重连后旧字节流无法与新连接衔接），线程停止后调用
+     * @return 丢弃的字节数
      */
-    void stop();
+    size_t reset();
 
 private:
     /**
@@ -62,7 +65,8 @@ private:
 
 private:
     bool m_discardMode;             ///< 是否为舍弃模式
-    std::atomic<bool> m_stopFlag;   ///< 停止标志
     std::vector<uint8_t> m_buffer;  ///< 用于拼接、解析数据帧的临时缓冲
+    uint64_t m_lastRecvNs = 0;      ///< 最近一段原始数据的接收时刻（补齐一帧的那一段）
+    uint64_t m_lastTraceId = 0;     ///< 最近一段原始数据的 Tracer flow ID
 };
 
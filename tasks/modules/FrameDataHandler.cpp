@@ -1,12 +1,32 @@
 #include "FrameDataHandler.h"
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
+#include "utils/AsyncLogger.h"
+#include "utils/AllocTrace.h"
+#include "utils/PayloadCipher.h"
+#include "QueryServer.h"
+#include "ClockSync.h"
+#include <map>
+#include <mutex>
+
+namespace {
+std::mutex                                        g_replyListenerMutex;
+std::map<int, FrameDataHandler::ReplyListener>    g_replyListeners;
+int                                               g_nextReplyListenerId = 1;
+} // namespace
 
 FrameDataHandler::FrameDataHandler()
+    : m_arena(AllocTrace::arenaOptions(m_arenaBlock, sizeof(m_arenaBlock)))
 {
     // 构造函数，如有必要，可在此进行成员变量初始化
     // 初始化 TelemetryUI
     m_telemetryUI.start(); // 启动 UI 线程
     std::cout << "UI thread started." << std::endl;
 
+    m_statePublisher.open(g_serverConfig.stateShm);
+    if (!g_serverConfig.frameShm.empty()) {
+        m_frameWriter.create(g_serverConfig.frameShm, 4 * 1024 * 1024);
+    }
 }
 
 FrameDataHandler::~FrameDataHandler()
@@ -15,8 +35,26 @@ FrameDataHandler::~FrameDataHandler()
     m_telemetryUI.stop(); // 停止 UI 线程
 }
 
+int FrameDataHandler::addReplyListener(ReplyListener listener)
+{
+    std::lock_guard<std::mutex> lk(g_replyListenerMutex);
+    const int id = g_nextReplyListenerId++;
+    g_replyListeners.emplace(id, std::move(listener));
+    return id;
+}
+
+void FrameDataHandler::removeReplyListener(int id)
+{
+    std::lock_guard<std::mutex> lk(g_replyListenerMutex);
+    g_replyListeners.erase(id);
+}
+
 void FrameDataHandler::handleFrameData(uint8_t cmdId, const uint8_t* data, uint16_t length)
 {
+    Tracer::Scope traceScope("handleFrameData", Tracer::currentFlow(), Tracer::Flow::Step);
+    if (m_frameWriter.isOpen()) {
+        m_frameWriter.publish(cmdId, data, length, ShmFrameRing::monotonicNs());
+    }
     switch (cmdId)
     {
     case 0xD1:
@@ -28,12 +66,19 @@ void FrameDataHandler::handleFrameData(uint8_t cmdId, const uint8_t* data, uint1
     case 0xA8:
         handleA8(data, length);
         break;
+    case 0x02:
+        // 心跳应答：用于估计机载时钟偏差
+        if (!g_clockSync.onHeartbeatReply(data, length)) {
+            LOG_WARN_RL("FrameDataHandler", 5, "Unmatched heartbeat reply, length = {}", length);
+        }
+        break;
     default:
-        std::cout << "[FrameDataHandler] Unknown cmdId = 0x"
-                  << std::hex << static_cast<int>(cmdId)
-                  << ", length = " << std::dec << length << std::endl;
+        // 对端异常时可能连续到达大量未知帧，限流避免解析线程被终端输出拖慢
+        LOG_WARN_RL("FrameDataHandler", 10, "Unknown cmdId = 0x{:x}, length = {}", cmdId, length);
         break;
     }
+    // 本帧在 arena 上创建的消息已用完（下游均已拷贝），释放以便下一帧复用初始块
+    m_arena.Reset();
 }
 
 void FrameDataHandler::handleD1(const uint8_t* data, uint16_t length)
@@ -44,8 +89,38 @@ void FrameDataHandler::handleD1(const uint8_t* data, uint16_t length)
 
     if (length < 1 + 1 + 1 + 4 + 15)
     {
-        std::cerr << "[FrameDataHandler] handleD1 error: data length too short."
-                << std::endl;
+        LOG_WARN_RL("FrameDataHandler", 10, "handleD1 error: data length too short ({}).", length);
+        return;
+    }
+
+    // 加密回复：加密标志 | 动作编号 | nonce | 密文 | tag（前两字节为 AAD），
+    // 解密到复用的缓冲后按明文格式继续解析
+    if (data[0] == PayloadCipher::kFlagAesGcm)
+    {
+        if (length < 2 + PayloadCipher::kOverhead + 1 + 4 + 15) {
+            Metrics::add(Metrics::CipherRejects);
+            LOG_WARN_RL("FrameDataHandler", 10, "handleD1 error: encrypted reply too short ({}).", length);
+            return;
+        }
+        m_plainReply.resize(length - PayloadCipher::kOverhead);
+        m_plainReply[0] = data[0];
+        m_plainReply[1] = data[1];
+        if (!g_payloadCipher.open(data, 2, data + 2, length - 2, m_plainReply.data() + 2)) {
+            Metrics::add(Metrics::CipherRejects);
+            LOG_WARN_RL("FrameDataHandler", 5, "[0xD1] Dropped encrypted reply for action {}: {}", data[1],
+                        g_payloadCipher.enabled() ? "authentication failed" : "no key configured");
+            return;
+        }
+        Metrics::add(Metrics::FramesOpened);
+        data   = m_plainReply.data();
+        length = static_cast<uint16_t>(m_plainReply.size());
+    }
+    else if (g_payloadCipher.enabled())
+    {
+        // 配置了密钥时明文回复无法认证来源，一律丢弃
+        Metrics::add(Metrics::CipherRejects);
+        LOG_WARN_RL("FrameDataHandler", 5, "[0xD1] Dropped plaintext reply for action {}: encryption is required.",
+                    data[1]);
         return;
     }
 
@@ -67,14 +142,22 @@ void FrameDataHandler::handleD1(const uint8_t* data, uint16_t length)
     std::string cloudBoxSN(reinterpret_cast<const char*>(&data[7]), 15);
 
     // 打印解析得到的信息
-    std::cout << "[FrameDataHandler][0xD1] "
-    << "CloudBoxSN: " << cloudBoxSN
-    << ", EncryptionFlag: " << static_cast<int>(encryptionFlag)
-    << ", ActionNumber: "   << static_cast<int>(actionNumber)
-    << ", ExecResult: "     << static_cast<int>(execResult)
-    << ", ErrorCode: "      << errorCode
-    << std::endl;
+    LOG_INFO("FrameDataHandler", "[0xD1] CloudBoxSN: {}, EncryptionFlag: {}, ActionNumber: {}, ExecResult: {}, ErrorCode: {}",
+             cloudBoxSN, encryptionFlag, actionNumber, execResult, errorCode);
 
+    // 分发给监听者（如分包上传等待应答）
+    ControlReply reply;
+    reply.encryptionFlag = encryptionFlag;
+    reply.actionNumber   = actionNumber;
+    reply.execResult     = execResult;
+    reply.errorCode      = errorCode;
+    reply.cloudBoxSN     = std::move(cloudBoxSN);
+    reply.extra.assign(data + 22, data + length);
+
+    std::lock_guard<std::mutex> lk(g_replyListenerMutex);
+    for (auto& kv : g_replyListeners) {
+        kv.second(reply);
+    }
 }
 
 void FrameDataHandler::handleA9(const uint8_t* data, uint16_t length)
@@ -82,15 +165,19 @@ void FrameDataHandler::handleA9(const uint8_t* data, uint16_t length)
     // // TODO: 处理 0xA9 类型数据的实际业务逻辑(遥测数据)
     // std::cout << "[FrameDataHandler] Handling 0xA9 data, length = "
     //           << length << std::endl;
-    // 将data转化为string，再通过protobuf反序列化
-    TelemetryData telemetryData;
-    std::string dataStr(reinterpret_cast<const char*>(data), length);
-    if (telemetryData.ParseFromString(dataStr)) {
+    // 直接从帧数据反序列化到 arena 上的消息
+    AllocTrace::Scope allocScope(AllocTrace::Telemetry, true);
+    TelemetryData& telemetryData = *google::protobuf::Arena::CreateMessage<TelemetryData>(&m_arena);
+    if (telemetryData.ParseFromArray(data, length)) {
         // std::cout << "Parsed TelemetryDataBuf successfully." << std::endl;
         // 这里可以进一步处理 telemetryData
+        g_clockSync.onVehicleTimestamp(telemetryData.timestamp());   // 空地时延
         m_telemetryUI.update(telemetryData); // 更新 UI 显示
+        m_statePublisher.onTelemetry(telemetryData);
+        g_queryServer.onTelemetry(telemetryData, data, length);
     } else {
-        std::cerr << "Failed to parse TelemetryDataBuf." << std::endl;
+        Metrics::add(Metrics::ProtobufErrors);
+        LOG_WARN_RL("FrameDataHandler", 5, "Failed to parse TelemetryDataBuf ({} bytes).", length);
     }
 }
 
@@ -99,14 +186,18 @@ void FrameDataHandler::handleA8(const uint8_t* data, uint16_t length)
     // // TODO: 处理 0xA8 类型数据的实际业务逻辑(无人机状态数据)
     // std::cout << "[FrameDataHandler] Handling 0xA8 data, length = "
     //           << length << std::endl;
-    // 将data转化为string，再通过protobuf反序列化
-    UavState uavState;
-    std::string dataStr(reinterpret_cast<const char*>(data), length);
-    if (uavState.ParseFromString(dataStr)) {
+    // 直接从帧数据反序列化到 arena 上的消息
+    AllocTrace::Scope allocScope(AllocTrace::Telemetry, true);
+    UavState& uavState = *google::protobuf::Arena::CreateMessage<UavState>(&m_arena);
+    if (uavState.ParseFromArray(data, length)) {
         // std::cout << "Parsed UavState successfully." << std::endl;
         // 这里可以进一步处理 uavState
+        g_clockSync.onVehicleTimestamp(uavState.timestamp());
         m_telemetryUI.updateUavState(uavState); // 更新 UI 显示
+        m_statePublisher.onUavState(uavState);
+        g_queryServer.onUavState(uavState, data, length);
     } else {
-        std::cerr << "Failed to parse UavState." << std::endl;
+        Metrics::add(Metrics::ProtobufErrors);
+        LOG_WARN_RL("FrameDataHandler", 5, "Failed to parse UavState ({} bytes).", length);
     }
 }
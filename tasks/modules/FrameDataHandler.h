@@ -2,9 +2,14 @@
 #define FRAMEDATAHANDLER_H
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include "common_types.h"
+#include <google/protobuf/arena.h>
 #include "TelemetryDataBuf-new.pb.h"
 #include "TelemetryUI.h"
+#include "StatePublisher.h"
+#include "ShmFrameRing.h"
 
 /**
  * @brief 处理不同命令ID对应的帧数据
@@ -23,6 +28,20 @@ public:
      */
     void handleFrameData(uint8_t cmdId, const uint8_t* data, uint16_t length);
 
+    using ReplyListener = std::function<void(const ControlReply&)>;
+
+    /**
+     * @brief 注册 0xD1 回复监听者（进程内全局，可在任意线程调用）
+     * @note  回调在解析线程中执行，应尽快返回，且不能在回调内注册/注销监听者
+     * @return 监听者编号，用于 removeReplyListener
+     */
+    static int addReplyListener(ReplyListener listener);
+
+    /**
+     * @brief 注销 0xD1 回复监听者
+     */
+    static void removeReplyListener(int id);
+
 private:
     // 以下是针对不同命令ID的处理函数，可以根据业务逻辑做更详细的拆分
     void handleD1(const uint8_t* data, uint16_t length);
@@ -30,7 +49,15 @@ private:
     void handleA8(const uint8_t* data, uint16_t length);
 
 private:
+    // 遥测帧解析在 arena 上进行，每帧处理完 Reset()；初始块随对象分配，稳态下解析不再申请堆内存
+    alignas(8) char m_arenaBlock[16 * 1024];
+    google::protobuf::Arena m_arena;
+
+    std::vector<uint8_t> m_plainReply; // 加密 0xD1 回复的解密缓冲，逐帧复用
+
     TelemetryUI m_telemetryUI; // 用于显示遥测数据的UI
+    StatePublisher m_statePublisher; // 最新状态写入共享内存，供本机其他进程读取
+    ShmFrameWriter m_frameWriter;    // 全部解析帧写入共享内存帧流环，供本机其他进程订阅
 };
 
 #endif // FRAMEDATAHANDLER_H
@@ -0,0 +1,456 @@
+#include "QueryServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "CLI2Frame.h"
+#include "CommandChannel.h"
+#include "utils/AsyncLogger.h"
+
+QueryServer g_queryServer;
+
+namespace {
+
+using google::protobuf::FieldDescriptor;
+using google::protobuf::Reflection;
+
+void appendU32(std::string& s, uint32_t v)
+{
+    const char b[4] = {char(v >> 24), char(v >> 16), char(v >> 8), char(v)};
+    s.append(b, 4);
+}
+
+uint32_t readU32(const char* p)
+{
+    const auto* u = reinterpret_cast<const uint8_t*>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+uint64_t readU64(const char* p)
+{
+    return (uint64_t(readU32(p)) << 32) | readU32(p + 4);
+}
+
+// TelemetryData 只有单值的标量 / 字符串字段
+void copyField(const TelemetryData& src, TelemetryData& dst, const FieldDescriptor* f)
+{
+    const Reflection* r = src.GetReflection();
+    switch (f->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_DOUBLE: r->SetDouble(&dst, f, r->GetDouble(src, f)); break;
+    case FieldDescriptor::CPPTYPE_FLOAT:  r->SetFloat(&dst, f, r->GetFloat(src, f)); break;
+    case FieldDescriptor::CPPTYPE_INT32:  r->SetInt32(&dst, f, r->GetInt32(src, f)); break;
+    case FieldDescriptor::CPPTYPE_INT64:  r->SetInt64(&dst, f, r->GetInt64(src, f)); break;
+    case FieldDescriptor::CPPTYPE_UINT32: r->SetUInt32(&dst, f, r->GetUInt32(src, f)); break;
+    case FieldDescriptor::CPPTYPE_UINT64: r->SetUInt64(&dst, f, r->GetUInt64(src, f)); break;
+    case FieldDescriptor::CPPTYPE_BOOL:   r->SetBool(&dst, f, r->GetBool(src, f)); break;
+    case FieldDescriptor::CPPTYPE_STRING: r->SetString(&dst, f, r->GetString(src, f)); break;
+    default: break;
+    }
+}
+
+// 通过接口只接受立即生成控制帧的命令；batch / script / route plan / 云台摇杆模式等会阻塞事件循环
+bool isRemoteCommand(const std::string& line)
+{
+    std::istringstream iss(line);
+    std::string first, second, third;
+    iss >> first >> second >> third;
+    if (first == "gimbal" && (third == "joystick" || third == "stream")) {
+        return false;
+    }
+    static const char* kAllowed[] = {"takeoff", "land", "rth", "brake", "goto", "home",
+                                     "gimbal", "camera", "control", "obstacle"};
+    for (const char* cmd : kAllowed) {
+        if (first == cmd) {
+            return true;
+        }
+    }
+    return first == "route" && (second == "start" || second == "pause" || second == "resume" || second == "stop");
+}
+
+} // namespace
+
+bool QueryServer::start(EventLoop& loop, const std::string& path, size_t historyDepth, bool allowCommands)
+{
+    if (path.empty() || m_listenFd >= 0) {
+        return false;
+    }
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[QueryServer] Socket path too long: " << path << "\n";
+        return false;
+    }
+    // 只替换上次异常退出留下的套接字文件，路径被普通文件 / 符号链接等占用时不删除
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            std::cerr << "[QueryServer] " << path << " exists and is not a socket\n";
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "[QueryServer] socket failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    // 套接字文件在 bind 时按 umask 创建：直接以仅属主可访问的权限创建，不留先创建后 chmod 的窗口
+    const mode_t oldMask = ::umask(077);
+    const int bound = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::umask(oldMask);
+    if (bound < 0 || ::listen(fd, 16) < 0) {
+        std::cerr << "[QueryServer] bind/listen " << path << " failed: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(m_dataMutex);
+        m_history.assign(historyDepth, HistoryRecord());
+        for (HistoryRecord& r : m_history) {
+            r.boxSn.reserve(32);
+            r.bytes.reserve(kRecordReserve);
+        }
+        m_historyNext  = 0;
+        m_historyCount = 0;
+        m_recording    = true;
+    }
+    m_loop          = &loop;
+    m_listenFd      = fd;
+    m_path          = path;
+    m_allowCommands = allowCommands;
+    loop.runInLoop([this, fd] {
+        m_loop->addFd(fd, EPOLLIN, [this](uint32_t) { onAccept(); });
+    });
+    std::cout << "[QueryServer] Listening on " << path << " (history " << historyDepth << " records, commands "
+              << (allowCommands ? "enabled" : "disabled") << ")\n";
+    return true;
+}
+
+void QueryServer::stop()
+{
+    const int fd = m_listenFd;
+    if (fd < 0) {
+        return;
+    }
+    m_listenFd = -1;
+    {
+        std::lock_guard<std::mutex> lk(m_dataMutex);
+        m_recording = false;
+    }
+    m_loop->runInLoop([this, fd] {
+        m_loop->removeFd(fd);
+        ::close(fd);
+        ::unlink(m_path.c_str());
+        while (!m_clients.empty()) {
+            closeClient(m_clients.begin()->first);
+        }
+    });
+}
+
+void QueryServer::onTelemetry(const TelemetryData& data, const uint8_t* bytes, size_t length)
+{
+    std::lock_guard<std::mutex> lk(m_dataMutex);
+    if (!m_recording) {
+        return;
+    }
+    // 新的云盒只在首次出现时插入一次（预热期间）并按槽位大小预留，之后原地覆盖
+    auto it = m_latestTelemetry.find(data.boxsn());
+    if (it == m_latestTelemetry.end()) {
+        it = m_latestTelemetry.emplace(data.boxsn(), std::string()).first;
+        it->second.reserve(kRecordReserve);
+    }
+    it->second.assign(reinterpret_cast<const char*>(bytes), length);
+    m_lastTelemetry = &it->second;
+
+    if (m_history.empty()) {
+        return;
+    }
+    HistoryRecord& rec = m_history[m_historyNext];
+    rec.timestamp = data.timestamp();
+    rec.boxSn.assign(data.boxsn());
+    rec.bytes.assign(reinterpret_cast<const char*>(bytes), length);
+    m_historyNext = (m_historyNext + 1) % m_history.size();
+    m_historyCount = std::min(m_historyCount + 1, m_history.size());
+}
+
+void QueryServer::onUavState(const UavState& state, const uint8_t* bytes, size_t length)
+{
+    std::lock_guard<std::mutex> lk(m_dataMutex);
+    if (!m_recording) {
+        return;
+    }
+    auto it = m_latestUavState.find(state.boxsn());
+    if (it == m_latestUavState.end()) {
+        it = m_latestUavState.emplace(state.boxsn(), std::string()).first;
+        it->second.reserve(kRecordReserve);
+    }
+    it->second.assign(reinterpret_cast<const char*>(bytes), length);
+    m_lastUavState = &it->second;
+}
+
+void QueryServer::onAccept()
+{
+    int fd;
+    while ((fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        Client c;
+        c.id = m_nextClientId++;
+        m_clients.emplace(fd, std::move(c));
+        m_loop->addFd(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { onClientEvent(fd, events); });
+    }
+}
+
+void QueryServer::onClientEvent(int fd, uint32_t events)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    Client& c = it->second;
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeClient(fd);
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        char buf[4096];
+        while (true) {
+            const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                c.in.append(buf, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                closeClient(fd);
+                return;
+            }
+            if (errno != EINTR) {
+                break;
+            }
+        }
+
+        // 连接上可能一次到达多个请求，全部处理后统一写出
+        size_t pos = 0;
+        while (c.in.size() - pos >= 4) {
+            const uint32_t len = readU32(c.in.data() + pos);
+            if (len < 5 || len > kMaxRequestBytes) {
+                LOG_WARN_RL("QueryServer", 1, "Bad request length {}, closing client.", len);
+                closeClient(fd);
+                return;
+            }
+            if (c.in.size() - pos < 4 + len) {
+                break;
+            }
+            const char* p = c.in.data() + pos + 4;
+            handleRequest(fd, static_cast<uint8_t>(p[0]), readU32(p + 1), p + 5, len - 5);
+            pos += 4 + len;
+        }
+        c.in.erase(0, pos);
+    }
+    if (!flush(fd, c)) {
+        closeClient(fd);
+    }
+}
+
+void QueryServer::handleRequest(int fd, uint8_t type, uint32_t reqId, const char* payload, size_t len)
+{
+    std::string out;
+    const std::string text(payload, len);   // 云盒编号或命令文本
+    switch (type) {
+    case GetTelemetry:
+    case GetUavState: {
+        // 保存的就是序列化字节，原样作为应答负载
+        const bool telemetry = type == GetTelemetry;
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lk(m_dataMutex);
+            const auto& latest = telemetry ? m_latestTelemetry : m_latestUavState;
+            const std::string* rec = telemetry ? m_lastTelemetry : m_lastUavState;
+            if (!text.empty()) {
+                auto it = latest.find(text);
+                rec = it == latest.end() ? nullptr : &it->second;
+            }
+            if (rec) {
+                out = *rec;
+                found = true;
+            }
+        }
+        if (!found) {
+            reply(fd, Error, reqId, telemetry ? "no telemetry received" : "no uav state received");
+            return;
+        }
+        break;
+    }
+    case GetHistory:
+        if (len < 21) {
+            reply(fd, Error, reqId, "history request too short");
+            return;
+        }
+        if (!handleHistory(out, payload, len)) {
+            reply(fd, Error, reqId, "bad history request or unknown field");
+            return;
+        }
+        break;
+    case SubmitCommand:
+        handleCommand(fd, reqId, text);
+        return;
+    default:
+        reply(fd, Error, reqId, "unknown request type");
+        return;
+    }
+    reply(fd, type | 0x80, reqId, out);
+}
+
+bool QueryServer::handleHistory(std::string& out, const char* payload, size_t len)
+{
+    const uint64_t from     = readU64(payload);
+    const uint64_t to       = readU64(payload + 8);
+    const uint32_t maxCount = readU32(payload + 16);
+    const size_t   nameLen  = static_cast<uint8_t>(payload[20]);
+    if (21 + nameLen > len) {
+        return false;
+    }
+    const std::string field(payload + 21, nameLen);
+    const std::string boxSn(payload + 21 + nameLen, len - 21 - nameLen);
+
+    const FieldDescriptor* fd = nullptr;
+    if (!field.empty()) {
+        fd = TelemetryData::descriptor()->FindFieldByName(field);
+        if (!fd || fd->is_repeated()) {
+            return false;
+        }
+    }
+
+    // 锁内从新到旧拷出记录字节（假定同一架飞机的时间戳不减），锁外解析并拼装应答
+    std::vector<std::string> picked;
+    {
+        std::lock_guard<std::mutex> lk(m_dataMutex);
+        const size_t depth = m_history.size();
+        for (size_t i = 0; i < m_historyCount && picked.size() < maxCount; ++i) {
+            const HistoryRecord& rec = m_history[(m_historyNext + depth - 1 - i) % depth];
+            if (!boxSn.empty() && rec.boxSn != boxSn) {
+                continue;
+            }
+            if (rec.timestamp < from) {
+                break;
+            }
+            if (rec.timestamp <= to) {
+                picked.push_back(rec.bytes);
+            }
+        }
+    }
+
+    TelemetryList list;
+    list.mutable_telemetrylist()->Reserve(static_cast<int>(picked.size()));
+    TelemetryData src;
+    for (auto it = picked.rbegin(); it != picked.rend(); ++it) {
+        TelemetryData* dst = list.add_telemetrylist();
+        if (!fd) {
+            dst->ParseFromString(*it);
+            continue;
+        }
+        src.ParseFromString(*it);
+        dst->set_timestamp(src.timestamp());
+        dst->set_boxsn(src.boxsn());
+        copyField(src, *dst, fd);
+    }
+    return list.SerializeToString(&out);
+}
+
+void QueryServer::handleCommand(int fd, uint32_t reqId, const std::string& line)
+{
+    if (!m_allowCommands) {
+        reply(fd, Error, reqId, "command submission disabled (set queryAllowCommands)");
+        return;
+    }
+    if (!isRemoteCommand(line)) {
+        reply(fd, Error, reqId, "command not allowed over query socket");
+        return;
+    }
+    DataFrame frame;
+    try {
+        frame = parseCommand(line);
+    } catch (const std::exception& e) {
+        reply(fd, Error, reqId, std::string("invalid command: ") + e.what());
+        return;
+    }
+    if (frame.size() <= 19 || frame[19] != 0xD1) {
+        reply(fd, Error, reqId, "invalid command");
+        return;
+    }
+
+    // 回调在解析线程或事件循环中执行，应答统一回到事件循环
+    const uint64_t clientId = m_clients[fd].id;
+    g_commandChannel.submit(std::move(frame), [this, fd, clientId, reqId](const CommandChannel::Result& r) {
+        std::string payload;
+        payload.push_back(static_cast<char>(r.status));
+        payload.push_back(static_cast<char>(r.action));
+        payload.push_back(static_cast<char>(r.reply.execResult));
+        appendU32(payload, r.reply.errorCode);
+        payload.push_back(static_cast<char>(r.attempts >> 8));
+        payload.push_back(static_cast<char>(r.attempts));
+        appendU32(payload, static_cast<uint32_t>(r.rttMs * 1000.0));
+
+        m_loop->runInLoop([this, fd, clientId, reqId, payload] {
+            auto it = m_clients.find(fd);
+            if (it == m_clients.end() || it->second.id != clientId) {
+                return;   // 客户端已断开
+            }
+            reply(fd, SubmitCommand | 0x80, reqId, payload);
+            if (!flush(fd, it->second)) {
+                closeClient(fd);
+            }
+        });
+    });
+}
+
+void QueryServer::reply(int fd, uint8_t type, uint32_t reqId, const std::string& payload)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    std::string& out = it->second.out;
+    appendU32(out, static_cast<uint32_t>(5 + payload.size()));
+    out.push_back(static_cast<char>(type));
+    appendU32(out, reqId);
+    out.append(payload);
+}
+
+bool QueryServer::flush(int fd, Client& c)
+{
+    while (!c.out.empty()) {
+        const ssize_t n = ::send(fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            c.out.erase(0, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    const bool needWrite = !c.out.empty();
+    if (needWrite != c.wantWrite) {
+        m_loop->modifyFd(fd, EPOLLIN | EPOLLRDHUP | (needWrite ? uint32_t(EPOLLOUT) : 0u));
+        c.wantWrite = needWrite;
+    }
+    return true;
+}
+
+void QueryServer::closeClient(int fd)
+{
+    m_loop->removeFd(fd);
+    ::close(fd);
+    m_clients.erase(fd);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TelemetryDataBuf-new.pb.h"
+#include "utils/EventLoop.h"
+
+/**
+ * @brief 本机查询接口：Unix 域套接字上的请求 / 应答，供自动化脚本读取飞机状态、提交命令，
+ *        代替解析 CLI 输出。全部在 g_eventLoop 中处理，不为请求创建线程。
+ *
+ *        帧格式（请求与应答相同，整数均为大端）：
+ *            [u32 长度（含其后所有字节）][u8 类型][u32 请求号][负载]
+ *        应答的类型为请求类型 | 0x80，请求号原样返回；出错时类型为 0xFF，负载为 UTF-8 错误信息。
+ *
+ *        | 请求                 | 负载                                              | 应答负载
+ *        |----------------------|---------------------------------------------------|-------------------------------
+ *        | 0x01 最新遥测        | 云盒编号（空表示最近更新的一架）                  | TelemetryData
+ *        | 0x02 最新飞机状态    | 云盒编号（同上）                                  | UavState
+ *        | 0x03 遥测历史        | [u64 起始时间戳][u64 结束时间戳][u32 最多条数]    | TelemetryList，每条只含
+ *        |                      | [u8 字段名长度][字段名][云盒编号]                 | timestamp、boxSn 与所选字段
+ *        |                      | 字段名为 TelemetryData 的字段名，空表示整条记录   | （按时间升序，取最新的若干条）
+ *        | 0x04 提交命令        | CLI 命令文本，如 "gimbal move abs -30 0 0"        | [u8 状态][u8 动作][u8 执行结果]
+ *        |                      | （仅控制命令，经 CommandChannel 排队发送）        | [u32 错误码][u16 发送次数][u32 RTT 微秒]
+ *
+ *        0x04 只有在配置 queryAllowCommands 为 true 时才受理，否则应答错误；套接字文件只对属主开放。
+ *        状态取值与 CommandChannel::Status 一致（0=Ok 1=Rejected 2=Timeout 3=Cancelled 4=Invalid）；
+ *        命令在收到回复或超时后才应答，同一连接上的其他请求不必等待，按请求号区分。
+ */
+class QueryServer
+{
+public:
+    enum Type : uint8_t {
+        GetTelemetry  = 0x01,
+        GetUavState   = 0x02,
+        GetHistory    = 0x03,
+        SubmitCommand = 0x04,
+        Error         = 0xFF,
+    };
+
+    static constexpr uint32_t kMaxRequestBytes = 64 * 1024;
+
+    /**
+     * @brief 在 path 上监听（已存在的套接字文件会被替换，其他类型的文件则拒绝启动），
+     *        historyDepth 为保留的遥测条数，allowCommands 为 false 时拒绝 0x04 提交命令
+     */
+    bool start(EventLoop& loop, const std::string& path, size_t historyDepth, bool allowCommands);
+    void stop();
+
+    /**
+     * @brief 记录解析结果（解析线程调用）；未启动时直接返回
+     * @param bytes / length 帧中的 protobuf 原始字节，按原样保存，查询时再解析
+     *
+     *        在遥测处理路径上调用，稳态下不分配内存：历史槽位在 start() 时预分配，
+     *        写入只是拷贝字节（仅当某条记录大于槽位已有容量时扩容一次）
+     */
+    void onTelemetry(const TelemetryData& data, const uint8_t* bytes, size_t length);
+    void onUavState(const UavState& state, const uint8_t* bytes, size_t length);
+
+private:
+    static constexpr size_t kRecordReserve = 512;   ///< 每个历史槽位预分配的字节数（0xA9 通常约 200 字节）
+
+    struct HistoryRecord {
+        uint64_t    timestamp = 0;
+        std::string boxSn;
+        std::string bytes;   ///< TelemetryData 序列化字节
+    };
+
+    struct Client {
+        uint64_t    id = 0;          ///< 区分复用的 fd，异步应答前校验
+        std::string in;
+        std::string out;
+        bool        wantWrite = false;
+    };
+
+    void onAccept();
+    void onClientEvent(int fd, uint32_t events);
+    void handleRequest(int fd, uint8_t type, uint32_t reqId, const char* payload, size_t len);
+    bool handleHistory(std::string& out, const char* payload, size_t len);
+    void handleCommand(int fd, uint32_t reqId, const std::string& line);
+    void reply(int fd, uint8_t type, uint32_t reqId, const std::string& payload);
+    bool flush(int fd, Client& c);
+    void closeClient(int fd);
+
+private:
+    EventLoop*  m_loop     = nullptr;
+    int         m_listenFd = -1;
+    std::string m_path;
+    bool        m_allowCommands = false;
+    uint64_t    m_nextClientId = 1;
+    std::unordered_map<int, Client> m_clients;   ///< 仅事件循环线程访问
+
+    // 解析线程写、事件循环读：锁内只拷贝字节，解析与拼装应答在锁外进行
+    std::mutex                                   m_dataMutex;
+    bool                                         m_recording = false;
+    std::vector<HistoryRecord>                   m_history;            ///< 环形缓冲，容量为 historyDepth
+    size_t                                       m_historyNext  = 0;   ///< 下一条写入的槽位
+    size_t                                       m_historyCount = 0;
+    std::unordered_map<std::string, std::string> m_latestTelemetry;    ///< 云盒编号 -> 最新一条的字节
+    std::unordered_map<std::string, std::string> m_latestUavState;
+    const std::string*                           m_lastTelemetry = nullptr;   ///< 指向上面 map 中的值（节点地址不变）
+    const std::string*                           m_lastUavState  = nullptr;
+};
+
+extern QueryServer g_queryServer;
@@ -1,4 +1,7 @@
 #include "ReplyFrameDecoder.h"
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
+#include "TelemetryRelay.h"
 
 ReplyFrameDecoder::ReplyFrameDecoder()
 {
@@ -10,31 +13,41 @@ void ReplyFrameDecoder::setDecodeCallback(std::function<void(uint8_t, const uint
     decode_callback_ = callback;
 }
 
-void ReplyFrameDecoder::runDecodeThread()
+void ReplyFrameDecoder::runDecodeThread(const StopToken& stop)
 {
     std::cout << "[ReplyFrameDecoder] runDecodeThread started.\n";
 
-    while (true) {
-        // 等待队列中有数据
+    while (!stop.stopRequested()) {
+        // 等待队列中有数据或停止
         std::unique_lock<std::mutex> lock(g_completeQueueMutex);
-        g_completeQueueCond.wait(lock, [] {
-            return !g_completeDataFrameQueue.empty();
-        });
+        stop.wait(lock, g_completeQueueCond, [] { return !g_completeDataFrameQueue.empty(); });
+        if (stop.stopRequested()) {
+            break;
+        }
 
         // 取出一帧数据
-        DataFrame frame = g_completeDataFrameQueue.front();
+        Metrics::setGauge(Metrics::CompleteQueueDepth, g_completeDataFrameQueue.size());
+        StampedFrame frame = std::move(g_completeDataFrameQueue.front());
         g_completeDataFrameQueue.pop();
 
         lock.unlock();
 
-        // std::cout << "[ReplyFrameDecoder] Received a frame of size: " << frame.size() << std::endl;
-        
+        // std::cout << "[ReplyFrameDecoder] Received a frame of size: " << frame.data.size() << std::endl;
+
         // 将该帧的每一个字节送入解析器
+        recv_ns      = frame.recvNs;
+        assembled_ns = frame.assembledNs;
+        Tracer::setCurrentFlow(frame.traceId);
+        Tracer::Scope traceScope("decode", frame.traceId, Tracer::Flow::Step);
         read_state  = 0;
-        for (uint8_t byte_data : frame) {
+        for (uint8_t byte_data : frame.data) {
             processByte(byte_data);
         }
+
+        // 解析完的整帧交给中继转发（移入共享缓冲，不拷贝）
+        g_telemetryRelay.publish(std::move(frame.data));
     }
+    std::cout << "[ReplyFrameDecoder] runDecodeThread exiting...\n";
 }
 
 void ReplyFrameDecoder::resetState()
@@ -104,9 +117,17 @@ void ReplyFrameDecoder::processSrcData(uint8_t data)
         // 一帧解析完毕, 可以在这里触发回调或处理数据
         // -----------------------------------------
         // 如果设置了回调函数，则将解析结果抛给外部
+        const uint64_t decodedNs = Metrics::nowNs();
+        Metrics::recordStage(Metrics::AssembledToDecoded, assembled_ns, decodedNs);
+        Metrics::add(Metrics::FramesDecoded);
         if (decode_callback_) {
             decode_callback_(command_id, src_data_bytes, src_data_length);
         }
+        const uint64_t handledNs = Metrics::nowNs();
+        Metrics::recordStage(Metrics::DecodedToHandled, decodedNs, handledNs);
+        Metrics::recordStage(Metrics::RecvToHandled, recv_ns, handledNs);
+        Metrics::add(Metrics::FramesHandled);
+        Tracer::checkTrigger(recv_ns, handledNs);
         // -----------------------------------------
 
         // 重置
@@ -9,6 +9,7 @@
 #include <functional>     // std::function
 
 #include "common_types.h" // 这里可以包含 extern 声明的全局队列、互斥量等
+#include "utils/StopToken.h"
 
 // ----------------------------------------------------------------------------
 // 回复数据帧格式
@@ -25,6 +26,8 @@ class ReplyFrameDecoder
 {
     // 让 TasksManager 可以直接调用本类的私有成员（包括线程函数）
     friend class TasksManager;
+    // 微基准（bench/micro_bench.cpp）直接驱动解析函数
+    friend struct BenchAccess;
 
 public:
     ReplyFrameDecoder();
@@ -40,9 +43,10 @@ public:
 
     /**
      * @brief 线程函数（**不在内部创建线程**），调用者在外部自行开启线程执行本函数。
-     *        该函数会阻塞等待队列中出现新的数据帧，并将其逐字节送入状态机进行解析。
+     *        该函数会阻塞等待队列中出现新的数据帧，并将其逐字节送入状态机进行解析，直到 stop 被请求。
+     *        停止时队列中尚未解析的完整帧原样保留，重启后继续处理。
      */
-    void runDecodeThread();
+    void runDecodeThread(const StopToken& stop);
 
     // 打印已接收的整个帧，仅作调试用
     void printMsgData();
@@ -86,6 +90,10 @@ private:
     uint16_t read_count;
     uint8_t  last_data;
 
+    // 当前帧的接收 / 组装时刻，用于阶段时延统计
+    uint64_t recv_ns      = 0;
+    uint64_t assembled_ns = 0;
+
     // 完整解析后回调函数
     std::function<void(uint8_t, const uint8_t*, uint16_t)> decode_callback_;
 };
@@ -0,0 +1,423 @@
+#include "RouteGenerator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr double kPi           = 3.14159265358979323846;
+constexpr double kDegToRad     = kPi / 180.0;
+constexpr double kEarthRadius  = 6378137.0;   ///< WGS84 长半轴(米)
+
+constexpr uint32_t kDefaultHOverlap = 70;     ///< 横向重叠率缺省值(%)
+constexpr uint32_t kDefaultVOverlap = 80;     ///< 纵向重叠率缺省值(%)
+constexpr uint32_t kMaxOverlap      = 95;
+constexpr double   kDampingShare    = 0.45;   ///< 协调转弯半径占相邻航段长度的上限比例
+constexpr double   kMinPointSpacing = 1.0;    ///< 相邻航点最小间距(米)，高于 RouteValidator 的 minSegmentLength
+
+// 航点动作类型（见 PointAction.type）
+constexpr uint32_t kActionTakePhoto        = 2;
+constexpr uint32_t kActionGimbalPitch      = 6;
+constexpr uint32_t kActionDistanceInterval = 10;
+constexpr uint32_t kActionStopInterval     = 12;
+
+struct Vec2 {
+    double x;
+    double y;
+};
+
+/**
+ * @brief 经纬度 <-> 局部平面坐标（米，x 向东，y 向北）
+ */
+class LocalFrame
+{
+public:
+    LocalFrame(double lng0, double lat0)
+        : m_lng0(lng0)
+        , m_lat0(lat0)
+        , m_ky(kEarthRadius * kDegToRad)
+        , m_kx(kEarthRadius * kDegToRad * std::cos(lat0 * kDegToRad))
+    {
+    }
+
+    Vec2 toLocal(double lng, double lat) const
+    {
+        return { (lng - m_lng0) * m_kx, (lat - m_lat0) * m_ky };
+    }
+
+    void toGeo(const Vec2& p, double& lng, double& lat) const
+    {
+        lng = m_lng0 + p.x / m_kx;
+        lat = m_lat0 + p.y / m_ky;
+    }
+
+private:
+    double m_lng0;
+    double m_lat0;
+    double m_ky;
+    double m_kx;
+};
+
+// 扫描线与多边形相交得到的一段（u 为沿航线方向坐标，v 为扫描线位置）
+struct Segment {
+    int    line;
+    double v;
+    double u0;
+    double u1;
+};
+
+double dist(const Vec2& a, const Vec2& b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// 多边形面积加权质心；退化时取顶点均值
+Vec2 centroid(const std::vector<Vec2>& poly)
+{
+    double a = 0.0, cx = 0.0, cy = 0.0;
+    for (size_t i = 0, n = poly.size(); i < n; ++i) {
+        const Vec2& p = poly[i];
+        const Vec2& q = poly[(i + 1) % n];
+        const double cross = p.x * q.y - q.x * p.y;
+        a  += cross;
+        cx += (p.x + q.x) * cross;
+        cy += (p.y + q.y) * cross;
+    }
+    if (std::fabs(a) > 1e-6) {
+        return { cx / (3.0 * a), cy / (3.0 * a) };
+    }
+    Vec2 m {0.0, 0.0};
+    for (const Vec2& p : poly) {
+        m.x += p.x;
+        m.y += p.y;
+    }
+    return { m.x / poly.size(), m.y / poly.size() };
+}
+
+PointData* addPoint(PlanLineData& plan, const LocalFrame& frame, const Vec2& p,
+                    float height, float speed, uint32_t flightPathMode)
+{
+    PointData* pt = plan.add_points();
+    double lng = 0.0, lat = 0.0;
+    frame.toGeo(p, lng, lat);
+    pt->set_lng(lng);
+    pt->set_lat(lat);
+    pt->set_height(height);
+    pt->set_speed(speed);
+    pt->set_flightpathmode(flightPathMode);
+    pt->set_interestindex(-1);
+    return pt;
+}
+
+void addAction(PointData* pt, uint32_t type, float param)
+{
+    PointAction* a = pt->add_actions();
+    a->set_type(type);
+    a->set_param(param);
+}
+
+/**
+ * @brief 为 [first, end) 中协调转弯（flightPathMode 2）的航点设置 dampingDistance
+ *
+ *        转弯半径取 radius，限制在 1~655.35 米内且不超过相邻航段的 45%（低于校验要求的一半，
+ *        给局部平面距离与 haversine 距离之间的差异留出余量）；
+ *        相邻航段过短、得不到 1 米以上的半径时，该航点退回为停稳转弯（flightPathMode 1）。
+ */
+void setDampingDistance(PlanLineData& plan, int first, const LocalFrame& frame, double radius)
+{
+    const int n = plan.points_size();
+    auto localAt = [&](int i) {
+        const PointData& p = plan.points(i);
+        return frame.toLocal(p.lng(), p.lat());
+    };
+    for (int i = first; i < n; ++i) {
+        PointData* pt = plan.mutable_points(i);
+        if (pt->flightpathmode() != 2) {
+            continue;
+        }
+        const Vec2 here = localAt(i);
+        double d = std::min(radius, 655.35);
+        if (i > first) {
+            d = std::min(d, dist(here, localAt(i - 1)) * kDampingShare);
+        }
+        if (i + 1 < n) {
+            d = std::min(d, dist(here, localAt(i + 1)) * kDampingShare);
+        }
+        d = std::floor(d * 100.0) / 100.0;   // 按厘米向下取整
+        if (d < 1.0) {
+            pt->set_flightpathmode(1);
+            continue;
+        }
+        pt->set_dampingdistance(static_cast<float>(d));
+    }
+}
+
+} // namespace
+
+bool RouteGenerator::fail(const std::string& msg)
+{
+    m_error = msg;
+    return false;
+}
+
+float RouteGenerator::pointSpeed(const PlanLineData& planData) const
+{
+    if (m_opts.speed > 0) {
+        return m_opts.speed;
+    }
+    return planData.autospeed() > 0 ? planData.autospeed() : 8.0f;
+}
+
+bool RouteGenerator::generate(PlanLineData& planData)
+{
+    m_error.clear();
+    if (planData.has_normalmodel() && planData.normalmodel().area_size() > 0) {
+        planData.clear_points();
+        return generateNormal(planData.normalmodel(), planData);
+    }
+    if (planData.has_surroundmodel() && planData.surroundmodel().area_size() > 0) {
+        planData.clear_points();
+        return generateSurround(planData.surroundmodel(), planData);
+    }
+    return fail("no normalModel/surroundModel area in plan");
+}
+
+// ------------------------------------------------------------------
+// 普通建模：弓字形扫描
+// ------------------------------------------------------------------
+bool RouteGenerator::generateNormal(const NormalModel& model, PlanLineData& planData)
+{
+    if (model.area_size() < 3) {
+        return fail("normalModel.area needs at least 3 points");
+    }
+    if (model.height() < 20 || model.height() > 1500) {
+        return fail("normalModel.height out of range (20~1500)");
+    }
+    const uint32_t hOverlap = model.hoverlap() ? model.hoverlap() : kDefaultHOverlap;
+    const uint32_t vOverlap = model.voverlap() ? model.voverlap() : kDefaultVOverlap;
+    if (hOverlap > kMaxOverlap || vOverlap > kMaxOverlap) {
+        return fail("normalModel overlap must be below 95%");
+    }
+
+    // 1. 覆盖尺寸 -> 航线间距与拍照间距
+    const double h         = model.height();
+    const double across    = 2.0 * h * std::tan(m_opts.camera.hfovDeg * kDegToRad / 2.0);
+    const double along     = 2.0 * h * std::tan(m_opts.camera.vfovDeg * kDegToRad / 2.0);
+    const double spacing   = across * (1.0 - hOverlap / 100.0);
+    const double photoDist = along  * (1.0 - vOverlap / 100.0);
+    if (!(spacing > 0.1) || !(photoDist > 0.1)) {
+        return fail("invalid camera field of view");
+    }
+
+    // 2. 区域投影到局部平面；南北向航线时交换坐标轴，使扫描线始终沿 u 方向
+    const LocalFrame frame(model.area(0).lng(), model.area(0).lat());
+    const bool northSouth = (model.direction() != 2);
+    std::vector<Vec2> poly;   // (u, v)
+    poly.reserve(model.area_size());
+    for (const PointData& p : model.area()) {
+        const Vec2 xy = frame.toLocal(p.lng(), p.lat());
+        poly.push_back(northSouth ? Vec2{xy.y, xy.x} : xy);
+    }
+    auto toXY = [northSouth](double u, double v) { return northSouth ? Vec2{v, u} : Vec2{u, v}; };
+
+    double vMin = std::numeric_limits<double>::max();
+    double vMax = std::numeric_limits<double>::lowest();
+    for (const Vec2& p : poly) {
+        vMin = std::min(vMin, p.y);
+        vMax = std::max(vMax, p.y);
+    }
+
+    // 3. 扫描线居中排布并与多边形求交（半开区间规则处理恰好落在顶点上的情况）
+    const int numLines = std::max(1, static_cast<int>(std::ceil((vMax - vMin) / spacing)));
+    const double vStart = vMin + ((vMax - vMin) - (numLines - 1) * spacing) / 2.0;
+
+    std::vector<Segment> segments;
+    std::vector<std::vector<int>> lineSegs(numLines);
+    std::vector<double> xs;
+    for (int line = 0; line < numLines; ++line) {
+        const double v = vStart + line * spacing;
+        xs.clear();
+        for (size_t i = 0, n = poly.size(); i < n; ++i) {
+            const Vec2& a = poly[i];
+            const Vec2& b = poly[(i + 1) % n];
+            if ((a.y <= v && v < b.y) || (b.y <= v && v < a.y)) {
+                xs.push_back(a.x + (v - a.y) * (b.x - a.x) / (b.y - a.y));
+            }
+        }
+        std::sort(xs.begin(), xs.end());
+        for (size_t k = 0; k + 1 < xs.size(); k += 2) {
+            if (xs[k + 1] - xs[k] < kMinPointSpacing) {
+                continue;   // 过短的片段不值得飞
+            }
+            lineSegs[line].push_back(static_cast<int>(segments.size()));
+            segments.push_back({line, v, xs[k], xs[k + 1]});
+        }
+    }
+    if (segments.empty()) {
+        return fail("normalModel.area is too small for the given height/overlap");
+    }
+
+    // 4. 排序：从首条（mirror=2 时为末条）扫描线出发，每次飞向邻近扫描线中最近的片段端点
+    const int firstLine = (model.mirror() == 2) ? numLines - 1 : 0;
+    int startLine = firstLine;
+    while (lineSegs[startLine].empty()) {
+        startLine += (model.mirror() == 2) ? -1 : 1;
+    }
+    const Segment& first = segments[lineSegs[startLine].front()];
+    Vec2 cur = toXY(first.u0, first.v);
+    int curLine = startLine;
+    size_t remaining = segments.size();
+
+    const float speed   = pointSpeed(planData);
+    const float height  = static_cast<float>(model.height());
+    const uint32_t fpm  = model.flightpathmode() ? model.flightpathmode() : 1;
+    // 倾斜模式使用配置的俯仰角（字段为 uint32，负值可能以补码形式存放），正摄模式垂直向下
+    const int32_t cfgPitch = static_cast<int32_t>(model.pitch());
+    const float pitch   = (model.mode() == 1 && cfgPitch != 0) ? -static_cast<float>(std::abs(cfgPitch)) : -90.0f;
+    const float interval = static_cast<float>(std::min(100.0, std::max(1.0, photoDist)));
+
+    planData.mutable_points()->Reserve(planData.points_size() +
+        static_cast<int>(m_opts.photoAtWaypoints ? segments.size() * 8 : segments.size() * 2));
+    bool firstPoint = true;
+    const int firstIndex = planData.points_size();
+
+    constexpr int kSearchLines = 2;
+    while (remaining > 0) {
+        int bestIdx = -1;
+        bool bestReversed = false;
+        double bestDist = std::numeric_limits<double>::max();
+        auto consider = [&](int line) {
+            for (int idx : lineSegs[line]) {
+                const Segment& s = segments[idx];
+                const double d0 = dist(cur, toXY(s.u0, s.v));
+                const double d1 = dist(cur, toXY(s.u1, s.v));
+                if (d0 < bestDist) { bestDist = d0; bestIdx = idx; bestReversed = false; }
+                if (d1 < bestDist) { bestDist = d1; bestIdx = idx; bestReversed = true; }
+            }
+        };
+        for (int l = std::max(0, curLine - kSearchLines); l <= std::min(numLines - 1, curLine + kSearchLines); ++l) {
+            consider(l);
+        }
+        if (bestIdx < 0) {
+            for (int l = 0; l < numLines; ++l) {
+                consider(l);
+            }
+        }
+
+        // 从候选列表中移除
+        const Segment seg = segments[bestIdx];
+        auto& list = lineSegs[seg.line];
+        list.erase(std::find(list.begin(), list.end(), bestIdx));
+        --remaining;
+
+        const double uFrom = bestReversed ? seg.u1 : seg.u0;
+        const double uTo   = bestReversed ? seg.u0 : seg.u1;
+        const Vec2 entry = toXY(uFrom, seg.v);
+        const Vec2 exit  = toXY(uTo, seg.v);
+
+        if (m_opts.photoAtWaypoints) {
+            const double len = std::fabs(uTo - uFrom);
+            const int shots = static_cast<int>(std::floor(len / photoDist)) + 1;
+            const double dir = (uTo > uFrom) ? 1.0 : -1.0;
+            // 段末端距最后一个曝光点过近时，把该曝光点并到末端，避免生成几乎重合的航点
+            const bool mergeEnd = shots > 1 && len - (shots - 1) * photoDist < kMinPointSpacing;
+            for (int i = 0; i <= shots; ++i) {
+                const double t = (mergeEnd && i == shots - 1) ? len : std::min(len, i * photoDist);
+                PointData* pt = addPoint(planData, frame, toXY(uFrom + dir * t, seg.v), height, speed, fpm);
+                if (firstPoint) {
+                    addAction(pt, kActionGimbalPitch, pitch);
+                    firstPoint = false;
+                }
+                addAction(pt, kActionTakePhoto, 1);
+                if (t >= len) {
+                    break;
+                }
+            }
+        } else {
+            PointData* in = addPoint(planData, frame, entry, height, speed, fpm);
+            if (firstPoint) {
+                addAction(in, kActionGimbalPitch, pitch);
+                firstPoint = false;
+            }
+            addAction(in, kActionDistanceInterval, interval);
+            PointData* out = addPoint(planData, frame, exit, height, speed, fpm);
+            addAction(out, kActionStopInterval, 0);
+        }
+
+        cur = exit;
+        curLine = seg.line;
+    }
+
+    // 协调转弯：在相邻扫描线间掉头，转弯半径取航线间距的一半
+    if (fpm == 2) {
+        setDampingDistance(planData, firstIndex, frame, spacing / 2.0);
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// 环绕建模：绕中心等角度分布曝光点
+// ------------------------------------------------------------------
+bool RouteGenerator::generateSurround(const SurroundModel& model, PlanLineData& planData)
+{
+    if (model.area_size() < 1) {
+        return fail("surroundModel.area is empty");
+    }
+    if (model.height() < 20 || model.height() > 1500) {
+        return fail("surroundModel.height out of range (20~1500)");
+    }
+    uint32_t count = model.exposurecount();
+    if (count == 0) {
+        count = 16;
+    } else if (count != 12 && count != 16 && count != 20 && count != 24) {
+        return fail("surroundModel.exposureCount must be 12, 16, 20 or 24");
+    }
+
+    const LocalFrame frame(model.area(0).lng(), model.area(0).lat());
+    std::vector<Vec2> area;
+    area.reserve(model.area_size());
+    for (const PointData& p : model.area()) {
+        area.push_back(frame.toLocal(p.lng(), p.lat()));
+    }
+    const Vec2 center = centroid(area);
+
+    // 半径：有边界区域时取边界点到中心的平均距离，否则取作业区域顶点的最远距离
+    double radius = 0.0;
+    if (model.boundary_size() > 0) {
+        for (const PointData& p : model.boundary()) {
+            radius += dist(center, frame.toLocal(p.lng(), p.lat()));
+        }
+        radius /= model.boundary_size();
+    } else {
+        for (const Vec2& p : area) {
+            radius = std::max(radius, dist(center, p));
+        }
+    }
+    if (radius < 1.0) {
+        return fail("surroundModel radius is too small");
+    }
+
+    const float speed  = pointSpeed(planData);
+    const float height = static_cast<float>(model.height());
+    const float pitch  = static_cast<float>(-std::atan2(height, radius) / kDegToRad);
+
+    planData.mutable_points()->Reserve(planData.points_size() + static_cast<int>(count));
+    for (uint32_t i = 0; i < count; ++i) {
+        // 从正北开始顺时针
+        const double a = 2.0 * kPi * i / count;
+        const Vec2 p { center.x + radius * std::sin(a), center.y + radius * std::cos(a) };
+        PointData* pt = addPoint(planData, frame, p, height, speed, 1);
+
+        // 机头朝向圆心：heading 为正北顺时针角度，范围 -180~180
+        pt->set_headingmode(3);
+        pt->set_heading(static_cast<float>(std::atan2(center.x - p.x, center.y - p.y) / kDegToRad));
+        if (i == 0) {
+            addAction(pt, kActionGimbalPitch, pitch);
+        }
+        addAction(pt, kActionTakePhoto, 1);
+    }
+    return true;
+}
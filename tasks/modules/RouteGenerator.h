@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include "TelemetryDataBuf-new.pb.h"
+
+/**
+ * @brief 由 PlanLineData 中的建模参数自动生成航点。
+ *
+ *        - NormalModel（普通建模）：在作业区域多边形内生成“弓”字形扫描航线。
+ *          航线间距 = 地面覆盖宽度 × (1 - 横向重叠率)，拍照间距 = 地面覆盖长度 × (1 - 纵向重叠率)，
+ *          覆盖尺寸由测绘高度与相机视场角计算。每条扫描线与多边形求交（支持凹多边形，
+ *          一条扫描线可能被切成多段），再按“就近衔接”排序各段，减少空飞与掉头距离。
+ *        - SurroundModel（环绕建模）：以作业区域中心为圆心、边界区域为半径生成环绕航点，
+ *          机头朝向圆心，每个曝光点调整云台俯仰并拍照。
+ *
+ *        坐标计算在以区域首点为原点的局部平面（ENU 近似）中完成，适用于十公里量级以内的区域。
+ */
+class RouteGenerator
+{
+public:
+    /**
+     * @brief 相机视场角（度），长边沿垂直航线方向
+     */
+    struct CameraSpec {
+        double hfovDeg = 73.7;   ///< 水平视场角
+        double vfovDeg = 53.1;   ///< 垂直视场角
+    };
+
+    struct Options {
+        CameraSpec camera;                 ///< 相机视场角
+        float      speed            = 0;   ///< 航点速度(米/秒)，0 表示沿用 PlanLineData.autoSpeed（仍为 0 时取 8）
+        bool       photoAtWaypoints = false; ///< true: 每个曝光位置生成一个航点并拍照；false: 每段首尾两个航点 + 等距间隔拍照
+    };
+
+    RouteGenerator() = default;
+    explicit RouteGenerator(const Options& opts) : m_opts(opts) {}
+
+    /**
+     * @brief 根据 planData 中已设置的 normalModel / surroundModel 生成航点，覆盖原有 points
+     * @return true 表示生成成功；false 表示没有可用的建模参数或参数非法
+     */
+    bool generate(PlanLineData& planData);
+
+    /**
+     * @brief 生成普通建模（弓字形）航点，追加到 planData.points
+     */
+    bool generateNormal(const NormalModel& model, PlanLineData& planData);
+
+    /**
+     * @brief 生成环绕建模航点，追加到 planData.points
+     */
+    bool generateSurround(const SurroundModel& model, PlanLineData& planData);
+
+    /**
+     * @brief 最近一次失败的原因
+     */
+    const std::string& error() const { return m_error; }
+
+private:
+    bool fail(const std::string& msg);
+    float pointSpeed(const PlanLineData& planData) const;
+
+private:
+    Options     m_opts;
+    std::string m_error;
+};
@@ -0,0 +1,248 @@
+#include "RouteUploader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+
+#include "CLI2Frame.h"
+#include "CommandTracker.h"
+#include "FrameDataHandler.h"
+
+namespace {
+constexpr size_t  CHUNK_HEADER_LEN  = 10;   ///< [传输ID 2B][包序号 2B][总包数 2B][总长度 4B]
+constexpr uint8_t EXEC_RESULT_OK    = 0;
+
+std::atomic<uint16_t> g_nextTransferId{1};
+
+void putBE16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void putBE32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+} // namespace
+
+RouteUploader::RouteUploader()
+    : RouteUploader(Options())
+{
+}
+
+RouteUploader::RouteUploader(const Options& opts)
+    : m_opts(opts)
+{
+    // 每包数据 + 分包头必须能放进一个控制帧
+    m_opts.chunkSize = std::min(std::max<size_t>(m_opts.chunkSize, 1), maxControlParamLen() - CHUNK_HEADER_LEN);
+    m_opts.window    = std::max<size_t>(m_opts.window, 1);
+
+    // 分包应答回显包序号（参数偏移 2），在途表按序号精确匹配
+    g_commandTracker.setSequenceOffset(ROUTE_CHUNK_ACTION_ID, 2);
+}
+
+bool RouteUploader::upload(std::string payload)
+{
+    using clock = std::chrono::steady_clock;
+
+    m_cache = std::move(payload);
+    m_stats = Stats();
+    m_stats.totalBytes = m_cache.size();
+
+    const size_t total = (m_cache.size() + m_opts.chunkSize - 1) / m_opts.chunkSize;
+    if (total == 0 || total > 0xFFFF || m_cache.size() > 0xFFFFFFFFu) {
+        std::cerr << "[RouteUploader] Invalid route size: " << m_cache.size() << " bytes.\n";
+        return false;
+    }
+    m_stats.totalChunks = static_cast<uint16_t>(total);
+
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_chunks.assign(total, ChunkState());
+        m_inFlight   = 0;
+        m_failed     = false;
+        m_failReason.clear();
+        m_lastReportedDecile = -1;
+    }
+    m_transferId = g_nextTransferId++;
+    m_startTime  = clock::now();
+
+    std::cout << "[RouteUploader] Uploading route: " << m_cache.size() << " bytes in "
+              << total << " chunks (transfer " << m_transferId << ").\n";
+
+    const int listenerId = FrameDataHandler::addReplyListener(
+        [this](const ControlReply& reply) { onReply(reply); });
+
+    size_t nextToSend = 0;
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (true) {
+        // 1. 填满发送窗口
+        while (m_inFlight < m_opts.window && nextToSend < total) {
+            sendChunk(static_cast<uint16_t>(nextToSend++));
+        }
+
+        printProgress();
+
+        if (m_failed || m_stats.ackedChunks == total) {
+            break;
+        }
+
+        // 2. 等待应答或最早的超时
+        auto deadline = clock::time_point::max();
+        for (const auto& c : m_chunks) {
+            if (c.inFlight) {
+                deadline = std::min(deadline, c.sentAt + m_opts.ackTimeout);
+            }
+        }
+        const uint16_t ackedBefore = m_stats.ackedChunks;
+        auto progressed = [&] { return m_failed || m_stats.ackedChunks != ackedBefore; };
+        if (deadline == clock::time_point::max()) {
+            m_cond.wait(lk, progressed);
+        } else {
+            m_cond.wait_until(lk, deadline, progressed);
+        }
+
+        // 3. 超时重发
+        const auto now = clock::now();
+        for (size_t seq = 0; seq < total && !m_failed; ++seq) {
+            ChunkState& c = m_chunks[seq];
+            if (!c.inFlight || now - c.sentAt < m_opts.ackTimeout) {
+                continue;
+            }
+            if (c.retries >= m_opts.maxRetries) {
+                m_failed     = true;
+                m_failReason = "chunk " + std::to_string(seq) + " not acknowledged after "
+                             + std::to_string(c.retries) + " retries";
+                break;
+            }
+            ++c.retries;
+            ++m_stats.retransmits;
+            sendChunk(static_cast<uint16_t>(seq));
+        }
+    }
+    const bool ok = !m_failed;
+    const std::string failReason = m_failReason;
+    lk.unlock();
+
+    FrameDataHandler::removeReplyListener(listenerId);
+
+    m_stats.elapsedMs = std::chrono::duration<double, std::milli>(clock::now() - m_startTime).count();
+    if (ok) {
+        const double kibPerSec = m_stats.elapsedMs > 0
+            ? (m_stats.totalBytes / 1024.0) / (m_stats.elapsedMs / 1000.0) : 0.0;
+        std::printf("[RouteUploader] Done: %zu bytes, %u chunks, %zu retransmits, %zu stale acks, %.1f ms, %.1f KiB/s\n",
+                    m_stats.totalBytes, m_stats.totalChunks, m_stats.retransmits, m_stats.staleAcks,
+                    m_stats.elapsedMs, kibPerSec);
+    } else {
+        std::cerr << "[RouteUploader] Upload failed: " << failReason << "\n";
+    }
+    m_cache.clear();
+    m_cache.shrink_to_fit();
+    return ok;
+}
+
+size_t RouteUploader::chunkLength(uint16_t seq) const
+{
+    const size_t offset = static_cast<size_t>(seq) * m_opts.chunkSize;
+    return std::min(m_opts.chunkSize, m_cache.size() - offset);
+}
+
+// 调用方需持有 m_mutex
+void RouteUploader::sendChunk(uint16_t seq)
+{
+    uint8_t header[CHUNK_HEADER_LEN];
+    putBE16(header + 0, m_transferId);
+    putBE16(header + 2, seq);
+    putBE16(header + 4, m_stats.totalChunks);
+    putBE32(header + 6, static_cast<uint32_t>(m_cache.size()));
+
+    // 数据片段直接从缓存按偏移写入帧
+    const size_t offset = static_cast<size_t>(seq) * m_opts.chunkSize;
+    DataFrame frame = createControlFrame(ROUTE_CHUNK_ACTION_ID,
+                                         header, sizeof(header),
+                                         reinterpret_cast<const uint8_t*>(m_cache.data()) + offset,
+                                         chunkLength(seq));
+
+    ChunkState& c = m_chunks[seq];
+    if (!c.inFlight) {
+        c.inFlight = true;
+        ++m_inFlight;
+    }
+    c.sentAt = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> qlk(g_queueMutex);
+        g_dataFrameQueue.push(std::move(frame));
+    }
+    g_queueCond.notify_one();
+}
+
+void RouteUploader::onReply(const ControlReply& reply)
+{
+    if (reply.actionNumber != ROUTE_CHUNK_ACTION_ID) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_chunks.empty() || m_failed) {
+        return;
+    }
+
+    // 应答回显 [包序号][传输ID]：只认本次上传的应答，之前上传迟到的应答不能确认同序号的包
+    if (reply.extra.size() < 4) {
+        return;
+    }
+    const size_t   seq        = (static_cast<size_t>(reply.extra[0]) << 8) | reply.extra[1];
+    const uint16_t transferId = static_cast<uint16_t>((reply.extra[2] << 8) | reply.extra[3]);
+    if (transferId != m_transferId) {
+        ++m_stats.staleAcks;
+        return;
+    }
+    if (seq >= m_chunks.size()) {
+        return;
+    }
+
+    if (reply.execResult != EXEC_RESULT_OK) {
+        m_failed     = true;
+        m_failReason = "chunk " + std::to_string(seq) + " rejected, result="
+                     + std::to_string(reply.execResult) + ", errorCode=" + std::to_string(reply.errorCode);
+        m_cond.notify_one();
+        return;
+    }
+
+    ChunkState& c = m_chunks[seq];
+    if (c.acked) {
+        return;   // 重发导致的重复应答
+    }
+    c.acked = true;
+    if (c.inFlight) {
+        c.inFlight = false;
+        --m_inFlight;
+    }
+    ++m_stats.ackedChunks;
+    m_stats.ackedBytes += chunkLength(static_cast<uint16_t>(seq));
+    m_cond.notify_one();
+}
+
+// 调用方需持有 m_mutex；每完成 10% 打印一次
+void RouteUploader::printProgress()
+{
+    if (m_stats.totalChunks == 0) {
+        return;
+    }
+    const int decile = static_cast<int>(m_stats.ackedChunks * 10 / m_stats.totalChunks);
+    if (decile <= m_lastReportedDecile || m_stats.ackedChunks == 0) {
+        return;
+    }
+    m_lastReportedDecile = decile;
+
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    std::printf("[RouteUploader] %u/%u chunks, %zu/%zu bytes, %.1f KiB/s\n",
+                m_stats.ackedChunks, m_stats.totalChunks, m_stats.ackedBytes, m_stats.totalBytes,
+                sec > 0 ? (m_stats.ackedBytes / 1024.0) / sec : 0.0);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common_types.h"
+
+constexpr uint8_t ROUTE_PLAN_ACTION_ID  = 0x10;  ///< 单帧航线规划
+constexpr uint8_t ROUTE_CHUNK_ACTION_ID = 0x44;  ///< 分包航线上传
+
+/**
+ * @brief 大航线分包上传。
+ *
+ *        控制帧的数据长度字段只有 2 字节，序列化后的 PlanLineData 超过单帧上限
+ *        (MAX_CONTROL_PARAM_LEN) 时，拆成多包以动作编号 ROUTE_CHUNK_ACTION_ID 发送：
+ *
+ *            动作参数(大端): [传输ID 2B][包序号 2B][总包数 2B][航线总长度 4B][数据 NB]
+ *
+ *        云盒对每一包回复 0xD1（动作编号 = ROUTE_CHUNK_ACTION_ID，执行结果 0 = 成功），
+ *        SN 之后回显 [包序号 2B][传输ID 2B]；传输 ID 与当前上传不一致（上一次上传迟到的应答）
+ *        或缺少回显的应答一律忽略，对应的包按超时重发。
+ *
+ *        发送端维护一个滑动窗口（默认同时在途 4 包），超时重发，任何一包执行失败即终止。
+ *        每一包都直接从缓存的序列化数据中按偏移取片段写入帧，不为单包另行拷贝参数。
+ *
+ *        upload() 为阻塞调用，在 CLI 线程中执行，期间打印进度与吞吐量。
+ */
+class RouteUploader
+{
+public:
+    struct Options {
+        size_t                    chunkSize  = 32 * 1024;  ///< 每包数据字节数
+        size_t                    window     = 4;          ///< 最多同时在途的包数
+        std::chrono::milliseconds ackTimeout{3000};        ///< 单包应答超时
+        int                       maxRetries = 3;          ///< 单包最大重发次数
+    };
+
+    struct Stats {
+        uint16_t totalChunks = 0;
+        uint16_t ackedChunks = 0;
+        size_t   totalBytes  = 0;
+        size_t   ackedBytes  = 0;
+        size_t   retransmits = 0;
+        size_t   staleAcks   = 0;   ///< 其他传输 ID 的应答（已忽略）
+        double   elapsedMs   = 0.0;
+    };
+
+    RouteUploader();
+    explicit RouteUploader(const Options& opts);
+
+    /**
+     * @brief 分包上传序列化后的航线数据（阻塞直到全部确认、失败或超时）
+     * @param payload 序列化后的 PlanLineData，上传期间作为分包来源的缓存
+     * @return true 表示全部分包均已确认
+     */
+    bool upload(std::string payload);
+
+    /**
+     * @brief 最近一次上传的统计信息
+     */
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct ChunkState {
+        bool                                  acked    = false;
+        bool                                  inFlight = false;
+        int                                   retries  = 0;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    void onReply(const ControlReply& reply);
+    void sendChunk(uint16_t seq);
+    size_t chunkLength(uint16_t seq) const;
+    void printProgress();
+
+private:
+    Options                 m_opts;
+    Stats                   m_stats;
+
+    std::string             m_cache;        ///< 序列化后的航线数据
+    uint16_t                m_transferId = 0;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::vector<ChunkState> m_chunks;
+    size_t                  m_inFlight   = 0;
+    bool                    m_failed     = false;
+    std::string             m_failReason;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    int                     m_lastReportedDecile = -1;
+};
@@ -0,0 +1,321 @@
+#include "RouteValidator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+constexpr double kPi          = 3.14159265358979323846;
+constexpr double kDegToRad    = kPi / 180.0;
+constexpr double kEarthRadius = 6371008.8;   ///< 平均地球半径(米)，用于 haversine
+
+constexpr float kDefaultSpeed    = 8.0f;
+constexpr float kDefaultMaxSpeed = 15.0f;
+
+using Severity = RouteValidator::Severity;
+using Issue    = RouteValidator::Issue;
+
+// 航点动作参数范围（见 PointAction.param 注释），type 为下标；min > max 表示不检查
+struct ParamRange {
+    float min;
+    float max;
+};
+constexpr ParamRange kActionParamRange[18] = {
+    {1, 0},        // 0  未定义
+    {2, 200},      // 1  变焦倍数
+    {0, 7},        // 2  拍照类型（0 表示使用默认相机）
+    {1, 0},        // 3  录像
+    {1, 0},        // 4  停录
+    {-180, 180},   // 5  机头偏航
+    {-120, 30},    // 6  云台俯仰
+    {-180, 180},   // 7  云台偏航
+    {-90, 60},     // 8  云台横滚
+    {1, 25},       // 9  悬停(秒)
+    {1, 100},      // 10 等距间隔拍照(米)
+    {1, 30},       // 11 等时间隔拍照(秒)
+    {1, 0},        // 12 结束间隔拍照
+    {1, 0},        // 13 单条喊话
+    {1, 0},        // 14 开始循环喊话
+    {1, 0},        // 15 结束循环喊话
+    {1, 0},        // 16 对焦
+    {1, 3},        // 17 切换视频源
+};
+
+// 按区间并行执行 fn(begin, end, chunk)，航点较少时直接在当前线程执行
+void parallelFor(size_t n, size_t chunks, const std::function<void(size_t, size_t, size_t)>& fn)
+{
+    if (chunks <= 1) {
+        fn(0, n, 0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    const size_t step = (n + chunks - 1) / chunks;
+    for (size_t c = 1; c < chunks; ++c) {
+        const size_t b = std::min(n, c * step);
+        const size_t e = std::min(n, b + step);
+        workers.emplace_back(fn, b, e, c);
+    }
+    fn(0, std::min(n, step), 0);
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+std::string fmt(const char* format, double a, double b = 0.0, double c = 0.0)
+{
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), format, a, b, c);
+    return buf;
+}
+
+} // namespace
+
+RouteValidator::Report RouteValidator::validate(const PlanLineData& plan) const
+{
+    Report report;
+    auto add = [](std::vector<Issue>& out, Severity s, int idx, std::string msg) {
+        out.push_back({s, idx, std::move(msg)});
+    };
+
+    // ------------------------------------------------------------------
+    // 1. 航线级参数
+    // ------------------------------------------------------------------
+    std::vector<Issue>& top = report.issues;
+    if (plan.maxspeed() < 0 || plan.maxspeed() > 15) {
+        add(top, Severity::Error, -1, fmt("maxSpeed %.2f out of range 0~15", plan.maxspeed()));
+    }
+    if (plan.autospeed() < 0 || plan.autospeed() > 15) {
+        add(top, Severity::Error, -1, fmt("autoSpeed %.2f out of range 0~15", plan.autospeed()));
+    }
+    const float maxSpeed  = plan.maxspeed()  > 0 ? plan.maxspeed()  : kDefaultMaxSpeed;
+    const float autoSpeed = plan.autospeed() > 0 ? plan.autospeed() : kDefaultSpeed;
+    if (autoSpeed > maxSpeed) {
+        add(top, Severity::Warning, -1, fmt("autoSpeed %.2f exceeds maxSpeed %.2f", autoSpeed, maxSpeed));
+    }
+    if (plan.homeheight() != 0 && (plan.homeheight() < 20 || plan.homeheight() > 1500)) {
+        add(top, Severity::Error, -1, fmt("homeHeight %.0f out of range 20~1500", plan.homeheight()));
+    }
+    if (plan.finishedaction() < 1 || plan.finishedaction() > 5) {
+        add(top, Severity::Error, -1, fmt("finishedAction %.0f out of range 1~5", plan.finishedaction()));
+    }
+    if (plan.loseaction() > 1) {
+        add(top, Severity::Error, -1, fmt("loseAction %.0f out of range 0~1", plan.loseaction()));
+    }
+
+    const size_t n = static_cast<size_t>(plan.points_size());
+    if (n < 2) {
+        add(top, Severity::Error, -1, "route needs at least 2 waypoints");
+    }
+
+    // ------------------------------------------------------------------
+    // 2. 航点数据转为 SoA，并检查单点参数
+    // ------------------------------------------------------------------
+    std::vector<double> latRad(n), lngRad(n), cosLat(n), height(n), speed(n), actionTime(n);
+
+    size_t chunks = 1;
+    if (n >= m_opts.parallelThreshold) {
+        const unsigned hw = m_opts.maxThreads ? m_opts.maxThreads : std::max(1u, std::thread::hardware_concurrency());
+        chunks = std::min<size_t>(hw, n / (m_opts.parallelThreshold / 4 + 1) + 1);
+    }
+    std::vector<std::vector<Issue>> pointIssues(chunks), segmentIssues(chunks);
+    const int interestCount = plan.interests_size();
+
+    parallelFor(n, chunks, [&](size_t begin, size_t end, size_t chunk) {
+        std::vector<Issue>& out = pointIssues[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            const PointData& p = plan.points(static_cast<int>(i));
+            const int idx = static_cast<int>(i);
+
+            latRad[i] = p.lat() * kDegToRad;
+            lngRad[i] = p.lng() * kDegToRad;
+            height[i] = p.height();
+
+            if (std::fabs(p.lat()) > 90.0 || std::fabs(p.lng()) > 180.0 ||
+                (p.lat() == 0.0 && p.lng() == 0.0)) {
+                add(out, Severity::Error, idx, fmt("invalid coordinate (%.7f, %.7f)", p.lng(), p.lat()));
+            }
+            if (p.height() < 0 || p.height() > 1500) {
+                add(out, Severity::Error, idx, fmt("height %.1f out of range 0~1500", p.height()));
+            }
+            if (p.speed() < 0 || p.speed() > 15) {
+                add(out, Severity::Error, idx, fmt("speed %.2f out of range 0~15", p.speed()));
+            } else if (p.speed() > maxSpeed) {
+                add(out, Severity::Warning, idx, fmt("speed %.2f exceeds maxSpeed %.2f", p.speed(), maxSpeed));
+            }
+            if (p.flightpathmode() < 1 || p.flightpathmode() > 4) {
+                add(out, Severity::Error, idx, fmt("flightPathMode %.0f out of range 1~4", p.flightpathmode()));
+            }
+            if (p.headingmode() > 5) {
+                add(out, Severity::Error, idx, fmt("headingMode %.0f out of range 0~5", p.headingmode()));
+            } else if (p.headingmode() == 3 && (p.heading() < -180 || p.heading() > 180)) {
+                add(out, Severity::Error, idx, fmt("heading %.1f out of range -180~180", p.heading()));
+            } else if (p.headingmode() == 4 && (p.interestindex() < 0 || p.interestindex() >= interestCount)) {
+                add(out, Severity::Error, idx, fmt("headingMode 4 needs a valid interestIndex (got %.0f, %.0f interests)",
+                                                   p.interestindex(), interestCount));
+            } else if (interestCount > 0 && p.interestindex() >= interestCount) {
+                add(out, Severity::Warning, idx, fmt("interestIndex %.0f out of range", p.interestindex()));
+            }
+
+            double t = 0.0;
+            for (const PointAction& a : p.actions()) {
+                if (a.type() < 1 || a.type() > 17) {
+                    add(out, Severity::Error, idx, fmt("unknown action type %.0f", a.type()));
+                    continue;
+                }
+                const ParamRange& r = kActionParamRange[a.type()];
+                if (r.min <= r.max && (a.param() < r.min || a.param() > r.max)) {
+                    add(out, Severity::Error, idx, fmt("action type %.0f param %.2f out of range", a.type(), a.param()));
+                }
+                if (a.waittime() < 0) {
+                    add(out, Severity::Error, idx, fmt("action waitTime %.0f is negative", a.waittime()));
+                }
+                t += std::max(0, a.waittime());
+                if (a.type() == 9) {
+                    t += a.param();
+                } else if (a.type() == 2) {
+                    t += m_opts.photoTime;
+                }
+            }
+            actionTime[i] = t;
+            speed[i] = std::min<double>(p.speed() > 0 ? p.speed() : autoSpeed, maxSpeed);
+        }
+    });
+
+    // cos(lat) 单独成批计算，循环内无分支
+    for (size_t i = 0; i < n; ++i) {
+        cosLat[i] = std::cos(latRad[i]);
+    }
+
+    // ------------------------------------------------------------------
+    // 3. 航段距离（haversine + 高度差）、航段用时、dampingDistance 检查
+    // ------------------------------------------------------------------
+    const size_t segs = n > 0 ? n - 1 : 0;
+    report.segmentDistance.assign(segs, 0.0);
+    std::vector<double> segTime(segs, 0.0);
+    std::vector<double> chunkClimb(chunks, 0.0);
+
+    parallelFor(segs, chunks, [&](size_t begin, size_t end, size_t chunk) {
+        double* dist = report.segmentDistance.data();
+        // 批量 haversine
+        for (size_t i = begin; i < end; ++i) {
+            const double sdLat = std::sin((latRad[i + 1] - latRad[i]) * 0.5);
+            const double sdLng = std::sin((lngRad[i + 1] - lngRad[i]) * 0.5);
+            const double a     = sdLat * sdLat + cosLat[i] * cosLat[i + 1] * sdLng * sdLng;
+            const double horiz = 2.0 * kEarthRadius * std::asin(std::sqrt(std::min(1.0, a)));
+            const double dz    = height[i + 1] - height[i];
+            dist[i] = std::sqrt(horiz * horiz + dz * dz);
+        }
+
+        double climb = 0.0;
+        std::vector<Issue>& out = segmentIssues[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            const int idx = static_cast<int>(i);
+            const PointData& next = plan.points(idx + 1);
+            if (dist[i] < m_opts.minSegmentLength) {
+                add(out, Severity::Error, idx + 1, fmt("only %.2f m from previous waypoint (min %.2f m)",
+                                                       dist[i], m_opts.minSegmentLength));
+            } else if (dist[i] > m_opts.maxSegmentLength) {
+                add(out, Severity::Warning, idx + 1, fmt("%.0f m from previous waypoint", dist[i]));
+            }
+
+            // 航段用时：匀速段 + 在下一个航点停稳所需的加减速时间 + 航点动作
+            const double v = std::max(0.1, speed[i]);
+            double t = dist[i] / v;
+            if (i == 0 || next.flightpathmode() == 1) {
+                t += v / m_opts.acceleration;
+            }
+            segTime[i] = t + actionTime[i + 1];
+            climb += std::max(0.0, height[i + 1] - height[i]);
+        }
+        chunkClimb[chunk] = climb;
+
+        // 协调转弯半径不能超过相邻航段长度；检查的是本区间内的航点（含区间末尾的航点）
+        const size_t pEnd = (end == segs) ? n : end;
+        for (size_t i = begin; i < pEnd; ++i) {
+            const PointData& p = plan.points(static_cast<int>(i));
+            if (p.flightpathmode() != 2) {
+                continue;
+            }
+            const double d = p.dampingdistance();
+            const int idx = static_cast<int>(i);
+            if (d < 1.0 || d > 655.35) {
+                add(out, Severity::Error, idx, fmt("dampingDistance %.2f out of range 1~655.35", d));
+                continue;
+            }
+            double adj = std::numeric_limits<double>::max();
+            if (i > 0)        adj = std::min(adj, dist[i - 1]);
+            if (i + 1 < n)    adj = std::min(adj, dist[i]);
+            if (d >= adj) {
+                add(out, Severity::Error, idx, fmt("dampingDistance %.2f must be shorter than adjacent segment %.2f m", d, adj));
+            } else if (d > adj / 2.0) {
+                add(out, Severity::Warning, idx, fmt("dampingDistance %.2f exceeds half of adjacent segment %.2f m", d, adj));
+            }
+        }
+    });
+
+    // ------------------------------------------------------------------
+    // 4. 汇总：累计 ETA、总航程、电量
+    // ------------------------------------------------------------------
+    report.segmentEta.resize(segs);
+    double elapsed = n > 0 ? actionTime[0] : 0.0;
+    double total   = 0.0;
+    for (size_t i = 0; i < segs; ++i) {
+        elapsed += segTime[i];
+        total   += report.segmentDistance[i];
+        report.segmentEta[i] = elapsed;
+    }
+    double climb = 0.0;
+    for (double c : chunkClimb) {
+        climb += c;
+    }
+    report.totalDistance  = total;
+    report.totalTime      = elapsed;
+    report.batteryPercent = elapsed / 60.0 * m_opts.batteryPerMinute + climb * m_opts.batteryPerClimbM;
+    if (report.batteryPercent > 100.0) {
+        add(top, Severity::Error, -1, fmt("estimated battery use %.0f%% exceeds one pack", report.batteryPercent));
+    } else if (plan.finishedaction() == 1 && report.batteryPercent > 80.0) {
+        add(top, Severity::Warning, -1, fmt("estimated battery use %.0f%% leaves little reserve for RTH",
+                                            report.batteryPercent));
+    }
+
+    std::vector<Issue> perPoint;
+    for (size_t c = 0; c < chunks; ++c) {
+        perPoint.insert(perPoint.end(), pointIssues[c].begin(), pointIssues[c].end());
+        perPoint.insert(perPoint.end(), segmentIssues[c].begin(), segmentIssues[c].end());
+    }
+    std::stable_sort(perPoint.begin(), perPoint.end(),
+                     [](const Issue& a, const Issue& b) { return a.pointIndex < b.pointIndex; });
+    report.issues.insert(report.issues.end(), perPoint.begin(), perPoint.end());
+
+    for (const Issue& is : report.issues) {
+        (is.severity == Severity::Error ? report.errorCount : report.warningCount)++;
+    }
+    return report;
+}
+
+void RouteValidator::printReport(const Report& report, size_t maxIssues)
+{
+    std::printf("[RouteValidator] %zu segments, %.1f m, ETA %.0f s (%.1f min), battery ~%.0f%%, "
+                "%zu error(s), %zu warning(s)\n",
+                report.segmentDistance.size(), report.totalDistance, report.totalTime,
+                report.totalTime / 60.0, report.batteryPercent, report.errorCount, report.warningCount);
+    size_t shown = 0;
+    for (const Issue& is : report.issues) {
+        if (shown++ >= maxIssues) {
+            std::printf("  ... %zu more\n", report.issues.size() - maxIssues);
+            break;
+        }
+        const char* tag = (is.severity == Severity::Error) ? "ERROR" : "WARN ";
+        if (is.pointIndex >= 0) {
+            std::printf("  %s point %d: %s\n", tag, is.pointIndex, is.message.c_str());
+        } else {
+            std::printf("  %s route: %s\n", tag, is.message.c_str());
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "TelemetryDataBuf-new.pb.h"
+
+/**
+ * @brief 航线上传前的本地校验与飞行时间 / 电量估算。
+ *
+ *        一次遍历完成：
+ *        - 航线级参数（速度、返航高度、结束动作、失联动作）范围检查；
+ *        - 每个航点的坐标、高度、速度、飞行模式、偏航模式、兴趣点、动作参数检查；
+ *        - 协调转弯的 dampingDistance 与前后航段长度的比较（过大会导致航线开始失败）；
+ *        - 航段距离、每段预计用时、总用时与电量估算。
+ *
+ *        坐标先整体转换为结构化数组（SoA），再批量计算航段距离，便于编译器向量化；
+ *        航点数超过 Options::parallelThreshold 时按区间切分到多个线程并行计算后合并。
+ */
+class RouteValidator
+{
+public:
+    enum class Severity { Warning, Error };
+
+    struct Issue {
+        Severity    severity;
+        int         pointIndex;   ///< 相关航点下标，-1 表示航线级问题
+        std::string message;
+    };
+
+    struct Report {
+        std::vector<Issue>  issues;
+        size_t              errorCount     = 0;
+        size_t              warningCount   = 0;
+        double              totalDistance  = 0.0;  ///< 总航程(米，含爬升)
+        double              totalTime      = 0.0;  ///< 预计总用时(秒，含动作)
+        double              batteryPercent = 0.0;  ///< 预计耗电百分比
+        std::vector<double> segmentDistance;       ///< 第 i 段: 航点 i -> i+1 的距离(米)
+        std::vector<double> segmentEta;            ///< 第 i 段: 到达航点 i+1 的累计用时(秒)
+
+        bool ok() const { return errorCount == 0; }
+    };
+
+    struct Options {
+        double acceleration      = 2.0;    ///< 加减速度(米/秒²)，直线飞行模式每个航点需停稳
+        double photoTime         = 1.0;    ///< 单次拍照耗时(秒)
+        double batteryPerMinute  = 2.5;    ///< 巡航耗电(%/分钟)
+        double batteryPerClimbM  = 0.02;   ///< 每爬升 1 米额外耗电(%)
+        double maxSegmentLength  = 2000.0; ///< 相邻航点距离告警阈值(米)
+        double minSegmentLength  = 0.5;    ///< 相邻航点最小距离(米)
+        size_t parallelThreshold = 50000;  ///< 航点数超过该值时并行计算
+        unsigned maxThreads      = 0;      ///< 0 表示使用硬件线程数
+    };
+
+    RouteValidator() = default;
+    explicit RouteValidator(const Options& opts) : m_opts(opts) {}
+
+    /**
+     * @brief 校验航线并估算航程 / 用时 / 电量
+     */
+    Report validate(const PlanLineData& planData) const;
+
+    /**
+     * @brief 打印校验报告（最多列出 maxIssues 条问题）
+     */
+    static void printReport(const Report& report, size_t maxIssues = 20);
+
+private:
+    Options m_opts;
+};
@@ -0,0 +1,146 @@
+#include "StatePublisher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "AsyncLogger.h"
+
+namespace {
+
+void copyString(char* dst, size_t size, const std::string& src)
+{
+    const size_t n = std::min(size - 1, src.size());
+    std::memcpy(dst, src.data(), n);
+    std::memset(dst + n, 0, size - n);
+}
+
+uint64_t monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+bool StatePublisher::open(const std::string& name)
+{
+    if (name.empty()) {
+        return false;
+    }
+    m_local.clear();
+    return m_table.create(name);
+}
+
+VehicleState* StatePublisher::stateFor(const std::string& boxSn, int& index)
+{
+    if (!m_table.isOpen()) {
+        return nullptr;
+    }
+    index = m_table.findOrAdd(boxSn.c_str());
+    if (index < 0) {
+        LOG_WARN_RL("StatePublisher", 1, "State table full, dropping box {}", boxSn);
+        return nullptr;
+    }
+    if (static_cast<size_t>(index) >= m_local.size()) {
+        m_local.resize(index + 1);   // 值初始化，新记录全部清零
+        copyString(m_local[index].boxSn, sizeof(VehicleState::boxSn), boxSn);
+    }
+    return &m_local[index];
+}
+
+void StatePublisher::publish(int index, VehicleState& state)
+{
+    state.updatedNs = monotonicNs();
+    ++state.updateCount;
+    m_table.write(index, state);
+}
+
+void StatePublisher::onTelemetry(const TelemetryData& data)
+{
+    int index = -1;
+    VehicleState* s = stateFor(data.boxsn(), index);
+    if (!s) {
+        return;
+    }
+    copyString(s->uavSn, sizeof(s->uavSn), data.uavsn());
+    copyString(s->uavModel, sizeof(s->uavModel), data.uavmodel());
+    s->telemetryTimestamp = data.timestamp();
+
+    s->lat             = data.lat();
+    s->lng             = data.lng();
+    s->altitude        = data.altitude();
+    s->ultrasonic      = data.ultrasonic();
+    s->rtkLat          = data.rtklat();
+    s->rtkLng          = data.rtklng();
+    s->rtkHFSL         = data.rtkhfsl();
+    s->rtkPositionInfo = data.rtkpositioninfo();
+    s->homeRange       = data.homerange();
+    s->satelliteCount  = data.satellitecount();
+
+    s->pitch     = data.pitch();
+    s->roll      = data.roll();
+    s->yaw       = data.yaw();
+    s->velocity  = data.velocity();
+    s->airspeed  = data.airspeed();
+    s->xVelocity = data.xvelocity();
+    s->yVelocity = data.yvelocity();
+    s->zVelocity = data.zvelocity();
+
+    s->ptPitch    = data.ptpitch();
+    s->ptRoll     = data.ptroll();
+    s->ptYaw      = data.ptyaw();
+    s->zoomFactor = data.zoomfactor();
+
+    s->flightMode           = data.flightmode();
+    s->airFlyTimes          = data.airflytimes();
+    s->predictFlyTimes      = data.predictflytimes();
+    s->predictGohomeBattery = data.predictgohomebattery();
+
+    // 电量字符串形如 "80_60"；收到过 UavState 时以其电池详情为准
+    if (s->uavStateTimestamp == 0 && !data.batterypower().empty()) {
+        const char* p = data.batterypower().c_str();
+        uint32_t    n = 0;
+        while (*p && n < 2) {
+            char* end = nullptr;
+            const long v = std::strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            s->batteryPercent[n++] = static_cast<uint32_t>(v);
+            p = (*end == '_') ? end + 1 : end;
+        }
+        s->batteryNum = n;
+    }
+    publish(index, *s);
+}
+
+void StatePublisher::onUavState(const UavState& state)
+{
+    int index = -1;
+    VehicleState* s = stateFor(state.boxsn(), index);
+    if (!s) {
+        return;
+    }
+    s->uavStateTimestamp = state.timestamp();
+
+    if (state.has_flightcontrollerstate()) {
+        const FlightControllerState& fc = state.flightcontrollerstate();
+        s->satelliteCount = fc.satellitecount();
+        s->gpsSignalLevel = fc.gpssignallevel();
+        s->flightMode     = fc.flightmode();
+        s->flightStatus   = fc.flightstatus();
+    }
+    if (state.has_batterystate()) {
+        const BatteryState& bat = state.batterystate();
+        const BatteryStateInfo* infos[2] = {&bat.firstbatteryinfo(), &bat.secondbatteryinfo()};
+        s->batteryNum = bat.batterynum();
+        for (int i = 0; i < 2; ++i) {
+            s->batteryPercent[i]     = infos[i]->batterycapacitypercent();
+            s->batteryVoltageMv[i]   = infos[i]->currentvoltage();
+            s->batteryTemperature[i] = infos[i]->batterytemperature();
+        }
+    }
+    publish(index, *s);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ShmStateTable.h"
+#include "TelemetryDataBuf-new.pb.h"
+
+/**
+ * @brief 把 0xA9 / 0xA8 解析结果写入共享内存状态表（ShmStateTable）。
+ *
+ *        每架飞机在本地保留一份合并后的 VehicleState：遥测与飞机状态分别更新各自字段，
+ *        每次更新后整条记录发布一次。只在解析线程中调用，无需加锁。
+ */
+class StatePublisher
+{
+public:
+    /**
+     * @brief 创建共享内存；name 为空时不发布
+     */
+    bool open(const std::string& name);
+
+    void onTelemetry(const TelemetryData& data);
+    void onUavState(const UavState& state);
+
+private:
+    VehicleState* stateFor(const std::string& boxSn, int& index);
+    void          publish(int index, VehicleState& state);
+
+private:
+    ShmStateTable             m_table;
+    std::vector<VehicleState> m_local;   ///< 与共享内存记录一一对应的本地副本
+};
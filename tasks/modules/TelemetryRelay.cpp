@@ -0,0 +1,347 @@
+#include "TelemetryRelay.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include "utils/AsyncLogger.h"
+#include "utils/Metrics.h"
+
+TelemetryRelay g_telemetryRelay;
+
+namespace {
+
+constexpr int kMaxIov = 64;
+
+void setNonBlocking(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+std::string peerName(int fd)
+{
+    sockaddr_in addr{};
+    socklen_t   len = sizeof(addr);
+    if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        return "?";
+    }
+    char ip[INET_ADDRSTRLEN] = {0};
+    ::inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+} // namespace
+
+bool TelemetryRelay::parsePolicy(const std::string& name, SlowPolicy& policy)
+{
+    if (name == "drop-oldest") {
+        policy = SlowPolicy::DropOldest;
+    } else if (name == "disconnect") {
+        policy = SlowPolicy::Disconnect;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool TelemetryRelay::start(EventLoop& loop, const std::string& bindIp, uint16_t port, size_t maxQueueBytes,
+                           SlowPolicy policy)
+{
+    if (port == 0 || isRunning()) {
+        return false;
+    }
+    if (m_listener.TCPInitServer(bindIp.c_str(), port) < 0) {
+        std::cerr << "[TelemetryRelay] Failed to listen on " << bindIp << ":" << port << "\n";
+        return false;
+    }
+    setNonBlocking(m_listener.GetListenFd());
+
+    m_loop          = &loop;
+    m_maxQueueBytes = maxQueueBytes;
+    m_policy        = policy;
+    m_running.store(true, std::memory_order_release);
+
+    const int listenFd = m_listener.GetListenFd();
+    loop.runInLoop([this, listenFd] {
+        m_loop->addFd(listenFd, EPOLLIN, [this](uint32_t) { onAccept(); });
+    });
+    std::cout << "[TelemetryRelay] Relaying frames on " << bindIp << ":" << port << " (queue limit "
+              << maxQueueBytes / 1024 << " KB, "
+              << (policy == SlowPolicy::DropOldest ? "drop-oldest" : "disconnect") << ")\n";
+    return true;
+}
+
+void TelemetryRelay::stop()
+{
+    if (!m_running.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    m_loop->runInLoop([this] {
+        m_loop->removeFd(m_listener.GetListenFd());
+        m_listener.CloseFd();
+        while (!m_clients.empty()) {
+            closeClient(m_clients.begin()->first, "relay stopped");
+        }
+        std::lock_guard<std::mutex> lk(m_pendingMutex);
+        m_pending.clear();
+    });
+}
+
+void TelemetryRelay::publish(DataFrame&& frame)
+{
+    if (!isRunning() || frame.size() < 5) {
+        return;
+    }
+    // 帧移入共享缓冲，之后所有客户端共用这一份
+    Buffer buf = std::make_shared<const DataFrame>(std::move(frame));
+    bool   first;
+    {
+        std::lock_guard<std::mutex> lk(m_pendingMutex);
+        first = m_pending.empty();
+        m_pending.push_back(std::move(buf));
+    }
+    // 事件循环处理前到达的帧合并为一次投递
+    if (first) {
+        m_loop->queueInLoop([this] { drainPending(); });
+    }
+}
+
+void TelemetryRelay::drainPending()
+{
+    std::vector<Buffer> frames;
+    {
+        std::lock_guard<std::mutex> lk(m_pendingMutex);
+        frames.swap(m_pending);
+    }
+    if (!isRunning()) {
+        return;
+    }
+
+    std::vector<int> toClose;
+    for (const Buffer& buf : frames) {
+        ++m_framesIn;
+        const uint8_t cmdId = (*buf)[4];
+        for (auto& kv : m_clients) {
+            if (kv.second.filter.test(cmdId)) {
+                enqueue(kv.second, buf);
+            }
+        }
+    }
+
+    // 整批入队后每个客户端只写一次
+    const uint64_t now = Metrics::nowNs();
+    for (auto& kv : m_clients) {
+        Client& c = kv.second;
+        if (c.queuedBytes > m_maxQueueBytes) {
+            toClose.push_back(kv.first);   // disconnect 策略下超限
+            ++m_slowDisconnects;
+        } else if (!c.queue.empty() && now - c.lastProgressNs > kStallTimeoutMs * 1000000ULL) {
+            toClose.push_back(kv.first);
+            ++m_slowDisconnects;
+        } else if (!c.wantWrite && !c.queue.empty() && !flush(c)) {
+            toClose.push_back(kv.first);
+        }
+    }
+    for (int fd : toClose) {
+        closeClient(fd, "slow or broken client");
+    }
+}
+
+void TelemetryRelay::enqueue(Client& c, const Buffer& buf)
+{
+    const size_t size = buf->size();
+    if (c.queuedBytes + size > m_maxQueueBytes) {
+        if (m_policy == SlowPolicy::Disconnect) {
+            c.queuedBytes += size;   // 标记超限，drainPending 统一断开
+            return;
+        }
+        // 丢最旧的整帧；已写出一部分的队首帧必须写完，否则下游帧边界错乱
+        const size_t keep = c.headOffset > 0 ? 1 : 0;
+        while (c.queuedBytes + size > m_maxQueueBytes && c.queue.size() > keep) {
+            c.queuedBytes -= c.queue[keep]->size();
+            c.queue.erase(c.queue.begin() + keep);
+            ++c.dropped;
+            ++m_framesDropped;
+        }
+        if (c.queuedBytes + size > m_maxQueueBytes) {
+            ++c.dropped;
+            ++m_framesDropped;
+            return;
+        }
+    }
+    if (c.queue.empty()) {
+        c.lastProgressNs = Metrics::nowNs();
+    }
+    c.queue.push_back(buf);
+    c.queuedBytes += size;
+}
+
+bool TelemetryRelay::flush(Client& c)
+{
+    while (!c.queue.empty()) {
+        iovec  iov[kMaxIov];
+        int    n = 0;
+        size_t offset = c.headOffset;
+        for (auto it = c.queue.begin(); it != c.queue.end() && n < kMaxIov; ++it, ++n) {
+            iov[n].iov_base = const_cast<uint8_t*>((*it)->data()) + offset;
+            iov[n].iov_len  = (*it)->size() - offset;
+            offset = 0;
+        }
+        msghdr msg{};
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = static_cast<size_t>(n);
+        const ssize_t sent = ::sendmsg(c.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+
+        c.lastProgressNs = Metrics::nowNs();
+        c.queuedBytes -= static_cast<size_t>(sent);
+        size_t left = static_cast<size_t>(sent);
+        while (left > 0) {
+            const size_t remain = c.queue.front()->size() - c.headOffset;
+            if (left < remain) {
+                c.headOffset += left;
+                break;
+            }
+            left -= remain;
+            c.queue.pop_front();
+            c.headOffset = 0;
+            ++c.sentFrames;
+        }
+    }
+
+    // 写不完时等待可写事件，写完后取消，避免空转
+    const bool needWrite = !c.queue.empty();
+    if (needWrite != c.wantWrite) {
+        m_loop->modifyFd(c.fd, EPOLLIN | EPOLLRDHUP | (needWrite ? uint32_t(EPOLLOUT) : 0u));
+        c.wantWrite = needWrite;
+    }
+    return true;
+}
+
+void TelemetryRelay::onAccept()
+{
+    int fd;
+    while ((fd = m_listener.TCPAccept()) >= 0) {
+        m_listener.SetCommFd(-1);   // 连接归中继管理，不由监听对象关闭
+        setNonBlocking(fd);
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Client c;
+        c.fd   = fd;
+        c.peer = peerName(fd);
+        c.filter.set();
+        m_clients.emplace(fd, std::move(c));
+        m_loop->addFd(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { onClientEvent(fd, events); });
+    }
+}
+
+void TelemetryRelay::onClientEvent(int fd, uint32_t events)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    Client& c = it->second;
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeClient(fd, "socket error");
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        char buf[512];
+        while (true) {
+            const ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n == 0) {
+                closeClient(fd, "closed by peer");
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeClient(fd, "recv failed");
+                    return;
+                }
+                break;
+            }
+            c.lineBuf.append(buf, static_cast<size_t>(n));
+            size_t pos;
+            while ((pos = c.lineBuf.find('\n')) != std::string::npos) {
+                handleCommand(c, c.lineBuf.substr(0, pos));
+                c.lineBuf.erase(0, pos + 1);
+            }
+            if (c.lineBuf.size() > 1024) {
+                c.lineBuf.clear();   // 不是订阅命令的输入，丢弃
+            }
+        }
+    }
+    if ((events & EPOLLOUT) && !flush(c)) {
+        closeClient(fd, "send failed");
+    }
+}
+
+void TelemetryRelay::handleCommand(Client& c, const std::string& line)
+{
+    std::istringstream ss(line);
+    std::string        word;
+    if (!(ss >> word) || word != "sub") {
+        return;
+    }
+    c.filter.reset();
+    while (ss >> word) {
+        if (word == "all") {
+            c.filter.set();
+            continue;
+        }
+        char* end = nullptr;
+        const unsigned long cmd = std::strtoul(word.c_str(), &end, 16);
+        if (end != word.c_str() && cmd < 256) {
+            c.filter.set(cmd);
+        }
+    }
+    LOG_INFO("TelemetryRelay", "Client {} subscribed to {} command ids", c.peer, c.filter.count());
+}
+
+void TelemetryRelay::closeClient(int fd, const char* reason)
+{
+    auto it = m_clients.find(fd);
+    if (it == m_clients.end()) {
+        return;
+    }
+    LOG_INFO("TelemetryRelay", "Client {} disconnected ({}), sent {} frames, dropped {}", it->second.peer, reason,
+             it->second.sentFrames, it->second.dropped);
+    m_loop->removeFd(fd);
+    ::close(fd);
+    m_clients.erase(it);
+}
+
+void TelemetryRelay::printStats()
+{
+    if (!isRunning()) {
+        std::cout << "[relay] Not running (set relayPort in config).\n";
+        return;
+    }
+    m_loop->runInLoop([this] {
+        std::cout << "[relay] clients=" << m_clients.size() << " framesIn=" << m_framesIn
+                  << " dropped=" << m_framesDropped << " slowDisconnects=" << m_slowDisconnects << "\n";
+        for (const auto& kv : m_clients) {
+            const Client& c = kv.second;
+            std::cout << "[relay]   " << c.peer << " queued=" << c.queuedBytes << "B sent=" << c.sentFrames
+                      << " dropped=" << c.dropped << " subscribed=" << c.filter.count() << "\n";
+        }
+    });
+}
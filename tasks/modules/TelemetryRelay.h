@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common_types.h"
+#include "utils/CLinuxTCPCom.h"
+#include "utils/EventLoop.h"
+
+/**
+ * @brief 遥测中继：本程序保持唯一一条到云盒的上行连接，把收到的完整回复帧（0x6A 0x77 ...）
+ *        原样转发给任意多个下游 TCP 客户端（看板、记录器等），避免每个看板各自连接云盒。
+ *
+ *        - 监听套接字由 CLinuxTCPCom::TCPInitServer / TCPAccept 建立，所有客户端读写都在 g_eventLoop 中进行；
+ *        - 解析线程 publish() 时把帧移入引用计数缓冲（shared_ptr），分发给各客户端时只复制指针，
+ *          发送用 sendmsg 直接从共享缓冲聚合写出，不再拷贝负载；
+ *        - 每个客户端一个有上限的发送队列，只按整帧丢弃，下游看到的始终是完整帧；
+ *          超限时按策略丢弃最旧的未发送帧（drop-oldest，遥测只关心最新值）或直接断开（disconnect）；
+ *          队列非空且超过 kStallTimeoutMs 没有任何写出进展的客户端视为卡死，无论策略如何都断开；
+ *        - 客户端可发送文本行订阅指定命令：`sub a9 a8` / `sub all`，默认全部转发。
+ */
+class TelemetryRelay
+{
+public:
+    enum class SlowPolicy { DropOldest, Disconnect };
+
+    static constexpr uint64_t kStallTimeoutMs = 10000;
+
+    /**
+     * @brief 监听 bindIp:port 并在 loop 上服务（可在任意线程调用）
+     * @param maxQueueBytes 每个客户端排队的最大字节数
+     */
+    bool start(EventLoop& loop, const std::string& bindIp, uint16_t port, size_t maxQueueBytes, SlowPolicy policy);
+    void stop();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 转发一帧完整回复帧（解析线程调用）；未启动时直接返回
+     */
+    void publish(DataFrame&& frame);
+
+    /**
+     * @brief 打印各客户端队列与丢弃统计（内部投递到事件循环执行）
+     */
+    void printStats();
+
+    static bool parsePolicy(const std::string& name, SlowPolicy& policy);
+
+private:
+    using Buffer = std::shared_ptr<const DataFrame>;
+
+    struct Client {
+        int                fd = -1;
+        std::string        peer;
+        std::bitset<256>   filter;              ///< 订阅的 cmdId，all 时全部置位
+        std::deque<Buffer> queue;
+        size_t             headOffset  = 0;     ///< 队首帧已写出的字节数
+        size_t             queuedBytes = 0;     ///< 队列中尚未写出的字节数
+        uint64_t           lastProgressNs = 0;  ///< 最近一次写出数据（或队列变空）的时刻
+        uint64_t           sentFrames  = 0;
+        uint64_t           dropped     = 0;
+        bool               wantWrite   = false; ///< 已注册 EPOLLOUT
+        std::string        lineBuf;             ///< 订阅命令的未完整行
+    };
+
+    void onAccept();
+    void onClientEvent(int fd, uint32_t events);
+    void handleCommand(Client& c, const std::string& line);
+    void drainPending();
+    void enqueue(Client& c, const Buffer& buf);
+    bool flush(Client& c);
+    void closeClient(int fd, const char* reason);
+
+private:
+    EventLoop*        m_loop = nullptr;
+    CLinuxTCPCom      m_listener;
+    size_t            m_maxQueueBytes = 0;
+    SlowPolicy        m_policy = SlowPolicy::DropOldest;
+    std::atomic<bool> m_running{false};
+
+    std::mutex          m_pendingMutex;
+    std::vector<Buffer> m_pending;              ///< 解析线程 → 事件循环，非空时已投递一次 drainPending
+
+    std::unordered_map<int, Client> m_clients;  ///< 仅事件循环线程访问
+
+    // 累计统计（事件循环线程写）
+    uint64_t m_framesIn        = 0;
+    uint64_t m_framesDropped   = 0;
+    uint64_t m_slowDisconnects = 0;
+};
+
+/**
+ * @brief 进程内唯一的遥测中继，relayPort 为 0 时不启动
+ */
+extern TelemetryRelay g_telemetryRelay;
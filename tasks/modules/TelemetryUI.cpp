@@ -1,7 +1,13 @@
 #include "TelemetryUI.h"
 #include <iostream>
 #include <chrono>
+#include <cmath>
 #include <thread>
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
+#include "utils/AllocTrace.h"
+#include "utils/ThreadSched.h"
+#include "ClockSync.h"
 
 // GLFW + OpenGL + ImGui 相关头
 #include <GLFW/glfw3.h>
@@ -41,19 +47,47 @@ void TelemetryUI::stop()
 
 void TelemetryUI::update(const TelemetryData& data)
 {
+    Tracer::Scope traceScope("publish", Tracer::currentFlow(), Tracer::Flow::Step);
     // 用锁保护，防止渲染线程同时访问
-    std::lock_guard<std::mutex> lock(m_dataMutex);
-    m_data = data;
+    {
+        std::lock_guard<std::mutex> lock(m_dataMutex);
+        m_data = data;
+    }
+    markPending();
 }
 
 void TelemetryUI::updateUavState(const UavState& state)
 {
-    std::lock_guard<std::mutex> lock(m_uavStateMutex);
-    m_uavState = state;
+    Tracer::Scope traceScope("publish", Tracer::currentFlow(), Tracer::Flow::Step);
+    {
+        // 以序列化字节保存：消息赋值先 Clear()，会删除并重新分配全部子消息，遥测路径上每帧都要分配
+        const size_t size = state.ByteSizeLong();
+        std::lock_guard<std::mutex> lock(m_uavStateMutex);
+        m_uavStateBytes.resize(size);
+        if (size > 0) {
+            state.SerializeToArray(m_uavStateBytes.data(), static_cast<int>(size));
+        }
+        m_uavStateDirty = true;
+    }
+    markPending();
+}
+
+void TelemetryUI::markPending()
+{
+    // 只保留最早的时刻：同一画面内合并的多次更新按最久等待的那次计时
+    uint64_t expected = 0;
+    m_pendingSinceNs.compare_exchange_strong(expected, Metrics::nowNs(), std::memory_order_relaxed);
+    if (const uint64_t flow = Tracer::currentFlow()) {
+        m_pendingTraceId.store(flow, std::memory_order_relaxed);
+    }
 }
 
 void TelemetryUI::uiThreadFunc()
 {
+    Tracer::setThreadName("ui");
+    ThreadSched::apply("ui");
+    AllocTrace::setThreadStage(AllocTrace::Render);
+
     // ---------------------------
     // 1) 初始化 GLFW
     // ---------------------------
@@ -94,6 +128,7 @@ void TelemetryUI::uiThreadFunc()
     while (!glfwWindowShouldClose(window) && !m_stop)
     {
         glfwPollEvents();
+        const uint64_t frameBeginNs = Tracer::enabled() ? Metrics::nowNs() : 0;
 
         // 新 ImGui 帧
         ImGui_ImplOpenGL3_NewFrame();
@@ -111,6 +146,17 @@ void TelemetryUI::uiThreadFunc()
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         glfwSwapBuffers(window);
+
+        const uint64_t pendingNs = m_pendingSinceNs.exchange(0, std::memory_order_relaxed);
+        if (pendingNs) {
+            const uint64_t renderedNs = Metrics::nowNs();
+            Metrics::recordStage(Metrics::HandledToRendered, pendingNs, renderedNs);
+            Metrics::add(Metrics::FramesRendered);
+            const uint64_t traceId = m_pendingTraceId.exchange(0, std::memory_order_relaxed);
+            if (traceId) {
+                Tracer::complete("render", frameBeginNs, renderedNs, traceId, Tracer::Flow::End);
+            }
+        }
     }
 
     // ---------------------------
@@ -150,6 +196,15 @@ void TelemetryUI::render()
         ImGui::Text("airspeed: %.2f m/s", m_data.airspeed());
         ImGui::Text("velocity: %.2f m/s", m_data.velocity());
         ImGui::Text("timestamp: %llu", static_cast<unsigned long long>(m_data.timestamp()));
+        // 数据龄：机载时间戳按估计的时钟偏差换算到本机时间后，距现在的时长
+        const double ageMs = g_clockSync.ageMs(m_data.timestamp());
+        if (!std::isnan(ageMs)) {
+            const ClockSync::Estimate clk = g_clockSync.estimate();
+            ImGui::Text("age: %.0f ms (link latency %.0f ms, %s)", ageMs, clk.lastLatencyMs,
+                        clk.fromExchange ? "heartbeat sync" : "one-way estimate");
+        } else {
+            ImGui::Text("age: n/a");
+        }
         ImGui::Text("ptpitch: %.2f deg", m_data.ptpitch());
         ImGui::Text("ptroll: %.2f deg", m_data.ptroll());
         ImGui::Text("ptyaw: %.2f deg", m_data.ptyaw());
@@ -189,6 +244,11 @@ void TelemetryUI::render()
     {
         // 为了保证读写安全，需要加锁
         std::lock_guard<std::mutex> lock(m_uavStateMutex);
+        if (m_uavStateDirty) {
+            // 解析放在渲染线程：子消息的分配不落在遥测路径上
+            m_uavState.ParseFromArray(m_uavStateBytes.data(), static_cast<int>(m_uavStateBytes.size()));
+            m_uavStateDirty = false;
+        }
 
         ImGui::Begin("UAV State",
                      nullptr,
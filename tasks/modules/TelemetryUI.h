@@ -3,11 +3,15 @@
 #include <atomic>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <string>
 #include "TelemetryDataBuf-new.pb.h"
 
 class TelemetryUI
 {
+    // 微基准（bench/micro_bench.cpp）模拟渲染线程持锁
+    friend struct BenchAccess;
+
 public:
     TelemetryUI();
     ~TelemetryUI();
@@ -31,6 +35,9 @@ private:
     // 渲染 ImGui 界面
     void render();
 
+    // 记录有新数据待绘制
+    void markPending();
+
 private:
     std::atomic_bool m_stop{false};
     std::thread      m_thread;
@@ -41,5 +48,11 @@ private:
 
     // -------------------- 新增：保护 UavState 的读写 --------------------
     std::mutex       m_uavStateMutex;
-    UavState         m_uavState;
+    std::vector<uint8_t> m_uavStateBytes;   ///< 遥测线程写入的最新 UavState 序列化字节（缓冲区复用）
+    bool             m_uavStateDirty = false;
+    UavState         m_uavState;            ///< 渲染线程解析出的视图，只在渲染线程使用
+
+    // 最早一次尚未绘制的更新时刻（Metrics::nowNs()），0 表示自上次提交画面后没有新数据
+    std::atomic<uint64_t> m_pendingSinceNs{0};
+    std::atomic<uint64_t> m_pendingTraceId{0};   ///< 最近一次待绘制更新的 Tracer flow ID
 };
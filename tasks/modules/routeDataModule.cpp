@@ -1,77 +1,636 @@
 #include "routeDataModule.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
-#include <google/protobuf/util/json_util.h> // MessageToJsonString, JsonStringToMessage
-#include <nlohmann/json.hpp>               // 仅用于再次 parse/dump 以实现美化输出
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <nlohmann/json.hpp>               // 仅使用其 SAX 解析器，不构造 DOM
+
+namespace pb = google::protobuf;
+
+namespace {
+
+// ------------------------------------------------------------------
+// 只读映射整个文件，析构时自动解除映射
+// ------------------------------------------------------------------
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+        m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(m_fd, &st) < 0 || st.st_size <= 0) {
+            return;
+        }
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (addr == MAP_FAILED) {
+            return;
+        }
+        // 顺序扫描，提示内核加大预读
+        ::madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(addr);
+        m_size = static_cast<size_t>(st.st_size);
+    }
+
+    ~MappedFile()
+    {
+        if (m_data) {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool        isOpen() const { return m_fd >= 0; }
+    const char* data()   const { return m_data; }
+    size_t      size()   const { return m_size; }
+
+private:
+    int         m_fd   = -1;
+    const char* m_data = nullptr;
+    size_t      m_size = 0;
+};
+
+// ------------------------------------------------------------------
+// SAX 处理器：按 token 流直接写入 protobuf 消息（通过反射，支持任意嵌套消息）
+// ------------------------------------------------------------------
+class PlanJsonSaxHandler
+{
+public:
+    using json = nlohmann::json;
+
+    explicit PlanJsonSaxHandler(pb::Message& root) : m_root(root) {}
+
+    const std::string& error() const { return m_error; }
+
+    // ---------- 标量 ----------
+    bool null()
+    {
+        // 与 protobuf JSON 语义一致：null 表示使用默认值
+        clearPendingField();
+        return true;
+    }
+
+    bool boolean(bool val)
+    {
+        return setScalar([&](pb::Message* msg, const pb::FieldDescriptor* f, const pb::Reflection* r, bool rep) {
+            if (f->cpp_type() != pb::FieldDescriptor::CPPTYPE_BOOL) {
+                return typeError(f, "bool");
+            }
+            rep ? r->AddBool(msg, f, val) : r->SetBool(msg, f, val);
+            return true;
+        });
+    }
+
+    bool number_integer(json::number_integer_t val)
+    {
+        return setNumber(static_cast<double>(val), val, val >= 0, static_cast<uint64_t>(val), true);
+    }
+
+    bool number_unsigned(json::number_unsigned_t val)
+    {
+        return setNumber(static_cast<double>(val), static_cast<int64_t>(val),
+                         true, val, val <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()));
+    }
+
+    bool number_float(json::number_float_t val, const json::string_t& /*raw*/)
+    {
+        double integral = 0.0;
+        const bool isIntegral = std::modf(val, &integral) == 0.0 &&
+                                std::fabs(val) < 9.2e18;
+        return setNumber(val, static_cast<int64_t>(val), val >= 0,
+                         val >= 0 ? static_cast<uint64_t>(val) : 0, isIntegral, !isIntegral);
+    }
+
+    bool string(json::string_t& val)
+    {
+        return setScalar([&](pb::Message* msg, const pb::FieldDescriptor* f, const pb::Reflection* r, bool rep) {
+            switch (f->cpp_type()) {
+            case pb::FieldDescriptor::CPPTYPE_STRING:
+                if (f->type() == pb::FieldDescriptor::TYPE_BYTES) {
+                    return typeError(f, "string");
+                }
+                rep ? r->AddString(msg, f, std::move(val)) : r->SetString(msg, f, std::move(val));
+                return true;
+            case pb::FieldDescriptor::CPPTYPE_ENUM: {
+                const pb::EnumValueDescriptor* ev = f->enum_type()->FindValueByName(val);
+                if (!ev) {
+                    return fail("unknown enum value \"" + val + "\" for field " + f->name());
+                }
+                rep ? r->AddEnum(msg, f, ev) : r->SetEnum(msg, f, ev);
+                return true;
+            }
+            default:
+                break;
+            }
+            // protobuf JSON 允许数字以字符串形式出现（如 64 位整数、"NaN"、"Infinity"）
+            if (val == "NaN" || val == "Infinity" || val == "-Infinity") {
+                const double d = (val == "NaN")      ? std::numeric_limits<double>::quiet_NaN()
+                               : (val == "Infinity") ? std::numeric_limits<double>::infinity()
+                                                     : -std::numeric_limits<double>::infinity();
+                return assignNumber(msg, f, r, rep, d, 0, false, 0, false, true);
+            }
+            const char* first = val.data();
+            const char* last  = val.data() + val.size();
+            int64_t  i = 0;
+            uint64_t u = 0;
+            double   d = 0.0;
+            if (std::from_chars(first, last, i).ptr == last) {
+                return assignNumber(msg, f, r, rep, static_cast<double>(i), i, i >= 0, static_cast<uint64_t>(i), true, false);
+            }
+            if (std::from_chars(first, last, u).ptr == last) {
+                return assignNumber(msg, f, r, rep, static_cast<double>(u), 0, true, u, false, false);
+            }
+            if (std::from_chars(first, last, d).ptr == last) {
+                return assignNumber(msg, f, r, rep, d, 0, false, 0, false, true);
+            }
+            return typeError(f, "string");
+        });
+    }
+
+    bool binary(json::binary_t& /*val*/)
+    {
+        return fail("binary values are not supported");
+    }
+
+    // ---------- 结构 ----------
+    bool start_object(std::size_t /*elements*/)
+    {
+        if (m_stack.empty()) {
+            m_stack.push_back({&m_root, nullptr, false});
+            return true;
+        }
+        Context& top = m_stack.back();
+        const pb::FieldDescriptor* f = top.field;
+        if (!f) {
+            return fail("unexpected object");
+        }
+        if (f->cpp_type() != pb::FieldDescriptor::CPPTYPE_MESSAGE) {
+            return typeError(f, "object");
+        }
+        const pb::Reflection* r = top.msg->GetReflection();
+        pb::Message* child = nullptr;
+        if (top.isArray) {
+            child = r->AddMessage(top.msg, f);
+        } else {
+            if (f->is_repeated()) {
+                return typeError(f, "object");
+            }
+            child = r->MutableMessage(top.msg, f);
+            top.field = nullptr;
+        }
+        m_stack.push_back({child, nullptr, false});
+        return true;
+    }
+
+    bool key(json::string_t& val)
+    {
+        Context& top = m_stack.back();
+        const pb::Descriptor* desc = top.msg->GetDescriptor();
+        const pb::FieldDescriptor* f = desc->FindFieldByName(val);
+        if (!f) {
+            f = desc->FindFieldByCamelcaseName(val);
+        }
+        if (!f) {
+            return fail("unknown field \"" + val + "\" in " + desc->name());
+        }
+        top.field = f;
+        return true;
+    }
+
+    bool end_object()
+    {
+        m_stack.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t /*elements*/)
+    {
+        if (m_stack.empty()) {
+            return fail("top-level value must be an object");
+        }
+        Context& top = m_stack.back();
+        const pb::FieldDescriptor* f = top.field;
+        if (!f || top.isArray) {
+            return fail("unexpected array");
+        }
+        if (!f->is_repeated()) {
+            return typeError(f, "array");
+        }
+        top.field = nullptr;
+        m_stack.push_back({top.msg, f, true});
+        return true;
+    }
+
+    bool end_array()
+    {
+        m_stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string& /*lastToken*/,
+                     const nlohmann::detail::exception& ex)
+    {
+        if (m_error.empty()) {
+            m_error = "syntax error at byte " + std::to_string(position) + ": " + ex.what();
+        }
+        return false;
+    }
+
+private:
+    struct Context {
+        pb::Message*               msg;
+        const pb::FieldDescriptor* field;   ///< 对象: 当前 key 对应的字段; 数组: 该 repeated 字段
+        bool                       isArray;
+    };
+
+    bool fail(const std::string& msg)
+    {
+        if (m_error.empty()) {
+            m_error = msg;
+        }
+        return false;
+    }
+
+    bool typeError(const pb::FieldDescriptor* f, const char* got)
+    {
+        return fail(std::string("field ") + f->full_name() + " does not accept a JSON " + got);
+    }
+
+    void clearPendingField()
+    {
+        if (!m_stack.empty() && !m_stack.back().isArray) {
+            m_stack.back().field = nullptr;
+        }
+    }
+
+    template <typename Fn>
+    bool setScalar(Fn&& fn)
+    {
+        if (m_stack.empty()) {
+            return fail("top-level value must be an object");
+        }
+        Context& top = m_stack.back();
+        const pb::FieldDescriptor* f = top.field;
+        if (!f) {
+            return fail("value without key");
+        }
+        if (!top.isArray && f->is_repeated()) {
+            return typeError(f, "scalar");
+        }
+        if (f->cpp_type() == pb::FieldDescriptor::CPPTYPE_MESSAGE) {
+            return typeError(f, "scalar");
+        }
+        const bool ok = fn(top.msg, f, top.msg->GetReflection(), top.isArray);
+        if (!top.isArray) {
+            top.field = nullptr;
+        }
+        return ok;
+    }
+
+    bool setNumber(double d, int64_t i, bool nonNegative, uint64_t u, bool isIntegral, bool isFloat = false)
+    {
+        return setScalar([&](pb::Message* msg, const pb::FieldDescriptor* f, const pb::Reflection* r, bool rep) {
+            return assignNumber(msg, f, r, rep, d, i, nonNegative, u, isIntegral, isFloat);
+        });
+    }
+
+    bool assignNumber(pb::Message* msg, const pb::FieldDescriptor* f, const pb::Reflection* r, bool rep,
+                      double d, int64_t i, bool nonNegative, uint64_t u, bool isIntegral, bool isFloat)
+    {
+        using FD = pb::FieldDescriptor;
+        auto outOfRange = [&]() { return fail("value out of range for field " + f->full_name()); };
+
+        switch (f->cpp_type()) {
+        case FD::CPPTYPE_DOUBLE:
+            rep ? r->AddDouble(msg, f, d) : r->SetDouble(msg, f, d);
+            return true;
+        case FD::CPPTYPE_FLOAT:
+            rep ? r->AddFloat(msg, f, static_cast<float>(d)) : r->SetFloat(msg, f, static_cast<float>(d));
+            return true;
+        case FD::CPPTYPE_INT32:
+            if (isFloat || !isIntegral || i < std::numeric_limits<int32_t>::min() || i > std::numeric_limits<int32_t>::max()) {
+                return outOfRange();
+            }
+            rep ? r->AddInt32(msg, f, static_cast<int32_t>(i)) : r->SetInt32(msg, f, static_cast<int32_t>(i));
+            return true;
+        case FD::CPPTYPE_INT64:
+            if (isFloat || !isIntegral) {
+                return outOfRange();
+            }
+            rep ? r->AddInt64(msg, f, i) : r->SetInt64(msg, f, i);
+            return true;
+        case FD::CPPTYPE_UINT32:
+            if (isFloat || !nonNegative || u > std::numeric_limits<uint32_t>::max()) {
+                return outOfRange();
+            }
+            rep ? r->AddUInt32(msg, f, static_cast<uint32_t>(u)) : r->SetUInt32(msg, f, static_cast<uint32_t>(u));
+            return true;
+        case FD::CPPTYPE_UINT64:
+            if (isFloat || !nonNegative) {
+                return outOfRange();
+            }
+            rep ? r->AddUInt64(msg, f, u) : r->SetUInt64(msg, f, u);
+            return true;
+        case FD::CPPTYPE_ENUM:
+            if (isFloat || !isIntegral || i < std::numeric_limits<int32_t>::min() || i > std::numeric_limits<int32_t>::max()) {
+                return outOfRange();
+            }
+            rep ? r->AddEnumValue(msg, f, static_cast<int>(i)) : r->SetEnumValue(msg, f, static_cast<int>(i));
+            return true;
+        default:
+            return typeError(f, "number");
+        }
+    }
+
+private:
+    pb::Message&         m_root;
+    std::vector<Context> m_stack;
+    std::string          m_error;
+};
+
+// ------------------------------------------------------------------
+// 流式 JSON 写出：格式与 nlohmann::json::dump(4) 相同（键按字节序排序）
+// ------------------------------------------------------------------
+class PlanJsonWriter
+{
+public:
+    explicit PlanJsonWriter(std::ofstream& ofs) : m_ofs(ofs)
+    {
+        m_buf.reserve(kFlushSize + 4096);
+    }
+
+    bool write(const pb::Message& msg)
+    {
+        writeMessage(msg, 0);
+        flush();
+        return m_error.empty() && m_ofs.good();
+    }
+
+    const std::string& error() const { return m_error; }
+
+private:
+    static constexpr size_t kFlushSize = 1 << 20;   ///< 缓冲超过 1 MiB 即写出
+    static constexpr int    kIndent    = 4;
+
+    const std::vector<const pb::FieldDescriptor*>& sortedFields(const pb::Descriptor* desc)
+    {
+        auto it = m_fieldCache.find(desc);
+        if (it != m_fieldCache.end()) {
+            return it->second;
+        }
+        std::vector<const pb::FieldDescriptor*> fields;
+        fields.reserve(desc->field_count());
+        for (int i = 0; i < desc->field_count(); ++i) {
+            fields.push_back(desc->field(i));
+        }
+        std::sort(fields.begin(), fields.end(),
+                  [](const pb::FieldDescriptor* a, const pb::FieldDescriptor* b) { return a->name() < b->name(); });
+        return m_fieldCache.emplace(desc, std::move(fields)).first->second;
+    }
+
+    void newline(int depth)
+    {
+        m_buf.push_back('\n');
+        m_buf.append(static_cast<size_t>(depth * kIndent), ' ');
+        if (m_buf.size() >= kFlushSize) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        m_ofs.write(m_buf.data(), static_cast<std::streamsize>(m_buf.size()));
+        m_buf.clear();
+    }
+
+    void writeMessage(const pb::Message& msg, int depth)
+    {
+        const pb::Reflection* r = msg.GetReflection();
+        bool first = true;
+        for (const pb::FieldDescriptor* f : sortedFields(msg.GetDescriptor())) {
+            // 与 always_print_primitive_fields 一致：未设置的子消息不输出，其余字段总是输出
+            if (!f->is_repeated() && f->cpp_type() == pb::FieldDescriptor::CPPTYPE_MESSAGE && !r->HasField(msg, f)) {
+                continue;
+            }
+            m_buf.append(first ? "{" : ",");
+            first = false;
+            newline(depth + 1);
+            writeString(f->name());
+            m_buf.append(": ");
+            if (f->is_repeated()) {
+                writeRepeated(msg, f, depth + 1);
+            } else {
+                writeValue(msg, f, -1, depth + 1);
+            }
+        }
+        if (first) {
+            m_buf.append("{}");
+            return;
+        }
+        newline(depth);
+        m_buf.push_back('}');
+    }
+
+    void writeRepeated(const pb::Message& msg, const pb::FieldDescriptor* f, int depth)
+    {
+        const int n = msg.GetReflection()->FieldSize(msg, f);
+        if (n == 0) {
+            m_buf.append("[]");
+            return;
+        }
+        m_buf.push_back('[');
+        for (int i = 0; i < n; ++i) {
+            if (i > 0) {
+                m_buf.push_back(',');
+            }
+            newline(depth + 1);
+            writeValue(msg, f, i, depth + 1);
+        }
+        newline(depth);
+        m_buf.push_back(']');
+    }
+
+    // index < 0 表示单值字段
+    void writeValue(const pb::Message& msg, const pb::FieldDescriptor* f, int index, int depth)
+    {
+        using FD = pb::FieldDescriptor;
+        const pb::Reflection* r = msg.GetReflection();
+        const bool rep = index >= 0;
+        switch (f->cpp_type()) {
+        case FD::CPPTYPE_MESSAGE:
+            writeMessage(rep ? r->GetRepeatedMessage(msg, f, index) : r->GetMessage(msg, f), depth);
+            break;
+        case FD::CPPTYPE_INT32:
+            writeInteger(rep ? r->GetRepeatedInt32(msg, f, index) : r->GetInt32(msg, f));
+            break;
+        case FD::CPPTYPE_UINT32:
+            writeInteger(rep ? r->GetRepeatedUInt32(msg, f, index) : r->GetUInt32(msg, f));
+            break;
+        case FD::CPPTYPE_INT64:     // protobuf JSON 中 64 位整数以字符串输出
+            m_buf.push_back('"');
+            writeInteger(rep ? r->GetRepeatedInt64(msg, f, index) : r->GetInt64(msg, f));
+            m_buf.push_back('"');
+            break;
+        case FD::CPPTYPE_UINT64:
+            m_buf.push_back('"');
+            writeInteger(rep ? r->GetRepeatedUInt64(msg, f, index) : r->GetUInt64(msg, f));
+            m_buf.push_back('"');
+            break;
+        case FD::CPPTYPE_FLOAT:
+            writeFloating(rep ? r->GetRepeatedFloat(msg, f, index) : r->GetFloat(msg, f));
+            break;
+        case FD::CPPTYPE_DOUBLE:
+            writeFloating(rep ? r->GetRepeatedDouble(msg, f, index) : r->GetDouble(msg, f));
+            break;
+        case FD::CPPTYPE_BOOL:
+            m_buf.append((rep ? r->GetRepeatedBool(msg, f, index) : r->GetBool(msg, f)) ? "true" : "false");
+            break;
+        case FD::CPPTYPE_ENUM:
+            writeString((rep ? r->GetRepeatedEnum(msg, f, index) : r->GetEnum(msg, f))->name());
+            break;
+        case FD::CPPTYPE_STRING:
+            if (f->type() == FD::TYPE_BYTES) {
+                if (m_error.empty()) {
+                    m_error = "bytes field " + f->full_name() + " is not supported";
+                }
+                m_buf.append("\"\"");
+                break;
+            }
+            writeString(rep ? r->GetRepeatedStringReference(msg, f, index, &m_scratch)
+                            : r->GetStringReference(msg, f, &m_scratch));
+            break;
+        }
+    }
+
+    template <typename T>
+    void writeInteger(T v)
+    {
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        m_buf.append(tmp, res.ptr);
+    }
+
+    template <typename T>
+    void writeFloating(T v)
+    {
+        if (std::isnan(v)) {
+            m_buf.append("\"NaN\"");
+            return;
+        }
+        if (std::isinf(v)) {
+            m_buf.append(v > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+            return;
+        }
+        // 最短可往返表示（与 protobuf 输出后再经 nlohmann 重排版的结果一致）
+        char tmp[32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        m_buf.append(tmp, res.ptr);
+    }
+
+    void writeString(const std::string& s)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        m_buf.push_back('"');
+        for (unsigned char c : s) {
+            switch (c) {
+            case '"':  m_buf.append("\\\""); break;
+            case '\\': m_buf.append("\\\\"); break;
+            case '\b': m_buf.append("\\b");  break;
+            case '\f': m_buf.append("\\f");  break;
+            case '\n': m_buf.append("\\n");  break;
+            case '\r': m_buf.append("\\r");  break;
+            case '\t': m_buf.append("\\t");  break;
+            default:
+                if (c < 0x20) {
+                    m_buf.append("\\u00");
+                    m_buf.push_back(kHex[c >> 4]);
+                    m_buf.push_back(kHex[c & 0x0F]);
+                } else {
+                    m_buf.push_back(static_cast<char>(c));   // UTF-8 原样输出
+                }
+                break;
+            }
+        }
+        m_buf.push_back('"');
+    }
+
+private:
+    std::ofstream& m_ofs;
+    std::string    m_buf;
+    std::string    m_scratch;
+    std::string    m_error;
+    std::unordered_map<const pb::Descriptor*, std::vector<const pb::FieldDescriptor*>> m_fieldCache;
+};
+
+} // namespace
 
 bool RouteDataModule::jsonFileToPlanLineData(const std::string& jsonFilePath,
                                              PlanLineData& planData)
 {
-    namespace pbutil = google::protobuf::util;
-
-    // 1. 读取 JSON 文件内容到字符串
-    std::ifstream ifs(jsonFilePath);
-    if (!ifs.is_open()) {
+    // 1. 映射 JSON 文件（不再整体拷贝到字符串）
+    MappedFile file(jsonFilePath);
+    if (!file.isOpen()) {
         std::cerr << "[RouteDataModule] Failed to open file: " << jsonFilePath << std::endl;
         return false;
     }
-    std::string jsonStr((std::istreambuf_iterator<char>(ifs)),
-                        std::istreambuf_iterator<char>());
-    ifs.close();
+    if (!file.data()) {
+        std::cerr << "[RouteDataModule] Failed to map file (empty?): " << jsonFilePath << std::endl;
+        return false;
+    }
 
-    // 2. 使用 protobuf 的 JsonStringToMessage 将 JSON 字符串转为 Protobuf 对象
-    pbutil::JsonParseOptions parseOptions;
-    parseOptions.ignore_unknown_fields = false; // 如果文件里有未知字段，你可选择是否忽略
-    auto parseStatus = pbutil::JsonStringToMessage(jsonStr, &planData, parseOptions);
-    if (!parseStatus.ok()) {
+    // 2. SAX 逐 token 解析，直接构建 PlanLineData / PointData
+    PlanJsonSaxHandler handler(planData);
+    const bool ok = nlohmann::json::sax_parse(file.data(), file.data() + file.size(), &handler);
+    if (!ok) {
         std::cerr << "[RouteDataModule] Failed to parse JSON to PlanLineData: "
-                  << parseStatus.ToString() << std::endl;
+                  << handler.error() << std::endl;
         return false;
     }
 
-    std::cout << "[RouteDataModule] jsonFileToPlanLineData: [" << jsonFilePath << "] done.\n";
+    std::cout << "[RouteDataModule] jsonFileToPlanLineData: [" << jsonFilePath << "] done, "
+              << planData.points_size() << " points.\n";
     return true;
 }
 
 bool RouteDataModule::planLineDataToJsonFile(const PlanLineData& planData,
                                              const std::string& jsonFilePath)
 {
-    namespace pbutil = google::protobuf::util;
-
-    // 1. 将 Protobuf 对象转换为 JSON 字符串（带格式选项）
-    std::string protoJsonStr;
-    pbutil::JsonPrintOptions jpOptions;
-    jpOptions.add_whitespace = true;            // 美化输出
-    jpOptions.always_print_primitive_fields = true;
-    jpOptions.preserve_proto_field_names = true;
-
-    auto status = pbutil::MessageToJsonString(planData, &protoJsonStr, jpOptions);
-    if (!status.ok()) {
-        std::cerr << "[RouteDataModule] Failed to convert PlanLineData to JSON: "
-                  << status.ToString() << std::endl;
-        return false;
-    }
-
-    // 2. 使用 nlohmann::json 再解析一次，仅用于更优雅的 dump(4) 格式化输出
-    nlohmann::json j;
-    try {
-        j = nlohmann::json::parse(protoJsonStr);
-    } catch (const std::exception& e) {
-        std::cerr << "[RouteDataModule] Failed to parse protoJsonStr with nlohmann: "
-                  << e.what() << std::endl;
-        return false;
-    }
-
-    // 3. 写入 JSON 文件
-    std::ofstream ofs(jsonFilePath);
+    std::ofstream ofs(jsonFilePath, std::ios::binary | std::ios::trunc);
     if (!ofs.is_open()) {
         std::cerr << "[RouteDataModule] Failed to open file for writing: "
                   << jsonFilePath << std::endl;
         return false;
     }
-    ofs << j.dump(4); // 4 个空格缩进
+
+    // 一次遍历直接输出（4 个空格缩进），不经过中间 JSON 字符串与 nlohmann 往返
+    PlanJsonWriter writer(ofs);
+    if (!writer.write(planData)) {
+        std::cerr << "[RouteDataModule] Failed to write PlanLineData as JSON: "
+                  << (writer.error().empty() ? "I/O error" : writer.error()) << std::endl;
+        return false;
+    }
     ofs.close();
 
     std::cout << "[RouteDataModule] planLineDataToJsonFile: [" << jsonFilePath << "] done.\n";
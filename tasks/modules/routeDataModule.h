@@ -5,6 +5,12 @@
 
 /**
  * @brief 负责将航迹文件(JSON) 转化为基于 protobuf 的 PlanLineData 数据结构（以及反向）。
+ *
+ *        读写均为流式实现：
+ *        - 读取时 mmap 整个文件，由 nlohmann 的 SAX 接口逐 token 推进，
+ *          借助 protobuf 反射直接填充 PlanLineData / PointData，不再构造中间 JSON 字符串或 DOM。
+ *        - 写入时一次遍历 PlanLineData，按块直接写出带 4 空格缩进的 JSON，
+ *          输出格式（字段按名字排序、基础字段总是输出）与原先 protobuf + nlohmann::dump(4) 的结果一致。
  */
 class RouteDataModule
 {
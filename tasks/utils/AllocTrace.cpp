@@ -0,0 +1,293 @@
+#include "AllocTrace.h"
+
+#include <google/protobuf/arena.h>
+
+#ifdef DJI_ALLOC_TRACE
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <fstream>
+#include <new>
+#include <unistd.h>
+#include "Metrics.h"
+#endif
+
+namespace {
+
+const char* const kStageNames[AllocTrace::StageCount] = {
+    "other", "recv", "assemble", "decode", "telemetry", "render", "send", "event_loop",
+};
+
+} // namespace
+
+const char* AllocTrace::stageName(Stage stage)
+{
+    return stage < StageCount ? kStageNames[stage] : "?";
+}
+
+#ifndef DJI_ALLOC_TRACE
+
+google::protobuf::ArenaOptions AllocTrace::arenaOptions(char* initialBlock, size_t initialBlockSize)
+{
+    google::protobuf::ArenaOptions opts;
+    opts.initial_block      = initialBlock;
+    opts.initial_block_size = initialBlockSize;
+    return opts;
+}
+
+std::string AllocTrace::toText()
+{
+    return "# allocation tracing not compiled in (cmake -DDJI_ALLOC_TRACE=ON)\n";
+}
+
+#else
+
+namespace {
+
+constexpr size_t   kHeaderSize = 16;
+constexpr uint32_t kMagic      = 0xA110CA7Eu;
+
+struct Header {
+    uint64_t size;
+    uint32_t stage;
+    uint32_t magic;
+};
+static_assert(sizeof(Header) == kHeaderSize, "header must keep 16-byte alignment");
+
+struct alignas(64) StageStats {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> live{0};
+    std::atomic<uint64_t> peak{0};
+    std::atomic<uint64_t> arenaBlocks{0};
+    std::atomic<uint64_t> arenaBytes{0};
+    std::atomic<uint64_t> frames{0};
+};
+
+// 静态存储零初始化，早于任何动态初始化，operator new 在程序启动最早期也可安全使用
+StageStats             g_stats[AllocTrace::StageCount];
+std::atomic<uint64_t>  g_assertAfter{0};   ///< 断言模式预热帧数，0 为关闭
+std::atomic<bool>      g_armed{false};
+
+thread_local uint8_t t_stage     = AllocTrace::Other;
+thread_local bool    t_reporting = false;
+
+[[noreturn]] void reportViolation(size_t size)
+{
+    t_reporting = true;
+    char msg[160];
+    const int n = std::snprintf(msg, sizeof(msg),
+                                "[AllocTrace] %zu-byte allocation on the steady-state telemetry path "
+                                "(DJI_ALLOC_ASSERT=%llu):\n",
+                                size, static_cast<unsigned long long>(g_assertAfter.load()));
+    ssize_t ignored = ::write(STDERR_FILENO, msg, static_cast<size_t>(n));
+    (void)ignored;
+    void* frames[32];
+    backtrace_symbols_fd(frames, backtrace(frames, 32), STDERR_FILENO);
+    std::abort();
+}
+
+void onAlloc(uint8_t stage, size_t size)
+{
+    StageStats& s = g_stats[stage];
+    s.allocs.fetch_add(1, std::memory_order_relaxed);
+    s.bytes.fetch_add(size, std::memory_order_relaxed);
+    const uint64_t live = s.live.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = s.peak.load(std::memory_order_relaxed);
+    while (live > peak && !s.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    if (stage == AllocTrace::Telemetry && g_armed.load(std::memory_order_relaxed) && !t_reporting) {
+        reportViolation(size);
+    }
+}
+
+void* tracedAlloc(size_t size, size_t align, bool nothrow)
+{
+    // 对齐要求不超过 16 时头部紧挨用户区；更大的对齐把用户区整体后移 align 字节，头部放在其前 16 字节
+    const size_t offset = align > kHeaderSize ? align : kHeaderSize;
+    void* raw = align > kHeaderSize ? std::aligned_alloc(align, (size + offset + align - 1) / align * align)
+                                    : std::malloc(size + offset);
+    if (!raw) {
+        if (nothrow) {
+            return nullptr;
+        }
+        throw std::bad_alloc();
+    }
+    char* user = static_cast<char*>(raw) + offset;
+    Header* h  = reinterpret_cast<Header*>(user - kHeaderSize);
+    h->size    = size;
+    h->stage   = t_stage;
+    h->magic   = kMagic;
+    onAlloc(t_stage, size);
+    return user;
+}
+
+void tracedFree(void* p, size_t align)
+{
+    if (!p) {
+        return;
+    }
+    char*   user = static_cast<char*>(p);
+    Header* h    = reinterpret_cast<Header*>(user - kHeaderSize);
+    if (h->magic == kMagic && h->stage < AllocTrace::StageCount) {
+        StageStats& s = g_stats[h->stage];
+        s.frees.fetch_add(1, std::memory_order_relaxed);
+        s.live.fetch_sub(h->size, std::memory_order_relaxed);
+    }
+    h->magic = 0;
+    std::free(user - (align > kHeaderSize ? align : kHeaderSize));
+}
+
+void* arenaBlockAlloc(size_t size)
+{
+    StageStats& s = g_stats[t_stage];
+    s.arenaBlocks.fetch_add(1, std::memory_order_relaxed);
+    s.arenaBytes.fetch_add(size, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void arenaBlockDealloc(void* p, size_t)
+{
+    ::operator delete(p);
+}
+
+struct Init {
+    Init()
+    {
+        if (const char* v = std::getenv("DJI_ALLOC_ASSERT")) {
+            g_assertAfter = std::strtoull(v, nullptr, 10);
+            // backtrace() 首次调用会加载 libgcc 并分配内存，先在这里调用一次
+            void* frames[1];
+            backtrace(frames, 1);
+        }
+    }
+} g_init;
+
+// Metrics 中与各阶段“帧”对应的计数器，-1 表示没有（Telemetry 使用 Scope 自己的计数）
+const int kFrameCounter[AllocTrace::StageCount] = {
+    -1, Metrics::RecvChunks, Metrics::FramesAssembled, Metrics::FramesDecoded,
+    -1, Metrics::FramesRendered, Metrics::FramesOut, -1,
+};
+
+uint64_t procStatusKb(const char* key)
+{
+    std::ifstream in("/proc/self/status");
+    std::string   line;
+    const size_t  keyLen = std::strlen(key);
+    while (std::getline(in, line)) {
+        if (line.compare(0, keyLen, key) == 0) {
+            return std::strtoull(line.c_str() + keyLen, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+AllocTrace::Scope::Scope(Stage stage, bool countFrame)
+    : m_prev(static_cast<Stage>(t_stage))
+    , m_countFrame(countFrame)
+{
+    t_stage = stage;
+}
+
+AllocTrace::Scope::~Scope()
+{
+    if (m_countFrame) {
+        const uint64_t frames = g_stats[t_stage].frames.fetch_add(1, std::memory_order_relaxed) + 1;
+        const uint64_t after  = g_assertAfter.load(std::memory_order_relaxed);
+        if (after && frames == after && t_stage == Telemetry) {
+            g_armed = true;
+        }
+    }
+    t_stage = m_prev;
+}
+
+void AllocTrace::setThreadStage(Stage stage)
+{
+    t_stage = stage;
+}
+
+google::protobuf::ArenaOptions AllocTrace::arenaOptions(char* initialBlock, size_t initialBlockSize)
+{
+    google::protobuf::ArenaOptions opts;
+    opts.initial_block      = initialBlock;
+    opts.initial_block_size = initialBlockSize;
+    opts.block_alloc        = arenaBlockAlloc;
+    opts.block_dealloc      = arenaBlockDealloc;
+    return opts;
+}
+
+std::string AllocTrace::toText()
+{
+    const Metrics::Snapshot snap = Metrics::snapshot();
+    std::string out = "# allocations per stage: allocs frees bytes frames allocs/frame bytes/frame live_kb peak_kb "
+                      "arena_blocks arena_kb\n";
+    char line[256];
+    for (int i = 0; i < StageCount; ++i) {
+        const StageStats& s = g_stats[i];
+        const uint64_t allocs = s.allocs.load(std::memory_order_relaxed);
+        const uint64_t bytes  = s.bytes.load(std::memory_order_relaxed);
+        const uint64_t frames = kFrameCounter[i] >= 0 ? snap.counters[kFrameCounter[i]]
+                                                      : s.frames.load(std::memory_order_relaxed);
+        const double   perFrameAllocs = frames ? static_cast<double>(allocs) / frames : 0.0;
+        const double   perFrameBytes  = frames ? static_cast<double>(bytes) / frames : 0.0;
+        std::snprintf(line, sizeof(line), "%-10s %10llu %10llu %12llu %9llu %9.2f %10.1f %9.1f %9.1f %6llu %9.1f\n",
+                      kStageNames[i], static_cast<unsigned long long>(allocs),
+                      static_cast<unsigned long long>(s.frees.load(std::memory_order_relaxed)),
+                      static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(frames),
+                      perFrameAllocs, perFrameBytes,
+                      static_cast<int64_t>(s.live.load(std::memory_order_relaxed)) / 1024.0,
+                      s.peak.load(std::memory_order_relaxed) / 1024.0,
+                      static_cast<unsigned long long>(s.arenaBlocks.load(std::memory_order_relaxed)),
+                      s.arenaBytes.load(std::memory_order_relaxed) / 1024.0);
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "process VmRSS %llu kB, VmHWM %llu kB\n",
+                  static_cast<unsigned long long>(procStatusKb("VmRSS:")),
+                  static_cast<unsigned long long>(procStatusKb("VmHWM:")));
+    out += line;
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// 全局 operator new / delete 替换
+// ---------------------------------------------------------------------------
+void* operator new(size_t size) { return tracedAlloc(size, 0, false); }
+void* operator new[](size_t size) { return tracedAlloc(size, 0, false); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracedAlloc(size, 0, true); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracedAlloc(size, 0, true); }
+void* operator new(size_t size, std::align_val_t al) { return tracedAlloc(size, static_cast<size_t>(al), false); }
+void* operator new[](size_t size, std::align_val_t al) { return tracedAlloc(size, static_cast<size_t>(al), false); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return tracedAlloc(size, static_cast<size_t>(al), true);
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return tracedAlloc(size, static_cast<size_t>(al), true);
+}
+
+void operator delete(void* p) noexcept { tracedFree(p, 0); }
+void operator delete[](void* p) noexcept { tracedFree(p, 0); }
+void operator delete(void* p, size_t) noexcept { tracedFree(p, 0); }
+void operator delete[](void* p, size_t) noexcept { tracedFree(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { tracedFree(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { tracedFree(p, 0); }
+void operator delete(void* p, std::align_val_t al) noexcept { tracedFree(p, static_cast<size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al) noexcept { tracedFree(p, static_cast<size_t>(al)); }
+void operator delete(void* p, size_t, std::align_val_t al) noexcept { tracedFree(p, static_cast<size_t>(al)); }
+void operator delete[](void* p, size_t, std::align_val_t al) noexcept { tracedFree(p, static_cast<size_t>(al)); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    tracedFree(p, static_cast<size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    tracedFree(p, static_cast<size_t>(al));
+}
+
+#endif // DJI_ALLOC_TRACE
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace google {
+namespace protobuf {
+struct ArenaOptions;
+} // namespace protobuf
+} // namespace google
+
+/**
+ * @brief 内存分配统计（编译期开关 DJI_ALLOC_TRACE，cmake -DDJI_ALLOC_TRACE=ON）。
+ *
+ *        - 开启后替换全局 operator new / delete：每块内存前加 16 字节头，记录大小与分配时所在阶段，
+ *          按阶段统计分配次数、字节数、当前占用与占用峰值（释放计入分配时的阶段，便于定位内存增长）；
+ *        - 阶段由线程局部标签决定：各线程启动时 setThreadStage()，线程内更细的路径用 Scope 临时覆盖；
+ *        - protobuf Arena 通过 arenaOptions() 创建时，块分配单独计入 arena 字节数；
+ *        - 断言模式：环境变量 DJI_ALLOC_ASSERT=N，遥测处理（Telemetry 阶段）完成 N 帧预热后
+ *          再发生任何分配即打印大小与调用栈并 abort()，用于在测试中守住稳态零分配；
+ *        - 未开启时 Scope / setThreadStage 为空操作，不替换 operator new，无任何开销。
+ *
+ *        报告（CLI `stats alloc`，退出时也会打印）：各阶段分配次数 / 字节、每帧分配次数与字节
+ *        （帧数取自 Metrics 中该阶段对应的计数器）、当前与峰值占用，以及进程 VmRSS / VmHWM。
+ *        RSS 只能按进程统计，各组件的“峰值占用”为该阶段分配且尚未释放的堆内存峰值。
+ */
+class AllocTrace
+{
+public:
+    enum Stage : uint8_t {
+        Other,       ///< 主线程 / CLI 及未标记的线程
+        Recv,        ///< socket 接收
+        Assemble,    ///< FrameAssembler
+        Decode,      ///< ReplyFrameDecoder 及 0xD1 等非遥测帧处理
+        Telemetry,   ///< 0xA9 / 0xA8 遥测处理（稳态应零分配）
+        Render,      ///< TelemetryUI 渲染线程
+        Send,        ///< 发送线程
+        EventLoop,   ///< 事件循环（定时器、查询接口、转发）
+        StageCount
+    };
+
+    /**
+     * @brief 线程内临时切换阶段标签，析构时恢复；countFrame 为 true 时析构时计一帧（用于断言模式预热）
+     */
+    class Scope
+    {
+    public:
+#ifdef DJI_ALLOC_TRACE
+        explicit Scope(Stage stage, bool countFrame = false);
+        ~Scope();
+#else
+        explicit Scope(Stage, bool = false) {}
+#endif
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+#ifdef DJI_ALLOC_TRACE
+    private:
+        Stage m_prev;
+        bool  m_countFrame;
+#endif
+    };
+
+#ifdef DJI_ALLOC_TRACE
+    static constexpr bool enabled() { return true; }
+    static void setThreadStage(Stage stage);
+#else
+    static constexpr bool enabled() { return false; }
+    static void setThreadStage(Stage) {}
+#endif
+
+    /**
+     * @brief 带分配统计钩子的 Arena 选项（未开启统计时为默认选项）
+     * @param initialBlock     可选的初始块（由调用方持有），Arena::Reset() 后仍复用，稳态解析不再分配
+     * @param initialBlockSize 初始块大小
+     */
+    static google::protobuf::ArenaOptions arenaOptions(char* initialBlock = nullptr, size_t initialBlockSize = 0);
+
+    /**
+     * @brief 文本报告；未开启统计时返回一行说明
+     */
+    static std::string toText();
+
+    static const char* stageName(Stage stage);
+};
@@ -0,0 +1,384 @@
+#include "AsyncLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <strings.h>
+
+namespace {
+
+constexpr size_t   kRingBytes  = 64 * 1024;                  ///< 每线程缓冲大小（2 的幂）
+constexpr size_t   kHeaderSize = 4 + 8 + 8 + 4;              ///< 长度 + LogSite* + 时间戳 + 被限流条数
+constexpr uint64_t kWindowNs   = 1000000000ULL;
+
+uint64_t steadyNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t wallNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+template <typename T>
+T readAt(const uint8_t* p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+} // namespace
+
+struct AsyncLogger::Ring {
+    std::unique_ptr<uint8_t[]> buf{new uint8_t[kRingBytes]};
+    alignas(64) std::atomic<uint64_t> head{0};   ///< 只由所属线程写
+    alignas(64) std::atomic<uint64_t> tail{0};   ///< 只由后台线程写
+};
+
+struct AsyncLogger::Record {
+    uint64_t    ts;
+    bool        toErr;
+    std::string text;
+};
+
+// --------------------------------------------------------------------------
+// Encoder
+// --------------------------------------------------------------------------
+void AsyncLogger::Encoder::header(LogSite& site)
+{
+    const uint64_t siteAddr   = reinterpret_cast<uintptr_t>(&site);
+    const uint64_t ts         = wallNs();
+    const uint32_t suppressed = site.unreported.exchange(0, std::memory_order_relaxed);
+    m_len = 4;   // 长度字段最后回填
+    std::memcpy(m_buf + m_len, &siteAddr, 8);   m_len += 8;
+    std::memcpy(m_buf + m_len, &ts, 8);         m_len += 8;
+    std::memcpy(m_buf + m_len, &suppressed, 4); m_len += 4;
+}
+
+void AsyncLogger::Encoder::finish()
+{
+    const uint32_t len = static_cast<uint32_t>(m_len);
+    std::memcpy(m_buf, &len, 4);
+}
+
+void AsyncLogger::Encoder::putScalar(ArgType type, uint64_t v)
+{
+    if (m_len + 9 > kMaxRecord) {
+        return;
+    }
+    m_buf[m_len++] = type;
+    std::memcpy(m_buf + m_len, &v, 8);
+    m_len += 8;
+}
+
+void AsyncLogger::Encoder::putString(const char* s, size_t n)
+{
+    n = std::min(n, kMaxStr);
+    if (m_len + 3 + n > kMaxRecord) {
+        return;
+    }
+    const uint16_t n16 = static_cast<uint16_t>(n);
+    m_buf[m_len++] = ArgStr;
+    std::memcpy(m_buf + m_len, &n16, 2);
+    m_len += 2;
+    std::memcpy(m_buf + m_len, s, n);
+    m_len += n;
+}
+
+// --------------------------------------------------------------------------
+// AsyncLogger
+// --------------------------------------------------------------------------
+AsyncLogger& AsyncLogger::instance()
+{
+    static AsyncLogger logger;
+    return logger;
+}
+
+AsyncLogger::AsyncLogger() = default;
+
+AsyncLogger::~AsyncLogger()
+{
+    stop();
+}
+
+void AsyncLogger::start()
+{
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread(&AsyncLogger::run, this);
+}
+
+void AsyncLogger::stop()
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_wakeMutex);
+    }
+    m_wakeCond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool AsyncLogger::allow(LogSite& site)
+{
+    if (site.level < level()) {
+        return false;
+    }
+    if (site.ratePerSec == 0) {
+        return true;
+    }
+
+    const uint64_t now   = steadyNs();
+    uint64_t       start = site.windowStartNs.load(std::memory_order_relaxed);
+    if (now - start >= kWindowNs
+        && site.windowStartNs.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        site.unreported.fetch_add(site.suppressed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        site.inWindow.store(0, std::memory_order_relaxed);
+    }
+    if (site.inWindow.fetch_add(1, std::memory_order_relaxed) < site.ratePerSec) {
+        return true;
+    }
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+AsyncLogger::Ring& AsyncLogger::localRing()
+{
+    // 线程退出后缓冲保留，由后台线程继续读出，与 Metrics / Tracer 的线程槽位一致
+    thread_local Ring* ring = nullptr;
+    if (!ring) {
+        ring = new Ring();
+        std::lock_guard<std::mutex> lk(m_ringMutex);
+        m_rings.push_back(ring);
+    }
+    return *ring;
+}
+
+void AsyncLogger::submit(const Encoder& enc)
+{
+    const uint32_t len = static_cast<uint32_t>(enc.size());
+
+    if (!m_running.load(std::memory_order_acquire)) {
+        std::string text;
+        format(enc.data(), len, text);
+        const LogSite* site = readAt<const LogSite*>(enc.data() + 4);
+        writeSync(site->level, text);
+        m_written.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Ring& ring = localRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (kRingBytes - (head - tail) < len) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const size_t pos   = head & (kRingBytes - 1);
+    const size_t first = std::min<size_t>(len, kRingBytes - pos);
+    std::memcpy(ring.buf.get() + pos, enc.data(), first);
+    std::memcpy(ring.buf.get(), enc.data() + first, len - first);
+    ring.head.store(head + len, std::memory_order_release);
+}
+
+void AsyncLogger::run()
+{
+    std::string out;
+    std::string err;
+    while (m_running.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lk(m_wakeMutex);
+            m_wakeCond.wait_for(lk, std::chrono::milliseconds(10),
+                                [this] { return !m_running.load(std::memory_order_acquire); });
+        }
+        drain(out, err);
+    }
+    drain(out, err);   // 退出前输出剩余日志
+}
+
+size_t AsyncLogger::drain(std::string& out, std::string& err)
+{
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lk(m_ringMutex);
+        rings = m_rings;
+    }
+
+    std::vector<Record> records;
+    std::vector<uint8_t> rec;
+    for (Ring* ring : rings) {
+        uint64_t       tail = ring->tail.load(std::memory_order_relaxed);
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        while (tail < head) {
+            const size_t pos = tail & (kRingBytes - 1);
+            uint8_t lenBytes[4];
+            for (size_t i = 0; i < 4; ++i) {
+                lenBytes[i] = ring->buf[(pos + i) & (kRingBytes - 1)];
+            }
+            const uint32_t len   = readAt<uint32_t>(lenBytes);
+            const size_t   first = std::min<size_t>(len, kRingBytes - pos);
+            rec.resize(len);
+            std::memcpy(rec.data(), ring->buf.get() + pos, first);
+            std::memcpy(rec.data() + first, ring->buf.get(), len - first);
+            tail += len;
+
+            const LogSite* site = readAt<const LogSite*>(rec.data() + 4);
+            Record r;
+            r.ts    = readAt<uint64_t>(rec.data() + 12);
+            r.toErr = site->level >= LogLevel::Warn;
+            format(rec.data(), len, r.text);
+            records.push_back(std::move(r));
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    if (records.empty()) {
+        return 0;
+    }
+
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.ts < b.ts; });
+    out.clear();
+    err.clear();
+    for (const Record& r : records) {
+        (r.toErr ? err : out) += r.text;
+    }
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+    }
+    if (!err.empty()) {
+        std::fwrite(err.data(), 1, err.size(), stderr);
+    }
+    m_written.fetch_add(records.size(), std::memory_order_relaxed);
+    return records.size();
+}
+
+void AsyncLogger::format(const uint8_t* rec, size_t len, std::string& out)
+{
+    const LogSite* site       = readAt<const LogSite*>(rec + 4);
+    const uint64_t ts         = readAt<uint64_t>(rec + 12);
+    const uint32_t suppressed = readAt<uint32_t>(rec + 20);
+
+    char buf[64];
+    const time_t sec = static_cast<time_t>(ts / 1000000000ULL);
+    struct tm tmv;
+    localtime_r(&sec, &tmv);
+    std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%03u [%c] ", tmv.tm_hour, tmv.tm_min, tmv.tm_sec,
+                  static_cast<unsigned>((ts / 1000000ULL) % 1000), levelName(site->level)[0]);
+    out += buf;
+    out += '[';
+    out += site->tag;
+    out += "] ";
+
+    // 依次取出参数并按占位符格式化
+    size_t off = kHeaderSize;
+    auto nextArg = [&](bool hex) -> bool {
+        if (off >= len) {
+            return false;
+        }
+        const uint8_t type = rec[off++];
+        if (type == ArgStr) {
+            const uint16_t n = readAt<uint16_t>(rec + off);
+            out.append(reinterpret_cast<const char*>(rec + off + 2), n);
+            off += 2 + n;
+            return true;
+        }
+        const uint64_t v = readAt<uint64_t>(rec + off);
+        off += 8;
+        switch (type) {
+        case ArgI64:
+            std::snprintf(buf, sizeof(buf), hex ? "%llx" : "%lld", static_cast<long long>(v));
+            break;
+        case ArgU64:
+            std::snprintf(buf, sizeof(buf), hex ? "%llx" : "%llu", static_cast<unsigned long long>(v));
+            break;
+        case ArgF64: {
+            double d;
+            std::memcpy(&d, &v, sizeof(d));
+            std::snprintf(buf, sizeof(buf), "%g", d);
+            break;
+        }
+        case ArgChar:
+            buf[0] = static_cast<char>(v);
+            buf[1] = '\0';
+            break;
+        default:
+            buf[0] = '\0';
+            break;
+        }
+        out += buf;
+        return true;
+    };
+
+    for (const char* p = site->fmt; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            if (!nextArg(false)) {
+                out += "{}";
+            }
+            ++p;
+        } else if (std::strncmp(p, "{:x}", 4) == 0) {
+            if (!nextArg(true)) {
+                out += "{:x}";
+            }
+            p += 3;
+        } else if (p[0] == '{' && p[1] == '{') {
+            out += '{';
+            ++p;
+        } else {
+            out += *p;
+        }
+    }
+    // 多余的参数追加在末尾
+    while (off < len) {
+        out += ' ';
+        nextArg(false);
+    }
+    if (suppressed) {
+        std::snprintf(buf, sizeof(buf), " (%u similar suppressed)", suppressed);
+        out += buf;
+    }
+    out += '\n';
+}
+
+void AsyncLogger::writeSync(LogLevel level, const std::string& text)
+{
+    std::FILE* fp = level >= LogLevel::Warn ? stderr : stdout;
+    std::fwrite(text.data(), 1, text.size(), fp);
+    if (fp == stdout) {
+        std::fflush(stdout);
+    }
+}
+
+const char* AsyncLogger::levelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info:  return "INFO";
+    case LogLevel::Warn:  return "WARN";
+    case LogLevel::Error: return "ERROR";
+    case LogLevel::Off:   return "OFF";
+    }
+    return "?";
+}
+
+bool AsyncLogger::parseLevel(const std::string& name, LogLevel& level)
+{
+    static const LogLevel kLevels[] = {LogLevel::Debug, LogLevel::Info, LogLevel::Warn, LogLevel::Error, LogLevel::Off};
+    for (LogLevel l : kLevels) {
+        if (strcasecmp(name.c_str(), levelName(l)) == 0) {
+            level = l;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 为 1 时编译 LOG_DEBUG 埋点；默认 0，调试埋点在发布构建中完全不生成代码
+#ifndef DJI_LOG_DEBUG
+#define DJI_LOG_DEBUG 0
+#endif
+
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error, Off };
+
+/**
+ * @brief 单个日志埋点的静态描述（由 LOG_* 宏生成，每个调用点一个）
+ */
+struct LogSite {
+    LogLevel    level;
+    const char* tag;
+    const char* fmt;
+    uint32_t    ratePerSec;                  ///< 每秒最多输出条数，0 表示不限
+
+    std::atomic<uint64_t> windowStartNs{0};
+    std::atomic<uint32_t> inWindow{0};
+    std::atomic<uint32_t> suppressed{0};     ///< 当前窗口被限流丢弃的条数
+    std::atomic<uint32_t> unreported{0};     ///< 已结束窗口中被丢弃、尚未随日志报告的条数
+};
+
+/**
+ * @brief 异步日志：调用线程只把参数按二进制编码写入本线程的环形缓冲，格式化与终端 I/O 在后台线程完成。
+ *
+ *        - 每线程一个单生产者 / 单消费者字节环（64 KB），写满时丢弃新日志并计数，从不阻塞调用方；
+ *        - 参数按类型编码（整数 / 浮点 / 字符串拷贝），格式串只保存指针，格式化推迟到后台线程；
+ *        - 格式串使用 "{}" 占位，"{:x}" 输出十六进制；
+ *        - 每个埋点可设每秒限额，超出部分丢弃，下一条输出时附带被丢弃的条数；
+ *        - 后台线程每 10ms 汇总所有线程的日志，按时间戳排序后一次性写出
+ *          （Warn / Error 写 stderr，其余写 stdout）；
+ *        - 后台线程未启动时（如初始化阶段）直接同步输出。
+ */
+class AsyncLogger
+{
+public:
+    static AsyncLogger& instance();
+
+    void start();
+
+    /**
+     * @brief 输出剩余日志并停止后台线程
+     */
+    void stop();
+
+    void     setLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return m_level.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 级别过滤 + 限流，返回 false 时调用方不应再编码参数
+     */
+    bool allow(LogSite& site);
+
+    template <typename... Args>
+    void log(LogSite& site, const Args&... args)
+    {
+        Encoder enc;
+        enc.header(site);
+        (enc.put(args), ...);
+        enc.finish();
+        submit(enc);
+    }
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+
+    static const char* levelName(LogLevel level);
+    static bool        parseLevel(const std::string& name, LogLevel& level);
+
+private:
+    enum ArgType : uint8_t { ArgI64, ArgU64, ArgF64, ArgStr, ArgChar };
+
+    static constexpr size_t kMaxStr    = 256;   ///< 单个字符串参数最多拷贝的字节数
+    static constexpr size_t kMaxRecord = 2048;  ///< 单条日志编码后的上限，超出的参数被截断
+
+    /**
+     * @brief 在栈上编码一条日志：[u32 长度][LogSite*][u64 时间戳][u32 被限流条数][参数...]
+     */
+    class Encoder
+    {
+    public:
+        void header(LogSite& site);
+
+        template <typename T>
+        void put(const T& v)
+        {
+            if constexpr (std::is_same_v<T, bool>) {
+                putScalar(ArgU64, static_cast<uint64_t>(v));
+            } else if constexpr (std::is_same_v<T, char>) {
+                putScalar(ArgChar, static_cast<uint64_t>(static_cast<unsigned char>(v)));
+            } else if constexpr (std::is_enum_v<T>) {
+                putScalar(ArgI64, static_cast<uint64_t>(static_cast<int64_t>(v)));
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                putScalar(ArgI64, static_cast<uint64_t>(static_cast<int64_t>(v)));
+            } else if constexpr (std::is_integral_v<T>) {
+                putScalar(ArgU64, static_cast<uint64_t>(v));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                double d = static_cast<double>(v);
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                putScalar(ArgF64, bits);
+            } else if constexpr (std::is_convertible_v<const T&, std::string>
+                                 && !std::is_convertible_v<const T&, const char*>) {
+                putString(static_cast<const std::string&>(v).data(), static_cast<const std::string&>(v).size());
+            } else {
+                const char* s = v;
+                putString(s ? s : "(null)", s ? std::strlen(s) : 6);
+            }
+        }
+
+        void           finish();   ///< 回填长度字段
+        const uint8_t* data() const { return m_buf; }
+        size_t         size() const { return m_len; }
+
+    private:
+        void putScalar(ArgType type, uint64_t v);
+        void putString(const char* s, size_t n);
+
+        uint8_t m_buf[kMaxRecord];
+        size_t  m_len = 0;
+    };
+
+    struct Ring;
+    struct Record;
+
+    AsyncLogger();
+    ~AsyncLogger();
+
+    void submit(const Encoder& enc);
+    Ring& localRing();
+    void run();
+    size_t drain(std::string& out, std::string& err);
+    static void format(const uint8_t* rec, size_t len, std::string& out);
+    static void writeSync(LogLevel level, const std::string& text);
+
+private:
+    std::atomic<LogLevel> m_level{LogLevel::Info};
+    std::atomic<bool>     m_running{false};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_written{0};
+
+    std::mutex         m_ringMutex;
+    std::vector<Ring*> m_rings;
+
+    std::mutex              m_wakeMutex;
+    std::condition_variable m_wakeCond;
+    std::thread             m_thread;
+};
+
+#define DJI_LOG_SITE(lvl, tag, rate, fmt, ...)                                          \
+    do {                                                                                \
+        static LogSite dji_log_site_{lvl, tag, fmt, rate};                              \
+        if (AsyncLogger::instance().allow(dji_log_site_)) {                             \
+            AsyncLogger::instance().log(dji_log_site_, ##__VA_ARGS__);                  \
+        }                                                                               \
+    } while (0)
+
+#define LOG_INFO(tag, fmt, ...)  DJI_LOG_SITE(LogLevel::Info, tag, 0, fmt, ##__VA_ARGS__)
+#define LOG_WARN(tag, fmt, ...)  DJI_LOG_SITE(LogLevel::Warn, tag, 0, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(tag, fmt, ...) DJI_LOG_SITE(LogLevel::Error, tag, 0, fmt, ##__VA_ARGS__)
+
+// 带每秒限额的版本，用于可能被对端数据触发刷屏的埋点
+#define LOG_INFO_RL(tag, perSec, fmt, ...)  DJI_LOG_SITE(LogLevel::Info, tag, perSec, fmt, ##__VA_ARGS__)
+#define LOG_WARN_RL(tag, perSec, fmt, ...)  DJI_LOG_SITE(LogLevel::Warn, tag, perSec, fmt, ##__VA_ARGS__)
+#define LOG_ERROR_RL(tag, perSec, fmt, ...) DJI_LOG_SITE(LogLevel::Error, tag, perSec, fmt, ##__VA_ARGS__)
+
+#if DJI_LOG_DEBUG
+#define LOG_DEBUG(tag, fmt, ...) DJI_LOG_SITE(LogLevel::Debug, tag, 0, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, fmt, ...) do { } while (0)
+#endif
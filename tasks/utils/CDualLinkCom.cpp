@@ -0,0 +1,512 @@
+#include "CDualLinkCom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include "AsyncLogger.h"
+#include "Metrics.h"
+
+namespace {
+
+constexpr uint8_t kCtrlHeader[2]     = {0x74, 0x79};
+constexpr uint8_t kReplyHeader[2]    = {0x6A, 0x77};
+constexpr uint8_t kCmdHeartbeat      = 0x02;
+constexpr uint8_t kCmdControl        = 0xD1;
+constexpr size_t  kCtrlCmdOffset     = 19;   // 控制帧: [0x74 0x79][长度 2B][SN 15B][0xD1][加密 1B][动作 1B]...
+constexpr size_t  kCtrlActionOffset  = 21;
+constexpr size_t  kReplyActionOffset = 6;    // 0xD1 回复: [0x6A 0x77][长度 2B][0xD1][加密 1B][动作 1B]...
+constexpr size_t  kMaxFrame          = 4 + 0xFFFF;
+
+// 心跳请求与其回复都在命令字之后紧跟 8 字节时间戳（回复为回显）
+uint64_t heartbeatKey(const uint8_t *frame)
+{
+    uint64_t key = 0;
+    for (int i = 0; i < 8; ++i) {
+        key = (key << 8) | frame[5 + i];
+    }
+    return key;
+}
+
+// FNV-1a，用于识别两条链路上的同一遥测样本
+uint64_t frameHash(const uint8_t *frame, size_t size)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ frame[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+} // namespace
+
+CDualLinkCom::CDualLinkCom(std::unique_ptr<ITransport> primary, std::unique_ptr<ITransport> standby,
+                           const DualLinkOptions& opts)
+    : m_opts(opts)
+{
+    m_links[0].role      = "primary";
+    m_links[0].transport = std::move(primary);
+    m_links[1].role      = "standby";
+    m_links[1].transport = std::move(standby);
+}
+
+CDualLinkCom::~CDualLinkCom()
+{
+    CloseFd();
+}
+
+bool CDualLinkCom::isHedged(const uint8_t *frame, size_t size) const
+{
+    if (size < 5 || frame[0] != kCtrlHeader[0] || frame[1] != kCtrlHeader[1]) {
+        return false;
+    }
+    if (size == 13 && frame[4] == kCmdHeartbeat) {
+        return true;
+    }
+    return size > kCtrlActionOffset && frame[kCtrlCmdOffset] == kCmdControl &&
+           std::find(m_opts.hedgeActions.begin(), m_opts.hedgeActions.end(), frame[kCtrlActionOffset]) !=
+               m_opts.hedgeActions.end();
+}
+
+bool CDualLinkCom::connectLink(Link& link)
+{
+    // 先在 ioMutex 下标记断开并关闭：之后的发送看到 up 为 false 直接放弃，
+    // 连接过程（可能阻塞）不持锁，发送方不会因此等待
+    closeLink(link);
+    const bool ok = link.transport->InitClient(link.ip.c_str(), link.port) == 0;
+    if (ok) {
+        // 刚连上、还没收到遥测的链路按连上时刻计算静默时长，启动时不会因另一条先到一帧就切走
+        link.lastTelemetryNs.store(Metrics::nowNs(), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(link.ioMutex);
+        link.up.store(true, std::memory_order_release);
+    }
+    return ok;
+}
+
+void CDualLinkCom::closeLink(Link& link)
+{
+    std::lock_guard<std::mutex> lk(link.ioMutex);
+    link.up.store(false, std::memory_order_release);
+    link.transport->CloseFd();
+}
+
+int CDualLinkCom::InitClient(const char *ip_str, uint16_t port)
+{
+    stopReaders();
+
+    m_links[0].ip   = ip_str;
+    m_links[0].port = port;
+    m_links[1].ip   = m_opts.standbyIp;
+    m_links[1].port = m_opts.standbyPort ? m_opts.standbyPort : port;
+
+    // 这里只连主链路；备链路由其接收线程去连，备链路地址不通时（阻塞的 connect 可达数分钟）不拖住初始化。
+    // 主链路连不上时同样交给接收线程重试，期间备链路一连上即可收发
+    closeLink(m_links[1]);
+    const bool primaryUp = connectLink(m_links[0]);
+    m_telemetryLink.store(primaryUp ? 0 : 1, std::memory_order_relaxed);
+    m_shutdown.store(false, std::memory_order_release);
+    m_running.store(true, std::memory_order_release);
+    for (int i = 0; i < 2; ++i) {
+        m_links[i].reader = std::thread(&CDualLinkCom::readerLoop, this, i);
+    }
+    printf("Dual link: primary %s:%u %s, standby %s:%u connecting in background\n", m_links[0].ip.c_str(),
+           m_links[0].port, primaryUp ? "up" : "down", m_links[1].ip.c_str(), m_links[1].port);
+    return 0;
+}
+
+int CDualLinkCom::sendOn(int idx, const void *buf, size_t size)
+{
+    Link& link = m_links[idx];
+    int   n    = -1;
+    {
+        // 接收线程可能正在关闭 / 重连这条链路：持 ioMutex 发送，且只在链路仍连通时发送
+        std::lock_guard<std::mutex> lk(link.ioMutex);
+        if (!link.up.load(std::memory_order_acquire)) {
+            return -1;
+        }
+        n = link.transport->SendData(buf, size);
+    }
+    if (n < 0) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        ++link.sendErrors;
+    }
+    return n;
+}
+
+int CDualLinkCom::sendBatchOn(int idx, const std::vector<std::vector<uint8_t>> &frames)
+{
+    Link& link = m_links[idx];
+    int   n    = -1;
+    {
+        std::lock_guard<std::mutex> lk(link.ioMutex);
+        if (!link.up.load(std::memory_order_acquire)) {
+            return -1;
+        }
+        n = link.transport->SendBatch(frames);
+    }
+    if (n < 0) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        ++link.sendErrors;
+    }
+    return n;
+}
+
+int CDualLinkCom::preferredLink() const
+{
+    const int t = m_telemetryLink.load(std::memory_order_relaxed);
+    if (m_links[t].up.load(std::memory_order_acquire)) {
+        return t;
+    }
+    return m_links[1 - t].up.load(std::memory_order_acquire) ? 1 - t : -1;
+}
+
+int CDualLinkCom::SendData(const void *buf, size_t size)
+{
+    const uint8_t *frame = static_cast<const uint8_t *>(buf);
+    if (!isHedged(frame, size)) {
+        const int idx = preferredLink();
+        if (idx < 0) {
+            return -1;
+        }
+        int n = sendOn(idx, buf, size);
+        if (n < 0 && m_links[1 - idx].up.load(std::memory_order_acquire)) {
+            n = sendOn(1 - idx, buf, size);
+        }
+        return n;
+    }
+
+    uint8_t mask = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (m_links[i].up.load(std::memory_order_acquire)) {
+            mask |= static_cast<uint8_t>(1u << i);
+        }
+    }
+    if (!mask) {
+        return -1;
+    }
+    Hedge h;
+    h.cmd       = frame[4] == kCmdHeartbeat ? kCmdHeartbeat : kCmdControl;
+    h.key       = h.cmd == kCmdHeartbeat ? heartbeatKey(frame) : frame[kCtrlActionOffset];
+    h.pending   = mask;
+    h.delivered = false;
+    h.sentNs    = Metrics::nowNs();
+    {
+        // 先登记再发送：回复可能在 send() 返回前就到达
+        std::lock_guard<std::mutex> lk(m_mutex);
+        h.id = ++m_nextHedgeId;
+        m_hedges.push_back(h);
+    }
+
+    int     sent   = -1;
+    uint8_t failed = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        const int n = sendOn(i, buf, size);
+        if (n < 0) {
+            failed |= static_cast<uint8_t>(1u << i);
+        } else {
+            sent = n;
+        }
+    }
+    if (failed) {
+        // 没发出去的链路不会有回复，不再等待
+        std::lock_guard<std::mutex> lk(m_mutex);
+        for (auto it = m_hedges.begin(); it != m_hedges.end(); ++it) {
+            if (it->id == h.id) {
+                it->pending &= static_cast<uint8_t>(~failed);
+                if (!it->pending) {
+                    m_hedges.erase(it);
+                }
+                break;
+            }
+        }
+    }
+    if (sent >= 0) {
+        Metrics::add(Metrics::HedgedFrames);
+    }
+    return sent;
+}
+
+int CDualLinkCom::SendBatch(const std::vector<std::vector<uint8_t>> &frames)
+{
+    const bool anyHedged = std::any_of(frames.begin(), frames.end(),
+                                       [this](const std::vector<uint8_t> &f) { return isHedged(f.data(), f.size()); });
+    if (anyHedged) {
+        return ITransport::SendBatch(frames);
+    }
+    // 都是单发的帧：整批交给同一条链路，保留其批量发送
+    const int idx = preferredLink();
+    if (idx < 0) {
+        return -1;
+    }
+    int n = sendBatchOn(idx, frames);
+    if (n < 0 && m_links[1 - idx].up.load(std::memory_order_acquire)) {
+        n = sendBatchOn(1 - idx, frames);
+    }
+    return n;
+}
+
+void CDualLinkCom::readerLoop(int idx)
+{
+    Link&                link = m_links[idx];
+    std::vector<uint8_t> acc;
+    uint8_t              buf[16 * 1024];
+    bool                 connected = link.up.load(std::memory_order_acquire);   // 曾经连上过
+    bool                 firstTry  = idx == 1;   // 备链路在 InitClient 中没有连接，立即去连
+
+    while (m_running.load(std::memory_order_acquire)) {
+        if (!link.up.load(std::memory_order_acquire)) {
+            if (!firstTry) {
+                std::unique_lock<std::mutex> lk(m_mutex);
+                if (m_stopCond.wait_for(lk, std::chrono::seconds(1),
+                                        [this] { return !m_running.load(std::memory_order_acquire); })) {
+                    break;
+                }
+            }
+            firstTry = false;
+            if (connectLink(link)) {
+                acc.clear();
+                if (connected) {
+                    {
+                        std::lock_guard<std::mutex> lk(m_mutex);
+                        ++link.reconnects;
+                    }
+                    LOG_INFO("DualLink", "{} link {}:{} restored.", link.role, link.ip, link.port);
+                } else {
+                    LOG_INFO("DualLink", "{} link {}:{} connected.", link.role, link.ip, link.port);
+                }
+                connected = true;
+            }
+            continue;
+        }
+
+        const int n = link.transport->RecvData(buf, sizeof(buf));
+        if (n > 0) {
+            acc.insert(acc.end(), buf, buf + n);
+            const uint64_t nowNs     = Metrics::nowNs();
+            bool           delivered = false;
+            size_t         pos       = 0;
+            {
+                std::lock_guard<std::mutex> lk(m_mutex);
+                while (acc.size() - pos >= 4) {
+                    if (acc[pos] != kReplyHeader[0] || acc[pos + 1] != kReplyHeader[1]) {
+                        ++pos;   // 重新同步：跳过的字节不会交给上层，在这里计数
+                        Metrics::add(Metrics::ResyncBytes);
+                        continue;
+                    }
+                    const size_t total = 4 + ((static_cast<size_t>(acc[pos + 2]) << 8) | acc[pos + 3]);
+                    if (acc.size() - pos < total) {
+                        break;
+                    }
+                    delivered |= onFrameLocked(idx, acc.data() + pos, total, nowNs);
+                    pos += total;
+                }
+            }
+            acc.erase(acc.begin(), acc.begin() + static_cast<std::ptrdiff_t>(pos));
+            if (acc.size() > kMaxFrame) {
+                Metrics::add(Metrics::DiscardedBytes, acc.size());
+                acc.clear();
+            }
+            if (delivered) {
+                m_readable.notify_one();
+            }
+        } else if (!m_running.load(std::memory_order_acquire)) {
+            break;
+        } else if (n == 0 || link.transport->GetCommFd() < 0) {
+            closeLink(link);
+            LOG_WARN("DualLink", "{} link {}:{} lost, reconnecting.", link.role, link.ip, link.port);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+}
+
+bool CDualLinkCom::onFrameLocked(int idx, const uint8_t *frame, size_t size, uint64_t nowNs)
+{
+    Link& link = m_links[idx];
+    ++link.frames;
+
+    bool deliver = true;
+    if (size > kReplyActionOffset && frame[4] == kCmdControl) {
+        deliver = acceptReplyLocked(idx, kCmdControl, frame[kReplyActionOffset], nowNs);
+    } else if (size >= 13 && frame[4] == kCmdHeartbeat) {
+        deliver = acceptReplyLocked(idx, kCmdHeartbeat, heartbeatKey(frame), nowNs);
+    } else {
+        // 遥测：只交付来源链路的，来源链路静默过久时立即切到这一条
+        link.lastTelemetryNs.store(nowNs, std::memory_order_relaxed);
+        const int cur = m_telemetryLink.load(std::memory_order_relaxed);
+        if (cur != idx) {
+            const Link&    other = m_links[cur];
+            const uint64_t last  = other.lastTelemetryNs.load(std::memory_order_relaxed);
+            if (other.up.load(std::memory_order_acquire) &&
+                nowNs - last <= static_cast<uint64_t>(m_opts.staleMs) * 1000000ull) {
+                deliver = false;
+            } else {
+                switchTelemetryLocked(idx);
+                LOG_WARN("DualLink", "Telemetry switched to {} link ({} link {}, silent for {} ms).", link.role,
+                         other.role, other.up.load(std::memory_order_acquire) ? "up" : "down",
+                         (nowNs - last) / 1000000);
+            }
+        }
+        // 本帧按当前来源交付后再比较先后，切换从下一帧生效
+        trackLeadLocked(idx, frame, size, nowNs);
+    }
+    if (deliver) {
+        m_pending.insert(m_pending.end(), frame, frame + size);
+    }
+    return deliver;
+}
+
+void CDualLinkCom::trackLeadLocked(int idx, const uint8_t *frame, size_t size, uint64_t nowNs)
+{
+    const uint64_t hash  = frameHash(frame, size);
+    const int      other = 1 - idx;
+    for (Sample& s : m_samples) {
+        if (s.link != other || s.hash != hash) {
+            continue;
+        }
+        // 同一样本已先从另一条链路到达
+        const uint64_t lead = nowNs - s.ns;
+        s.link = -1;
+        if (lead < kLeadMarginNs) {
+            return;   // 视为同时到达，不影响切换计数
+        }
+        ++m_links[other].leads;
+        if (other == m_telemetryLink.load(std::memory_order_relaxed)) {
+            m_leadStreak = 0;
+        } else if (++m_leadStreak >= kSwitchLeads) {
+            // 切换时较新链路上已先到、被丢弃的样本不再从旧链路交付，遥测会少几帧（约一个领先时长）
+            switchTelemetryLocked(other);
+            LOG_WARN("DualLink", "Telemetry switched to {} link ({} consecutive samples ahead, last by {} ms).",
+                     m_links[other].role, kSwitchLeads, lead / 1000000);
+        }
+        return;
+    }
+    m_samples[m_sampleNext] = Sample{hash, nowNs, idx};
+    m_sampleNext            = (m_sampleNext + 1) % kSampleWindow;
+}
+
+void CDualLinkCom::switchTelemetryLocked(int idx)
+{
+    m_telemetryLink.store(idx, std::memory_order_relaxed);
+    m_leadStreak = 0;
+    ++m_switches;
+    Metrics::add(Metrics::LinkSwitches);
+}
+
+bool CDualLinkCom::acceptReplyLocked(int idx, uint8_t cmd, uint64_t key, uint64_t nowNs)
+{
+    while (!m_hedges.empty() && nowNs - m_hedges.front().sentNs > kHedgeExpiryNs) {
+        m_hedges.pop_front();
+    }
+    // 每条链路的回复按发送顺序到达：配对该链路上最早一个尚未回复的同类双发
+    const uint8_t bit = static_cast<uint8_t>(1u << idx);
+    for (auto it = m_hedges.begin(); it != m_hedges.end(); ++it) {
+        if (it->cmd != cmd || it->key != key || !(it->pending & bit)) {
+            continue;
+        }
+        it->pending &= static_cast<uint8_t>(~bit);
+        const bool first = !it->delivered;
+        it->delivered    = true;
+        if (first) {
+            ++m_links[idx].wins;
+        } else {
+            ++m_links[idx].duplicates;
+            Metrics::add(Metrics::HedgeDuplicates);
+        }
+        if (!it->pending) {
+            m_hedges.erase(it);
+        }
+        return first;
+    }
+    return true;   // 单发命令的回复
+}
+
+int CDualLinkCom::RecvData(void *buf, size_t size)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_readable.wait(lk, [this] {
+        return m_offset < m_pending.size() || m_shutdown.load(std::memory_order_acquire) ||
+               !m_running.load(std::memory_order_acquire);
+    });
+    if (m_offset >= m_pending.size()) {
+        return 0;
+    }
+    const size_t n = std::min(size, m_pending.size() - m_offset);
+    std::memcpy(buf, m_pending.data() + m_offset, n);
+    m_offset += n;
+    if (m_offset == m_pending.size()) {
+        m_pending.clear();
+        m_offset = 0;
+    }
+    return static_cast<int>(n);
+}
+
+void CDualLinkCom::ShutdownRead()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_shutdown.store(true, std::memory_order_release);
+    }
+    m_readable.notify_all();
+}
+
+void CDualLinkCom::stopReaders()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_running.store(false, std::memory_order_release);
+    }
+    m_stopCond.notify_all();
+    m_readable.notify_all();
+    for (auto& link : m_links) {
+        link.transport->ShutdownRead();
+    }
+    for (auto& link : m_links) {
+        if (link.reader.joinable()) {
+            link.reader.join();
+        }
+    }
+}
+
+void CDualLinkCom::CloseFd()
+{
+    stopReaders();
+    for (auto& link : m_links) {
+        closeLink(link);
+    }
+}
+
+int CDualLinkCom::GetCommFd() const
+{
+    if (!m_running.load(std::memory_order_acquire)) {
+        return -1;
+    }
+    for (const auto& link : m_links) {
+        if (link.up.load(std::memory_order_acquire)) {
+            return link.transport->GetCommFd();
+        }
+    }
+    return -1;
+}
+
+std::string CDualLinkCom::status() const
+{
+    const uint64_t nowNs = Metrics::nowNs();
+    const int      cur   = m_telemetryLink.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(m_mutex);
+    std::ostringstream oss;
+    oss << "[DualLink] telemetry from " << m_links[cur].role << ", " << m_switches << " switch(es), "
+        << m_hedges.size() << " hedged frame(s) awaiting the slower reply\n";
+    for (const auto& link : m_links) {
+        const uint64_t last = link.lastTelemetryNs.load(std::memory_order_relaxed);
+        oss << "  " << link.role << " " << link.ip << ":" << link.port << " "
+            << (link.up.load(std::memory_order_acquire) ? "up" : "down") << "  frames=" << link.frames
+            << " telemetry_leads=" << link.leads << " first_replies=" << link.wins << " duplicates=" << link.duplicates << " reconnects=" << link.reconnects
+            << " send_errors=" << link.sendErrors << " silent=" << (last ? (nowNs - last) / 1000000 : 0) << " ms\n";
+    }
+    return oss.str();
+}
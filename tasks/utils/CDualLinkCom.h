@@ -0,0 +1,154 @@
+#ifndef C_DUAL_LINK_COM_H
+#define C_DUAL_LINK_COM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ITransport.h"
+
+/**
+ * @brief 双链路热备选项（配置 standbyServer / standbyPort / linkStaleMs）
+ */
+struct DualLinkOptions {
+    std::string          standbyIp;
+    uint16_t             standbyPort = 0;
+    int                  staleMs     = 300;   ///< 遥测来源链路静默超过该时长、另一条仍有数据时切换
+    std::vector<uint8_t> hedgeActions = {
+        0x12,   // rth
+        0x14,   // land
+        0x29,   // land force
+        0x32,   // brake
+        0x20,   // route stop
+        0x3A,   // goto stop
+    };
+};
+
+/**
+ * @brief 主 / 备两条独立链路（如两家运营商、两个服务器地址）组成的传输层，对上层仍是一条字节流。
+ *
+ *        - 紧急控制帧（hedgeActions 中的动作）与心跳同时从两条链路发出，0xD1 / 0x02 回复先到者交付，
+ *          另一条链路上的同一回复丢弃：0xD1 按动作编号依次配对，心跳按回显的时间戳配对；
+ *        - 其余帧只走当前遥测来源链路（断开时走另一条，发送失败时再换另一条重发一次）；
+ *        - 遥测只交付来源链路上的帧。同一样本在两条链路上按内容识别、比较到达先后，另一条链路连续
+ *          kSwitchLeads 个样本领先（超过 kLeadMarginNs）时切到较新的那条；来源链路静默超过 staleMs
+ *          而另一条仍有数据时立即切换；
+ *        - 每条链路一个接收线程，各自拼帧后按上述规则合并成完整帧交给 RecvData，
+ *          链路的首次连接（主链路除外）与断开后的重连都由其接收线程完成（每秒一次），另一条照常收发，上层不感知；
+ *        - 两条链路都断开时 GetCommFd() 返回 -1；ShutdownRead() 之后 RecvData 返回 0。
+ *
+ *        链路本身为 CLinuxTCPCom 或 CLinuxUDPCom：io_uring 后端的录制写请求挂在其接收线程的 ring 上，
+ *        而这里录制发生在上层接收线程，两者不在同一线程，双链路模式下不使用。
+ */
+class CDualLinkCom : public ITransport
+{
+public:
+    CDualLinkCom(std::unique_ptr<ITransport> primary, std::unique_ptr<ITransport> standby,
+                 const DualLinkOptions& opts);
+    ~CDualLinkCom() override;
+
+    /**
+     * @brief 主链路连接 ip:port，备链路连接 standbyIp:standbyPort，启动两条链路的接收线程后返回 0
+     *
+     *        只有主链路在调用线程中同步连接；备链路（以及没连上的主链路）由各自的接收线程连接与重试，
+     *        不通的备链路地址不会阻塞调用方。
+     */
+    int  InitClient(const char *ip_str, uint16_t port) override;
+    int  SendData(const void *buf, size_t size) override;
+    int  SendBatch(const std::vector<std::vector<uint8_t>> &frames) override;
+    int  RecvData(void *buf, size_t size) override;
+    void ShutdownRead() override;
+    void CloseFd() override;
+    int  GetCommFd() const override;
+    const char *Name() const override { return "dual"; }
+
+    /**
+     * @brief 是否为双发的帧（紧急控制帧或心跳）
+     */
+    bool isHedged(const uint8_t *frame, size_t size) const;
+
+    std::string status() const;
+
+private:
+    struct Link {
+        const char*                 role;
+        std::unique_ptr<ITransport> transport;
+        std::string                 ip;
+        uint16_t                    port = 0;
+        std::thread                 reader;
+        std::mutex                  ioMutex;         ///< 串行化该链路上的发送与关闭 / 重连（不在阻塞的接收中持有）
+        std::atomic<bool>           up{false};       ///< 在 ioMutex 下修改
+        std::atomic<uint64_t>       lastTelemetryNs{0};
+        // 以下统计在 m_mutex 下读写
+        uint64_t                    frames     = 0;
+        uint64_t                    wins       = 0;   ///< 双发帧的回复先于另一条链路到达
+        uint64_t                    leads      = 0;   ///< 遥测样本先于另一条链路到达
+        uint64_t                    duplicates = 0;   ///< 被丢弃的后到回复
+        uint64_t                    reconnects = 0;
+        uint64_t                    sendErrors = 0;
+    };
+
+    /**
+     * @brief 一次双发：等待两条链路各自的回复，先到者交付
+     */
+    struct Hedge {
+        uint64_t id;
+        uint8_t  cmd;
+        uint64_t key;        ///< 0xD1 为动作编号，心跳为时间戳
+        uint8_t  pending;    ///< 尚未回复的链路（bit 0 主，bit 1 备）
+        bool     delivered;
+        uint64_t sentNs;
+    };
+
+    /**
+     * @brief 最近到达的一个遥测样本（帧内容哈希），等待另一条链路上的同一样本
+     */
+    struct Sample {
+        uint64_t hash = 0;
+        uint64_t ns   = 0;
+        int      link = -1;   ///< -1 表示空槽或已配对
+    };
+
+    void readerLoop(int idx);
+    bool connectLink(Link& link);
+    void closeLink(Link& link);
+    bool onFrameLocked(int idx, const uint8_t *frame, size_t size, uint64_t nowNs);
+    bool acceptReplyLocked(int idx, uint8_t cmd, uint64_t key, uint64_t nowNs);
+    void trackLeadLocked(int idx, const uint8_t *frame, size_t size, uint64_t nowNs);
+    void switchTelemetryLocked(int idx);
+    int  sendOn(int idx, const void *buf, size_t size);
+    int  sendBatchOn(int idx, const std::vector<std::vector<uint8_t>> &frames);
+    int  preferredLink() const;
+    void stopReaders();
+
+private:
+    static constexpr uint64_t kHedgeExpiryNs = 10ull * 1000 * 1000 * 1000;
+    static constexpr size_t   kSampleWindow  = 64;                  ///< 等待配对的遥测样本数（约 1 s @ 50 Hz）
+    static constexpr int      kSwitchLeads   = 16;                  ///< 连续领先这么多个样本才切换，避免来回抖动
+    static constexpr uint64_t kLeadMarginNs  = 2ull * 1000 * 1000;  ///< 先后相差不足该值视为同时到达
+
+    DualLinkOptions   m_opts;
+    Link              m_links[2];
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_shutdown{false};
+    std::atomic<int>  m_telemetryLink{0};
+
+    mutable std::mutex      m_mutex;      ///< 保护以下成员与各链路统计
+    std::condition_variable m_readable;
+    std::condition_variable m_stopCond;   ///< 唤醒重连等待中的接收线程
+    std::deque<Hedge>       m_hedges;
+    uint64_t                m_nextHedgeId = 0;
+    std::vector<uint8_t>    m_pending;    ///< 已交付、尚未被 RecvData 取走的完整帧
+    size_t                  m_offset = 0;
+    uint64_t                m_switches = 0;
+    Sample                  m_samples[kSampleWindow];
+    size_t                  m_sampleNext = 0;
+    int                     m_leadStreak = 0;   ///< 另一条链路连续领先的样本数
+};
+
+#endif // C_DUAL_LINK_COM_H
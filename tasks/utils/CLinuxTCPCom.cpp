@@ -1,5 +1,8 @@
 #include "CLinuxTCPCom.h"
+#include <algorithm>
 #include <mutex>
+#include <sys/uio.h>
+#include "AsyncLogger.h"
 
 std::mutex send_mutex;
 
@@ -69,7 +72,10 @@ int CLinuxTCPCom::TCPAccept()
     int new_fd = accept(listen_fd, (struct sockaddr *)&cli_addr, &cli_len); // 
     if (new_fd < 0)
     {
-        printf("Accept fail! errno=%d\n", errno);
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            printf("Accept fail! errno=%d\n", errno);
+        }
         return -1;
     }
 
@@ -106,6 +112,10 @@ int CLinuxTCPCom::TCPInitClient(const char *ip_str, uint16_t port)
         return -1;
     }
 
+    // 4. 控制帧都很小，关闭 Nagle 避免与对端延迟确认叠加造成数十毫秒的命令时延
+    int nodelay = 1;
+    setsockopt(comm_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
     printf("TCP Client Connect to %s:%d Success!\n", ip_str, port);
     return 0;
 }
@@ -116,22 +126,79 @@ int CLinuxTCPCom::TCPSendData(const void *buf, size_t size)
 
     if (comm_fd < 0)
     {
-        printf("No valid communication fd to send data.\n");
+        LOG_ERROR_RL("CLinuxTCPCom", 1, "No valid communication fd to send data.");
         return -1;
     }
     if (NULL == buf || size == 0)
     {
-        printf("Invalid buffer or size to send.\n");
+        LOG_ERROR_RL("CLinuxTCPCom", 1, "Invalid buffer or size to send.");
         return -1;
     }
 
     ssize_t sent = send(comm_fd, buf, size, MSG_NOSIGNAL); // MSG_NOSIGNAL: 防止SIGPIPE信号导致进程退出
     if (sent < 0)
     {
-        printf("Send data fail! errno=%d\n", errno);
+        LOG_ERROR_RL("CLinuxTCPCom", 5, "Send data fail! errno={}", errno);
+        return -1;
+    }
+
+    return (int)sent;
+}
+
+int CLinuxTCPCom::SendBatch(const std::vector<std::vector<uint8_t>> &frames)
+{
+    if (frames.size() == 1)
+    {
+        return TCPSendData(frames[0].data(), frames[0].size());
+    }
+
+    std::lock_guard<std::mutex> lock(send_mutex);
+    if (comm_fd < 0)
+    {
+        LOG_ERROR_RL("CLinuxTCPCom", 1, "No valid communication fd to send data.");
         return -1;
     }
 
+    std::vector<struct iovec> iov;
+    iov.reserve(frames.size());
+    size_t total = 0;
+    for (const auto &frame : frames)
+    {
+        iov.push_back({const_cast<uint8_t *>(frame.data()), frame.size()});
+        total += frame.size();
+    }
+
+    // 阻塞套接字上 sendmsg 通常一次写完；被信号打断等情况下从写到的位置继续
+    size_t sent = 0;
+    size_t first = 0;
+    while (sent < total)
+    {
+        struct msghdr msg = {};
+        msg.msg_iov    = iov.data() + first;
+        msg.msg_iovlen = iov.size() - first;
+        ssize_t n = sendmsg(comm_fd, &msg, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR_RL("CLinuxTCPCom", 5, "Send data fail! errno={}", errno);
+            return -1;
+        }
+        sent += static_cast<size_t>(n);
+        while (n > 0 && first < iov.size())
+        {
+            const size_t step = std::min(static_cast<size_t>(n), iov[first].iov_len);
+            iov[first].iov_base = static_cast<uint8_t *>(iov[first].iov_base) + step;
+            iov[first].iov_len -= step;
+            n -= static_cast<ssize_t>(step);
+            if (iov[first].iov_len == 0)
+            {
+                ++first;
+            }
+        }
+    }
     return (int)sent;
 }
 
@@ -139,20 +206,20 @@ int CLinuxTCPCom::TCPRecvData(void *buf, size_t size)
 {
     if (comm_fd < 0)
     {
-        printf("No valid communication fd to receive data.\n");
+        LOG_ERROR_RL("CLinuxTCPCom", 1, "No valid communication fd to receive data.");
         return -1;
     }
 
     if (NULL == buf || size == 0)
     {
-        printf("Invalid buffer or size to receive.\n");
+        LOG_ERROR_RL("CLinuxTCPCom", 1, "Invalid buffer or size to receive.");
         return -1;
     }
 
     ssize_t received = recv(comm_fd, buf, size, 0);
     if (received < 0)
     {
-        printf("Receive data fail! errno=%d\n", errno);
+        LOG_ERROR_RL("CLinuxTCPCom", 5, "Receive data fail! errno={}", errno);
         return -1;
     }
 
@@ -170,6 +237,11 @@ int CLinuxTCPCom::GetCommFd() const
     return comm_fd;
 }
 
+int CLinuxTCPCom::GetListenFd() const
+{
+    return listen_fd;
+}
+
 void CLinuxTCPCom::CloseFd()
 {
     if (comm_fd >= 0)
@@ -185,5 +257,11 @@ void CLinuxTCPCom::CloseFd()
     }
 }
 
-// 为了唤醒阻塞在recv的线程，必须调用shutdown
-// shutdown(tcpCom.GetCommFd(), SHUT_RDWR);
\ No newline at end of file
+// 为了唤醒阻塞在recv的线程，必须调用shutdown（仅 close 不会让其他线程中的 recv 返回）
+void CLinuxTCPCom::ShutdownRead()
+{
+    if (comm_fd >= 0)
+    {
+        shutdown(comm_fd, SHUT_RD);
+    }
+}
\ No newline at end of file
@@ -6,16 +6,18 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <string.h>
 #include <errno.h>
+#include "ITransport.h"
 
 #define TCP_BUFF_LEN 1024
 
-class CLinuxTCPCom
+class CLinuxTCPCom : public ITransport
 {
 public:
     CLinuxTCPCom();
-    ~CLinuxTCPCom();
+    ~CLinuxTCPCom() override;
 
     /**
      * @brief 初始化为TCP服务器模式
@@ -30,6 +32,7 @@ public:
      * @brief 等待客户端连接（仅在服务器模式下使用）
      * @return 成功返回新生成的通信socket的文件描述符，失败返回-1
      * @note 此函数调用accept()阻塞等待客户端连接，一旦有连接请求会产生新的套接字用于通信。
+     *       监听套接字被设为非阻塞时（如交给事件循环），没有待接受的连接直接返回-1，errno 为 EAGAIN。
      */
     int TCPAccept();
 
@@ -58,6 +61,18 @@ public:
      */
     int TCPRecvData(void *buf, size_t size);
 
+    /**
+     * @brief 一次 sendmsg() 写出多帧（iovec 聚合，不拷贝），写不完时继续写余下部分
+     * @return 成功发送的总字节数，出错返回-1
+     */
+    int SendBatch(const std::vector<std::vector<uint8_t>> &frames) override;
+
+    // ITransport（客户端模式）
+    int InitClient(const char *ip_str, uint16_t port) override { return TCPInitClient(ip_str, port); }
+    int SendData(const void *buf, size_t size) override { return TCPSendData(buf, size); }
+    int RecvData(void *buf, size_t size) override { return TCPRecvData(buf, size); }
+    const char *Name() const override { return "tcp"; }
+
     /**
      * @brief 设置通信使用的文件描述符（如服务器accept后的套接字）
      */
@@ -66,12 +81,23 @@ public:
     /**
      * @brief 获取当前的通信套接字文件描述符
      */
-    int GetCommFd() const;
+    int GetCommFd() const override;
+
+    /**
+     * @brief 获取监听套接字文件描述符（服务器模式），未初始化时为-1
+     */
+    int GetListenFd() const;
 
     /**
      * @brief 关闭套接字
      */
-    void CloseFd();
+    void CloseFd() override;
+
+    /**
+     * @brief 关闭通信套接字的读方向，唤醒阻塞在 recv() 上的线程（recv 返回 0），
+     *        不影响正在进行的发送；之后仍需 CloseFd() 释放套接字
+     */
+    void ShutdownRead() override;
 
 private:
     int listen_fd;   // 服务器监听套接字（服务器模式下使用）
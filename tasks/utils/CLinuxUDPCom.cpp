@@ -0,0 +1,387 @@
+#include "CLinuxUDPCom.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Metrics.h"
+
+namespace {
+
+constexpr uint16_t kHeartbeatStream = 1;
+constexpr int      kRecvBufBytes    = 1 << 20;   ///< 遥测突发时避免内核丢包
+
+bool isHeartbeat(const uint8_t *frame, size_t size)
+{
+    return size == 13 && frame[0] == 0x74 && frame[1] == 0x79 && frame[4] == 0x02;
+}
+
+// 收发两个方向的丢包序列不能相同，否则请求与其应答总是一起丢
+UdpLinkOptions reverseDirection(UdpLinkOptions opts)
+{
+    opts.seed ^= 0x9E3779B9u;
+    return opts;
+}
+
+} // namespace
+
+CLinuxUDPCom::CLinuxUDPCom(const UdpLinkOptions& emulator)
+    : m_emuOpts(emulator)
+    , m_txEmu(emulator)
+    , m_rxEmu(reverseDirection(emulator))
+    , m_rxBufs(kBatch * kMaxDatagram)
+{
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        printf("Create eventfd fail! errno=%d\n", errno);
+    }
+    if (m_txEmu.enabled()) {
+        printf("UDP link emulation: loss=%.3f delay=%dms jitter=%dms\n", emulator.loss, emulator.delayMs,
+               emulator.jitterMs);
+    }
+}
+
+CLinuxUDPCom::~CLinuxUDPCom()
+{
+    CloseFd();
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+}
+
+int CLinuxUDPCom::InitClient(const char *ip_str, uint16_t port)
+{
+    CloseFd();
+
+    m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        printf("Create socket fail! errno=%d\n", errno);
+        return -1;
+    }
+    int rcvbuf = kRecvBufBytes;
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    // connect 只固定对端地址：之后可直接 send/recv，且只收该对端的数据报
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip_str);
+    addr.sin_port        = htons(port);
+    if (connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        printf("Connect to server fail! errno=%d\n", errno);
+        close(m_fd);
+        m_fd = -1;
+        return -1;
+    }
+
+    std::vector<std::string> out;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const uint32_t seed = std::random_device{}() ^
+                              static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        m_session.reset(new ReliableUdpSession(seed));
+        m_txEmu = UdpLinkEmulator(m_emuOpts);
+        m_rxEmu = UdpLinkEmulator(reverseDirection(m_emuOpts));
+        m_txEmu.submit(m_session->makeReliable(nullptr, 0, Metrics::nowNs()), Metrics::nowNs(), out);
+    }
+    m_rxPending.clear();
+    m_rxOffset = 0;
+    m_shutdown.store(false, std::memory_order_release);
+    transmit(out);
+    wakeup();
+
+    printf("UDP Client Connect to %s:%d Success!\n", ip_str, port);
+    return 0;
+}
+
+std::string CLinuxUDPCom::wrapLocked(const uint8_t *frame, size_t size, uint64_t nowNs, bool &reliable)
+{
+    // 心跳丢了就丢了：下一个心跳会带新的时间戳，重传只会让 ClockSync 得到错误的往返时间
+    if (isHeartbeat(frame, size)) {
+        return m_session->makeUnreliable(kHeartbeatStream, frame, size);
+    }
+    reliable = true;
+    return m_session->makeReliable(frame, size, nowNs);
+}
+
+int CLinuxUDPCom::SendData(const void *buf, size_t size)
+{
+    std::vector<std::vector<uint8_t>> frames(1);
+    frames[0].assign(static_cast<const uint8_t *>(buf), static_cast<const uint8_t *>(buf) + size);
+    return SendBatch(frames);
+}
+
+int CLinuxUDPCom::SendBatch(const std::vector<std::vector<uint8_t>> &frames)
+{
+    if (m_fd < 0) {
+        return -1;
+    }
+    std::vector<std::string> out;
+    out.reserve(frames.size());
+    bool anyReliable = false;
+    int  total       = 0;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const uint64_t now     = Metrics::nowNs();
+        const uint64_t dropped = m_txEmu.dropped();
+        for (const auto &frame : frames) {
+            m_txEmu.submit(wrapLocked(frame.data(), frame.size(), now, anyReliable), now, out);
+            total += static_cast<int>(frame.size());
+        }
+        Metrics::add(Metrics::UdpEmulatedDrops, m_txEmu.dropped() - dropped);
+    }
+    transmit(out);
+    // 接收线程的 poll 超时可能还是按“无待确认数据”计算的，唤醒它重新计算重传时刻
+    if (anyReliable || m_txEmu.enabled()) {
+        wakeup();
+    }
+    return total;
+}
+
+void CLinuxUDPCom::transmit(const std::vector<std::string> &datagrams)
+{
+    if (datagrams.empty() || m_fd < 0) {
+        return;
+    }
+    const size_t n = datagrams.size();
+    std::vector<mmsghdr> msgs(n);
+    std::vector<iovec>   iov(n);
+    for (size_t i = 0; i < n; ++i) {
+        iov[i].iov_base            = const_cast<char *>(datagrams[i].data());
+        iov[i].iov_len             = datagrams[i].size();
+        msgs[i].msg_hdr            = msghdr();
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    size_t sent = 0;
+    while (sent < n) {
+        const int r = sendmmsg(m_fd, msgs.data() + sent, static_cast<unsigned>(n - sent), 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // 对端未监听时内核会回报 ECONNREFUSED；可靠数据由重传兜底，不可靠数据本就允许丢失
+            if (errno != ECONNREFUSED) {
+                printf("UDP sendmmsg fail! errno=%d\n", errno);
+            }
+            return;
+        }
+        sent += static_cast<size_t>(r);
+    }
+}
+
+int CLinuxUDPCom::RecvData(void *buf, size_t size)
+{
+    while (true) {
+        if (m_rxOffset < m_rxPending.size()) {
+            const size_t n = std::min(size, m_rxPending.size() - m_rxOffset);
+            memcpy(buf, m_rxPending.data() + m_rxOffset, n);
+            m_rxOffset += n;
+            if (m_rxOffset == m_rxPending.size()) {
+                m_rxPending.clear();
+                m_rxOffset = 0;
+            }
+            return static_cast<int>(n);
+        }
+        if (m_shutdown.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        if (m_fd < 0 || !pollOnce()) {
+            return -1;
+        }
+    }
+}
+
+bool CLinuxUDPCom::pollOnce()
+{
+    uint64_t deadline;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        deadline = std::min({m_session->nextDeadlineNs(), m_txEmu.nextReleaseNs(), m_rxEmu.nextReleaseNs()});
+    }
+    const uint64_t now     = Metrics::nowNs();
+    int            timeout = -1;
+    if (deadline != UINT64_MAX) {
+        timeout = deadline <= now ? 0 : static_cast<int>((deadline - now + 999999) / 1000000);
+    }
+
+    pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+    const int r = poll(fds, m_wakeFd >= 0 ? 2 : 1, timeout);
+    if (r < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        printf("UDP poll fail! errno=%d\n", errno);
+        return false;
+    }
+    if (m_wakeFd >= 0 && (fds[1].revents & POLLIN)) {
+        uint64_t v;
+        while (read(m_wakeFd, &v, sizeof(v)) > 0) {
+        }
+    }
+    if (fds[0].revents & (POLLIN | POLLERR)) {
+        receiveBatch();
+    }
+    serviceTimers();
+    return true;
+}
+
+void CLinuxUDPCom::receiveBatch()
+{
+    mmsghdr msgs[kBatch];
+    iovec   iov[kBatch];
+    for (int i = 0; i < kBatch; ++i) {
+        iov[i].iov_base            = m_rxBufs.data() + i * kMaxDatagram;
+        iov[i].iov_len             = kMaxDatagram;
+        msgs[i].msg_hdr            = msghdr();
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int n = recvmmsg(m_fd, msgs, kBatch, MSG_DONTWAIT, nullptr);
+    if (n <= 0) {
+        // ECONNREFUSED：之前发出的数据报被对端以 ICMP 端口不可达拒绝，读出错误即可
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNREFUSED) {
+            printf("UDP recvmmsg fail! errno=%d\n", errno);
+        }
+        return;
+    }
+
+    std::vector<std::string> acks;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const uint64_t now = Metrics::nowNs();
+        if (m_rxEmu.enabled()) {
+            const uint64_t dropped = m_rxEmu.dropped();
+            m_rxDelayed.clear();
+            for (int i = 0; i < n; ++i) {
+                m_rxEmu.submit(std::string(static_cast<const char *>(iov[i].iov_base), msgs[i].msg_len), now,
+                               m_rxDelayed);
+            }
+            Metrics::add(Metrics::UdpEmulatedDrops, m_rxEmu.dropped() - dropped);
+            for (const auto &d : m_rxDelayed) {
+                inboundLocked(reinterpret_cast<const uint8_t *>(d.data()), d.size(), now, acks);
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                inboundLocked(static_cast<const uint8_t *>(iov[i].iov_base), msgs[i].msg_len, now, acks);
+            }
+        }
+        commitLocked();
+    }
+    transmit(acks);
+}
+
+void CLinuxUDPCom::inboundLocked(const uint8_t *data, size_t length, uint64_t nowNs, std::vector<std::string> &acks)
+{
+    std::string ack;
+    const auto  in = m_session->onDatagram(data, length, nowNs, ack);
+    if (!ack.empty()) {
+        acks.push_back(std::move(ack));
+    }
+    switch (in.kind) {
+    case ReliableUdpSession::Kind::Reliable:
+    case ReliableUdpSession::Kind::Unreliable:
+        if (in.length > 0) {
+            m_batch.push_back(Delivery{in.stream, in.payload, in.length});
+        }
+        break;
+    case ReliableUdpSession::Kind::Duplicate:
+        Metrics::add(Metrics::UdpDuplicates);
+        break;
+    case ReliableUdpSession::Kind::Stale:
+        Metrics::add(Metrics::UdpStale);
+        break;
+    default:
+        break;
+    }
+}
+
+void CLinuxUDPCom::commitLocked()
+{
+    // 同一批内同一条不可靠数据流只交付最后（最新）一帧：下游处理落后时，旧遥测只会推迟新遥测
+    for (size_t i = 0; i < m_batch.size(); ++i) {
+        const Delivery &d = m_batch[i];
+        if (d.stream != 0) {
+            bool superseded = false;
+            for (size_t j = i + 1; j < m_batch.size(); ++j) {
+                if (m_batch[j].stream == d.stream) {
+                    superseded = true;
+                    break;
+                }
+            }
+            if (superseded) {
+                Metrics::add(Metrics::UdpCollapsed);
+                continue;
+            }
+        }
+        m_rxPending.insert(m_rxPending.end(), d.data, d.data + d.length);
+    }
+    m_batch.clear();
+}
+
+void CLinuxUDPCom::serviceTimers()
+{
+    std::vector<std::string> out;
+    std::vector<std::string> acks;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const uint64_t now = Metrics::nowNs();
+
+        const auto    &stats       = m_session->stats();
+        const uint64_t retransmits = stats.retransmits;
+        const uint64_t expired     = stats.expired;
+        std::vector<std::string> resend;
+        m_session->collectRetransmits(now, resend);
+        Metrics::add(Metrics::UdpRetransmits, stats.retransmits - retransmits);
+        Metrics::add(Metrics::UdpExpired, stats.expired - expired);
+
+        const uint64_t dropped = m_txEmu.dropped();
+        for (auto &d : resend) {
+            m_txEmu.submit(std::move(d), now, out);
+        }
+        Metrics::add(Metrics::UdpEmulatedDrops, m_txEmu.dropped() - dropped);
+        m_txEmu.release(now, out);
+
+        if (m_rxEmu.nextReleaseNs() <= now) {
+            m_rxDelayed.clear();
+            m_rxEmu.release(now, m_rxDelayed);
+            for (const auto &d : m_rxDelayed) {
+                inboundLocked(reinterpret_cast<const uint8_t *>(d.data()), d.size(), now, acks);
+            }
+            commitLocked();
+        }
+    }
+    transmit(acks);
+    transmit(out);
+}
+
+void CLinuxUDPCom::wakeup()
+{
+    if (m_wakeFd >= 0) {
+        const uint64_t one = 1;
+        (void)!write(m_wakeFd, &one, sizeof(one));
+    }
+}
+
+void CLinuxUDPCom::ShutdownRead()
+{
+    m_shutdown.store(true, std::memory_order_release);
+    wakeup();
+}
+
+void CLinuxUDPCom::CloseFd()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
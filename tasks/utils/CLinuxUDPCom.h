@@ -0,0 +1,78 @@
+#ifndef C_LINUX_UDP_COM_H
+#define C_LINUX_UDP_COM_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ITransport.h"
+#include "ReliableUdp.h"
+
+/**
+ * @brief UDP 选择性可靠传输（客户端），协议见 ReliableUdpSession。
+ *
+ *        - 发送：心跳（0x02）走不可靠数据报（重传会使 ClockSync 的往返样本失真），其余帧都走可靠数据报；
+ *          SendBatch 用一次 sendmmsg() 发出；
+ *        - 接收：RecvData 在 poll() 上等待套接字与内部 eventfd，可读时一次 recvmmsg() 取一批数据报，
+ *          回 ACK（同样合并为一次 sendmmsg()），同一批内同一条不可靠数据流只交付最新一帧，
+ *          交付的帧依次拼成字节流返回；poll 超时按最早的重传时刻计算，重传由接收线程完成；
+ *        - ShutdownRead 通过 eventfd 唤醒接收线程，之后 RecvData 返回 0；
+ *        - 可选本地链路模拟（UdpLinkEmulator）：收发两个方向分别按配置丢包 / 加时延抖动。
+ *
+ *        连接建立时先发一个空的可靠数据报，服务端据此登记客户端地址并开始推送数据流。
+ */
+class CLinuxUDPCom : public ITransport
+{
+public:
+    explicit CLinuxUDPCom(const UdpLinkOptions& emulator = UdpLinkOptions());
+    ~CLinuxUDPCom() override;
+
+    int  InitClient(const char *ip_str, uint16_t port) override;
+    int  SendData(const void *buf, size_t size) override;
+    int  SendBatch(const std::vector<std::vector<uint8_t>> &frames) override;
+    int  RecvData(void *buf, size_t size) override;
+    void ShutdownRead() override;
+    void CloseFd() override;
+    int  GetCommFd() const override { return m_fd; }
+    const char *Name() const override { return "udp"; }
+
+private:
+    struct Delivery {
+        uint16_t       stream;   ///< 0 为可靠数据
+        const uint8_t* data;
+        size_t         length;
+    };
+
+    std::string wrapLocked(const uint8_t *frame, size_t size, uint64_t nowNs, bool &reliable);
+    void        transmit(const std::vector<std::string> &datagrams);
+    bool        pollOnce();
+    void        receiveBatch();
+    void        inboundLocked(const uint8_t *data, size_t length, uint64_t nowNs, std::vector<std::string> &acks);
+    void        commitLocked();
+    void        serviceTimers();
+    void        wakeup();
+
+private:
+    static constexpr int    kBatch       = 32;
+    static constexpr size_t kMaxDatagram = 2048;
+
+    int               m_fd     = -1;
+    int               m_wakeFd = -1;
+    std::atomic<bool> m_shutdown{false};
+
+    std::mutex                          m_mutex;     ///< 保护会话与链路模拟（收发两个线程共用）
+    std::unique_ptr<ReliableUdpSession> m_session;
+    UdpLinkOptions                      m_emuOpts;
+    UdpLinkEmulator                     m_txEmu;
+    UdpLinkEmulator                     m_rxEmu;
+
+    // 以下只由接收线程访问
+    std::vector<uint8_t>     m_rxBufs;               ///< kBatch × kMaxDatagram，recvmmsg 直接写入
+    std::vector<std::string> m_rxDelayed;            ///< 链路模拟时延到达的数据报（本批处理期间有效）
+    std::vector<Delivery>    m_batch;
+    std::vector<uint8_t>     m_rxPending;            ///< 已交付、尚未被 RecvData 取走的字节
+    size_t                   m_rxOffset = 0;
+};
+
+#endif // C_LINUX_UDP_COM_H
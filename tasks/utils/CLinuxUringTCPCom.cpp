@@ -0,0 +1,184 @@
+#include "CLinuxUringTCPCom.h"
+
+#include <algorithm>
+#include <mutex>
+#include "AsyncLogger.h"
+
+CLinuxUringTCPCom::~CLinuxUringTCPCom()
+{
+    CloseFd();
+}
+
+bool CLinuxUringTCPCom::Supported(std::string *why)
+{
+    static std::once_flag once;
+    static bool           ok = false;
+    static std::string    reason;
+    std::call_once(once, [] { ok = IoUring::probe(&reason); });
+    if (!ok && why) {
+        *why = reason;
+    }
+    return ok;
+}
+
+int CLinuxUringTCPCom::InitClient(const char *ip_str, uint16_t port)
+{
+    CloseFd();
+    if (TCPInitClient(ip_str, port) < 0) {
+        return -1;
+    }
+
+    std::string why;
+    if (!m_ring.init(kRingEntries, kCqEntries, &why) ||
+        !m_ring.registerBufferRing(kBufGroup, kBufCount, kBufSize, &why)) {
+        printf("io_uring setup fail! %s\n", why.c_str());
+        CloseFd();
+        return -1;
+    }
+    m_segments.clear();
+    m_segHead     = 0;
+    m_eof         = false;
+    m_error       = 0;
+    m_noBufStreak = 0;
+    armRecv();
+
+    g_linkRecorder.setAsyncWriter([this](int fd, LinkRecorder::Chunk *chunk) { return queueWrite(fd, chunk); });
+    return 0;
+}
+
+bool CLinuxUringTCPCom::armRecv()
+{
+    io_uring_sqe *sqe = m_ring.getSqe();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = GetCommFd();
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufGroup;
+    sqe->ioprio    = m_multishot ? IORING_RECV_MULTISHOT : 0;
+    sqe->user_data = kTagRecv;
+    m_armed = true;
+    return true;
+}
+
+void CLinuxUringTCPCom::reap()
+{
+    m_ring.forEachCqe([this](const io_uring_cqe &cqe) {
+        if (cqe.user_data != kTagRecv) {
+            --m_writesInflight;
+            g_linkRecorder.complete(reinterpret_cast<LinkRecorder::Chunk *>(cqe.user_data), cqe.res);
+            return;
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            m_armed = false;   // 单次 recv、缓冲耗尽或出错后需要重新提交
+        }
+        if (cqe.res > 0) {
+            m_noBufStreak = 0;
+            m_segments.push_back(Segment{static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT),
+                                         static_cast<uint32_t>(cqe.res), 0});
+        } else if (cqe.res == 0) {
+            m_eof = true;   // 对端关闭或 ShutdownRead()
+        } else if (cqe.res == -EINVAL && m_multishot) {
+            m_multishot = false;
+            printf("io_uring multishot recv not supported, using single-shot recv.\n");
+        } else if (cqe.res == -ENOBUFS) {
+            // 缓冲都在应用手里时属正常，归还后重新提交即可；连续出现说明内核取不到已发布的缓冲
+            if (++m_noBufStreak >= kMaxNoBufStreak) {
+                m_error = ENOBUFS;
+            }
+        } else if (cqe.res != -EINTR && cqe.res != -ECANCELED) {
+            m_error = -cqe.res;
+        }
+    });
+}
+
+int CLinuxUringTCPCom::RecvData(void *buf, size_t size)
+{
+    if (!m_ring.valid()) {
+        LOG_ERROR_RL("CLinuxUringTCPCom", 1, "No valid communication fd to receive data.");
+        return -1;
+    }
+    while (true) {
+        if (m_segHead < m_segments.size()) {
+            Segment     &seg = m_segments[m_segHead];
+            const size_t n   = std::min(size, static_cast<size_t>(seg.length - seg.offset));
+            memcpy(buf, m_ring.buffer(seg.bid) + seg.offset, n);
+            seg.offset += static_cast<uint32_t>(n);
+            if (seg.offset == seg.length) {
+                m_ring.recycleBuffer(seg.bid);
+                if (++m_segHead == m_segments.size()) {
+                    m_segments.clear();
+                    m_segHead = 0;
+                }
+            }
+            return static_cast<int>(n);
+        }
+
+        reap();
+        if (m_segHead < m_segments.size()) {
+            continue;
+        }
+        if (m_eof) {
+            return 0;
+        }
+        if (m_error) {
+            LOG_ERROR_RL("CLinuxUringTCPCom", 5, "Receive data fail! errno={}", m_error);
+            errno   = m_error;
+            m_error = 0;
+            m_eof   = true;   // 连接已不可用，之后按关闭处理
+            return -1;
+        }
+        if (!m_armed) {
+            armRecv();
+        }
+        // 提交（重新挂起的 recv、录制写请求、归还的缓冲）并等待下一个完成事件
+        const int r = m_ring.submitAndWait(1);
+        if (r < 0 && r != -EINTR && r != -EAGAIN && r != -EBUSY) {
+            LOG_ERROR_RL("CLinuxUringTCPCom", 5, "io_uring_enter fail! errno={}", -r);
+            return -1;
+        }
+    }
+}
+
+bool CLinuxUringTCPCom::queueWrite(int fd, LinkRecorder::Chunk *chunk)
+{
+    io_uring_sqe *sqe = m_ring.getSqe();
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode    = IORING_OP_WRITE;
+    sqe->fd        = fd;
+    sqe->addr      = reinterpret_cast<uint64_t>(chunk->data.data());
+    sqe->len       = static_cast<uint32_t>(chunk->data.size());
+    sqe->off       = chunk->offset;
+    sqe->user_data = reinterpret_cast<uint64_t>(chunk);
+    ++m_writesInflight;
+    return true;
+}
+
+void CLinuxUringTCPCom::drainWrites()
+{
+    while (m_writesInflight > 0) {
+        const int r = m_ring.submitAndWait(1);
+        if (r < 0 && r != -EINTR) {
+            break;
+        }
+        reap();
+    }
+}
+
+void CLinuxUringTCPCom::CloseFd()
+{
+    if (m_ring.valid()) {
+        // 先停止接收新的录制写请求，再等已提交的写完，最后关闭 ring（会取消挂起的 recv）
+        g_linkRecorder.setAsyncWriter(nullptr);
+        drainWrites();
+        m_enterCalls += m_ring.enterCalls();
+        m_ring.close();
+    }
+    m_segments.clear();
+    m_segHead = 0;
+    m_armed   = false;
+    CLinuxTCPCom::CloseFd();
+}
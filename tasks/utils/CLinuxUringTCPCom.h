@@ -0,0 +1,73 @@
+#ifndef C_LINUX_URING_TCP_COM_H
+#define C_LINUX_URING_TCP_COM_H
+
+#include <string>
+#include <vector>
+#include "CLinuxTCPCom.h"
+#include "IoUring.h"
+#include "LinkRecorder.h"
+
+/**
+ * @brief 基于 io_uring 的 TCP 客户端：连接、发送沿用 CLinuxTCPCom，接收方向改为 multishot recv。
+ *
+ *        - 连接建立后提交一次 multishot recv（IORING_RECV_MULTISHOT），内核从 provided buffer ring
+ *          （kBufCount × kBufSize）中挑选缓冲写入，每段数据一个 CQE；RecvData 先消费已完成的 CQE，
+ *          完成队列为空时才 io_uring_enter 等待，负载高时平均每帧的系统调用数趋近于 0；
+ *        - 内核不支持 multishot（6.0 之前）时首个 CQE 返回 -EINVAL，自动改为每次提交单次 recv；
+ *        - 链路录制（LinkRecorder）的写文件请求挂在同一个 ring 上，随下一次等待接收一起提交；
+ *        - ShutdownRead 仍是 shutdown(SHUT_RD)：进行中的 recv 以 0 完成，RecvData 返回 0。
+ *
+ *        ring 只由接收线程使用（InitClient / CloseFd 在接收线程或流水线停止后调用）。
+ *        运行时用 Supported() 检测，不可用时由调用方回退到 CLinuxTCPCom。
+ */
+class CLinuxUringTCPCom : public CLinuxTCPCom
+{
+public:
+    ~CLinuxUringTCPCom() override;
+
+    /**
+     * @brief 当前内核 / 运行环境是否可用（结果缓存）
+     */
+    static bool Supported(std::string *why = nullptr);
+
+    int  InitClient(const char *ip_str, uint16_t port) override;
+    int  RecvData(void *buf, size_t size) override;
+    void CloseFd() override;
+    const char *Name() const override { return "tcp+io_uring"; }
+
+    uint64_t EnterCalls() const { return m_enterCalls + m_ring.enterCalls(); }   ///< 累计 io_uring_enter 次数
+
+private:
+    struct Segment {
+        uint16_t bid;
+        uint32_t length;
+        uint32_t offset;   ///< 已被 RecvData 取走的字节
+    };
+
+    bool armRecv();
+    void reap();
+    bool queueWrite(int fd, LinkRecorder::Chunk *chunk);
+    void drainWrites();
+
+private:
+    static constexpr unsigned kRingEntries = 64;
+    static constexpr unsigned kCqEntries   = 1024;
+    static constexpr unsigned kBufCount    = 64;
+    static constexpr unsigned kBufSize     = 16 * 1024;
+    static constexpr uint16_t kBufGroup    = 1;
+    static constexpr uint64_t kTagRecv     = 1;   ///< 其余 user_data 为录制块指针
+    static constexpr unsigned kMaxNoBufStreak = 8;
+
+    IoUring              m_ring;
+    std::vector<Segment> m_segments;        ///< 已完成、未取完的接收数据（按到达顺序）
+    size_t               m_segHead   = 0;
+    bool                 m_armed     = false;
+    bool                 m_multishot = true;
+    bool                 m_eof       = false;
+    int                  m_error     = 0;
+    unsigned             m_noBufStreak    = 0;   ///< 连续 -ENOBUFS 次数
+    size_t               m_writesInflight = 0;
+    uint64_t             m_enterCalls     = 0;   ///< 之前各连接的 ring 上的累计
+};
+
+#endif // C_LINUX_URING_TCP_COM_H
@@ -0,0 +1,262 @@
+#include "EventLoop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+EventLoop g_eventLoop;
+
+namespace {
+constexpr int kMaxEvents = 64;
+} // namespace
+
+EventLoop::EventLoop()
+    : m_base(std::chrono::steady_clock::now())
+{
+    m_epollFd  = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_timerFd  = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeupFd < 0 || m_timerFd < 0) {
+        std::cerr << "[EventLoop] Failed to create epoll/eventfd/timerfd: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = m_wakeupFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeupFd, &ev);
+    ev.data.fd = m_timerFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_timerFd, &ev);
+}
+
+EventLoop::~EventLoop()
+{
+    for (int fd : {m_timerFd, m_wakeupFd, m_epollFd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool EventLoop::loop()
+{
+    if (m_epollFd < 0 || m_wakeupFd < 0 || m_timerFd < 0) {
+        return false;
+    }
+    m_threadId.store(std::this_thread::get_id(), std::memory_order_release);
+    m_quit     = false;
+    m_running.store(true, std::memory_order_release);
+
+    // 时间轮从当前时刻开始计数，启动前投递的定时器在 runPending() 中按真实延时加入
+    m_wheel.advance(nowTick());
+    runPending();
+    rearmTimer();
+
+    epoll_event events[kMaxEvents];
+    while (!m_quit.load(std::memory_order_acquire)) {
+        const int n = epoll_wait(m_epollFd, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[EventLoop] epoll_wait failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_wakeupFd) {
+                handleWakeup();
+            } else if (fd == m_timerFd) {
+                handleTimer();
+            } else {
+                auto it = m_fdCallbacks.find(fd);
+                if (it != m_fdCallbacks.end()) {
+                    FdCallback cb = it->second;   // 回调中可能 removeFd 自身
+                    cb(events[i].events);
+                }
+            }
+        }
+
+        runPending();
+        rearmTimer();
+    }
+
+    m_running.store(false, std::memory_order_release);
+    m_threadId.store(std::thread::id(), std::memory_order_release);
+    return true;
+}
+
+void EventLoop::quit()
+{
+    m_quit.store(true, std::memory_order_release);
+    wakeup();
+}
+
+EventLoop::TimerId EventLoop::runAfter(Duration delay, Functor cb)
+{
+    return addTimer(delay, Duration::zero(), std::move(cb));
+}
+
+EventLoop::TimerId EventLoop::runEvery(Duration interval, Functor cb)
+{
+    if (interval <= Duration::zero()) {
+        std::cerr << "[EventLoop] runEvery: interval must be positive.\n";
+        return 0;
+    }
+    return addTimer(interval, interval, std::move(cb));
+}
+
+void EventLoop::cancel(TimerId id)
+{
+    if (id == 0) {
+        return;
+    }
+    runInLoop([this, id] { m_wheel.cancel(id); });
+}
+
+void EventLoop::runInLoop(Functor cb)
+{
+    if (isInLoopThread()) {
+        cb();
+    } else {
+        queueInLoop(std::move(cb));
+    }
+}
+
+void EventLoop::queueInLoop(Functor cb)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_pendingMutex);
+        m_pending.push_back(std::move(cb));
+    }
+    if (!isInLoopThread()) {
+        wakeup();
+    }
+}
+
+bool EventLoop::addFd(int fd, uint32_t events, FdCallback cb)
+{
+    epoll_event ev{};
+    ev.events  = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::cerr << "[EventLoop] epoll_ctl ADD fd " << fd << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    m_fdCallbacks[fd] = std::move(cb);
+    return true;
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events)
+{
+    epoll_event ev{};
+    ev.events  = events;
+    ev.data.fd = fd;
+    return epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::removeFd(int fd)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    m_fdCallbacks.erase(fd);
+}
+
+EventLoop::TimerId EventLoop::addTimer(Duration delay, Duration interval, Functor cb)
+{
+    const TimerId id = m_nextTimerId.fetch_add(1, std::memory_order_relaxed);
+    // 到期时刻在调用线程确定，避免跨线程投递的延迟计入定时
+    const auto deadline = std::chrono::steady_clock::now() + std::max(delay, Duration::zero());
+
+    runInLoop([this, id, deadline, interval, cb = std::move(cb)]() mutable {
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - m_base).count();
+        const int64_t iv = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+        // 向上取整，保证不会提前触发
+        const uint64_t expire   = ns > 0 ? static_cast<uint64_t>((ns + kTickNs - 1) / kTickNs) : 0;
+        const uint64_t interTck = iv > 0 ? static_cast<uint64_t>(std::max<int64_t>(1, (iv + kTickNs / 2) / kTickNs)) : 0;
+        m_wheel.add(id, expire, interTck, std::move(cb));
+    });
+    return id;
+}
+
+uint64_t EventLoop::nowTick() const
+{
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - m_base).count();
+    return static_cast<uint64_t>(ns / kTickNs);
+}
+
+void EventLoop::wakeup()
+{
+    const uint64_t one = 1;
+    if (::write(m_wakeupFd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        std::cerr << "[EventLoop] wakeup failed: " << std::strerror(errno) << "\n";
+    }
+}
+
+void EventLoop::handleWakeup()
+{
+    uint64_t value;
+    while (::read(m_wakeupFd, &value, sizeof(value)) > 0) {
+    }
+}
+
+void EventLoop::handleTimer()
+{
+    uint64_t expirations;
+    while (::read(m_timerFd, &expirations, sizeof(expirations)) > 0) {
+    }
+    m_armedTick = UINT64_MAX;
+    m_wheel.advance(nowTick());
+}
+
+void EventLoop::runPending()
+{
+    std::vector<Functor> pending;
+    {
+        std::lock_guard<std::mutex> lk(m_pendingMutex);
+        pending.swap(m_pending);
+    }
+    for (auto& fn : pending) {
+        fn();
+    }
+}
+
+// 将 timerfd 设置为时间轮下一个需要处理的 tick（绝对时间），没有定时器时关闭
+void EventLoop::rearmTimer()
+{
+    uint64_t tick;
+    // 已到期（如 runAfter(0) 或回调中新增的立即定时器）直接处理
+    while (m_wheel.nextTick(tick) && tick <= nowTick()) {
+        m_wheel.advance(nowTick());
+        runPending();
+    }
+
+    if (!m_wheel.nextTick(tick)) {
+        if (m_armedTick != UINT64_MAX) {
+            itimerspec off{};
+            timerfd_settime(m_timerFd, 0, &off, nullptr);
+            m_armedTick = UINT64_MAX;
+        }
+        return;
+    }
+    if (tick == m_armedTick) {
+        return;
+    }
+
+    const auto deadline   = m_base + std::chrono::nanoseconds(static_cast<int64_t>(tick) * kTickNs);
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    itimerspec spec{};
+    spec.it_value.tv_sec  = sinceEpoch / 1000000000;
+    spec.it_value.tv_nsec = sinceEpoch % 1000000000;
+    if (timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        std::cerr << "[EventLoop] timerfd_settime failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+    m_armedTick = tick;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TimerWheel.h"
+
+/**
+ * @brief 基于 epoll 的单线程事件循环：文件描述符事件 + 定时器 + 跨线程任务投递。
+ *
+ *        - 定时器由分层时间轮（TimerWheel）管理，tick 为 100us；timerfd 只按“下一个需要处理的 tick”
+ *          以绝对时间设置一次，空闲时不会周期性唤醒，触发抖动通常在 0.1ms 以内。
+ *        - runAfter / runEvery / cancel / runInLoop 可在任意线程调用：非事件循环线程的调用经
+ *          eventfd 唤醒后在事件循环线程中执行，因此所有回调都在事件循环线程中串行运行，不要在回调中阻塞。
+ *        - 定时器的最长延时不受限制（超过约 5 天的定时器先放入溢出链表）。
+ */
+class EventLoop
+{
+public:
+    using TimerId    = TimerWheel::TimerId;
+    using Functor    = std::function<void()>;
+    using FdCallback = std::function<void(uint32_t events)>;
+    using Duration   = std::chrono::steady_clock::duration;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief 在当前线程运行事件循环，直到 quit()
+     * @return 初始化失败返回 false
+     */
+    bool loop();
+
+    /**
+     * @brief 退出事件循环（可在任意线程调用）
+     */
+    void quit();
+
+    /**
+     * @brief 一次性定时器，delay 之后在事件循环线程执行 cb
+     * @return 定时器 ID，可用于 cancel()
+     */
+    TimerId runAfter(Duration delay, Functor cb);
+
+    /**
+     * @brief 周期定时器，首次在 interval 之后执行，之后按固定节拍执行（不累计回调耗时）
+     */
+    TimerId runEvery(Duration interval, Functor cb);
+
+    /**
+     * @brief 取消定时器；对已触发的一次性定时器调用无副作用
+     */
+    void cancel(TimerId id);
+
+    /**
+     * @brief 在事件循环线程执行 cb；若当前就在事件循环线程则立即执行
+     */
+    void runInLoop(Functor cb);
+
+    /**
+     * @brief 投递到事件循环线程，下一轮执行
+     */
+    void queueInLoop(Functor cb);
+
+    /**
+     * @brief 监听文件描述符（EPOLLIN / EPOLLOUT 等），回调在事件循环线程执行
+     * @note 需在事件循环线程调用，其他线程请通过 runInLoop 包装
+     */
+    bool addFd(int fd, uint32_t events, FdCallback cb);
+    bool modifyFd(int fd, uint32_t events);
+    void removeFd(int fd);
+
+    bool isInLoopThread() const { return m_threadId.load(std::memory_order_acquire) == std::this_thread::get_id(); }
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 当前存活的定时器个数（仅事件循环线程内准确）
+     */
+    size_t timerCount() const { return m_wheel.size(); }
+
+private:
+    TimerId  addTimer(Duration delay, Duration interval, Functor cb);
+    uint64_t nowTick() const;
+    void     wakeup();
+    void     handleWakeup();
+    void     handleTimer();
+    void     rearmTimer();
+    void     runPending();
+
+private:
+    static constexpr int64_t kTickNs = 100 * 1000;   ///< 时间轮 tick：100us
+
+    int m_epollFd  = -1;
+    int m_wakeupFd = -1;
+    int m_timerFd  = -1;
+
+    std::atomic<bool>    m_running{false};
+    std::atomic<bool>    m_quit{false};
+    std::atomic<std::thread::id> m_threadId{};   ///< 其他线程经 isInLoopThread() 读取
+    std::chrono::steady_clock::time_point m_base;  ///< tick 0 对应的时刻
+
+    TimerWheel           m_wheel;
+    uint64_t             m_armedTick = UINT64_MAX; ///< timerfd 当前设置的 tick
+    std::atomic<TimerId> m_nextTimerId{1};
+
+    std::mutex           m_pendingMutex;
+    std::vector<Functor> m_pending;
+
+    std::unordered_map<int, FdCallback> m_fdCallbacks;
+};
+
+/**
+ * @brief 进程内共享的事件循环，由 TasksManager 在独立线程中运行
+ */
+extern EventLoop g_eventLoop;
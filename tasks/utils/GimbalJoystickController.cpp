@@ -3,57 +3,25 @@
 #include "GimbalJoystickController.h"
 #include <iostream>
 #include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <termios.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/input.h>
 #include <thread>
 #include <atomic>
-
-// (在别的文件里移植的，防止引用混乱)
-static DataFrame createControlFrame(uint8_t actionId, const std::vector<uint8_t>& actionParam)
-{
-    // 1. 定义协议中的默认值或常量
-    constexpr uint8_t FRAME_HEADER[2] = { 0x74, 0x79 };  // 帧头
-    constexpr uint8_t DEFAULT_COMMAND_ID      = 0xD1;    // 指令编号
-    constexpr uint8_t DEFAULT_ENCRYPTION_FLAG = 0x00;    // 加密标志(0x00=不加密)
-
-    // SN号(15B)，这里示例直接硬编码
-    static const std::vector<uint8_t> SN_NUMBER = {
-        'D', 'B', 'M', '2', '5', '0', '9', '7', '4', '0', '6', '5', '0', '0', '8'
-    };
-
-    // 2. 开始组装数据帧
-    DataFrame frame;
-
-    // (1) 插入帧头
-    frame.insert(frame.end(), std::begin(FRAME_HEADER), std::end(FRAME_HEADER));
-
-    // (2) 为“数据长度”字段预留2个字节，待后面计算回填
-    frame.push_back(0x00);
-    frame.push_back(0x00);
-
-    // (3) 插入 SN 号(15字节)
-    frame.insert(frame.end(), SN_NUMBER.begin(), SN_NUMBER.end());
-
-    // (4) 插入指令编号
-    frame.push_back(DEFAULT_COMMAND_ID);
-
-    // (5) 插入加密标志
-    frame.push_back(DEFAULT_ENCRYPTION_FLAG);
-
-    // (6) 插入动作编号
-    frame.push_back(actionId);
-
-    // (7) 插入动作参数（原 actionParam）
-    frame.insert(frame.end(), actionParam.begin(), actionParam.end());
-
-    // 3. 计算并回填“数据长度”（不包含帧头2字节 + 数据长度本身2字节）
-    //    也就是从SN号开始到最后的所有字段大小
-    uint16_t length = static_cast<uint16_t>(frame.size() - 4);
-    frame[2] = static_cast<uint8_t>((length >> 8) & 0xFF);
-    frame[3] = static_cast<uint8_t>((length & 0xFF));
-
-    return frame;
-}
+#include "common_utils.h"
+#include "CLI2Frame.h"
+#include "EventLoop.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
 
 // 动作编号(示例值),比如 0x00=回中, 0x01=上, 0x05=下, 0x07=左, 0x03=右
 static constexpr uint8_t ACTION_GIMBAL_CENTER = 0x00;
@@ -61,11 +29,15 @@ static constexpr uint8_t ACTION_GIMBAL_UP     = 0x01;
 static constexpr uint8_t ACTION_GIMBAL_DOWN   = 0x05;
 static constexpr uint8_t ACTION_GIMBAL_LEFT   = 0x07;
 static constexpr uint8_t ACTION_GIMBAL_RIGHT  = 0x03;
+static constexpr uint8_t ACTION_GIMBAL_SPEED  = 0xF4;   // 云台速度控制，与 gimbal move speed 相同
 
 
 // 返回值表示这帧是否真正入队（true=已入队，false=被丢弃）
 bool enqueueWithThrottle(const DataFrame& frame)
 {
+    if (frame.empty()) {
+        return false;
+    }
     using clock = std::chrono::steady_clock;
     static std::atomic<clock::time_point> lastPush{
         clock::now() - std::chrono::milliseconds(200)};   // 保证第一帧能通过
@@ -176,3 +148,373 @@ void GimbalJoystickController::run()
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
     std::cout << "Exiting gimbal joystick mode...\n";
 }
+
+// ============================================================================
+// 连续杆量模式
+// ============================================================================
+namespace {
+
+/**
+ * @brief 输入线程、事件循环定时器与发送线程共享的杆量状态
+ */
+struct StickStream {
+    std::atomic<bool>     active{false};
+    std::atomic<uint32_t> stick{0};        ///< 当前杆量：高 16 位俯仰、低 16 位偏航，int16 定点（±32767 = 满杆）
+    std::atomic<uint64_t> changeNs{0};     ///< 尚未发出的最早一次杆量变化时刻，0 表示没有
+    std::atomic<uint64_t> inputEvents{0};
+
+    /**
+     * @brief 已入队未写出的一帧杆量帧
+     */
+    struct Pending {
+        const uint8_t* tag;                ///< 帧缓冲区地址：帧经队列移动到发送批次，地址不变，用来与其他速度帧区分
+        uint64_t       inputNs;            ///< 携带的输入时刻（0 表示无新输入）
+        uint64_t       queuedNs;
+    };
+
+    std::mutex           mutex;            ///< 保护以下成员
+    std::deque<Pending>  inFlight;
+    LatencyHistogram     latency;          ///< 输入到写出 socket 的时延（微秒）
+    uint64_t             ticks         = 0;
+    uint64_t             framesSkipped = 0;
+    uint64_t             framesSent    = 0;
+    uint64_t             framesExpired = 0; ///< 入队后超过保持时长仍未写出（发送失败或丢弃）的帧
+};
+
+StickStream g_stick;
+
+constexpr float kStep     = 0.25f;   // 键盘每次按键改变的杆量
+constexpr float kDeadzone = 0.05f;
+
+uint32_t packStick(float pitch, float yaw)
+{
+    const auto p = static_cast<int16_t>(std::lround(pitch * 32767.0f));
+    const auto y = static_cast<int16_t>(std::lround(yaw * 32767.0f));
+    return (static_cast<uint32_t>(static_cast<uint16_t>(p)) << 16) | static_cast<uint16_t>(y);
+}
+
+void unpackStick(uint32_t v, float& pitch, float& yaw)
+{
+    pitch = static_cast<int16_t>(v >> 16) / 32767.0f;
+    yaw   = static_cast<int16_t>(v & 0xFFFF) / 32767.0f;
+}
+
+float clampStick(float v)
+{
+    return v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : v);
+}
+
+/**
+ * @brief 更新杆量（后到覆盖先到）；杆量有变化时记下时刻，用于统计输入到发出的时延
+ */
+void setStick(float pitch, float yaw)
+{
+    const uint32_t v   = packStick(clampStick(pitch), clampStick(yaw));
+    const uint32_t old = g_stick.stick.exchange(v, std::memory_order_acq_rel);
+    g_stick.inputEvents.fetch_add(1, std::memory_order_relaxed);
+    if (v != old) {
+        uint64_t expected = 0;
+        g_stick.changeNs.compare_exchange_strong(expected, Metrics::nowNs(), std::memory_order_acq_rel);
+    }
+}
+
+DataFrame createSpeedFrame(float pitchSpeed, float yawSpeed, uint16_t timeMs)
+{
+    std::vector<uint8_t> param;
+    const auto p = floatToBigEndian(pitchSpeed);
+    const auto r = floatToBigEndian(0.0f);
+    const auto y = floatToBigEndian(yawSpeed);
+    const auto t = uint16ToBigEndian(timeMs);
+    param.insert(param.end(), p.begin(), p.end());
+    param.insert(param.end(), r.begin(), r.end());
+    param.insert(param.end(), y.begin(), y.end());
+    param.insert(param.end(), t.begin(), t.end());
+    return createControlFrame(ACTION_GIMBAL_SPEED, param);
+}
+
+void pushFrame(DataFrame frame)
+{
+    if (frame.empty()) {
+        return;   // 构建失败（如加密失败），CLI2Frame 已报错
+    }
+    {
+        std::lock_guard<std::mutex> lk(g_queueMutex);
+        g_dataFrameQueue.push(std::move(frame));
+    }
+    g_queueCond.notify_one();
+}
+
+/**
+ * @brief 定时器节拍：取当前杆量发出一帧；上一帧还积压在发送队列时跳过本拍，下一拍自然带上最新杆量。
+ *
+ *        入队超过 holdMs 仍未写出的帧（发送失败被丢弃）不再计入积压，否则杆量流会就此停住；
+ *        其携带的输入时刻交还给下一帧，时延从最初的输入算起。
+ */
+void streamTick(float maxSpeed, uint16_t holdMs)
+{
+    if (!g_stick.active.load(std::memory_order_acquire)) {
+        return;
+    }
+    DataFrame frame;
+    {
+        std::lock_guard<std::mutex> lk(g_stick.mutex);
+        ++g_stick.ticks;
+        const uint64_t now = Metrics::nowNs();
+        while (!g_stick.inFlight.empty()
+               && now - g_stick.inFlight.front().queuedNs > static_cast<uint64_t>(holdMs) * 1000000ULL) {
+            if (const uint64_t inputNs = g_stick.inFlight.front().inputNs) {
+                const uint64_t later = g_stick.changeNs.load(std::memory_order_acquire);
+                if (later == 0 || later > inputNs) {
+                    g_stick.changeNs.store(inputNs, std::memory_order_release);
+                }
+            }
+            g_stick.inFlight.pop_front();
+            ++g_stick.framesExpired;
+        }
+        if (g_stick.inFlight.size() >= 2) {
+            ++g_stick.framesSkipped;
+            return;
+        }
+        float pitch, yaw;
+        unpackStick(g_stick.stick.load(std::memory_order_acquire), pitch, yaw);
+        frame = createSpeedFrame(pitch * maxSpeed, yaw * maxSpeed, holdMs);
+        if (frame.empty()) {
+            return;   // 构建失败（如加密失败），CLI2Frame 已报错
+        }
+        g_stick.inFlight.push_back({frame.data(), g_stick.changeNs.exchange(0, std::memory_order_acq_rel), now});
+    }
+    pushFrame(std::move(frame));
+}
+
+/**
+ * @brief 读取 evdev 设备（或同格式的事件录制文件）；普通文件按事件自带的时间间隔回放，读完即结束
+ */
+void readEvdev(const std::string& path, const std::atomic<bool>& stop, std::atomic<bool>& finished)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[Gimbal] Cannot open input device " << path << ": " << std::strerror(errno) << "\n";
+        finished = true;
+        return;
+    }
+    struct stat st;
+    const bool replay = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+    // 各轴量程：真实设备从驱动读取，录制文件按 int16 处理
+    auto range = [fd](int code, int& lo, int& hi) {
+        input_absinfo info{};
+        if (::ioctl(fd, EVIOCGABS(code), &info) == 0 && info.maximum > info.minimum) {
+            lo = info.minimum;
+            hi = info.maximum;
+        } else {
+            lo = -32768;
+            hi = 32767;
+        }
+    };
+    int xLo, xHi, yLo, yHi;
+    range(ABS_X, xLo, xHi);
+    range(ABS_Y, yLo, yHi);
+    auto normalize = [](int v, int lo, int hi) {
+        const float n = 2.0f * static_cast<float>(v - lo) / static_cast<float>(hi - lo) - 1.0f;
+        return std::fabs(n) < kDeadzone ? 0.0f : clampStick(n);
+    };
+
+    float pitch = 0.0f, yaw = 0.0f;
+    bool  haveBase = false;
+    uint64_t baseEventUs = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    while (!stop.load(std::memory_order_acquire)) {
+        input_event ev;
+        const ssize_t n = ::read(fd, &ev, sizeof(ev));
+        if (n == 0 && replay) {
+            break;   // 录制文件回放结束
+        }
+        if (n != static_cast<ssize_t>(sizeof(ev))) {
+            pollfd pfd{fd, POLLIN, 0};
+            ::poll(&pfd, 1, 50);
+            continue;
+        }
+        if (replay) {
+            const uint64_t evUs = static_cast<uint64_t>(ev.input_event_sec) * 1000000ULL + ev.input_event_usec;
+            if (!haveBase) {
+                baseEventUs = evUs;
+                haveBase    = true;
+            }
+            std::this_thread::sleep_until(start + std::chrono::microseconds(evUs - baseEventUs));
+        }
+        if (ev.type == EV_ABS) {
+            // 左右摇杆都可用：X / RX 为偏航，Y / RY 为俯仰（前推为负值，对应抬头）
+            if (ev.code == ABS_X || ev.code == ABS_RX) {
+                yaw = normalize(ev.value, xLo, xHi);
+            } else if (ev.code == ABS_Y || ev.code == ABS_RY) {
+                pitch = -normalize(ev.value, yLo, yHi);
+            }
+        } else if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+            setStick(pitch, yaw);   // 一次上报内的多个轴合并为一次更新
+        }
+    }
+    ::close(fd);
+    finished = true;
+}
+
+} // namespace
+
+void GimbalJoystickController::onFrameSent(const DataFrame& frame)
+{
+    if (!g_stick.active.load(std::memory_order_acquire) || frame.size() <= 21 || frame[19] != 0xD1
+        || frame[21] != ACTION_GIMBAL_SPEED) {
+        return;
+    }
+    const uint64_t now = Metrics::nowNs();
+    std::lock_guard<std::mutex> lk(g_stick.mutex);
+    auto it = std::find_if(g_stick.inFlight.begin(), g_stick.inFlight.end(),
+                           [&frame](const StickStream::Pending& p) { return p.tag == frame.data(); });
+    if (it == g_stick.inFlight.end()) {
+        return;   // 不是本模式发出的速度帧（如单步模式或其他调用方的 0xF4 帧）
+    }
+    const uint64_t inputNs = it->inputNs;
+    g_stick.inFlight.erase(it);
+    ++g_stick.framesSent;
+    if (inputNs != 0 && now > inputNs) {
+        g_stick.latency.record((now - inputNs) / 1000);
+    }
+}
+
+bool GimbalJoystickController::isStreamFrame(const DataFrame& frame)
+{
+    if (!g_stick.active.load(std::memory_order_acquire) || frame.size() <= 21 || frame[19] != 0xD1
+        || frame[21] != ACTION_GIMBAL_SPEED) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(g_stick.mutex);
+    return std::any_of(g_stick.inFlight.begin(), g_stick.inFlight.end(),
+                       [&frame](const StickStream::Pending& p) { return p.tag == frame.data(); });
+}
+
+void GimbalJoystickController::runStream(const StreamOptions& opts)
+{
+    const int      rateHz = std::max(10, std::min(50, opts.rateHz));
+    const auto     period = std::chrono::microseconds(1000000 / rateHz);
+    const uint16_t holdMs = static_cast<uint16_t>(2 * 1000 / rateHz);   // 两个节拍收不到新帧即停
+
+    {
+        std::lock_guard<std::mutex> lk(g_stick.mutex);
+        g_stick.inFlight.clear();
+        g_stick.latency.reset();
+        g_stick.ticks = g_stick.framesSkipped = g_stick.framesSent = g_stick.framesExpired = 0;
+    }
+    g_stick.stick.store(0);
+    g_stick.changeNs.store(0);
+    g_stick.inputEvents.store(0);
+    g_stick.active.store(true, std::memory_order_release);
+
+    const float maxSpeed = opts.maxSpeed;
+    const EventLoop::TimerId timer = g_eventLoop.runEvery(period, [maxSpeed, holdMs] { streamTick(maxSpeed, holdMs); });
+
+    std::atomic<bool> stopInput{false};
+    std::atomic<bool> inputFinished{false};
+    std::thread       inputThread;
+    if (!opts.device.empty()) {
+        inputThread = std::thread(readEvdev, opts.device, std::cref(stopInput), std::ref(inputFinished));
+    }
+
+    struct termios oldt, newt;
+    const bool tty = tcgetattr(STDIN_FILENO, &oldt) == 0;
+    if (tty) {
+        newt = oldt;
+        newt.c_lflag &= static_cast<unsigned int>(~(ICANON | ECHO));
+        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
+    }
+
+    std::cout << "=== Gimbal Stick Streaming (" << rateHz << " Hz, full stick = " << maxSpeed << " deg/s) ===\n"
+              << (opts.device.empty() ? "Arrow keys change pitch/yaw rate in steps, space stops.\n"
+                                      : "Reading stick input from " + opts.device + "\n")
+              << "Press '0' to recenter, 'q' to quit.\n";
+
+    // 键盘：方向键按步长累加杆量（终端没有松键事件，杆量保持到再次按键）；
+    // evdev 模式下键盘只用于退出 / 回中，录制文件回放结束后自动退出
+    // 直接 read() 标准输入：stdio 缓冲里剩余的字节 poll() 看不到，按键会滞后一拍
+    float pitch = 0.0f, yaw = 0.0f;
+    bool  stdinOpen = true;
+    bool  quit      = false;
+    int   escState  = 0;   // 方向键为 ESC '[' X 三个字节，可能分多次读到
+    while (!quit && !inputFinished.load(std::memory_order_acquire)) {
+        if (!stdinOpen) {
+            if (opts.device.empty()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+        pollfd pfd{STDIN_FILENO, POLLIN, 0};
+        if (::poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        char buf[64];
+        const ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+        if (n <= 0) {
+            stdinOpen = false;
+            continue;
+        }
+        for (ssize_t i = 0; i < n && !quit; ++i) {
+            const char c = buf[i];
+            if (escState == 1) {
+                escState = c == 0x5B ? 2 : 0;
+                continue;
+            }
+            if (escState == 2) {
+                escState = 0;
+                switch (c) {
+                case 0x41: pitch = clampStick(pitch + kStep); break;   // 上
+                case 0x42: pitch = clampStick(pitch - kStep); break;   // 下
+                case 0x43: yaw   = clampStick(yaw + kStep); break;     // 右
+                case 0x44: yaw   = clampStick(yaw - kStep); break;     // 左
+                default: continue;
+                }
+                setStick(pitch, yaw);
+                std::cout << "[Gimbal] pitch " << pitch * maxSpeed << " deg/s, yaw " << yaw * maxSpeed << " deg/s\n";
+                continue;
+            }
+            if (c == 0x1B) {
+                escState = 1;
+            } else if (c == 'q') {
+                quit = true;
+            } else if (c == '0') {
+                pushFrame(createControlFrame(ACTION_GIMBAL_CENTER, {0}));
+                pitch = yaw = 0.0f;
+                setStick(0.0f, 0.0f);
+                std::cout << "[Gimbal] center\n";
+            } else if (c == ' ') {
+                pitch = yaw = 0.0f;
+                setStick(0.0f, 0.0f);
+            }
+        }
+    }
+
+    // 停止定时器后补发一帧零速度，云台立即停住
+    g_stick.active.store(false, std::memory_order_release);
+    g_eventLoop.cancel(timer);
+    pushFrame(createSpeedFrame(0.0f, 0.0f, holdMs));
+    stopInput = true;
+    if (inputThread.joinable()) {
+        inputThread.join();
+    }
+    if (tty) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+    }
+
+    std::lock_guard<std::mutex> lk(g_stick.mutex);
+    std::printf("[Gimbal] %llu ticks, %llu frames sent, %llu skipped (send backlog), %llu expired unsent, "
+                "%llu input events\n",
+                static_cast<unsigned long long>(g_stick.ticks), static_cast<unsigned long long>(g_stick.framesSent),
+                static_cast<unsigned long long>(g_stick.framesSkipped),
+                static_cast<unsigned long long>(g_stick.framesExpired),
+                static_cast<unsigned long long>(g_stick.inputEvents.load()));
+    if (g_stick.latency.count() > 0) {
+        std::printf("[Gimbal] input->wire latency: p50 %.1f ms, p99 %.1f ms, max %.1f ms (%llu changes)\n",
+                    g_stick.latency.percentile(50) / 1000.0, g_stick.latency.percentile(99) / 1000.0,
+                    g_stick.latency.max() / 1000.0, static_cast<unsigned long long>(g_stick.latency.count()));
+    }
+    std::cout << "Exiting gimbal stick streaming...\n";
+}
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <string>
 #include "common_types.h"
 
 // 你的项目中 DataFrame 的定义
@@ -13,14 +14,39 @@ using DataFrame = std::vector<uint8_t>;
 
 /**
  * @brief 用于云台“摇杆控制”的类。进入run()后，捕获键盘输入并生成相应的数据帧。
+ *
+ *        runStream() 为连续杆量模式：输入（键盘或 evdev 设备）只更新当前杆量，g_eventLoop 的定时器按固定频率
+ *        每个节拍发出一帧 0xF4 云台速度控制，后到的输入覆盖先到的（只发最新值）；
+ *        帧内持续时间为两个节拍，数据流中断时云台自动停止。
  */
 class GimbalJoystickController
 {
 public:
+    struct StreamOptions {
+        int         rateHz   = 20;     ///< 发帧频率，限制在 10~50Hz
+        float       maxSpeed = 30.0f;  ///< 满杆对应的角速度（度/秒）
+        std::string device;            ///< evdev 设备（或事件录制文件）路径，空表示键盘
+    };
+
     /**
      * @brief 进入摇杆控制模式，直到用户按'q'退出
      */
     void run();
+
+    /**
+     * @brief 进入连续杆量模式，直到用户按'q'退出（或事件录制文件回放结束）
+     */
+    void runStream(const StreamOptions& opts);
+
+    /**
+     * @brief 发送线程写出一帧后调用；连续杆量模式下据此统计输入到发出的时延
+     */
+    static void onFrameSent(const DataFrame& frame);
+
+    /**
+     * @brief 是否为连续杆量模式发出、尚未写出的杆量帧（按帧缓冲区地址识别，需在 onFrameSent() 之前调用）
+     */
+    static bool isStreamFrame(const DataFrame& frame);
 };
 
 #endif // GIMBAL_JOYSTICK_CONTROLLER_H
@@ -0,0 +1,80 @@
+#ifndef I_TRANSPORT_H
+#define I_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief 与云盒之间的传输层接口（客户端模式），ComTask / TasksManager 只通过该接口收发。
+ *
+ *        - CLinuxTCPCom：TCP 字节流；
+ *        - CLinuxUDPCom：UDP 选择性可靠（控制帧确认重传，遥测不可靠、只保留最新）。
+ *
+ *        RecvData 返回的是字节流：调用方不能假定一次返回恰好一帧，仍交给 FrameAssembler 拼帧。
+ *        发送方向由发送线程调用，接收方向由接收线程调用，两者可并发。
+ */
+class ITransport
+{
+public:
+    virtual ~ITransport() = default;
+
+    /**
+     * @brief 连接服务器
+     * @return 成功返回0，失败返回-1
+     */
+    virtual int InitClient(const char *ip_str, uint16_t port) = 0;
+
+    /**
+     * @brief 发送一帧
+     * @return 成功发送的字节数，出错返回-1
+     */
+    virtual int SendData(const void *buf, size_t size) = 0;
+
+    /**
+     * @brief 一次发送多帧（发送队列中积压的帧合并为一次系统调用）；默认逐帧调用 SendData
+     * @return 成功发送的总字节数，任意一帧出错返回-1
+     */
+    virtual int SendBatch(const std::vector<std::vector<uint8_t>> &frames);
+
+    /**
+     * @brief 接收数据，阻塞直到有数据、连接关闭或 ShutdownRead()
+     * @return 实际接收到的字节数，出错返回-1，连接关闭或 ShutdownRead() 后返回0
+     */
+    virtual int RecvData(void *buf, size_t size) = 0;
+
+    /**
+     * @brief 唤醒阻塞在 RecvData() 上的线程，不影响发送
+     */
+    virtual void ShutdownRead() = 0;
+
+    /**
+     * @brief 关闭连接
+     */
+    virtual void CloseFd() = 0;
+
+    /**
+     * @brief 当前套接字，未连接时为-1
+     */
+    virtual int GetCommFd() const = 0;
+
+    /**
+     * @brief 传输类型名（"tcp" / "udp"）
+     */
+    virtual const char *Name() const = 0;
+};
+
+inline int ITransport::SendBatch(const std::vector<std::vector<uint8_t>> &frames)
+{
+    int total = 0;
+    for (const auto &frame : frames) {
+        const int n = SendData(frame.data(), frame.size());
+        if (n < 0) {
+            return -1;
+        }
+        total += n;
+    }
+    return total;
+}
+
+#endif // I_TRANSPORT_H
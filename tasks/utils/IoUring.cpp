@@ -0,0 +1,313 @@
+#include "IoUring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// 内核按 io_uring_buf 数组读取缓冲区环，尾指针占用 bufs[0].resv
+static_assert(offsetof(io_uring_buf_ring, tail) == offsetof(io_uring_buf, resv),
+              "io_uring_buf_ring.tail must overlay bufs[0].resv");
+
+int sysSetup(unsigned entries, io_uring_params* p)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int sysRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+void setWhy(std::string* why, const std::string& text)
+{
+    if (why) {
+        *why = text;
+    }
+}
+
+} // namespace
+
+IoUring::~IoUring()
+{
+    close();
+}
+
+bool IoUring::probe(std::string* why)
+{
+    IoUring ring;
+    if (!ring.init(4, 0, why)) {
+        return false;
+    }
+
+    // 接收与写文件需要 IORING_OP_RECV / IORING_OP_WRITE（5.6）
+    const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    std::vector<uint8_t> storage(probeSize, 0);
+    auto* pr = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (sysRegister(ring.m_fd, IORING_REGISTER_PROBE, pr, 256) < 0) {
+        setWhy(why, std::string("IORING_REGISTER_PROBE failed: ") + std::strerror(errno));
+        return false;
+    }
+    for (int op : {IORING_OP_RECV, IORING_OP_WRITE, IORING_OP_ASYNC_CANCEL}) {
+        if (op > pr->last_op || !(pr->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            setWhy(why, "opcode " + std::to_string(op) + " not supported");
+            return false;
+        }
+    }
+    // provided buffer ring 需要 5.19；multishot recv（6.0）在首次提交时由调用方检测
+    if (!ring.registerBufferRing(0, 2, 64, why)) {
+        return false;
+    }
+    // 注册成功不代表能取到缓冲（如兼容层实现不完整时 recv 返回 -ENOBUFS），
+    // 因此在 socketpair 上实际走一遍 WRITE + 选缓冲的 RECV
+    int sv[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
+        setWhy(why, std::string("socketpair failed: ") + std::strerror(errno));
+        return false;
+    }
+    static const char kByte = 'x';
+    io_uring_sqe* w = ring.getSqe();
+    w->opcode    = IORING_OP_WRITE;
+    w->fd        = sv[1];
+    w->addr      = reinterpret_cast<uint64_t>(&kByte);
+    w->len       = 1;
+    w->flags     = IOSQE_IO_LINK;
+    w->user_data = 1;
+    io_uring_sqe* r = ring.getSqe();
+    r->opcode    = IORING_OP_RECV;
+    r->fd        = sv[0];
+    r->flags     = IOSQE_BUFFER_SELECT;
+    r->buf_group = 0;
+    r->user_data = 2;
+    int  writeRes = -ETIMEDOUT;
+    int  recvRes  = -ETIMEDOUT;
+    bool selected = false;
+    const int submitted = ring.submitAndWait(0);
+    if (submitted < 0) {
+        writeRes = submitted;
+    } else {
+        // 不阻塞等待：实现不完整时完成事件可能永远不来
+        for (int i = 0; i < 100 && recvRes == -ETIMEDOUT; ++i) {
+            sysEnter(ring.m_fd, 0, 0, IORING_ENTER_GETEVENTS);   // COOP_TASKRUN 下需进入内核才会处理完成
+            ring.forEachCqe([&](const io_uring_cqe& cqe) {
+                if (cqe.user_data == 1) {
+                    writeRes = cqe.res;
+                } else {
+                    recvRes  = cqe.res;
+                    selected = cqe.flags & IORING_CQE_F_BUFFER;
+                }
+            });
+            if (recvRes == -ETIMEDOUT) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+    ::close(sv[0]);
+    ::close(sv[1]);
+    if (writeRes != 1 || recvRes != 1 || !selected) {
+        setWhy(why, "self-test failed (write=" + std::to_string(writeRes) + ", recv=" + std::to_string(recvRes) +
+                        (selected ? "" : ", no provided buffer") + ")");
+        return false;
+    }
+    return true;
+}
+
+bool IoUring::init(unsigned entries, unsigned cqEntries, std::string* why)
+{
+    close();
+
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    // COOP_TASKRUN（5.19）：完成事件只在本线程进入内核时处理，不用 IPI 打断正在运行的线程
+    p.flags = IORING_SETUP_COOP_TASKRUN;
+    if (cqEntries) {
+        p.flags |= IORING_SETUP_CQSIZE;
+        p.cq_entries = cqEntries;
+    }
+    m_fd = sysSetup(entries, &p);
+    if (m_fd < 0 && errno == EINVAL) {
+        p.flags &= ~IORING_SETUP_COOP_TASKRUN;
+        m_fd = sysSetup(entries, &p);
+    }
+    if (m_fd < 0) {
+        setWhy(why, std::string("io_uring_setup failed: ") + std::strerror(errno));
+        return false;
+    }
+
+    m_sqRingSz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    m_cqRingSz = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        m_sqRingSz = m_cqRingSz = std::max(m_sqRingSz, m_cqRingSz);
+    }
+    m_sqRing = ::mmap(nullptr, m_sqRingSz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                      IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+        m_sqRing = nullptr;
+        setWhy(why, std::string("mmap SQ ring failed: ") + std::strerror(errno));
+        close();
+        return false;
+    }
+    if (single) {
+        m_cqRing = m_sqRing;
+    } else {
+        m_cqRing = ::mmap(nullptr, m_cqRingSz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                          IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED) {
+            m_cqRing = nullptr;
+            setWhy(why, std::string("mmap CQ ring failed: ") + std::strerror(errno));
+            close();
+            return false;
+        }
+    }
+    m_sqesSz = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, m_sqesSz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        setWhy(why, std::string("mmap SQEs failed: ") + std::strerror(errno));
+        close();
+        return false;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq    = static_cast<uint8_t*>(m_sqRing);
+    auto* cq    = static_cast<uint8_t*>(m_cqRing);
+    m_sqHead    = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    m_sqTail    = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    m_sqMask    = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    m_sqArray   = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    m_sqEntries = p.sq_entries;
+    m_sqeTail   = *m_sqTail;
+    m_cqHead    = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    m_cqTail    = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    m_cqMask    = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    m_cqes      = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    // SQ 数组固定为恒等映射，之后只需推进尾指针
+    for (unsigned i = 0; i < m_sqEntries; ++i) {
+        m_sqArray[i] = i;
+    }
+    m_enterCalls = 0;
+    return true;
+}
+
+void IoUring::close()
+{
+    // 关闭 ring 会取消其中仍在进行的请求
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    if (m_sqes) {
+        ::munmap(m_sqes, m_sqesSz);
+        m_sqes = nullptr;
+    }
+    if (m_cqRing && m_cqRing != m_sqRing) {
+        ::munmap(m_cqRing, m_cqRingSz);
+    }
+    m_cqRing = nullptr;
+    if (m_sqRing) {
+        ::munmap(m_sqRing, m_sqRingSz);
+        m_sqRing = nullptr;
+    }
+    if (m_bufRing) {
+        ::munmap(m_bufRing, m_bufRingSz);
+        m_bufRing = nullptr;
+    }
+    m_bufs.clear();
+    m_bufs.shrink_to_fit();
+    m_bufCount = 0;
+}
+
+io_uring_sqe* IoUring::getSqe()
+{
+    const unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    if (m_sqeTail - head >= m_sqEntries) {
+        return nullptr;
+    }
+    io_uring_sqe* sqe = &m_sqes[m_sqeTail & m_sqMask];
+    ++m_sqeTail;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::submitAndWait(unsigned waitNr)
+{
+    publishBuffers();
+    const unsigned toSubmit = m_sqeTail - *m_sqTail;
+    __atomic_store_n(m_sqTail, m_sqeTail, __ATOMIC_RELEASE);
+    if (toSubmit == 0 && waitNr == 0) {
+        return 0;
+    }
+    ++m_enterCalls;
+    const int r = sysEnter(m_fd, toSubmit, waitNr, waitNr ? IORING_ENTER_GETEVENTS : 0);
+    return r < 0 ? -errno : r;
+}
+
+bool IoUring::registerBufferRing(uint16_t groupId, unsigned count, unsigned size, std::string* why)
+{
+    if (count == 0 || (count & (count - 1)) != 0 || count > 32768) {
+        setWhy(why, "buffer count must be a power of two <= 32768");
+        return false;
+    }
+    m_bufRingSz = count * sizeof(io_uring_buf);
+    void* mem = ::mmap(nullptr, m_bufRingSz, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (mem == MAP_FAILED) {
+        setWhy(why, std::string("mmap buffer ring failed: ") + std::strerror(errno));
+        return false;
+    }
+    m_bufRing = static_cast<io_uring_buf_ring*>(mem);
+
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = reinterpret_cast<uint64_t>(mem);
+    reg.ring_entries = count;
+    reg.bgid         = groupId;
+    if (sysRegister(m_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        setWhy(why, std::string("IORING_REGISTER_PBUF_RING failed: ") + std::strerror(errno));
+        ::munmap(mem, m_bufRingSz);
+        m_bufRing = nullptr;
+        return false;
+    }
+
+    m_bufCount = count;
+    m_bufSize  = size;
+    m_bufGroup = groupId;
+    m_bufTail  = 0;
+    m_bufs.assign(static_cast<size_t>(count) * size, 0);
+    for (unsigned i = 0; i < count; ++i) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    publishBuffers();
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t bid)
+{
+    // 环上就是 io_uring_buf 数组（tail 与 bufs[0].resv 重叠）。C++ 下 uapi 头文件的 __DECLARE_FLEX_ARRAY
+    // 在 bufs 前多放了一个空结构体，m_bufRing->bufs 的偏移是 8 而不是 0，不能经由它写描述符
+    io_uring_buf& b = reinterpret_cast<io_uring_buf*>(m_bufRing)[m_bufTail & (m_bufCount - 1)];
+    b.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    b.len  = m_bufSize;
+    b.bid  = bid;
+    ++m_bufTail;
+}
+
+void IoUring::publishBuffers()
+{
+    if (m_bufRing) {
+        __atomic_store_n(&m_bufRing->tail, m_bufTail, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief io_uring 的最小封装（直接使用系统调用，不依赖 liburing）：提交 / 完成队列、provided buffer ring。
+ *
+ *        - 只供单个线程使用（提交与收割都在同一线程），不加锁；
+ *        - 提交的 SQE 在下一次 submitAndWait() 时一并交给内核，与等待完成合为一次 io_uring_enter；
+ *        - provided buffer ring（IORING_REGISTER_PBUF_RING）：内核收包时自行挑选缓冲，
+ *          配合 multishot recv 一次提交即可持续接收，应用用完后 recycleBuffer() 归还。
+ *
+ *        probe() 在运行时检测内核是否可用（io_uring 被禁用、seccomp 拦截、内核过旧等），不可用时调用方回退。
+ */
+class IoUring
+{
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @brief 检测 io_uring 与 provided buffer ring 是否可用：除检查操作码外，还在 socketpair 上
+     *        实际完成一次 WRITE 与选缓冲的 RECV（最多等待约 100ms）
+     * @param why 不可用时写入原因
+     */
+    static bool probe(std::string* why = nullptr);
+
+    /**
+     * @brief 创建队列
+     * @param entries  提交队列长度
+     * @param cqEntries 完成队列长度（multishot 接收突发时需要更大的完成队列），0 为默认（2 × entries）
+     */
+    bool init(unsigned entries, unsigned cqEntries = 0, std::string* why = nullptr);
+    void close();
+    bool valid() const { return m_fd >= 0; }
+
+    /**
+     * @brief 取一个空闲 SQE（已清零），提交队列满时返回 nullptr
+     */
+    io_uring_sqe* getSqe();
+
+    /**
+     * @brief 提交所有新 SQE，并等待至少 waitNr 个完成
+     * @return 成功返回提交的 SQE 数，失败返回 -errno（等待被信号打断时为 -EINTR）
+     */
+    int submitAndWait(unsigned waitNr);
+
+    /**
+     * @brief 依次处理已完成的 CQE，返回处理的个数
+     */
+    template <typename F>
+    unsigned forEachCqe(F&& f)
+    {
+        unsigned       head = *m_cqHead;
+        const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        unsigned       n    = 0;
+        for (; head != tail; ++head, ++n) {
+            f(m_cqes[head & m_cqMask]);
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+        return n;
+    }
+
+    /**
+     * @brief 注册 provided buffer ring：count（2 的幂）个 size 字节的缓冲，组号 groupId
+     */
+    bool registerBufferRing(uint16_t groupId, unsigned count, unsigned size, std::string* why = nullptr);
+
+    /**
+     * @brief 归还缓冲给内核（可连续归还多个，下次 submitAndWait 之前统一发布）
+     */
+    void recycleBuffer(uint16_t bid);
+
+    uint8_t* buffer(uint16_t bid) { return m_bufs.data() + static_cast<size_t>(bid) * m_bufSize; }
+    uint16_t bufferGroup() const { return m_bufGroup; }
+
+    uint64_t enterCalls() const { return m_enterCalls; }   ///< io_uring_enter 调用次数
+
+private:
+    void publishBuffers();
+
+private:
+    int m_fd = -1;
+
+    void*  m_sqRing   = nullptr;
+    void*  m_cqRing   = nullptr;
+    size_t m_sqRingSz = 0;
+    size_t m_cqRingSz = 0;
+    io_uring_sqe* m_sqes    = nullptr;
+    size_t        m_sqesSz  = 0;
+
+    unsigned* m_sqHead  = nullptr;
+    unsigned* m_sqTail  = nullptr;
+    unsigned* m_sqArray = nullptr;
+    unsigned  m_sqMask  = 0;
+    unsigned  m_sqEntries = 0;
+    unsigned  m_sqeTail   = 0;   ///< 已填写的 SQE（尚未发布给内核的在 *m_sqTail 之后）
+
+    unsigned*     m_cqHead = nullptr;
+    unsigned*     m_cqTail = nullptr;
+    unsigned      m_cqMask = 0;
+    io_uring_cqe* m_cqes   = nullptr;
+
+    // provided buffer ring
+    io_uring_buf_ring*   m_bufRing     = nullptr;
+    size_t               m_bufRingSz   = 0;
+    unsigned             m_bufCount    = 0;
+    unsigned             m_bufSize     = 0;
+    uint16_t             m_bufGroup    = 0;
+    uint16_t             m_bufTail     = 0;   ///< 本地尾指针，publishBuffers() 时写回共享内存
+    std::vector<uint8_t> m_bufs;
+
+    uint64_t m_enterCalls = 0;
+};
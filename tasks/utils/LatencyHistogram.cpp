@@ -0,0 +1,107 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int    kSubBits    = 6;                       ///< 每个 2 的幂区间 64 个子桶
+constexpr int    kLinearBits = kSubBits + 1;            ///< 0~127 线性
+constexpr int    kMaxExp     = 35;                      ///< 最高位上限 -> 2^36 us
+constexpr size_t kBuckets    = (1u << kLinearBits) + (kMaxExp - kLinearBits + 1) * (1u << kSubBits);
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(kBuckets, 0)
+{
+}
+
+size_t LatencyHistogram::bucketCount()
+{
+    return kBuckets;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < (1u << kLinearBits)) {
+        return static_cast<size_t>(value);
+    }
+    int exp = 63 - __builtin_clzll(value);
+    if (exp > kMaxExp) {
+        return kBuckets - 1;
+    }
+    const int    shift = exp - kSubBits;
+    const size_t sub   = static_cast<size_t>(value >> shift) - (1u << kSubBits);
+    return (1u << kLinearBits) + static_cast<size_t>(exp - kLinearBits) * (1u << kSubBits) + sub;
+}
+
+// 桶的代表值取区间中点
+uint64_t LatencyHistogram::bucketValue(size_t index)
+{
+    if (index < (1u << kLinearBits)) {
+        return index;
+    }
+    const size_t rel   = index - (1u << kLinearBits);
+    const int    exp   = static_cast<int>(rel >> kSubBits) + kLinearBits;
+    const int    shift = exp - kSubBits;
+    const uint64_t top = (rel & ((1u << kSubBits) - 1)) + (1u << kSubBits);
+    return (top << shift) + ((1ULL << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t us)
+{
+    ++m_buckets[bucketIndex(us)];
+    ++m_count;
+    m_sum += us;
+    m_min = std::min(m_min, us);
+    m_max = std::max(m_max, us);
+}
+
+void LatencyHistogram::addBucket(size_t index, uint64_t n)
+{
+    if (index >= kBuckets || n == 0) {
+        return;
+    }
+    const uint64_t v = bucketValue(index);
+    m_buckets[index] += n;
+    m_count += n;
+    m_sum   += v * n;
+    m_min    = std::min(m_min, v);
+    m_max    = std::max(m_max, v);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < kBuckets; ++i) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    m_min    = std::min(m_min, other.m_min);
+    m_max    = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_sum   = 0;
+    m_min   = UINT64_MAX;
+    m_max   = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    q = std::min(100.0, std::max(0.0, q));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q / 100.0 * m_count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return std::min(std::max(bucketValue(i), min()), m_max);
+        }
+    }
+    return m_max;
+}
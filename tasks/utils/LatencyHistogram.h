@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief HDR 风格的对数-线性直方图，用于记录时延（单位由调用方决定，通常为微秒或纳秒）。
+ *
+ *        0~127 每 1 个单位一个桶；之后每个 2 的幂区间再均分为 64 个子桶，相对误差 < 1.6%。
+ *        上限 2^36 个单位（微秒约 19 小时，纳秒约 68 秒），超出部分计入最后一个桶。
+ *        固定约 2000 个桶，record() 为 O(1) 且不分配内存；非线程安全，由调用方加锁。
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief 记录一个样本（微秒）
+     */
+    void record(uint64_t us);
+
+    /**
+     * @brief 合并另一个直方图
+     */
+    void merge(const LatencyHistogram& other);
+
+    void reset();
+
+    uint64_t count() const { return m_count; }
+    uint64_t min()   const { return m_count ? m_min : 0; }
+    uint64_t max()   const { return m_max; }
+    double   mean()  const { return m_count ? static_cast<double>(m_sum) / m_count : 0.0; }
+
+    /**
+     * @brief 百分位值，q 取值 0~100，如 99.9
+     */
+    uint64_t percentile(double q) const;
+
+    /**
+     * @brief 按桶累加 n 个样本（用于合并外部按同样桶布局计数的数据，如各线程的原子计数）
+     */
+    void addBucket(size_t index, uint64_t n);
+
+    static size_t   bucketCount();
+    static size_t   bucketIndex(uint64_t value);
+    static uint64_t bucketValue(size_t index);
+
+private:
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count = 0;
+    uint64_t m_sum   = 0;
+    uint64_t m_min   = UINT64_MAX;
+    uint64_t m_max   = 0;
+};
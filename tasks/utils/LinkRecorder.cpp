@@ -0,0 +1,193 @@
+#include "LinkRecorder.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+LinkRecorder g_linkRecorder;
+
+namespace {
+
+void putLE(std::vector<uint8_t>& out, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+} // namespace
+
+bool LinkRecorder::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_fd >= 0) {
+        std::cerr << "[LinkRecorder] Already recording to " << m_path << "\n";
+        return false;
+    }
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[LinkRecorder] Cannot open " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    std::vector<uint8_t> header = {'D', 'J', 'I', 'L', 'I', 'N', 'K', '1'};
+    const auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+    putLE(header, static_cast<uint64_t>(wallNs), 8);
+
+    m_fd      = fd;
+    m_path    = path;
+    m_offset  = 0;
+    m_stats   = Stats();
+    if (!writeSync(header.data(), header.size(), 0)) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_offset = header.size();
+    m_active.store(true, std::memory_order_relaxed);
+    std::cout << "[LinkRecorder] Recording received bytes to " << path << "\n";
+    return true;
+}
+
+void LinkRecorder::stop()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (m_fd < 0) {
+        return;
+    }
+    m_active.store(false, std::memory_order_relaxed);
+    // 调用方不是接收线程，不能往接收线程的 ring 上提交
+    submitLocked(false);
+    if (!m_idle.wait_for(lk, std::chrono::seconds(2), [this] { return m_inflight == 0; })) {
+        std::cerr << "[LinkRecorder] " << m_inflight << " chunk(s) still in flight, closing anyway.\n";
+    }
+    ::close(m_fd);   // 仍在途的请求持有文件引用，关闭 fd 不影响其完成
+    m_fd = -1;
+    std::cout << "[LinkRecorder] Stopped: " << m_stats.records << " records, " << m_stats.bytes << " bytes -> " << m_path
+              << " (" << m_stats.asyncWrites << " async / " << m_stats.syncWrites << " sync writes, " << m_stats.dropped
+              << " records dropped, " << m_stats.errors << " errors)\n";
+}
+
+void LinkRecorder::record(const uint8_t* data, size_t length, uint64_t recvNs)
+{
+    if (!active()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_fd < 0) {
+        return;
+    }
+    const size_t need = 12 + length;
+    if (m_current && !m_current->data.empty() && m_current->data.size() + need > kChunkSize) {
+        submitLocked(true);
+    }
+    if (!m_current) {
+        if (!m_free.empty()) {
+            m_current = m_free.back();
+            m_free.pop_back();
+        } else if (m_chunks.size() < kMaxChunks) {
+            m_chunks.emplace_back(new Chunk());
+            m_current = m_chunks.back().get();
+            m_current->data.reserve(kChunkSize);
+        } else {
+            ++m_stats.dropped;   // 磁盘跟不上：丢弃，不阻塞接收
+            return;
+        }
+    }
+    putLE(m_current->data, recvNs, 8);
+    putLE(m_current->data, length, 4);
+    m_current->data.insert(m_current->data.end(), data, data + length);
+    ++m_stats.records;
+    m_stats.bytes += length;
+}
+
+void LinkRecorder::submitLocked(bool allowAsync)
+{
+    Chunk* chunk = m_current;
+    if (!chunk || chunk->data.empty()) {
+        return;
+    }
+    m_current     = nullptr;
+    chunk->offset = m_offset;
+    m_offset     += chunk->data.size();
+    if (allowAsync && m_asyncWriter && m_asyncWriter(m_fd, chunk)) {
+        ++m_inflight;
+        ++m_stats.asyncWrites;
+        return;
+    }
+    if (!writeSync(chunk->data.data(), chunk->data.size(), chunk->offset)) {
+        ++m_stats.errors;
+    }
+    chunk->data.clear();
+    m_free.push_back(chunk);
+}
+
+bool LinkRecorder::writeSync(const uint8_t* data, size_t length, uint64_t offset)
+{
+    ++m_stats.syncWrites;
+    while (length > 0) {
+        const ssize_t n = ::pwrite(m_fd, data, length, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::cerr << "[LinkRecorder] Write to " << m_path << " failed: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        data   += n;
+        length -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+void LinkRecorder::setAsyncWriter(AsyncWriter writer)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_asyncWriter = std::move(writer);
+}
+
+void LinkRecorder::complete(Chunk* chunk, int result)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        const size_t size = chunk->data.size();
+        if (result < 0) {
+            std::cerr << "[LinkRecorder] Async write failed: " << std::strerror(-result) << "\n";
+            ++m_stats.errors;
+        } else if (static_cast<size_t>(result) < size && m_fd >= 0) {
+            // 短写：余下部分同步补齐
+            if (!writeSync(chunk->data.data() + result, size - result, chunk->offset + result)) {
+                ++m_stats.errors;
+            }
+        }
+        chunk->data.clear();
+        m_free.push_back(chunk);
+        --m_inflight;
+    }
+    m_idle.notify_all();
+}
+
+LinkRecorder::Stats LinkRecorder::stats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_stats;
+}
+
+std::string LinkRecorder::status() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    std::ostringstream oss;
+    if (m_fd < 0) {
+        oss << "[LinkRecorder] Not recording.\n";
+    } else {
+        oss << "[LinkRecorder] Recording to " << m_path << ": " << m_stats.records << " records, " << m_stats.bytes
+            << " bytes, " << m_stats.asyncWrites << " async / " << m_stats.syncWrites << " sync writes, " << m_inflight
+            << " in flight, " << m_stats.dropped << " dropped, " << m_stats.errors << " errors\n";
+    }
+    return oss.str();
+}
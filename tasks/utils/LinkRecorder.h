@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 链路录制：把接收线程收到的原始字节流（带接收时间戳）写入文件，供离线分析与复现。
+ *
+ *        文件格式（小端）：
+ *            "DJILINK1" | 录制开始时刻（系统时钟，ns，u64）
+ *            之后每段：接收时刻（Metrics::nowNs，u64）| 长度（u32）| 数据
+ *
+ *        - record() 只在接收线程调用：先写入 64KB 暂存块，写满后整块交给写出方。
+ *          传输层注册了异步写出（io_uring）时，写请求挂到接收线程的 ring 上，随下一次等待接收一并提交；
+ *          否则直接 pwrite()；
+ *        - 在途的块最多 kMaxChunks 个，都在途时新数据丢弃并计数，不阻塞接收线程；
+ *        - 未录制时 record() 只有一次 relaxed 原子读。
+ */
+class LinkRecorder
+{
+public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kMaxChunks = 8;
+
+    struct Stats {
+        uint64_t records     = 0;
+        uint64_t bytes       = 0;
+        uint64_t asyncWrites = 0;
+        uint64_t syncWrites  = 0;   ///< 含文件头
+        uint64_t dropped     = 0;   ///< 在途块已满时丢弃的段数
+        uint64_t errors      = 0;
+    };
+
+    struct Chunk {
+        std::vector<uint8_t> data;
+        uint64_t             offset = 0;   ///< 在文件中的位置
+    };
+
+    /**
+     * @brief 异步写出：提交成功返回 true，写完后由写出方调用 complete()；返回 false 时改为同步写出
+     */
+    using AsyncWriter = std::function<bool(int fd, Chunk* chunk)>;
+
+    bool start(const std::string& path);
+
+    /**
+     * @brief 写出暂存数据，等待在途的块写完（最多 2 秒）后关闭文件
+     */
+    void stop();
+
+    bool active() const { return m_active.load(std::memory_order_relaxed); }
+
+    void record(const uint8_t* data, size_t length, uint64_t recvNs);
+
+    /**
+     * @brief 由传输层在接收线程中设置 / 清除（传空函数）
+     */
+    void setAsyncWriter(AsyncWriter writer);
+
+    /**
+     * @brief 异步写出完成，result 为写入字节数或 -errno
+     */
+    void complete(Chunk* chunk, int result);
+
+    Stats       stats() const;
+    std::string status() const;
+
+private:
+    void submitLocked(bool allowAsync);
+    bool writeSync(const uint8_t* data, size_t length, uint64_t offset);
+
+private:
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_idle;
+    std::atomic<bool>       m_active{false};
+    int                     m_fd = -1;
+    std::string             m_path;
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;    ///< 全部块（复用，不释放）
+    std::vector<Chunk*>                 m_free;
+    Chunk*                              m_current  = nullptr;
+    size_t                              m_inflight = 0;
+    AsyncWriter                         m_asyncWriter;
+
+    uint64_t m_offset = 0;
+    Stats    m_stats;
+};
+
+extern LinkRecorder g_linkRecorder;
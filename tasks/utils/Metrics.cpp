@@ -0,0 +1,275 @@
+#include "Metrics.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "EventLoop.h"
+
+namespace {
+
+constexpr size_t kCacheLine = 64;
+
+const char* const kCounterNames[Metrics::CounterCount] = {
+    "bytes_in", "recv_chunks", "bytes_out", "frames_out", "frames_assembled", "resync_bytes",
+    "discarded_bytes", "frames_decoded", "frames_handled", "protobuf_errors", "frames_rendered",
+    "udp_retransmits", "udp_expired", "udp_duplicates", "udp_stale", "udp_collapsed", "udp_emulated_drops",
+    "frames_sealed", "frames_opened", "cipher_rejects", "hedged_frames", "hedge_duplicates", "link_switches",
+};
+const char* const kGaugeNames[Metrics::GaugeCount] = {
+    "send_queue_depth", "raw_queue_depth", "complete_queue_depth",
+};
+const char* const kStageNames[Metrics::StageCount] = {
+    "recv_to_assembled", "assembled_to_decoded", "decoded_to_handled", "handled_to_rendered", "recv_to_handled",
+    "air_to_ground",
+};
+
+// 单写者自增：只有所属线程写，relaxed load + store 即可，避免 lock 前缀指令
+inline void bump(std::atomic<uint64_t>& a, uint64_t n)
+{
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct alignas(kCacheLine) ThreadSlot {
+    std::atomic<uint64_t> counters[Metrics::CounterCount] = {};
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets[Metrics::StageCount];
+
+    ThreadSlot()
+    {
+        for (auto& b : buckets) {
+            const size_t n = LatencyHistogram::bucketCount();
+            b.reset(new std::atomic<uint64_t>[n]);
+            for (size_t i = 0; i < n; ++i) {
+                b[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+struct alignas(kCacheLine) PaddedGauge {
+    std::atomic<uint64_t> value{0};
+    std::atomic<uint64_t> max{0};
+};
+
+// 线程退出后槽位保留，累计值不丢失；线程数量有限，不回收
+std::mutex               g_slotMutex;
+std::vector<ThreadSlot*> g_slots;
+PaddedGauge              g_gauges[Metrics::GaugeCount];
+const auto               g_startTime = std::chrono::steady_clock::now();
+
+ThreadSlot& localSlot()
+{
+    thread_local ThreadSlot* slot = nullptr;
+    if (!slot) {
+        slot = new ThreadSlot();
+        std::lock_guard<std::mutex> lk(g_slotMutex);
+        g_slots.push_back(slot);
+    }
+    return *slot;
+}
+
+int g_endpointFd = -1;
+
+struct EndpointClient {
+    std::string out;         ///< 待发送的响应，收到请求前为空
+    size_t      sent = 0;
+};
+// 只在事件循环线程访问
+std::unordered_map<int, EndpointClient> g_endpointClients;
+
+void closeClient(EventLoop& loop, int fd)
+{
+    loop.removeFd(fd);
+    ::close(fd);
+    g_endpointClients.erase(fd);
+}
+
+void serveClient(EventLoop& loop, int fd)
+{
+    auto it = g_endpointClients.find(fd);
+    if (it == g_endpointClients.end()) {
+        return;
+    }
+    EndpointClient& c = it->second;
+    if (c.out.empty()) {
+        // 读掉请求（HTTP GET 或任意一行），避免未读数据导致关闭时发送 RST
+        char req[1024];
+        while (::recv(fd, req, sizeof(req), 0) > 0) {
+        }
+        const std::string body = Metrics::toText(Metrics::snapshot());
+        c.out = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nContent-Length: "
+              + std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    while (c.sent < c.out.size()) {
+        const ssize_t n = ::send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 发送缓冲已满：剩余部分等 EPOLLOUT 再写，不在事件循环上阻塞
+            loop.modifyFd(fd, EPOLLOUT | EPOLLRDHUP);
+            return;
+        }
+        break;
+    }
+    closeClient(loop, fd);
+}
+
+} // namespace
+
+uint64_t Metrics::nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Metrics::add(Counter c, uint64_t n)
+{
+    bump(localSlot().counters[c], n);
+}
+
+void Metrics::setGauge(Gauge g, uint64_t value)
+{
+    PaddedGauge& pg = g_gauges[g];
+    pg.value.store(value, std::memory_order_relaxed);
+    uint64_t prev = pg.max.load(std::memory_order_relaxed);
+    while (value > prev && !pg.max.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Metrics::recordStage(Stage s, uint64_t startNs, uint64_t endNs)
+{
+    if (startNs == 0 || endNs < startNs) {
+        return;
+    }
+    bump(localSlot().buckets[s][LatencyHistogram::bucketIndex(endNs - startNs)], 1);
+}
+
+Metrics::Snapshot Metrics::snapshot()
+{
+    Snapshot snap;
+    snap.uptimeSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_startTime).count();
+
+    std::lock_guard<std::mutex> lk(g_slotMutex);
+    const size_t nb = LatencyHistogram::bucketCount();
+    for (const ThreadSlot* slot : g_slots) {
+        for (int c = 0; c < CounterCount; ++c) {
+            snap.counters[c] += slot->counters[c].load(std::memory_order_relaxed);
+        }
+        for (int s = 0; s < StageCount; ++s) {
+            for (size_t i = 0; i < nb; ++i) {
+                const uint64_t n = slot->buckets[s][i].load(std::memory_order_relaxed);
+                if (n) {
+                    snap.stages[s].addBucket(i, n);
+                }
+            }
+        }
+    }
+    for (int g = 0; g < GaugeCount; ++g) {
+        snap.gauges[g]   = g_gauges[g].value.load(std::memory_order_relaxed);
+        snap.gaugeMax[g] = g_gauges[g].max.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+std::string Metrics::toText(const Snapshot& snap)
+{
+    std::string out;
+    char line[256];
+
+    std::snprintf(line, sizeof(line), "uptime_seconds %.1f\n", snap.uptimeSec);
+    out += line;
+    for (int c = 0; c < CounterCount; ++c) {
+        std::snprintf(line, sizeof(line), "%s %llu\n", kCounterNames[c],
+                      static_cast<unsigned long long>(snap.counters[c]));
+        out += line;
+    }
+    for (int g = 0; g < GaugeCount; ++g) {
+        std::snprintf(line, sizeof(line), "%s %llu (max %llu)\n", kGaugeNames[g],
+                      static_cast<unsigned long long>(snap.gauges[g]),
+                      static_cast<unsigned long long>(snap.gaugeMax[g]));
+        out += line;
+    }
+    out += "# stage latency in us: count p50 p90 p99 p99.9 max\n";
+    for (int s = 0; s < StageCount; ++s) {
+        const LatencyHistogram& h = snap.stages[s];
+        std::snprintf(line, sizeof(line), "%s %llu %.1f %.1f %.1f %.1f %.1f\n", kStageNames[s],
+                      static_cast<unsigned long long>(h.count()),
+                      h.percentile(50) / 1e3, h.percentile(90) / 1e3, h.percentile(99) / 1e3,
+                      h.percentile(99.9) / 1e3, h.max() / 1e3);
+        out += line;
+    }
+    return out;
+}
+
+bool Metrics::startEndpoint(EventLoop& loop, uint16_t port)
+{
+    if (port == 0 || g_endpointFd >= 0) {
+        return false;
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "[Metrics] socket failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // 只对本机开放
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 8) < 0) {
+        std::cerr << "[Metrics] bind/listen 127.0.0.1:" << port << " failed: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+    g_endpointFd = fd;
+
+    loop.runInLoop([&loop, fd] {
+        loop.addFd(fd, EPOLLIN, [&loop, fd](uint32_t) {
+            int client;
+            while ((client = ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                g_endpointClients[client] = EndpointClient();
+                loop.addFd(client, EPOLLIN | EPOLLRDHUP, [&loop, client](uint32_t) { serveClient(loop, client); });
+            }
+        });
+    });
+    std::cout << "[Metrics] Text endpoint on 127.0.0.1:" << port << "\n";
+    return true;
+}
+
+void Metrics::stopEndpoint(EventLoop& loop)
+{
+    const int fd = g_endpointFd;
+    if (fd < 0) {
+        return;
+    }
+    g_endpointFd = -1;
+    loop.runInLoop([&loop, fd] {
+        loop.removeFd(fd);
+        ::close(fd);
+        for (const auto& kv : g_endpointClients) {
+            loop.removeFd(kv.first);
+            ::close(kv.first);
+        }
+        g_endpointClients.clear();
+    });
+}
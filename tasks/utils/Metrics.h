@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "LatencyHistogram.h"
+
+class EventLoop;
+
+/**
+ * @brief 收发流水线的运行指标：计数器、队列深度、各阶段时延。
+ *
+ *        - 计数器按线程分片：每个线程首次写入时分配一块按缓存行对齐的槽位，之后只由该线程写
+ *          （relaxed load + store，无锁、无原子读改写指令），读取时汇总所有线程；
+ *        - 阶段时延同样按线程分片记录到与 LatencyHistogram 相同桶布局的原子计数中，单位为纳秒；
+ *        - 队列深度为全局仪表值（各自独占缓存行），由消费者在取出前写入，同时记录历史最大值。
+ *
+ *        阶段划分（接收方向）：
+ *            recv       socket 读到数据（完成该帧的那一段）
+ *            assembled  FrameAssembler 组装出完整帧
+ *            decoded    ReplyFrameDecoder 解析出命令与数据
+ *            handled    FrameDataHandler 处理完毕
+ *            rendered   TelemetryUI 将最新数据绘制并提交到屏幕
+ *
+ *        snapshot() 汇总当前值；startEndpoint() 在事件循环上开启本地文本端点，
+ *        `curl http://127.0.0.1:<port>/` 或 `nc 127.0.0.1 <port>` 即可查看。
+ */
+class Metrics
+{
+public:
+    enum Counter {
+        BytesIn,           ///< socket 接收字节数
+        RecvChunks,        ///< recv() 返回的数据段数
+        BytesOut,          ///< socket 发送字节数
+        FramesOut,         ///< 发送帧数
+        FramesAssembled,   ///< 组装出的完整帧
+        ResyncBytes,       ///< 帧头不匹配时丢弃的字节（重新同步）
+        DiscardedBytes,    ///< 舍弃模式下丢弃的字节
+        FramesDecoded,     ///< 解析出的帧
+        FramesHandled,     ///< 处理完毕的帧
+        ProtobufErrors,    ///< protobuf 解析失败次数
+        FramesRendered,    ///< UI 提交的画面中包含新数据的次数
+        UdpRetransmits,    ///< UDP 可靠数据报重传次数
+        UdpExpired,        ///< UDP 可靠数据报重传用尽仍未确认
+        UdpDuplicates,     ///< 收到的重复可靠数据报
+        UdpStale,          ///< 迟到而丢弃的不可靠数据报
+        UdpCollapsed,      ///< 同一批内被同流更新数据覆盖的不可靠数据报
+        UdpEmulatedDrops,  ///< 链路模拟丢弃的数据报
+        FramesSealed,      ///< 加密发出的控制帧
+        FramesOpened,      ///< 解密成功的控制帧回复
+        CipherRejects,     ///< 认证失败、未配置密钥或配置了密钥却为明文而丢弃的回复
+        HedgedFrames,      ///< 双链路模式下同时从两条链路发出的帧
+        HedgeDuplicates,   ///< 双发帧后到的回复（已丢弃）
+        LinkSwitches,      ///< 双链路模式下遥测来源链路切换次数
+        CounterCount
+    };
+
+    enum Gauge {
+        SendQueueDepth,      ///< g_dataFrameQueue
+        RawQueueDepth,       ///< g_recvRawDataFrameQueue
+        CompleteQueueDepth,  ///< g_completeDataFrameQueue
+        GaugeCount
+    };
+
+    enum Stage {
+        RecvToAssembled,
+        AssembledToDecoded,
+        DecodedToHandled,
+        HandledToRendered,
+        RecvToHandled,       ///< 端到端：接收 -> 处理完毕
+        AirToGround,         ///< 机载时间戳 -> 处理完毕（按 ClockSync 估计的时钟偏差校正）
+        StageCount
+    };
+
+    struct Snapshot {
+        double           uptimeSec = 0.0;
+        uint64_t         counters[CounterCount] = {};
+        uint64_t         gauges[GaugeCount]     = {};
+        uint64_t         gaugeMax[GaugeCount]   = {};
+        LatencyHistogram stages[StageCount];          ///< 纳秒
+    };
+
+    static void add(Counter c, uint64_t n = 1);
+    static void setGauge(Gauge g, uint64_t value);
+
+    /**
+     * @brief 记录阶段时延；startNs 为 0（上游未打时间戳）时忽略
+     */
+    static void recordStage(Stage s, uint64_t startNs, uint64_t endNs);
+
+    /**
+     * @brief steady_clock 纳秒时间戳，用于各阶段打点
+     */
+    static uint64_t nowNs();
+
+    static Snapshot    snapshot();
+    static std::string toText(const Snapshot& snap);
+
+    /**
+     * @brief 在 loop 上监听 127.0.0.1:port，每个连接返回一次文本快照（兼容 HTTP GET）
+     * @note  需在 loop 运行前或 loop 线程中调用；port 为 0 时不启动
+     */
+    static bool startEndpoint(EventLoop& loop, uint16_t port);
+    static void stopEndpoint(EventLoop& loop);
+};
@@ -0,0 +1,220 @@
+#include "PayloadCipher.h"
+
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#if defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+PayloadCipher g_payloadCipher;
+
+namespace {
+
+std::atomic<uint32_t> g_nextCipherId{1};
+
+} // namespace
+
+struct PayloadCipher::ThreadContext {
+    uint32_t        owner      = 0;
+    uint32_t        generation = 0;
+    bool            encrypt    = false;
+    EVP_CIPHER_CTX* ctx        = nullptr;
+    uint8_t         nonceBase[PayloadCipher::kNonceSize] = {};   ///< 与密钥同时取得的快照
+
+    ~ThreadContext() { EVP_CIPHER_CTX_free(ctx); }
+};
+
+PayloadCipher::PayloadCipher()
+    : m_id(g_nextCipherId.fetch_add(1, std::memory_order_relaxed))
+{
+    std::memset(m_nonceBase, 0, sizeof(m_nonceBase));
+}
+
+bool PayloadCipher::parseHexKey(const std::string& hex, std::vector<uint8_t>& key)
+{
+    if (hex.size() != 32 && hex.size() != 64) {
+        return false;
+    }
+    key.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        if (!std::isxdigit(static_cast<unsigned char>(hex[i])) ||
+            !std::isxdigit(static_cast<unsigned char>(hex[i + 1]))) {
+            return false;
+        }
+        key.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return true;
+}
+
+bool PayloadCipher::setKeyHex(const std::string& hex)
+{
+    if (hex.empty()) {
+        return setKey({});
+    }
+    std::vector<uint8_t> key;
+    if (!parseHexKey(hex, key)) {
+        std::cerr << "[PayloadCipher] Key must be 32 or 64 hex characters.\n";
+        return false;
+    }
+    return setKey(key);
+}
+
+bool PayloadCipher::setKey(const std::vector<uint8_t>& key)
+{
+    if (!key.empty() && key.size() != 16 && key.size() != 32) {
+        std::cerr << "[PayloadCipher] Unsupported key length " << key.size() << " (16 or 32 bytes).\n";
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_key = key;
+    // 换密钥时 nonce 起点也重新随机；计数不清零，旧密钥的上下文在换代前继续加密也不会重复 nonce
+    if (RAND_bytes(m_nonceBase, sizeof(m_nonceBase)) != 1) {
+        std::random_device rd;
+        for (auto& b : m_nonceBase) {
+            b = static_cast<uint8_t>(rd());
+        }
+    }
+    m_generation.fetch_add(1, std::memory_order_release);
+    m_enabled.store(!key.empty(), std::memory_order_release);
+    return true;
+}
+
+PayloadCipher::ThreadContext* PayloadCipher::context(bool encrypt)
+{
+    // 每个线程最多缓存 4 个实例的加密 / 解密上下文，超出时覆盖第一个
+    thread_local ThreadContext slots[8];
+
+    const uint32_t generation = m_generation.load(std::memory_order_acquire);
+    ThreadContext* tc         = nullptr;
+    ThreadContext* empty      = nullptr;
+    for (auto& s : slots) {
+        if (s.owner == m_id && s.encrypt == encrypt) {
+            if (s.generation == generation) {
+                return &s;
+            }
+            tc = &s;
+            break;
+        }
+        if (!empty && s.owner == 0) {
+            empty = &s;
+        }
+    }
+    if (!tc) {
+        tc = empty ? empty : &slots[0];
+    }
+    if (!tc->ctx && !(tc->ctx = EVP_CIPHER_CTX_new())) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_key.empty()) {
+        return nullptr;
+    }
+    const EVP_CIPHER* cipher = m_key.size() == 16 ? EVP_aes_128_gcm() : EVP_aes_256_gcm();
+    const int ok = encrypt ? EVP_EncryptInit_ex(tc->ctx, cipher, nullptr, m_key.data(), nullptr)
+                           : EVP_DecryptInit_ex(tc->ctx, cipher, nullptr, m_key.data(), nullptr);
+    if (ok != 1) {
+        tc->owner = 0;
+        return nullptr;
+    }
+    std::memcpy(tc->nonceBase, m_nonceBase, kNonceSize);
+    tc->owner      = m_id;
+    tc->encrypt    = encrypt;
+    tc->generation = m_generation.load(std::memory_order_relaxed);
+    return tc;
+}
+
+void PayloadCipher::nextNonce(const ThreadContext& tc, uint8_t* nonce)
+{
+    // 起点取自上下文中与密钥一起加载的快照，不读可能正被 setKey() 改写的 m_nonceBase
+    std::memcpy(nonce, tc.nonceBase, kNonceSize);
+    uint64_t carry = m_nonceCounter.fetch_add(1, std::memory_order_relaxed);
+    for (int i = static_cast<int>(kNonceSize) - 1; i >= 4 && carry; --i) {
+        carry += nonce[i];
+        nonce[i] = static_cast<uint8_t>(carry);
+        carry >>= 8;
+    }
+}
+
+bool PayloadCipher::seal(const uint8_t* aad, size_t aadLength, const uint8_t* plain, size_t length, uint8_t* sealed)
+{
+    ThreadContext* tc = enabled() ? context(true) : nullptr;
+    if (!tc) {
+        return false;
+    }
+    nextNonce(*tc, sealed);
+    uint8_t* out = sealed + kNonceSize;
+    int      n   = 0;
+    if (EVP_EncryptInit_ex(tc->ctx, nullptr, nullptr, nullptr, sealed) != 1 ||
+        (aadLength > 0 && EVP_EncryptUpdate(tc->ctx, nullptr, &n, aad, static_cast<int>(aadLength)) != 1) ||
+        (length > 0 && EVP_EncryptUpdate(tc->ctx, out, &n, plain, static_cast<int>(length)) != 1) ||
+        EVP_EncryptFinal_ex(tc->ctx, out + length, &n) != 1 ||
+        EVP_CIPHER_CTX_ctrl(tc->ctx, EVP_CTRL_GCM_GET_TAG, kTagSize, out + length) != 1) {
+        return false;
+    }
+    return true;
+}
+
+bool PayloadCipher::open(const uint8_t* aad, size_t aadLength, const uint8_t* sealed, size_t sealedLength,
+                         uint8_t* plain)
+{
+    if (sealedLength < kOverhead) {
+        return false;
+    }
+    ThreadContext* tc = enabled() ? context(false) : nullptr;
+    if (!tc) {
+        return false;
+    }
+    const size_t length = sealedLength - kOverhead;
+    uint8_t      tag[kTagSize];
+    std::memcpy(tag, sealed + kNonceSize + length, kTagSize);
+    int n = 0;
+    return EVP_DecryptInit_ex(tc->ctx, nullptr, nullptr, nullptr, sealed) == 1 &&
+           (aadLength == 0 || EVP_DecryptUpdate(tc->ctx, nullptr, &n, aad, static_cast<int>(aadLength)) == 1) &&
+           (length == 0 ||
+            EVP_DecryptUpdate(tc->ctx, plain, &n, sealed + kNonceSize, static_cast<int>(length)) == 1) &&
+           EVP_CIPHER_CTX_ctrl(tc->ctx, EVP_CTRL_GCM_SET_TAG, kTagSize, tag) == 1 &&
+           EVP_DecryptFinal_ex(tc->ctx, plain + length, &n) == 1;
+}
+
+bool PayloadCipher::peek(const uint8_t* sealed, size_t sealedLength, size_t count, uint8_t* plain)
+{
+    if (count == 0 || sealedLength < kOverhead + count) {
+        return false;
+    }
+    ThreadContext* tc = enabled() ? context(false) : nullptr;
+    if (!tc) {
+        return false;
+    }
+    // GCM 的明文只取决于密钥流，AAD 只影响 tag，这里两者都跳过；下次使用时重新设置 IV 即复位
+    int n = 0;
+    return EVP_DecryptInit_ex(tc->ctx, nullptr, nullptr, nullptr, sealed) == 1 &&
+           EVP_DecryptUpdate(tc->ctx, plain, &n, sealed + kNonceSize, static_cast<int>(count)) == 1;
+}
+
+bool PayloadCipher::accelerated()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul");
+#elif defined(__aarch64__)
+    const unsigned long caps = getauxval(AT_HWCAP);
+    return (caps & HWCAP_AES) && (caps & HWCAP_PMULL);
+#else
+    return false;
+#endif
+}
+
+std::string PayloadCipher::describe() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_key.empty()) {
+        return "disabled";
+    }
+    return std::string(m_key.size() == 16 ? "AES-128-GCM" : "AES-256-GCM") +
+           (accelerated() ? " (AES-NI + PCLMUL)" : " (software)");
+}
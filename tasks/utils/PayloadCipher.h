@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 控制帧负载的 AES-GCM 认证加密（OpenSSL EVP，客户端与模拟器共用）。
+ *
+ *        密封后的负载：nonce 12B | 密文 | tag 16B，比明文多 kOverhead 字节；
+ *        帧中不加密、但参与认证的字段（长度、SN、命令、加密标志、动作编号）作为 AAD 传入。
+ *
+ *        - EVP 在运行时按 CPU 选择实现：支持 AES-NI + PCLMULQDQ（或 VAES）时走硬件路径，
+ *          否则为纯软件实现，accelerated() 报告前者是否可用；
+ *        - 明文与密文可以是同一块内存（就地加解密），调用方按布局预留好 nonce / tag 的空间，不需要额外缓冲；
+ *        - 每个线程缓存自己的 EVP 上下文，换密钥后各线程在下一次使用时重新载入，加解密本身不加锁；
+ *        - nonce 为设置密钥时的 12 字节随机数加上实例内单调递增的计数（低 8 字节），计数换密钥也不清零，
+ *          各线程使用与密钥一同加载的起点快照，换密钥期间也不会重复。
+ */
+class PayloadCipher
+{
+public:
+    static constexpr size_t  kNonceSize = 12;
+    static constexpr size_t  kTagSize   = 16;
+    static constexpr size_t  kOverhead  = kNonceSize + kTagSize;
+    static constexpr uint8_t kFlagAesGcm = 0x01;   ///< 帧中加密标志的取值（0x00 为明文）
+
+    PayloadCipher();
+
+    /**
+     * @brief 设置密钥：16 / 32 字节对应 AES-128 / AES-256-GCM，空密钥关闭加密
+     */
+    bool setKey(const std::vector<uint8_t>& key);
+
+    /**
+     * @brief 十六进制密钥（32 或 64 个字符），空串关闭加密
+     */
+    bool setKeyHex(const std::string& hex);
+
+    static bool parseHexKey(const std::string& hex, std::vector<uint8_t>& key);
+
+    bool enabled() const { return m_enabled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 加密 plain[0, length)，结果写入 sealed（nonce | 密文 | tag，length + kOverhead 字节）。
+     *        sealed + kNonceSize == plain 时为就地加密
+     */
+    bool seal(const uint8_t* aad, size_t aadLength, const uint8_t* plain, size_t length, uint8_t* sealed);
+
+    /**
+     * @brief 校验并解密 sealed（nonce | 密文 | tag），明文（sealedLength - kOverhead 字节）写入 plain。
+     *        plain == sealed + kNonceSize 时为就地解密；认证失败返回 false，plain 内容无意义
+     */
+    bool open(const uint8_t* aad, size_t aadLength, const uint8_t* sealed, size_t sealedLength, uint8_t* plain);
+
+    /**
+     * @brief 只解出密文开头 count 字节，不校验 tag。仅用于本进程自己加密的帧（如发送时读取分包序号）
+     */
+    bool peek(const uint8_t* sealed, size_t sealedLength, size_t count, uint8_t* plain);
+
+    /**
+     * @brief CPU 是否支持 AES-NI 与 PCLMULQDQ（EVP 会自动使用）
+     */
+    static bool accelerated();
+
+    std::string describe() const;
+
+private:
+    struct ThreadContext;
+    ThreadContext* context(bool encrypt);
+    void nextNonce(const ThreadContext& tc, uint8_t* nonce);
+
+private:
+    mutable std::mutex    m_mutex;
+    std::vector<uint8_t>  m_key;
+    std::atomic<uint32_t> m_generation{0};   ///< 每次换密钥递增，线程上下文据此重新载入
+    std::atomic<bool>     m_enabled{false};
+    uint8_t               m_nonceBase[kNonceSize];   ///< m_mutex 保护，线程上下文载入密钥时一并复制
+    std::atomic<uint64_t> m_nonceCounter{0};
+    const uint32_t        m_id;              ///< 区分同一线程中的多个实例
+};
+
+extern PayloadCipher g_payloadCipher;
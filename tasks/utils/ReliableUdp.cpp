@@ -0,0 +1,244 @@
+#include "ReliableUdp.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint64_t kInitialRtoNs  = 200 * 1000000ULL;
+constexpr uint64_t kMinRtoNs      = 30 * 1000000ULL;    ///< 控制帧 ACK 立即回复，RTO 下限可远低于 TCP 的 200ms
+constexpr uint64_t kMaxRtoNs      = 2000 * 1000000ULL;
+constexpr size_t   kMaxRecvWindow = 4096;               ///< 缺口之后已收到的序号上限，超过后放弃等待最早的缺口
+
+void putBE16(std::string& out, uint16_t v)
+{
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v & 0xFF));
+}
+
+void putBE32(std::string& out, uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((v >> shift) & 0xFF));
+    }
+}
+
+uint16_t getBE16(const uint8_t* p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t getBE32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+} // namespace
+
+ReliableUdpSession::ReliableUdpSession(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    m_session = static_cast<uint16_t>(std::uniform_int_distribution<int>(1, 0xFFFF)(rng));
+}
+
+std::string ReliableUdpSession::encode(Type type, uint16_t stream, uint32_t seq, const uint8_t* data,
+                                       size_t length) const
+{
+    std::string out;
+    out.reserve(kHeaderSize + length);
+    out.push_back(static_cast<char>(kMagic));
+    out.push_back(static_cast<char>(type));
+    putBE16(out, type == Ack ? m_peerSession : m_session);   // ACK 回填被确认方的会话号
+    putBE16(out, stream);
+    putBE32(out, seq);
+    out.append(reinterpret_cast<const char*>(data), length);
+    return out;
+}
+
+std::string ReliableUdpSession::makeReliable(const uint8_t* data, size_t length, uint64_t nowNs)
+{
+    const uint32_t seq = m_nextSeq++;
+    Pending p;
+    p.datagram    = encode(Reliable, 0, seq, data, length);
+    p.firstSentNs = nowNs;
+    p.rtoNs       = m_hasRtt ? std::max(kMinRtoNs, std::min(kMaxRtoNs, static_cast<uint64_t>(
+                                   m_srttNs + std::max(4 * m_rttvarNs, 1e6))))
+                             : kInitialRtoNs;
+    p.deadlineNs  = nowNs + p.rtoNs;
+    ++m_stats.reliableSent;
+    return m_pending.emplace(seq, std::move(p)).first->second.datagram;
+}
+
+std::string ReliableUdpSession::makeUnreliable(uint16_t stream, const uint8_t* data, size_t length)
+{
+    ++m_stats.unreliableSent;
+    return encode(Unreliable, stream, ++m_txStreamSeq[stream], data, length);
+}
+
+void ReliableUdpSession::resetPeer(uint16_t session)
+{
+    if (m_hasPeer) {
+        ++m_stats.peerResets;
+    }
+    m_hasPeer     = true;
+    m_peerSession = session;
+    m_recvBase    = 1;
+    m_recvAbove.clear();
+    m_rxStreamSeq.clear();
+}
+
+ReliableUdpSession::Incoming ReliableUdpSession::onDatagram(const uint8_t* data, size_t length, uint64_t nowNs,
+                                                            std::string& ackOut)
+{
+    Incoming in;
+    if (length < kHeaderSize || data[0] != kMagic || data[1] > Ack) {
+        return in;
+    }
+    const uint8_t  type    = data[1];
+    const uint16_t session = getBE16(data + 2);
+    const uint16_t stream  = getBE16(data + 4);
+    const uint32_t seq     = getBE32(data + 6);
+
+    if (type == Ack) {
+        if (session == m_session) {
+            onAck(seq, nowNs);
+        }
+        in.kind = Kind::Ack;
+        return in;
+    }
+
+    if (!m_hasPeer || session != m_peerSession) {
+        resetPeer(session);
+    }
+    in.stream  = stream;
+    in.payload = data + kHeaderSize;
+    in.length  = length - kHeaderSize;
+
+    if (type == Reliable) {
+        ackOut = encode(Ack, 0, seq, nullptr, 0);
+        if (static_cast<int32_t>(seq - m_recvBase) < 0 || m_recvAbove.count(seq)) {
+            ++m_stats.duplicates;
+            in.kind = Kind::Duplicate;
+            return in;
+        }
+        if (seq == m_recvBase) {
+            ++m_recvBase;
+        } else {
+            m_recvAbove.insert(seq);
+            if (m_recvAbove.size() > kMaxRecvWindow) {
+                m_recvBase = *m_recvAbove.begin();
+            }
+        }
+        while (!m_recvAbove.empty() && *m_recvAbove.begin() == m_recvBase) {
+            m_recvAbove.erase(m_recvAbove.begin());
+            ++m_recvBase;
+        }
+        ++m_stats.delivered;
+        in.kind = Kind::Reliable;
+        return in;
+    }
+
+    // 不可靠：只接受比已交付更新的
+    auto it = m_rxStreamSeq.find(stream);
+    if (it != m_rxStreamSeq.end() && static_cast<int32_t>(seq - it->second) <= 0) {
+        ++m_stats.stale;
+        in.kind = Kind::Stale;
+        return in;
+    }
+    m_rxStreamSeq[stream] = seq;
+    ++m_stats.delivered;
+    in.kind = Kind::Unreliable;
+    return in;
+}
+
+void ReliableUdpSession::onAck(uint32_t seq, uint64_t nowNs)
+{
+    auto it = m_pending.find(seq);
+    if (it == m_pending.end()) {
+        return;   // 重传后先后收到两个 ACK
+    }
+    if (it->second.tries == 1 && nowNs > it->second.firstSentNs) {
+        const double r = static_cast<double>(nowNs - it->second.firstSentNs);
+        if (!m_hasRtt) {
+            m_srttNs   = r;
+            m_rttvarNs = r / 2;
+            m_hasRtt   = true;
+        } else {
+            m_rttvarNs = 0.75 * m_rttvarNs + 0.25 * std::fabs(m_srttNs - r);
+            m_srttNs   = 0.875 * m_srttNs + 0.125 * r;
+        }
+    }
+    m_pending.erase(it);
+    ++m_stats.acked;
+}
+
+void ReliableUdpSession::collectRetransmits(uint64_t nowNs, std::vector<std::string>& out)
+{
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        Pending& p = it->second;
+        if (p.deadlineNs > nowNs) {
+            ++it;
+            continue;
+        }
+        if (p.tries >= kMaxTries) {
+            ++m_stats.expired;
+            it = m_pending.erase(it);
+            continue;
+        }
+        ++p.tries;
+        ++m_stats.retransmits;
+        p.rtoNs      = std::min(p.rtoNs * 2, kMaxRtoNs);
+        p.deadlineNs = nowNs + p.rtoNs;
+        out.push_back(p.datagram);
+        ++it;
+    }
+}
+
+uint64_t ReliableUdpSession::nextDeadlineNs() const
+{
+    uint64_t next = UINT64_MAX;
+    for (const auto& kv : m_pending) {
+        next = std::min(next, kv.second.deadlineNs);
+    }
+    return next;
+}
+
+// --------------------------------------------------------------------------
+// UdpLinkEmulator
+// --------------------------------------------------------------------------
+UdpLinkEmulator::UdpLinkEmulator(const UdpLinkOptions& opts)
+    : m_opts(opts)
+    , m_rng(opts.seed)
+{
+}
+
+void UdpLinkEmulator::submit(std::string datagram, uint64_t nowNs, std::vector<std::string>& ready)
+{
+    if (m_opts.loss > 0 && std::uniform_real_distribution<double>(0, 1)(m_rng) < m_opts.loss) {
+        ++m_dropped;
+        return;
+    }
+    int delayMs = m_opts.delayMs;
+    if (m_opts.jitterMs > 0) {
+        delayMs += std::uniform_int_distribution<int>(-m_opts.jitterMs, m_opts.jitterMs)(m_rng);
+    }
+    if (delayMs <= 0) {
+        ready.push_back(std::move(datagram));
+        return;
+    }
+    m_queue.emplace(nowNs + static_cast<uint64_t>(delayMs) * 1000000ULL, std::move(datagram));
+}
+
+void UdpLinkEmulator::release(uint64_t nowNs, std::vector<std::string>& ready)
+{
+    while (!m_queue.empty() && m_queue.begin()->first <= nowNs) {
+        ready.push_back(std::move(m_queue.begin()->second));
+        m_queue.erase(m_queue.begin());
+    }
+}
+
+uint64_t UdpLinkEmulator::nextReleaseNs() const
+{
+    return m_queue.empty() ? UINT64_MAX : m_queue.begin()->first;
+}
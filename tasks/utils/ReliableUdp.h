@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief UDP 选择性可靠传输的协议状态（不含 socket），客户端 CLinuxUDPCom 与模拟器共用。
+ *
+ *        每个数据报承载一个完整帧，前面加 10 字节头：
+ *            0xD5 | 类型 | 会话号 BE16 | 数据流号 BE16 | 序号 BE32
+ *
+ *        - 可靠（类型 1）：控制帧及其应答。接收方逐个回 ACK（类型 2，会话号填被确认方的会话号），
+ *          按序号去重后立即交付（不保证顺序）；发送方未收到 ACK 时按 RTO 重传（RFC 6298 估计 RTT，
+ *          指数退避，最多 kMaxTries 次后放弃）；
+ *        - 不可靠（类型 0）：遥测等周期数据。每条数据流（发送方自定，如“飞机 × 命令”）独立编号，
+ *          接收方只接受比该流已交付序号更新的数据报（latest-wins），迟到 / 重复的直接丢弃；
+ *        - 会话号在建立会话时随机生成，对端重启（会话号变化）时接收状态随之重置。
+ *
+ *        非线程安全，由调用方加锁。
+ */
+class ReliableUdpSession
+{
+public:
+    static constexpr size_t  kHeaderSize = 10;
+    static constexpr uint8_t kMagic      = 0xD5;
+    static constexpr int     kMaxTries   = 10;
+
+    enum Type : uint8_t { Unreliable = 0, Reliable = 1, Ack = 2 };
+
+    enum class Kind {
+        Invalid,      ///< 不是本协议的数据报
+        Reliable,     ///< 新的可靠数据，需交付（ackOut 已填）
+        Unreliable,   ///< 新的不可靠数据，需交付
+        Ack,          ///< 确认，已处理
+        Duplicate,    ///< 重复的可靠数据（仍需回 ACK，ackOut 已填）
+        Stale         ///< 过时的不可靠数据
+    };
+
+    struct Incoming {
+        Kind           kind    = Kind::Invalid;
+        uint16_t       stream  = 0;
+        const uint8_t* payload = nullptr;
+        size_t         length  = 0;
+    };
+
+    struct Stats {
+        uint64_t reliableSent   = 0;
+        uint64_t retransmits    = 0;
+        uint64_t acked          = 0;
+        uint64_t expired        = 0;   ///< 重传次数用尽仍未确认
+        uint64_t unreliableSent = 0;
+        uint64_t delivered      = 0;
+        uint64_t duplicates     = 0;
+        uint64_t stale          = 0;
+        uint64_t peerResets     = 0;
+    };
+
+    explicit ReliableUdpSession(uint32_t seed);
+
+    /**
+     * @brief 封装一个可靠数据报并登记待确认
+     */
+    std::string makeReliable(const uint8_t* data, size_t length, uint64_t nowNs);
+
+    /**
+     * @brief 封装一个不可靠数据报，stream 不能为 0
+     */
+    std::string makeUnreliable(uint16_t stream, const uint8_t* data, size_t length);
+
+    /**
+     * @brief 处理收到的数据报；返回 Reliable / Duplicate 时 ackOut 为应回的 ACK
+     */
+    Incoming onDatagram(const uint8_t* data, size_t length, uint64_t nowNs, std::string& ackOut);
+
+    /**
+     * @brief 取出到期需要重传的数据报（同时推进其重传时刻）
+     */
+    void collectRetransmits(uint64_t nowNs, std::vector<std::string>& out);
+
+    /**
+     * @brief 最早的重传时刻，没有待确认数据时返回 UINT64_MAX
+     */
+    uint64_t nextDeadlineNs() const;
+
+    size_t       inflight() const { return m_pending.size(); }
+    double       srttMs() const { return m_srttNs / 1e6; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Pending {
+        std::string datagram;
+        uint64_t    firstSentNs = 0;
+        uint64_t    deadlineNs  = 0;
+        uint64_t    rtoNs       = 0;
+        int         tries       = 1;
+    };
+
+    std::string encode(Type type, uint16_t stream, uint32_t seq, const uint8_t* data, size_t length) const;
+    void        onAck(uint32_t seq, uint64_t nowNs);
+    void        resetPeer(uint16_t session);
+
+private:
+    uint16_t m_session;
+    uint32_t m_nextSeq = 1;
+    std::map<uint32_t, Pending> m_pending;
+    std::unordered_map<uint16_t, uint32_t> m_txStreamSeq;
+
+    // RTT 估计（RFC 6298），只用未重传过的数据报采样
+    double m_srttNs   = 0;
+    double m_rttvarNs = 0;
+    bool   m_hasRtt   = false;
+
+    bool     m_hasPeer     = false;
+    uint16_t m_peerSession = 0;
+    uint32_t m_recvBase    = 1;                 ///< 小于它的可靠序号都已收到
+    std::set<uint32_t> m_recvAbove;             ///< 已收到的、大于 m_recvBase 的可靠序号
+    std::unordered_map<uint16_t, uint32_t> m_rxStreamSeq;   ///< 各不可靠数据流已交付的最新序号
+
+    Stats m_stats;
+};
+
+/**
+ * @brief 链路模拟参数
+ */
+struct UdpLinkOptions {
+    double   loss     = 0.0;   ///< 丢包率 0~1
+    int      delayMs  = 0;
+    int      jitterMs = 0;     ///< 在 delayMs 基础上 ± 均匀抖动
+    uint32_t seed     = 1;
+};
+
+/**
+ * @brief 本地链路模拟：按概率丢弃数据报，并附加固定时延 + 均匀抖动（抖动大于发送间隔时会乱序）。
+ *        用于在本机复现蜂窝链路的丢包与乱序，收发两个方向各用一个实例。非线程安全。
+ */
+class UdpLinkEmulator
+{
+public:
+    explicit UdpLinkEmulator(const UdpLinkOptions& opts = UdpLinkOptions());
+
+    bool enabled() const { return m_opts.loss > 0 || m_opts.delayMs > 0 || m_opts.jitterMs > 0; }
+
+    /**
+     * @brief 数据报进入模拟链路：被丢弃，或放入延时队列，或（无时延时）直接追加到 ready
+     */
+    void submit(std::string datagram, uint64_t nowNs, std::vector<std::string>& ready);
+
+    /**
+     * @brief 取出已到达的数据报
+     */
+    void release(uint64_t nowNs, std::vector<std::string>& ready);
+
+    /**
+     * @brief 队列中最早的到达时刻，队列为空时返回 UINT64_MAX
+     */
+    uint64_t nextReleaseNs() const;
+
+    void     clear() { m_queue.clear(); }
+    uint64_t dropped() const { return m_dropped; }
+
+private:
+    UdpLinkOptions m_opts;
+    std::mt19937 m_rng;
+    std::multimap<uint64_t, std::string> m_queue;   ///< 到达时刻 -> 数据报
+    uint64_t     m_dropped = 0;
+};
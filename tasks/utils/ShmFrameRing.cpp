@@ -0,0 +1,296 @@
+#include "ShmFrameRing.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kHeaderSize = sizeof(ShmFrameRing::EntryHeader);
+constexpr uint64_t kMinCapacity = 64 * 1024;
+
+inline uint64_t align8(uint64_t n)
+{
+    return (n + 7) & ~uint64_t(7);
+}
+
+} // namespace
+
+static_assert(sizeof(ShmFrameRing::EntryHeader) == 24, "entry header layout changed");
+
+size_t ShmFrameRing::mappedSize(size_t capacity)
+{
+    return sizeof(Header) + capacity;
+}
+
+uint64_t ShmFrameRing::monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// --------------------------------------------------------------------------
+// 写者
+// --------------------------------------------------------------------------
+ShmFrameWriter::~ShmFrameWriter()
+{
+    close();
+}
+
+bool ShmFrameWriter::create(const std::string& name, size_t capacity)
+{
+    close();
+    uint64_t cap = kMinCapacity;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "[ShmFrameWriter] shm_open " << name << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    const size_t size = ShmFrameRing::mappedSize(cap);
+    if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        std::cerr << "[ShmFrameWriter] ftruncate failed: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[ShmFrameWriter] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    m_header   = static_cast<ShmFrameRing::Header*>(p);
+    m_data     = static_cast<uint8_t*>(p) + sizeof(ShmFrameRing::Header);
+    m_capacity = cap;
+    m_head     = 0;
+    m_seq      = 0;
+    m_name     = name;
+
+    // 与 ShmStateTable 相同：先作废魔数，初始化完成后最后写入
+    m_header->magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->version         = ShmFrameRing::kVersion;
+    m_header->entryHeaderSize = static_cast<uint16_t>(kHeaderSize);
+    m_header->capacity        = cap;
+    m_header->writerPid       = static_cast<uint64_t>(::getpid());
+    m_header->reserved.store(0, std::memory_order_relaxed);
+    m_header->published.store(0, std::memory_order_relaxed);
+    m_header->frames.store(0, std::memory_order_relaxed);
+    m_header->magic.store(ShmFrameRing::kMagic, std::memory_order_release);
+
+    std::cout << "[ShmFrameWriter] Publishing frame stream at /dev/shm" << name << " (" << cap / 1024 << " KB)\n";
+    return true;
+}
+
+void ShmFrameWriter::close()
+{
+    if (!m_header) {
+        return;
+    }
+    ::munmap(m_header, ShmFrameRing::mappedSize(m_capacity));
+    ::shm_unlink(m_name.c_str());
+    m_header = nullptr;
+    m_data   = nullptr;
+}
+
+bool ShmFrameWriter::publish(uint8_t cmdId, const uint8_t* data, uint32_t length, uint64_t timestampNs)
+{
+    if (!m_header || length > m_capacity / 4) {
+        return false;
+    }
+    const uint64_t size = align8(kHeaderSize + length);
+    const uint64_t pos  = m_head & (m_capacity - 1);
+    const uint64_t pad  = (m_capacity - pos < size) ? m_capacity - pos : 0;
+    const uint64_t next = m_head + pad + size;
+
+    // 先公布将被覆盖的范围，再写数据：读者读完后看到 reserved 越过自己的位置即知数据可能已被改写
+    m_header->reserved.store(next, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (pad >= kHeaderSize) {
+        ShmFrameRing::EntryHeader padding{};
+        padding.length = static_cast<uint32_t>(pad - kHeaderSize);
+        padding.flags  = ShmFrameRing::kFlagPadding;
+        std::memcpy(m_data + pos, &padding, kHeaderSize);
+    }
+
+    ShmFrameRing::EntryHeader hdr{};
+    hdr.length      = length;
+    hdr.cmdId       = cmdId;
+    hdr.seq         = m_seq++;
+    hdr.timestampNs = timestampNs;
+    uint8_t* dst = m_data + ((m_head + pad) & (m_capacity - 1));
+    std::memcpy(dst, &hdr, kHeaderSize);
+    if (length) {
+        std::memcpy(dst + kHeaderSize, data, length);
+    }
+
+    m_head = next;
+    m_header->frames.store(m_seq, std::memory_order_relaxed);
+    m_header->published.store(next, std::memory_order_release);
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// 读者
+// --------------------------------------------------------------------------
+ShmFrameReader::~ShmFrameReader()
+{
+    close();
+}
+
+bool ShmFrameReader::open(const std::string& name, bool fromStart)
+{
+    close();
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "[ShmFrameReader] shm_open " << name << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(ShmFrameRing::Header) + kMinCapacity) {
+        std::cerr << "[ShmFrameReader] " << name << " is too small or not initialized.\n";
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[ShmFrameReader] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    const auto* header = static_cast<const ShmFrameRing::Header*>(p);
+    const uint64_t cap = header->capacity;
+    if (header->magic.load(std::memory_order_acquire) != ShmFrameRing::kMagic
+        || header->version != ShmFrameRing::kVersion || header->entryHeaderSize != kHeaderSize
+        || (cap & (cap - 1)) != 0 || ShmFrameRing::mappedSize(cap) != size) {
+        std::cerr << "[ShmFrameReader] " << name << " has an incompatible layout.\n";
+        ::munmap(p, size);
+        return false;
+    }
+
+    m_header   = header;
+    m_data     = static_cast<const uint8_t*>(p) + sizeof(ShmFrameRing::Header);
+    m_capacity = cap;
+    m_mapped   = size;
+    m_lost     = 0;
+    m_overruns = 0;
+    m_expected = UINT64_MAX;   // 以读到的第一帧为起点
+
+    // 只有写入位置才是条目边界：环还没写满一圈时可以从头读，否则从最新位置开始
+    const uint64_t published = m_header->published.load(std::memory_order_acquire);
+    m_cursor = (fromStart && published <= m_capacity) ? 0 : published;
+    return true;
+}
+
+void ShmFrameReader::close()
+{
+    if (!m_header) {
+        return;
+    }
+    ::munmap(const_cast<ShmFrameRing::Header*>(m_header), m_mapped);
+    m_header = nullptr;
+    m_data   = nullptr;
+}
+
+uint64_t ShmFrameReader::lag() const
+{
+    return m_header ? m_header->published.load(std::memory_order_acquire) - m_cursor : 0;
+}
+
+bool ShmFrameReader::stillValid() const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_header->reserved.load(std::memory_order_relaxed) - m_cursor <= m_capacity;
+}
+
+void ShmFrameReader::resync()
+{
+    // 落后超过一圈：跳到最新位置，丢失的帧数在下一帧到达时按序号差计入
+    ++m_overruns;
+    m_cursor = m_header->published.load(std::memory_order_acquire);
+}
+
+ShmFrameReader::Status ShmFrameReader::peek(ShmFrameRing::FrameView& view)
+{
+    if (!m_header) {
+        return Status::Empty;
+    }
+    while (true) {
+        const uint64_t published = m_header->published.load(std::memory_order_acquire);
+        if (m_cursor == published) {
+            return Status::Empty;
+        }
+        if (published - m_cursor > m_capacity) {
+            resync();
+            return Status::Overrun;
+        }
+
+        const uint64_t pos  = m_cursor & (m_capacity - 1);
+        const uint64_t tail = m_capacity - pos;
+        if (tail < kHeaderSize) {
+            m_cursor += tail;   // 尾部放不下条目头，写者直接回绕
+            continue;
+        }
+        ShmFrameRing::EntryHeader hdr;
+        std::memcpy(&hdr, m_data + pos, kHeaderSize);
+        if (!stillValid() || kHeaderSize + hdr.length > tail) {
+            resync();
+            return Status::Overrun;
+        }
+        if (hdr.flags & ShmFrameRing::kFlagPadding) {
+            m_cursor += tail;
+            continue;
+        }
+
+        view.cmdId       = hdr.cmdId;
+        view.seq         = hdr.seq;
+        view.timestampNs = hdr.timestampNs;
+        view.data        = m_data + pos + kHeaderSize;
+        view.length      = hdr.length;
+        m_next           = m_cursor + align8(kHeaderSize + hdr.length);
+        m_peekedSeq      = hdr.seq;
+        return Status::Ok;
+    }
+}
+
+bool ShmFrameReader::commit()
+{
+    if (!stillValid()) {
+        resync();
+        return false;
+    }
+    // 序号直接从共享内存重新读取会有竞争，这里用 peek 时已校验过的条目头中的序号
+    if (m_expected != UINT64_MAX && m_peekedSeq > m_expected) {
+        m_lost += m_peekedSeq - m_expected;
+    }
+    m_expected = m_peekedSeq + 1;
+    m_cursor   = m_next;
+    return true;
+}
+
+ShmFrameReader::Status ShmFrameReader::read(ShmFrameRing::FrameView& out, uint8_t* buf, size_t bufSize)
+{
+    const Status st = peek(out);
+    if (st != Status::Ok) {
+        return st;
+    }
+    std::memcpy(buf, out.data, out.length < bufSize ? out.length : bufSize);
+    if (!commit()) {
+        return Status::Overrun;
+    }
+    out.data = buf;
+    return Status::Ok;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 共享内存帧流环：本程序把解析出的每一帧 (cmdId, 时间戳, 负载) 依次写入，
+ *        本机任意多个进程各自持有游标读取，互不影响。
+ *
+ *        - 单写者，从不等待读者：环满后直接覆盖最旧的数据；
+ *        - 读者各自维护游标（只在自己进程内），不向共享内存写任何东西，读者数量不受限制；
+ *        - 每帧带递增序号，读者据此统计丢失的帧；被覆盖时（读者落后超过一圈）报告 Overrun，
+ *          并跳到最新位置继续；
+ *        - 写入时先推进 reserved（将被覆盖的范围），写完再推进 published；读者读完后检查 reserved，
+ *          确认读到的字节在读取期间没有被覆盖；
+ *        - 读取可以零拷贝：poll() 直接把共享内存中的负载指针交给回调，回调返回后再校验，
+ *          若校验失败则该帧计为丢失（回调应把结果视为不可信）；需要先校验再使用时用 read() 拷贝。
+ *
+ *        条目布局（8 字节对齐，不跨越环尾；尾部空间不足时写填充条目或直接回绕）：
+ *            [u32 负载长度][u8 cmdId][u8 标志][u16 保留][u64 序号][u64 时间戳 ns] [负载...]
+ *
+ *        其他进程只需本头文件与 ShmFrameRing.cpp。
+ */
+class ShmFrameRing
+{
+public:
+    static constexpr uint32_t kMagic   = 0x46524D53;   ///< "FRMS"
+    static constexpr uint16_t kVersion = 1;
+
+    struct alignas(64) Header {
+        std::atomic<uint32_t> magic;
+        uint16_t              version;
+        uint16_t              entryHeaderSize;
+        uint64_t              capacity;             ///< 数据区字节数（2 的幂）
+        uint64_t              writerPid;
+        alignas(64) std::atomic<uint64_t> reserved;    ///< 写者即将写到的位置（累计字节）
+        alignas(64) std::atomic<uint64_t> published;   ///< 已完整写入的位置（累计字节）
+        std::atomic<uint64_t>             frames;      ///< 已发布的帧数（即下一帧序号）
+    };
+
+    struct EntryHeader {
+        uint32_t length;
+        uint8_t  cmdId;
+        uint8_t  flags;      ///< kFlagPadding 表示环尾填充
+        uint16_t reserved;
+        uint64_t seq;
+        uint64_t timestampNs;
+    };
+    static constexpr uint8_t kFlagPadding = 0x01;
+
+    /**
+     * @brief 读者看到的一帧；data 指向共享内存（poll）或调用方缓冲（read）
+     */
+    struct FrameView {
+        uint8_t        cmdId       = 0;
+        uint64_t       seq         = 0;
+        uint64_t       timestampNs = 0;   ///< CLOCK_MONOTONIC
+        const uint8_t* data        = nullptr;
+        uint32_t       length      = 0;
+    };
+
+    static size_t mappedSize(size_t capacity);
+    static uint64_t monotonicNs();
+};
+
+/**
+ * @brief 写者（本程序解析线程）
+ */
+class ShmFrameWriter
+{
+public:
+    ShmFrameWriter() = default;
+    ~ShmFrameWriter();
+
+    ShmFrameWriter(const ShmFrameWriter&) = delete;
+    ShmFrameWriter& operator=(const ShmFrameWriter&) = delete;
+
+    /**
+     * @brief 创建（或重建）共享内存；capacity 向上取整为 2 的幂，至少 64 KB
+     */
+    bool create(const std::string& name, size_t capacity);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    /**
+     * @brief 发布一帧，负载超过容量 1/4 时拒绝
+     */
+    bool publish(uint8_t cmdId, const uint8_t* data, uint32_t length, uint64_t timestampNs);
+
+private:
+    ShmFrameRing::Header* m_header   = nullptr;
+    uint8_t*              m_data     = nullptr;
+    uint64_t              m_capacity = 0;
+    uint64_t              m_head     = 0;   ///< 本地写位置
+    uint64_t              m_seq      = 0;
+    std::string           m_name;
+};
+
+/**
+ * @brief 读者（可在任意进程中使用）
+ */
+class ShmFrameReader
+{
+public:
+    enum class Status { Ok, Empty, Overrun };
+
+    ShmFrameReader() = default;
+    ~ShmFrameReader();
+
+    ShmFrameReader(const ShmFrameReader&) = delete;
+    ShmFrameReader& operator=(const ShmFrameReader&) = delete;
+
+    /**
+     * @brief 只读映射；fromStart 为 false 时从当前最新位置开始读
+     */
+    bool open(const std::string& name, bool fromStart = false);
+    void close();
+
+    /**
+     * @brief 零拷贝读取：对每个可读帧调用 fn(const FrameView&)，最多 maxFrames 帧
+     * @return 成功交付且校验通过的帧数
+     */
+    template <typename Fn>
+    size_t poll(Fn&& fn, size_t maxFrames = SIZE_MAX)
+    {
+        size_t n = 0;
+        ShmFrameRing::FrameView view;
+        while (n < maxFrames) {
+            const Status st = peek(view);
+            if (st == Status::Empty) {
+                break;
+            }
+            if (st == Status::Overrun) {
+                continue;
+            }
+            fn(static_cast<const ShmFrameRing::FrameView&>(view));
+            if (commit()) {
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * @brief 拷贝读取：校验通过后才返回 Ok，out.data 指向 buf
+     * @param buf     调用方缓冲，长度不足时负载被截断（length 仍为原长度）
+     */
+    Status read(ShmFrameRing::FrameView& out, uint8_t* buf, size_t bufSize);
+
+    uint64_t lostFrames() const { return m_lost; }
+    uint64_t overruns() const { return m_overruns; }
+
+    /**
+     * @brief 写者领先本读者的字节数（积压）
+     */
+    uint64_t lag() const;
+
+private:
+    Status peek(ShmFrameRing::FrameView& view);
+    bool   commit();
+    bool   stillValid() const;
+    void   resync();
+
+private:
+    const ShmFrameRing::Header* m_header   = nullptr;
+    const uint8_t*              m_data     = nullptr;
+    uint64_t                    m_capacity = 0;
+    size_t                      m_mapped   = 0;
+    uint64_t                    m_cursor   = 0;
+    uint64_t                    m_next     = 0;   ///< peek 后的下一条位置
+    uint64_t                    m_peekedSeq = 0;  ///< peek 时已校验的条目头中的帧序号，commit 据此统计丢帧
+    uint64_t                    m_expected = 0;   ///< 期望的下一帧序号
+    uint64_t                    m_lost     = 0;
+    uint64_t                    m_overruns = 0;
+};
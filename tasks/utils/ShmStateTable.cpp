@@ -0,0 +1,185 @@
+#include "ShmStateTable.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+size_t ShmStateTable::mappedSize()
+{
+    return sizeof(Header) + sizeof(Slot) * kCapacity;
+}
+
+ShmStateTable::~ShmStateTable()
+{
+    close();
+}
+
+bool ShmStateTable::create(const std::string& name)
+{
+    close();
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "[ShmStateTable] shm_open " << name << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    const size_t size = mappedSize();
+    if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        std::cerr << "[ShmStateTable] ftruncate failed: " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[ShmStateTable] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    m_header = static_cast<Header*>(p);
+    m_slots  = reinterpret_cast<Slot*>(static_cast<char*>(p) + sizeof(Header));
+    m_owner  = true;
+    m_name   = name;
+
+    // 先作废魔数，读者在重建期间会认为表不可用；清空后最后写入魔数
+    m_header->magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memset(static_cast<char*>(p) + sizeof(std::atomic<uint32_t>), 0, size - sizeof(std::atomic<uint32_t>));
+    m_header->version    = kVersion;
+    m_header->recordSize = static_cast<uint16_t>(sizeof(VehicleState));
+    m_header->capacity   = kCapacity;
+    m_header->writerPid  = static_cast<uint64_t>(::getpid());
+    m_header->magic.store(kMagic, std::memory_order_release);
+
+    std::cout << "[ShmStateTable] Publishing vehicle state at /dev/shm" << name << " (" << size << " bytes)\n";
+    return true;
+}
+
+bool ShmStateTable::open(const std::string& name)
+{
+    close();
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "[ShmStateTable] shm_open " << name << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < mappedSize()) {
+        std::cerr << "[ShmStateTable] " << name << " is too small or not initialized.\n";
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, mappedSize(), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[ShmStateTable] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    Header* header = static_cast<Header*>(p);
+    if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion
+        || header->recordSize != sizeof(VehicleState) || header->capacity != kCapacity) {
+        std::cerr << "[ShmStateTable] " << name << " has an incompatible layout.\n";
+        ::munmap(p, mappedSize());
+        return false;
+    }
+
+    m_header = header;
+    m_slots  = reinterpret_cast<Slot*>(static_cast<char*>(p) + sizeof(Header));
+    m_owner  = false;
+    m_name   = name;
+    return true;
+}
+
+void ShmStateTable::close()
+{
+    if (!m_header) {
+        return;
+    }
+    ::munmap(m_header, mappedSize());
+    if (m_owner) {
+        ::shm_unlink(m_name.c_str());
+    }
+    m_header = nullptr;
+    m_slots  = nullptr;
+    m_owner  = false;
+}
+
+int ShmStateTable::findOrAdd(const char* boxSn)
+{
+    const int idx = find(boxSn);
+    if (idx >= 0) {
+        return idx;
+    }
+    const uint32_t n = m_header->count.load(std::memory_order_relaxed);
+    if (n >= kCapacity) {
+        return -1;
+    }
+    // 键写好后再增加 count，读者看到的新记录一定带有 boxSn
+    Slot& slot = m_slots[n];
+    slot.seq.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::strncpy(slot.state.boxSn, boxSn, sizeof(slot.state.boxSn) - 1);
+    slot.seq.store(2, std::memory_order_release);
+    m_header->count.store(n + 1, std::memory_order_release);
+    return static_cast<int>(n);
+}
+
+void ShmStateTable::write(int index, const VehicleState& state)
+{
+    Slot& slot = m_slots[index];
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.state, &state, sizeof(VehicleState));
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+uint32_t ShmStateTable::count() const
+{
+    if (!m_header) {
+        return 0;
+    }
+    const uint32_t n = m_header->count.load(std::memory_order_acquire);
+    return n < kCapacity ? n : kCapacity;
+}
+
+int ShmStateTable::find(const char* boxSn) const
+{
+    const uint32_t n = count();
+    for (uint32_t i = 0; i < n; ++i) {
+        // boxSn 在记录分配后不再改变，可直接比较
+        if (std::strncmp(m_slots[i].state.boxSn, boxSn, sizeof(VehicleState::boxSn) - 1) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool ShmStateTable::tryRead(int index, VehicleState& out) const
+{
+    if (index < 0 || static_cast<uint32_t>(index) >= count()) {
+        return false;
+    }
+    const Slot& slot = m_slots[index];
+    const uint32_t before = slot.seq.load(std::memory_order_acquire);
+    if (before & 1u) {
+        return false;
+    }
+    std::memcpy(&out, &slot.state, sizeof(VehicleState));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == before;
+}
+
+bool ShmStateTable::read(int index, VehicleState& out, int maxTries) const
+{
+    for (int i = 0; i < maxTries; ++i) {
+        if (tryRead(index, out)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 共享内存中的最新状态表：每架飞机一条定长记录，由本程序写入，本机其他进程（视频叠加、
+ *        任务规划、记录器等）直接映射后读取。
+ *
+ *        - 布局固定（仅含 POD 字段，不依赖 protobuf），其他工具只需本头文件与 ShmStateTable.cpp；
+ *        - 每条记录由序号锁（seqlock）保护：写入前序号加 1（奇数表示正在写），写完再加 1；
+ *          读者拷贝前后各读一次序号，两次相等且为偶数即为一致快照；
+ *        - 单写者（解析线程），读者不写共享内存、不加锁、不进系统调用，任意频率轮询；
+ *          tryRead() 只尝试一次，是无等待的；read() 在与写入冲突时有限次重试。
+ *
+ *        读者示例：
+ *            ShmStateTable table;
+ *            if (table.open("/dji_cli_state")) {
+ *                VehicleState s;
+ *                if (table.read(0, s)) { ... s.lat, s.lng, s.yaw ... }
+ *            }
+ */
+
+/**
+ * @brief 单架飞机的最新状态（来自 0xA9 TelemetryData 与 0xA8 UavState）
+ */
+struct VehicleState {
+    char     boxSn[32];            ///< 云盒编号（记录的键）
+    char     uavSn[32];
+    char     uavModel[32];
+
+    uint64_t telemetryTimestamp;   ///< TelemetryData.timestamp（设备时间）
+    uint64_t uavStateTimestamp;    ///< UavState.timestamp（设备时间）
+    uint64_t updatedNs;            ///< 本机写入时刻，CLOCK_MONOTONIC 纳秒，可跨进程比较
+    uint32_t updateCount;          ///< 累计写入次数
+    uint32_t reserved0;
+
+    // 位置
+    double   lat;
+    double   lng;
+    float    altitude;             ///< 椭球高（米）
+    float    ultrasonic;           ///< 相对高度（米）
+    double   rtkLat;
+    double   rtkLng;
+    float    rtkHFSL;
+    uint32_t rtkPositionInfo;      ///< 50 为固定解
+    float    homeRange;            ///< 距降落点水平距离（米）
+    uint32_t satelliteCount;
+    uint32_t gpsSignalLevel;
+
+    // 姿态与速度
+    float    pitch;
+    float    roll;
+    float    yaw;
+    float    velocity;             ///< 地速（米/秒）
+    float    airspeed;
+    float    xVelocity;
+    float    yVelocity;
+    float    zVelocity;
+
+    // 云台 / 相机
+    float    ptPitch;
+    float    ptRoll;
+    float    ptYaw;
+    float    zoomFactor;
+
+    // 飞行状态
+    uint32_t flightMode;           ///< 含义见 TelemetryData.flightMode
+    uint32_t flightStatus;         ///< 0=地面未启动，1=地面已启动，2=空中
+    uint32_t airFlyTimes;          ///< 本架次飞行时长（秒）
+    uint32_t predictFlyTimes;      ///< 预计剩余飞行时间（秒）
+
+    // 电池（最多两块）
+    uint32_t batteryNum;
+    uint32_t batteryPercent[2];
+    int32_t  batteryVoltageMv[2];
+    float    batteryTemperature[2];
+    uint32_t predictGohomeBattery; ///< 预计返航所需最小电量百分比
+};
+
+class ShmStateTable
+{
+public:
+    static constexpr uint32_t kMagic    = 0x53544154;   ///< "STAT"
+    static constexpr uint16_t kVersion  = 1;
+    static constexpr uint32_t kCapacity = 16;           ///< 最多记录的飞机数
+
+    struct alignas(64) Header {
+        std::atomic<uint32_t> magic;        ///< 初始化完成后最后写入
+        uint16_t              version;
+        uint16_t              recordSize;   ///< sizeof(VehicleState)，读者用于校验布局
+        uint32_t              capacity;
+        std::atomic<uint32_t> count;        ///< 已占用的记录数，只增不减
+        uint64_t              writerPid;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq;
+        uint32_t              reserved;
+        VehicleState          state;
+    };
+
+    ShmStateTable() = default;
+    ~ShmStateTable();
+
+    ShmStateTable(const ShmStateTable&) = delete;
+    ShmStateTable& operator=(const ShmStateTable&) = delete;
+
+    /**
+     * @brief 写者：创建（或重建）共享内存并清空
+     */
+    bool create(const std::string& name);
+
+    /**
+     * @brief 读者：只读映射已存在的共享内存，并校验魔数 / 版本 / 记录大小
+     */
+    bool open(const std::string& name);
+
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    /**
+     * @brief 写者：按 boxSn 查找记录，不存在则分配，表满返回 -1
+     */
+    int findOrAdd(const char* boxSn);
+
+    /**
+     * @brief 写者：发布一条完整记录
+     */
+    void write(int index, const VehicleState& state);
+
+    /**
+     * @brief 读者：当前记录数
+     */
+    uint32_t count() const;
+
+    /**
+     * @brief 读者：按 boxSn 查找，未找到返回 -1
+     */
+    int find(const char* boxSn) const;
+
+    /**
+     * @brief 读者：尝试一次读取，与写入冲突时返回 false（无等待）
+     */
+    bool tryRead(int index, VehicleState& out) const;
+
+    /**
+     * @brief 读者：读取一致快照，冲突时最多重试 maxTries 次
+     */
+    bool read(int index, VehicleState& out, int maxTries = 64) const;
+
+    static size_t mappedSize();
+
+private:
+    Header*     m_header   = nullptr;
+    Slot*       m_slots    = nullptr;
+    bool        m_owner    = false;
+    std::string m_name;
+};
@@ -0,0 +1,54 @@
+#include "StopToken.h"
+#include <thread>
+
+bool StopToken::sleepFor(std::chrono::milliseconds duration) const
+{
+    if (!m_state) {
+        std::this_thread::sleep_for(duration);
+        return true;
+    }
+    std::unique_lock<std::mutex> lk(m_state->mutex);
+    return !m_state->cond.wait_for(lk, duration, [this] { return stopRequested(); });
+}
+
+StopSource::StopSource()
+    : m_state(std::make_shared<StopToken::State>())
+{
+}
+
+bool StopSource::requestStop()
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lk(m_state->mutex);
+        if (m_state->stopped.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        callbacks.swap(m_state->callbacks);
+    }
+    m_state->cond.notify_all();
+    for (auto& cb : callbacks) {
+        cb();
+    }
+    return true;
+}
+
+void StopSource::onStop(std::function<void()> cb)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_state->mutex);
+        if (!m_state->stopped.load(std::memory_order_acquire)) {
+            m_state->callbacks.push_back(std::move(cb));
+            return;
+        }
+    }
+    cb();
+}
+
+void StopSource::notifyAll(std::mutex& mutex, std::condition_variable& cv)
+{
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+    }
+    cv.notify_all();
+}
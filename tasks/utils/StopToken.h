@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 协作式停止（C++17 下 std::stop_token 的简化替代）。
+ *
+ *        - StopSource 由线程的管理方持有，requestStop() 只做一次：置位后依次执行 onStop() 注册的回调
+ *          （唤醒条件变量、shutdown socket 等），让各线程所有阻塞点都能立即返回；
+ *        - StopToken 按值传给线程函数，循环条件与条件变量的谓词都检查 stopRequested()；
+ *          需要休眠的地方用 sleepFor()，停止时立即返回；
+ *        - 每次启动使用新的 StopSource，旧线程持有的 token 仍指向已停止的状态，不会被“复活”。
+ */
+class StopToken
+{
+public:
+    StopToken() = default;
+
+    bool stopRequested() const { return m_state && m_state->stopped.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 可中断休眠
+     * @return 休眠满时长返回 true，期间被请求停止返回 false
+     */
+    bool sleepFor(std::chrono::milliseconds duration) const;
+
+    /**
+     * @brief 可中断的条件变量等待：pred 成立或被请求停止时返回
+     * @note 停止时的唤醒依赖 StopSource::onStop() 中注册了对应 cv 的 notifyAll()
+     * @return pred() 的最终结果
+     */
+    template <typename Pred>
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, Pred pred) const
+    {
+        cv.wait(lock, [&] { return pred() || stopRequested(); });
+        return pred();
+    }
+
+private:
+    friend class StopSource;
+
+    struct State {
+        std::atomic<bool>                  stopped{false};
+        std::mutex                         mutex;
+        std::condition_variable            cond;        ///< sleepFor() 使用
+        std::vector<std::function<void()>> callbacks;
+    };
+
+    explicit StopToken(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+    std::shared_ptr<State> m_state;
+};
+
+class StopSource
+{
+public:
+    StopSource();
+
+    StopToken token() const { return StopToken(m_state); }
+
+    bool stopRequested() const { return m_state->stopped.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 请求停止并执行已注册的回调（在调用线程中执行）
+     * @return 首次调用返回 true
+     */
+    bool requestStop();
+
+    /**
+     * @brief 注册停止回调；已停止时立即执行
+     */
+    void onStop(std::function<void()> cb);
+
+    /**
+     * @brief 在 mutex 保护下唤醒 cv 的全部等待者（避免等待方检查谓词后、入睡前错过通知）
+     */
+    static void notifyAll(std::mutex& mutex, std::condition_variable& cv);
+
+private:
+    std::shared_ptr<StopToken::State> m_state;
+};
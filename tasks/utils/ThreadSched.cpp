@@ -0,0 +1,261 @@
+#include "ThreadSched.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "LatencyHistogram.h"
+
+namespace {
+
+constexpr long kProbePeriodNs = 1000000;   ///< 探测线程唤醒周期 1ms
+
+struct Entry {
+    std::string      name;
+    pid_t            tid = 0;
+    ThreadPolicy     policy;
+    std::string      note;       ///< 降级说明
+    LatencyHistogram jitterUs;   ///< 最近一次探测结果
+};
+
+std::mutex         g_mutex;
+std::vector<Entry> g_entries;
+
+pid_t currentTid()
+{
+    return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+std::string cpuListText(const cpu_set_t& set)
+{
+    std::string out;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            out += (out.empty() ? "" : ",") + std::to_string(cpu);
+        }
+    }
+    return out.empty() ? "-" : out;
+}
+
+uint64_t nonvoluntarySwitches(pid_t tid, bool& alive)
+{
+    std::ifstream in("/proc/self/task/" + std::to_string(tid) + "/status");
+    alive = in.is_open();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0) {
+            return std::strtoull(line.c_str() + 27, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+void probeThread(const ThreadPolicy& policy, const std::string& name, int durationMs, LatencyHistogram& out)
+{
+    std::string ignored;
+    ThreadSched::applyPolicy(policy, ignored);
+    const std::string threadName = ("p-" + name).substr(0, 15);
+    pthread_setname_np(pthread_self(), threadName.c_str());
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    const long long endNs = next.tv_sec * 1000000000LL + next.tv_nsec + durationMs * 1000000LL;
+    while (true) {
+        next.tv_nsec += kProbePeriodNs;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const long long nowNs  = now.tv_sec * 1000000000LL + now.tv_nsec;
+        const long long lateNs = nowNs - (next.tv_sec * 1000000000LL + next.tv_nsec);
+        out.record(lateNs > 0 ? static_cast<uint64_t>(lateNs / 1000) : 0);
+        if (nowNs >= endNs) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool ThreadSched::applyPolicy(const ThreadPolicy& policy, std::string& note)
+{
+    note.clear();
+    bool ok = true;
+    auto addNote = [&note, &ok](const std::string& text) {
+        note += (note.empty() ? "" : "; ") + text;
+        ok = false;
+    };
+
+    // 1. CPU 亲和性：剔除不在当前允许集合（在线 CPU / cgroup cpuset）中的 CPU
+    if (!policy.cpus.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &allowed);
+            }
+        }
+        cpu_set_t   set;
+        std::string dropped;
+        CPU_ZERO(&set);
+        for (int cpu : policy.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                CPU_SET(cpu, &set);
+            } else {
+                dropped += (dropped.empty() ? "" : ",") + std::to_string(cpu);
+            }
+        }
+        if (!dropped.empty()) {
+            addNote("cpu " + dropped + " not available");
+        }
+        if (CPU_COUNT(&set) == 0) {
+            addNote("affinity unchanged");
+        } else if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+            addNote(std::string("affinity denied (") + std::strerror(err) + ")");
+        }
+    }
+
+    // 2. SCHED_FIFO：EPERM 时按 RLIMIT_RTPRIO 降低优先级重试，仍失败则留在 SCHED_OTHER
+    bool fifo = false;
+    if (policy.fifoPriority > 0) {
+        int prio = std::max(sched_get_priority_min(SCHED_FIFO),
+                            std::min(sched_get_priority_max(SCHED_FIFO), policy.fifoPriority));
+        sched_param sp{};
+        sp.sched_priority = prio;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        rlimit rl{};
+        if (err == EPERM && getrlimit(RLIMIT_RTPRIO, &rl) == 0 && rl.rlim_cur > 0 &&
+            rl.rlim_cur < static_cast<rlim_t>(prio)) {
+            sp.sched_priority = static_cast<int>(rl.rlim_cur);
+            err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+            if (err == 0) {
+                addNote("fifo " + std::to_string(prio) + " capped to RLIMIT_RTPRIO " + std::to_string(rl.rlim_cur));
+            }
+        }
+        if (err == 0) {
+            fifo = true;
+        } else {
+            addNote("SCHED_FIFO " + std::to_string(prio) + " denied (" + std::strerror(err) + "), using SCHED_OTHER");
+        }
+    }
+
+    // 3. nice（Linux 下按线程生效）；FIFO 生效时 nice 无意义，不再设置
+    if (policy.hasNice && !fifo) {
+        errno = 0;
+        const int current = getpriority(PRIO_PROCESS, static_cast<id_t>(currentTid()));
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(currentTid()), policy.nice) != 0) {
+            addNote("nice " + std::to_string(policy.nice) + " denied (" + std::strerror(errno) + "), keeping " +
+                    std::to_string(current));
+        }
+    }
+    return ok;
+}
+
+void ThreadSched::apply(const char* name)
+{
+    Entry entry;
+    entry.name = name;
+    entry.tid  = currentTid();
+    const auto it = g_serverConfig.threadPolicies.find(name);
+    if (it != g_serverConfig.threadPolicies.end()) {
+        entry.policy = it->second;
+        if (!applyPolicy(entry.policy, entry.note)) {
+            std::cerr << "[ThreadSched] " << name << ": " << entry.note << "\n";
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(g_mutex);
+    auto existing = std::find_if(g_entries.begin(), g_entries.end(),
+                                 [name](const Entry& e) { return e.name == name; });
+    if (existing != g_entries.end()) {
+        *existing = std::move(entry);   // 任务重启后同名线程替换旧记录
+    } else {
+        g_entries.push_back(std::move(entry));
+    }
+}
+
+void ThreadSched::probe(int durationMs)
+{
+    std::vector<std::pair<std::string, ThreadPolicy>> targets;
+    {
+        std::lock_guard<std::mutex> lk(g_mutex);
+        for (const Entry& e : g_entries) {
+            targets.emplace_back(e.name, e.policy);
+        }
+    }
+
+    std::vector<LatencyHistogram> results(targets.size());
+    std::vector<std::thread>      probes;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        probes.emplace_back(probeThread, std::cref(targets[i].second), std::cref(targets[i].first), durationMs,
+                            std::ref(results[i]));
+    }
+    for (std::thread& t : probes) {
+        t.join();
+    }
+
+    std::lock_guard<std::mutex> lk(g_mutex);
+    for (size_t i = 0; i < targets.size(); ++i) {
+        for (Entry& e : g_entries) {
+            if (e.name == targets[i].first) {
+                e.jitterUs = results[i];
+            }
+        }
+    }
+}
+
+std::string ThreadSched::report()
+{
+    std::lock_guard<std::mutex> lk(g_mutex);
+    std::string out = "# thread        tid     policy   prio nice cpus         nvcsw  jitter_us: p50    p99    max  "
+                      "samples\n";
+    char line[256];
+    for (const Entry& e : g_entries) {
+        bool           alive = false;
+        const uint64_t nvcsw = nonvoluntarySwitches(e.tid, alive);
+        if (!alive) {
+            std::snprintf(line, sizeof(line), "%-14s %7d  (exited)\n", e.name.c_str(), e.tid);
+            out += line;
+            continue;
+        }
+        const int   policy = sched_getscheduler(e.tid);
+        sched_param sp{};
+        sched_getparam(e.tid, &sp);
+        errno = 0;
+        const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(e.tid));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(e.tid, sizeof(set), &set);
+
+        std::snprintf(line, sizeof(line), "%-14s %7d %-8s %4d %4d %-10s %7llu %15llu %6llu %6llu %8llu\n",
+                      e.name.c_str(), e.tid,
+                      policy == SCHED_FIFO ? "fifo" : policy == SCHED_RR ? "rr" : "other", sp.sched_priority, nice,
+                      cpuListText(set).c_str(), static_cast<unsigned long long>(nvcsw),
+                      static_cast<unsigned long long>(e.jitterUs.percentile(50)),
+                      static_cast<unsigned long long>(e.jitterUs.percentile(99)),
+                      static_cast<unsigned long long>(e.jitterUs.max()),
+                      static_cast<unsigned long long>(e.jitterUs.count()));
+        out += line;
+        if (!e.note.empty()) {
+            out += "    degraded: " + e.note + "\n";
+        }
+    }
+    if (g_entries.empty()) {
+        out += "(no threads registered)\n";
+    }
+    return out;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include "common_types.h"
+
+/**
+ * @brief 流水线线程的 CPU 亲和性 / SCHED_FIFO 优先级 / nice 设置与调度抖动报告。
+ *
+ *        - 各线程启动时调用 apply(name)，按 g_serverConfig.threadPolicies[name] 设置当前线程；
+ *          未配置的线程保持默认调度（UI 线程默认 nice 5）；
+ *        - 无特权时逐项降级而不失败：SCHED_FIFO 被拒绝（无 CAP_SYS_NICE 且 RLIMIT_RTPRIO 不足）时
+ *          改用 SCHED_OTHER + 配置的 nice；负 nice 被拒绝时保持原值；不在线的 CPU 从亲和性中剔除；
+ *          每项降级打印一次原因；
+ *        - report() 列出各线程实际生效的调度策略、优先级、nice、CPU 集合与非自愿上下文切换次数；
+ *        - probe(ms)：为每个已登记的线程起一个同等调度设置的探测线程，以 1ms 周期
+ *          clock_nanosleep(TIMER_ABSTIME) 唤醒，统计唤醒时刻相对预定时刻的延迟（cyclictest 方式），
+ *          与真实负载同时运行，反映该线程设置在当前负载下能达到的调度抖动。
+ *
+ *        CLI：`stats sched [ms]`。
+ */
+class ThreadSched
+{
+public:
+    /**
+     * @brief 对当前线程应用 name 对应的配置并登记（name 同 Tracer::setThreadName 使用的线程名）
+     */
+    static void apply(const char* name);
+
+    /**
+     * @brief 对当前线程应用给定设置
+     * @param note 降级说明（全部生效时为空）
+     * @return 全部按配置生效返回 true
+     */
+    static bool applyPolicy(const ThreadPolicy& policy, std::string& note);
+
+    /**
+     * @brief 运行调度抖动探测，阻塞 durationMs 毫秒，结果保存到下一次 report()
+     */
+    static void probe(int durationMs);
+
+    /**
+     * @brief 各线程实际生效的调度设置及最近一次探测结果
+     */
+    static std::string report();
+};
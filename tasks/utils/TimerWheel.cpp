@@ -0,0 +1,221 @@
+#include "TimerWheel.h"
+
+#include <cstring>
+
+TimerWheel::TimerWheel(uint64_t startTick)
+    : m_now(startTick)
+{
+    for (auto& level : m_head) {
+        for (auto& h : level) {
+            h = kNil;
+        }
+    }
+    std::memset(m_bitmap, 0, sizeof(m_bitmap));
+}
+
+void TimerWheel::add(TimerId id, uint64_t expireTick, uint64_t intervalTicks, Callback cb)
+{
+    if (id == 0 || !cb || m_index.count(id)) {
+        return;
+    }
+
+    uint32_t idx;
+    if (!m_free.empty()) {
+        idx = m_free.back();
+        m_free.pop_back();
+    } else {
+        idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& n     = m_nodes[idx];
+    n.id        = id;
+    n.expire    = expireTick < m_now ? m_now : expireTick;
+    n.interval  = intervalTicks;
+    n.cb        = std::move(cb);
+    n.cancelled = false;
+    m_index.emplace(id, idx);
+    link(idx);
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    auto it = m_index.find(id);
+    if (it == m_index.end()) {
+        return false;
+    }
+    Node& n = m_nodes[it->second];
+    if (n.cancelled) {
+        return false;
+    }
+    if (n.level >= 0) {
+        unlink(it->second);
+        release(it->second);
+    } else {
+        // 正在 advance() 中处理（可能就是当前回调自身），处理完后释放
+        n.cancelled = true;
+    }
+    return true;
+}
+
+size_t TimerWheel::advance(uint64_t nowTick)
+{
+    size_t fired = 0;
+    uint64_t t;
+    int level, slot;
+    while (nextEvent(t, level, slot) && t <= nowTick) {
+        m_now = t;
+
+        // 整槽取出，回调中对本槽的增删不会影响遍历
+        uint32_t& h = head(level, slot);
+        for (uint32_t i = h; i != kNil; i = m_nodes[i].next) {
+            m_scratch.push_back(i);
+            m_nodes[i].level = -1;
+        }
+        h = kNil;
+        if (level < kLevels) {
+            m_bitmap[level][slot / 64] &= ~(1ULL << (slot % 64));
+        }
+
+        for (uint32_t idx : m_scratch) {
+            Node& n = m_nodes[idx];
+            if (n.cancelled) {
+                release(idx);
+                continue;
+            }
+            if (level != 0) {
+                link(idx);          // 下沉到更低层
+                continue;
+            }
+
+            ++fired;
+            n.cb();                 // deque 节点地址稳定，回调中可安全地 add / cancel
+
+            if (n.cancelled || n.interval == 0) {
+                release(idx);
+                continue;
+            }
+            // 周期定时器按固定节拍重排，不累计回调执行时间；错过的周期直接跳过
+            n.expire += n.interval;
+            if (n.expire <= m_now) {
+                n.expire += ((m_now - n.expire) / n.interval + 1) * n.interval;
+            }
+            link(idx);
+        }
+        m_scratch.clear();
+    }
+    if (nowTick > m_now) {
+        m_now = nowTick;
+    }
+    return fired;
+}
+
+bool TimerWheel::nextTick(uint64_t& tick) const
+{
+    int level, slot;
+    return nextEvent(tick, level, slot);
+}
+
+uint32_t& TimerWheel::head(int level, int slot)
+{
+    return level == kLevels ? m_overflow : m_head[level][slot];
+}
+
+void TimerWheel::link(uint32_t idx)
+{
+    Node& n = m_nodes[idx];
+    const uint64_t diff = n.expire ^ m_now;
+
+    int level = 0;
+    while (level < kLevels && (diff >> (kSlotBits * (level + 1))) != 0) {
+        ++level;
+    }
+    const int slot = level < kLevels ? static_cast<int>((n.expire >> (kSlotBits * level)) & (kSlots - 1)) : 0;
+
+    uint32_t& h = head(level, slot);
+    n.level = static_cast<int16_t>(level);
+    n.slot  = static_cast<uint16_t>(slot);
+    n.prev  = kNil;
+    n.next  = h;
+    if (h != kNil) {
+        m_nodes[h].prev = idx;
+    }
+    h = idx;
+    if (level < kLevels) {
+        m_bitmap[level][slot / 64] |= 1ULL << (slot % 64);
+    }
+}
+
+void TimerWheel::unlink(uint32_t idx)
+{
+    Node& n = m_nodes[idx];
+    uint32_t& h = head(n.level, n.slot);
+    if (n.prev != kNil) {
+        m_nodes[n.prev].next = n.next;
+    } else {
+        h = n.next;
+    }
+    if (n.next != kNil) {
+        m_nodes[n.next].prev = n.prev;
+    }
+    if (h == kNil && n.level < kLevels) {
+        m_bitmap[n.level][n.slot / 64] &= ~(1ULL << (n.slot % 64));
+    }
+    n.level = -1;
+    n.prev = n.next = kNil;
+}
+
+void TimerWheel::release(uint32_t idx)
+{
+    Node& n = m_nodes[idx];
+    m_index.erase(n.id);
+    n.cb = nullptr;         // 及时释放回调捕获的资源
+    n.id = 0;
+    n.level = -1;
+    n.cancelled = false;
+    m_free.push_back(idx);
+}
+
+int TimerWheel::findSlot(int level, int from) const
+{
+    for (int w = from / 64; w < kWords; ++w) {
+        uint64_t bits = m_bitmap[level][w];
+        if (w == from / 64) {
+            bits &= ~0ULL << (from % 64);
+        }
+        if (bits) {
+            return w * 64 + __builtin_ctzll(bits);
+        }
+    }
+    return -1;
+}
+
+// 第 0 层的槽与当前 tick 高位相同，找到即为到期 tick；
+// 第 L 层的槽表示“当前 tick 的第 L 字节走到该值时需要下沉”，当前槽不可能非空，从下一个槽开找。
+// 低层的候选一定早于高层，因此自下而上找到第一个即可。
+bool TimerWheel::nextEvent(uint64_t& tick, int& level, int& slot) const
+{
+    for (int l = 0; l < kLevels; ++l) {
+        const int shift = kSlotBits * l;
+        const int cur   = static_cast<int>((m_now >> shift) & (kSlots - 1));
+        const int from  = (l == 0) ? cur : cur + 1;
+        if (from >= kSlots) {
+            continue;
+        }
+        const int s = findSlot(l, from);
+        if (s >= 0) {
+            const uint64_t highMask = ~((1ULL << (shift + kSlotBits)) - 1);
+            tick  = (m_now & highMask) | (static_cast<uint64_t>(s) << shift);
+            level = l;
+            slot  = s;
+            return true;
+        }
+    }
+    if (m_overflow != kNil) {
+        tick  = (m_now | ((1ULL << (kSlotBits * kLevels)) - 1)) + 1;
+        level = kLevels;
+        slot  = 0;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 分层时间轮（4 层 × 256 槽），由 EventLoop 驱动，非线程安全。
+ *
+ *        时间以 tick 为单位（tick 长度由 EventLoop 决定）。定时器按到期 tick 与当前 tick
+ *        最高的不同字节放入对应层：第 0 层为最近 256 个 tick，第 1~3 层依次放大 256 倍；
+ *        当前 tick 进入高层某个槽时，该槽内的定时器下沉到低层（cascade）。
+ *        每层用位图记录非空槽，nextTick() 直接定位下一个需要处理的 tick，
+ *        空闲时无需逐 tick 推进。增删为 O(1)，适合同时存在成千上万个定时器的场景。
+ */
+class TimerWheel
+{
+public:
+    using TimerId  = uint64_t;
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(uint64_t startTick = 0);
+
+    /**
+     * @brief 添加定时器
+     * @param id 调用方分配的唯一 ID（非 0）
+     * @param expireTick 到期 tick；不晚于当前 tick 时在下一次 advance() 中立即触发
+     * @param intervalTicks 周期（tick），0 表示一次性定时器
+     */
+    void add(TimerId id, uint64_t expireTick, uint64_t intervalTicks, Callback cb);
+
+    /**
+     * @brief 取消定时器；可在回调中取消自身
+     * @return 找到并取消返回 true
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief 推进到 nowTick，依次触发所有到期定时器
+     * @return 本次触发的回调个数
+     */
+    size_t advance(uint64_t nowTick);
+
+    /**
+     * @brief 下一个需要处理的 tick（到期或层间下沉）
+     * @return 没有任何定时器时返回 false
+     */
+    bool nextTick(uint64_t& tick) const;
+
+    uint64_t currentTick() const { return m_now; }
+    size_t   size() const { return m_index.size(); }
+
+private:
+    static constexpr int      kLevels    = 4;
+    static constexpr int      kSlotBits  = 8;
+    static constexpr int      kSlots     = 1 << kSlotBits;
+    static constexpr int      kWords     = kSlots / 64;
+    static constexpr uint32_t kNil       = 0xFFFFFFFFu;
+
+    struct Node {
+        TimerId  id       = 0;
+        uint64_t expire   = 0;
+        uint64_t interval = 0;
+        Callback cb;
+        uint32_t prev     = kNil;
+        uint32_t next     = kNil;
+        int16_t  level    = -1;   ///< -1 表示不在任何槽中（空闲或正在处理）；kLevels 表示溢出链表
+        uint16_t slot     = 0;
+        bool     cancelled = false;
+    };
+
+    uint32_t& head(int level, int slot);
+    void      link(uint32_t idx);
+    void      unlink(uint32_t idx);
+    void      release(uint32_t idx);
+    int       findSlot(int level, int from) const;
+    bool      nextEvent(uint64_t& tick, int& level, int& slot) const;
+
+private:
+    uint64_t m_now;
+
+    std::deque<Node>      m_nodes;     ///< deque 保证扩容时已有节点地址不变（回调中可能新增定时器）
+    std::vector<uint32_t> m_free;
+    std::unordered_map<TimerId, uint32_t> m_index;
+
+    uint32_t m_head[kLevels][kSlots];
+    uint64_t m_bitmap[kLevels][kWords];
+    uint32_t m_overflow = kNil;        ///< 超出 4 层范围（2^32 tick）的定时器，跨越该边界时再重新分层
+    std::vector<uint32_t> m_scratch;   ///< advance() 中取出的一个槽
+};
@@ -0,0 +1,310 @@
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "EventLoop.h"
+#include "Metrics.h"
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+constexpr size_t kRingEvents = 1u << 15;   ///< 每线程 32768 条，约 1.3 MB
+
+struct Event {
+    const char*  name;
+    uint64_t     beginNs;
+    uint64_t     endNs;
+    uint64_t     flowId;
+    Tracer::Flow flow;
+};
+
+struct Ring {
+    std::atomic<uint64_t>    head{0};      ///< 已发布的事件总数，只由所属线程写
+    std::unique_ptr<Event[]> events{new Event[kRingEvents]};
+    long                     tid = 0;
+    char                     name[16] = {};
+};
+
+// 与 Metrics 的线程槽位相同：线程退出后保留，以便导出其最后的事件
+std::mutex         g_ringMutex;
+std::vector<Ring*> g_rings;
+
+std::atomic<uint64_t> g_startNs{0};
+std::atomic<uint64_t> g_nextFlowId{1};
+
+std::mutex            g_triggerMutex;
+std::string           g_triggerPath;
+std::atomic<uint64_t> g_triggerNs{0};   ///< 0 表示未布防
+
+thread_local Ring*    t_ring        = nullptr;
+thread_local uint64_t t_currentFlow = 0;
+thread_local char     t_name[16]    = {};
+
+Ring& localRing()
+{
+    if (!t_ring) {
+        t_ring      = new Ring();
+        t_ring->tid = static_cast<long>(::syscall(SYS_gettid));
+        if (t_name[0]) {
+            std::memcpy(t_ring->name, t_name, sizeof(t_ring->name));
+        } else {
+            pthread_getname_np(pthread_self(), t_ring->name, sizeof(t_ring->name));
+        }
+        std::lock_guard<std::mutex> lk(g_ringMutex);
+        g_rings.push_back(t_ring);
+    }
+    return *t_ring;
+}
+
+void appendJsonString(std::string& out, const char* s)
+{
+    out += '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            out += '\\';
+        }
+        out += (static_cast<unsigned char>(*s) < 0x20) ? ' ' : *s;
+    }
+    out += '"';
+}
+
+} // namespace
+
+// --------------------------------------------------------------------------
+// Scope
+// --------------------------------------------------------------------------
+Tracer::Scope::Scope(const char* name, uint64_t flowId, Flow flow)
+    : m_name(name)
+    , m_flowId(flowId)
+    , m_flow(flow)
+{
+    if (Tracer::enabled()) {
+        m_beginNs = Metrics::nowNs();
+    }
+}
+
+Tracer::Scope::~Scope()
+{
+    if (m_beginNs) {
+        Tracer::complete(m_name, m_beginNs, Metrics::nowNs(), m_flowId, m_flow);
+    }
+}
+
+void Tracer::Scope::setFlow(uint64_t flowId, Flow flow)
+{
+    m_flowId = flowId;
+    m_flow   = flow;
+}
+
+// --------------------------------------------------------------------------
+// 记录
+// --------------------------------------------------------------------------
+void Tracer::start()
+{
+    g_startNs.store(Metrics::nowNs(), std::memory_order_relaxed);
+    s_enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+    s_enabled.store(false, std::memory_order_release);
+}
+
+void Tracer::complete(const char* name, uint64_t beginNs, uint64_t endNs, uint64_t flowId, Flow flow)
+{
+    if (!enabled()) {
+        return;
+    }
+    Ring& ring = localRing();
+    const uint64_t idx = ring.head.load(std::memory_order_relaxed);
+    Event& ev = ring.events[idx & (kRingEvents - 1)];
+    ev.name    = name;
+    ev.beginNs = beginNs;
+    ev.endNs   = endNs;
+    ev.flowId  = flowId;
+    ev.flow    = flowId ? flow : Flow::None;
+    ring.head.store(idx + 1, std::memory_order_release);
+}
+
+uint64_t Tracer::newFlowId()
+{
+    return g_nextFlowId.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::frameFlowId(const std::vector<uint8_t>& frame)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (uint8_t b : frame) {
+        h = (h ^ b) * 1099511628211ULL;
+    }
+    // 最高位置 1，与 newFlowId() 的递增 ID 区分开
+    return h | (1ULL << 63);
+}
+
+void Tracer::setCurrentFlow(uint64_t flowId)
+{
+    t_currentFlow = flowId;
+}
+
+uint64_t Tracer::currentFlow()
+{
+    return t_currentFlow;
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    std::strncpy(t_name, name, sizeof(t_name) - 1);
+    pthread_setname_np(pthread_self(), t_name);
+    if (t_ring) {
+        std::memcpy(t_ring->name, t_name, sizeof(t_ring->name));
+    }
+}
+
+size_t Tracer::ringCapacity()
+{
+    return kRingEvents;
+}
+
+// --------------------------------------------------------------------------
+// 导出
+// --------------------------------------------------------------------------
+long Tracer::dump(const std::string& path)
+{
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lk(g_ringMutex);
+        rings = g_rings;
+    }
+    const uint64_t startNs = g_startNs.load(std::memory_order_relaxed);
+
+    std::FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp) {
+        std::cerr << "[Tracer] Cannot open " << path << ": " << std::strerror(errno) << "\n";
+        return -1;
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool   first = true;
+    long   count = 0;
+    char   buf[256];
+    auto   emit  = [&](const char* text) {
+        if (!first) {
+            out += ",\n";
+        }
+        first = false;
+        out += text;
+    };
+
+    std::vector<Event> copy(kRingEvents);
+    for (Ring* ring : rings) {
+        // 先读 head，再拷贝，再读一次 head：拷贝期间可能被覆盖的槽位（以及正在写的那一个）一律丢弃
+        const uint64_t h1    = ring->head.load(std::memory_order_acquire);
+        const uint64_t first1 = h1 > kRingEvents ? h1 - kRingEvents : 0;
+        for (uint64_t i = first1; i < h1; ++i) {
+            copy[i & (kRingEvents - 1)] = ring->events[i & (kRingEvents - 1)];
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t h2    = ring->head.load(std::memory_order_relaxed);
+        const uint64_t valid = (h2 + 1 > kRingEvents) ? h2 + 1 - kRingEvents : 0;
+
+        std::string name = "tid ";
+        name += std::to_string(ring->tid);
+        std::string meta = "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + std::to_string(ring->tid)
+                         + ",\"args\":{\"name\":";
+        appendJsonString(meta, ring->name[0] ? ring->name : name.c_str());
+        meta += "}}";
+        emit(meta.c_str());
+
+        for (uint64_t i = std::max(first1, valid); i < h1; ++i) {
+            const Event& ev = copy[i & (kRingEvents - 1)];
+            if (ev.beginNs < startNs) {
+                continue;
+            }
+            const double ts  = (ev.beginNs - startNs) / 1e3;
+            const double dur = (ev.endNs - ev.beginNs) / 1e3;
+            std::string line = "{\"ph\":\"X\",\"cat\":\"frame\",\"pid\":1,\"tid\":" + std::to_string(ring->tid)
+                             + ",\"name\":";
+            appendJsonString(line, ev.name);
+            std::snprintf(buf, sizeof(buf), ",\"ts\":%.3f,\"dur\":%.3f", ts, dur);
+            line += buf;
+            if (ev.flowId) {
+                std::snprintf(buf, sizeof(buf), ",\"args\":{\"flow\":\"0x%llx\"}",
+                              static_cast<unsigned long long>(ev.flowId));
+                line += buf;
+            }
+            line += '}';
+            emit(line.c_str());
+            ++count;
+
+            if (ev.flow != Flow::None) {
+                // flow 事件绑定到同一线程上包含该时刻的时间段；终点使用 "bp":"e" 绑定到包围它的时间段
+                const char* ph = ev.flow == Flow::Start ? "s" : (ev.flow == Flow::Step ? "t" : "f");
+                std::snprintf(buf, sizeof(buf),
+                              "{\"ph\":\"%s\",\"cat\":\"frame\",\"name\":\"frame\",\"id\":\"0x%llx\",\"pid\":1,"
+                              "\"tid\":%ld,\"ts\":%.3f%s}",
+                              ph, static_cast<unsigned long long>(ev.flowId), ring->tid, ts,
+                              ev.flow == Flow::End ? ",\"bp\":\"e\"" : "");
+                emit(buf);
+            }
+        }
+
+        if (out.size() > (1u << 20)) {
+            std::fwrite(out.data(), 1, out.size(), fp);
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    std::fwrite(out.data(), 1, out.size(), fp);
+    std::fclose(fp);
+
+    std::cout << "[Tracer] Wrote " << count << " events to " << path << "\n";
+    return count;
+}
+
+// --------------------------------------------------------------------------
+// 触发器
+// --------------------------------------------------------------------------
+void Tracer::armTrigger(double thresholdMs, const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lk(g_triggerMutex);
+        g_triggerPath = path;
+    }
+    g_triggerNs.store(std::max<uint64_t>(1, static_cast<uint64_t>(thresholdMs * 1e6)), std::memory_order_release);
+    if (!enabled()) {
+        start();   // 触发时要有缓冲可写，未开启时顺带开始记录
+    }
+}
+
+void Tracer::disarmTrigger()
+{
+    g_triggerNs.store(0, std::memory_order_release);
+}
+
+void Tracer::checkTrigger(uint64_t recvNs, uint64_t handledNs)
+{
+    const uint64_t threshold = g_triggerNs.load(std::memory_order_relaxed);
+    if (threshold == 0 || recvNs == 0 || handledNs < recvNs || handledNs - recvNs < threshold) {
+        return;
+    }
+    uint64_t expected = threshold;
+    if (!g_triggerNs.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+        return;   // 已被其他线程触发或解除
+    }
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lk(g_triggerMutex);
+        path = g_triggerPath;
+    }
+    std::cerr << "[Tracer] Frame took " << (handledNs - recvNs) / 1e6 << " ms, dumping trace to " << path << "\n";
+    // 文件 I/O 放到事件循环线程，不占用解析线程
+    g_eventLoop.queueInLoop([path] { Tracer::dump(path); });
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 帧生命周期追踪，导出 Chrome trace-event JSON（chrome://tracing 或 ui.perfetto.dev 直接打开）。
+ *
+ *        - 默认关闭；关闭时每个埋点只有一次 relaxed 读和一次分支；
+ *        - 开启后每个线程首次记录时分配一个固定容量的环形缓冲，只由该线程写，写满后覆盖最旧的事件，
+ *          因此任何时刻都保留最近一段时间的完整记录（飞行记录仪模式）；
+ *        - dump() 可在任意线程调用：读取各线程已发布的事件，丢弃读取期间可能被覆盖的部分，不阻塞写入方；
+ *        - 事件为 "X"（完整时间段）；带 flowId 的事件额外输出 flow 事件，把同一帧在不同线程上的各阶段连起来。
+ *
+ *        接收方向以 socket 读到的每段数据为一条 flow：recv -> parseBuffer -> decode -> handleFrameData
+ *        -> publish -> render；发送方向以帧内容哈希为 flow：parseCommand -> TCPSendData
+ *        （相同内容的帧会共用同一条 flow，排查时以时间先后区分）。
+ *
+ *        触发器：armTrigger(thresholdMs, path) 后，接收 -> 处理完毕的时延首次超过阈值时，
+ *        在事件循环线程把当前各环形缓冲写出到 path，并自动解除。
+ */
+class Tracer
+{
+public:
+    enum class Flow : uint8_t { None, Start, Step, End };
+
+    /**
+     * @brief RAII 时间段：构造时记录起点，析构时提交一条事件（追踪关闭时什么也不做）
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name, uint64_t flowId = 0, Flow flow = Flow::None);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief 在时间段结束前补充 flow 信息（如 flowId 需要在段内才能算出）
+         */
+        void setFlow(uint64_t flowId, Flow flow);
+
+    private:
+        const char* m_name;
+        uint64_t    m_beginNs = 0;
+        uint64_t    m_flowId;
+        Flow        m_flow;
+    };
+
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 开始记录；此前缓冲中的事件不再导出
+     */
+    static void start();
+    static void stop();
+
+    /**
+     * @brief 提交一条完整时间段事件，name 必须是静态字符串
+     */
+    static void complete(const char* name, uint64_t beginNs, uint64_t endNs,
+                         uint64_t flowId = 0, Flow flow = Flow::None);
+
+    /**
+     * @brief 写出 Chrome trace-event JSON
+     * @return 写出的事件数，失败返回 -1
+     */
+    static long dump(const std::string& path);
+
+    static void armTrigger(double thresholdMs, const std::string& path);
+    static void disarmTrigger();
+
+    /**
+     * @brief 由解析线程在一帧处理完毕后调用，检查是否触发自动导出
+     */
+    static void checkTrigger(uint64_t recvNs, uint64_t handledNs);
+
+    /**
+     * @brief 分配一个新的 flow ID（非 0）
+     */
+    static uint64_t newFlowId();
+
+    /**
+     * @brief 按帧内容计算 flow ID（FNV-1a，非 0），用于没有随帧携带 ID 的发送方向
+     */
+    static uint64_t frameFlowId(const std::vector<uint8_t>& frame);
+
+    /**
+     * @brief 当前线程正在处理的接收 flow（解析线程在回调前设置，供下游埋点取用）
+     */
+    static void     setCurrentFlow(uint64_t flowId);
+    static uint64_t currentFlow();
+
+    /**
+     * @brief 设置当前线程名（同时作用于 pthread 名与追踪输出，系统限制 15 字符）
+     */
+    static void setThreadName(const char* name);
+
+    static size_t ringCapacity();
+
+private:
+    static std::atomic<bool> s_enabled;
+};